@@ -11,6 +11,7 @@ import tarfile
 import configparser
 import subprocess
 import hashlib
+import struct
 from typing import Iterable
 
 pj = os.path.join
@@ -19,11 +20,13 @@ argparser = argparse.ArgumentParser(description="bundle assets into a folder")
 argparser.add_argument("--desc", help="the input bundle description file")
 argparser.add_argument("--dir", help="the input directory")
 argparser.add_argument("--outdir", help="the output directory")
-argparser.add_argument("--bundle", help="output tar file")
+argparser.add_argument("--bundle", help="output bundle file")
+argparser.add_argument("--format", help="output bundle format", choices=["pack", "tar"], default="pack")
 argparser.add_argument("--depfile", help="the output dependency file")
 argparser.add_argument("--config", help="config file with tool paths")
 argparser.add_argument("--debug", help="enable debug mode", action="store_true")
 argparser.add_argument("--root", help="source root directory")
+argparser.add_argument("--incremental", help="only rebuild changed assets and patch the existing bundle", action="store_true")
 args = argparser.parse_args()
 
 bundlefile = args.desc
@@ -98,9 +101,91 @@ class Config:
 
 config = Config(args.config)
 
+# read in chunks rather than with hashlib.file_digest, that needs python 3.11
+HASH_CHUNK_SIZE = 1024 * 1024
+
 def hash_file(path):
+    h = hashlib.sha256()
     with open(path, "rb") as file:
-        return hashlib.file_digest(file, 'sha256').hexdigest()
+        while chunk := file.read(HASH_CHUNK_SIZE):
+            h.update(chunk)
+    return h.hexdigest()
+
+class BuildCache:
+    # records a fingerprint of the inputs of every output so unchanged
+    # assets are not rebuilt. only used with --incremental
+    VERSION = 1
+
+    def __init__(self, path, enabled):
+        self.path = path
+        self.enabled = enabled
+        self.entries = dict()
+        self.used = dict()
+        self.hashes = dict()
+
+        if not enabled or not os.path.exists(path):
+            return
+
+        try:
+            data = json.load(open(path, "r"))
+            if data.get('version') == self.VERSION:
+                self.entries = data['outputs']
+        except (OSError, ValueError, KeyError) as e:
+            log.info(f'ignoring unreadable build cache {path}: {e}')
+
+    # shared headers are hashed once per run rather than once per shader
+    def hash_input(self, path):
+        if path not in self.hashes:
+            self.hashes[path] = hash_file(path)
+        return self.hashes[path]
+
+    def fingerprint(self, command, inputs):
+        h = hashlib.sha256()
+        for arg in flatten(command):
+            h.update(str(arg).encode('utf-8') + b'\0')
+
+        for path in sorted(set(inputs)):
+            h.update(path.encode('utf-8') + b'\0' + self.hash_input(path).encode('utf-8'))
+
+        return h.hexdigest()
+
+    def is_fresh(self, outputs, key):
+        if not self.enabled:
+            return False
+
+        return all(os.path.exists(it) and self.entries.get(it) == key for it in outputs)
+
+    def record(self, outputs, key):
+        for output in outputs:
+            self.used[output] = key
+
+    # only outputs produced by this run are kept so removed assets do not linger
+    def save(self):
+        json.dump({ 'version': self.VERSION, 'outputs': self.used }, open(self.path, "w"), indent=1)
+
+cache = BuildCache(pj(outputdir, 'bundle.cache.json'), args.incremental)
+
+# every file written into the bundle directory this run
+produced = set()
+
+def build_step(outputs, command, inputs):
+    for output in outputs:
+        produced.add(os.path.normpath(output))
+
+    for path in inputs:
+        deps.add(path)
+
+    key = cache.fingerprint(command, inputs)
+    if cache.is_fresh(outputs, key):
+        log.info(f'up to date: {", ".join(outputs)}')
+        cache.record(outputs, key)
+        return 0
+
+    result = run_command(command)
+    if result == 0:
+        cache.record(outputs, key)
+
+    return result
 
 def tool_exit(code):
     if code == 0:
@@ -141,6 +226,10 @@ def copyfile(src, dst):
     log.info(f"copying {src} to {dst}\n")
     shutil.copy(src, dst)
 
+    if os.path.isdir(dst):
+        dst = pj(dst, os.path.basename(src))
+    produced.add(os.path.normpath(dst))
+
 def copy_redist(outdir, name, redists, debug_redists):
     indir = config.get_redist(name)
     os.makedirs(outdir, exist_ok=True)
@@ -153,6 +242,8 @@ def copy_redist(outdir, name, redists, debug_redists):
     for redist in debug_redists:
         copyfile(pj(indir, redist), outdir)
 
+SHADER_HEADER_EXTS = ('.hlsl', '.hlsli', '.hpp', '.h')
+
 class ShaderCompiler:
     # dxc is the path to dxc.exe
     # target_dir is the output directory
@@ -166,10 +257,13 @@ class ShaderCompiler:
 
         # TODO: this include path is a bit of a hack but meson is just so shit
         # at producing build directories with any rigid structure
+        self.include_dirs = [
+            rootdir + '\\src\\common\\draw\\include\\draw',
+            rootdir + '\\src\\common\\draw\\include'
+        ]
         self.args = [
             self.dxc, '/WX', '/Ges',
-            '-I' + rootdir + '\\src\\common\\draw\\include\\draw',
-            '-I' + rootdir + '\\src\\common\\draw\\include'
+            [ '-I' + it for it in self.include_dirs ]
         ]
         if self.debug:
             self.args += [ '/Zi', '/Fd', self.pdb_dir + '\\' ]
@@ -193,7 +287,16 @@ class ShaderCompiler:
         for define in defines:
             extra_args += [ '-D', define ]
 
-        return run_command([ self.args, extra_args, file ])
+        return build_step([ output ], [ self.args, extra_args, file ], [ file ] + self.get_headers(file))
+
+    # dxc doesnt report what a shader includes, so any header it could
+    # include is treated as an input
+    def get_headers(self, file):
+        result = []
+        for dir in [ os.path.dirname(file) ] + self.include_dirs:
+            for dirpath, _, filenames in os.walk(dir):
+                result += [ pj(dirpath, it) for it in filenames if it.endswith(SHADER_HEADER_EXTS) ]
+        return result
 
 class AtlasGenerator:
     def __init__(self, target_dir, input_dir):
@@ -213,7 +316,7 @@ class AtlasGenerator:
             '-arfont', f'{atlas_path}.arfont',
             '-imageout', f'{atlas_path}.png'
         ]
-        return run_command(cmd)
+        return build_step([ f'{atlas_path}.arfont', f'{atlas_path}.png' ], cmd, files)
 
     # if `files` is not present in the options,
     # it is assumed that `path` is the file
@@ -225,6 +328,213 @@ class AtlasGenerator:
         else:
             return [ path ]
 
+# indexed bundle format, must match src/common/archive/include/archive/pack.hpp
+PACK_MAGIC = b'SMPK'
+PACK_VERSION = 1
+
+PACK_HEADER = struct.Struct('<4sHHIIQQ')
+PACK_ENTRY = struct.Struct('<IHBBQQQQ')
+
+PACK_COMPRESS_NONE = 0
+PACK_COMPRESS_LZ4 = 1
+PACK_COMPRESS_ZSTD = 2
+
+# entries that dont shrink by at least this much are stored uncompressed
+# so they can be read straight from the mapping
+PACK_MIN_SAVING = 0.95
+
+def pack_hash(data):
+    # 64 bit FNV-1a, sm::pack::hashData
+    h = 0xcbf29ce484222325
+    for b in data:
+        h ^= b
+        h = (h * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+def get_pack_compressor():
+    try:
+        import zstandard
+        cctx = zstandard.ZstdCompressor(level=19)
+        return PACK_COMPRESS_ZSTD, cctx.compress
+    except ImportError:
+        pass
+
+    try:
+        import lz4.block
+        return PACK_COMPRESS_LZ4, lambda data: lz4.block.compress(data, mode='high_compression', store_size=False)
+    except ImportError:
+        pass
+
+    log.info('neither zstandard or lz4 are installed, pack entries will be stored uncompressed')
+    return PACK_COMPRESS_NONE, None
+
+def compress_entry(compressor, data):
+    kind, compress = compressor
+    if compress is None or len(data) == 0:
+        return PACK_COMPRESS_NONE, data
+
+    packed = compress(data)
+    if len(packed) >= len(data) * PACK_MIN_SAVING:
+        return PACK_COMPRESS_NONE, data
+
+    return kind, packed
+
+# the pack is content addressed, entries with identical data share one blob.
+# this sidecar records where each blob is stored keyed by its sha256 so an
+# incremental build can append only new blobs and rewrite the index
+PACK_BLOBS_VERSION = 1
+
+# an incremental build rewrites the whole pack once less than this
+# fraction of the stored data is still referenced
+PACK_MIN_LIVE = 0.5
+
+def load_pack_blobs(path):
+    blobs_path = path + '.blobs.json'
+    if not os.path.exists(path) or not os.path.exists(blobs_path):
+        return None
+
+    try:
+        blobs = json.load(open(blobs_path, "r"))
+        if blobs.get('version') != PACK_BLOBS_VERSION:
+            return None
+
+        # make sure the sidecar describes the pack on disk
+        with open(path, 'rb') as file:
+            header = PACK_HEADER.unpack(file.read(PACK_HEADER.size))
+
+        if header[0] != PACK_MAGIC or header[1] != PACK_VERSION or header[5] != blobs['data_end']:
+            return None
+
+        return blobs
+    except (OSError, ValueError, KeyError, struct.error) as e:
+        log.info(f'ignoring unreadable pack index {blobs_path}: {e}')
+        return None
+
+def write_pack(path, root, incremental = False):
+    compressor = get_pack_compressor()
+
+    # entries are named the same way they were in the tar, relative to the parent of root
+    files = []
+    for dirpath, _, filenames in os.walk(root):
+        for filename in filenames:
+            fullpath = pj(dirpath, filename)
+            name = os.path.relpath(fullpath, os.path.dirname(root)).replace(os.sep, '/')
+            files.append((name, fullpath, hash_file(fullpath)))
+
+    # the runtime binary searches the toc
+    files.sort(key=lambda it: it[0].encode('utf-8'))
+
+    existing = load_pack_blobs(path) if incremental else None
+    if existing is not None:
+        live = { digest for _, _, digest in files }
+        stored = sum(blob['stored'] for blob in existing['blobs'].values())
+        reused = sum(blob['stored'] for digest, blob in existing['blobs'].items() if digest in live)
+
+        if stored > 0 and reused < stored * PACK_MIN_LIVE:
+            log.info(f'pack {path} is mostly unreferenced data, rewriting it')
+            existing = None
+
+    blobs = existing['blobs'] if existing is not None else dict()
+
+    entries = []
+    names = bytearray()
+    written = 0
+
+    # the pack is built next to the old one and only moved over it once complete,
+    # an interrupted build leaves the previous pack and its sidecar untouched
+    temp_path = path + '.tmp'
+    blobs_path = path + '.blobs.json'
+    try:
+        with open(temp_path, 'wb') as out:
+            if existing is not None:
+                # the old blobs keep their offsets, the old index after them is dropped
+                with open(path, 'rb') as old:
+                    copy_prefix(old, out, existing['data_end'])
+            else:
+                out.write(b'\0' * PACK_HEADER.size)
+
+            for name, fullpath, digest in files:
+                blob = blobs.get(digest)
+                if blob is None:
+                    data = open(fullpath, 'rb').read()
+                    compression, packed = compress_entry(compressor, data)
+
+                    blob = {
+                        'offset': out.tell(),
+                        'stored': len(packed),
+                        'size': len(data),
+                        'compression': compression,
+                        'hash': pack_hash(data)
+                    }
+
+                    out.write(packed)
+                    blobs[digest] = blob
+                    written += 1
+
+                encoded = name.encode('utf-8')
+                entries.append(PACK_ENTRY.pack(
+                    len(names), len(encoded), blob['compression'], 0,
+                    blob['offset'], blob['stored'], blob['size'], blob['hash']
+                ))
+                names += encoded
+
+            # the toc is read in place so has to be aligned
+            out.write(b'\0' * (-out.tell() % 8))
+
+            toc_offset = out.tell()
+            for entry in entries:
+                out.write(entry)
+
+            names_offset = out.tell()
+            out.write(names)
+
+            out.seek(0)
+            out.write(PACK_HEADER.pack(PACK_MAGIC, PACK_VERSION, 0, len(entries), len(names), toc_offset, names_offset))
+
+            out.flush()
+            os.fsync(out.fileno())
+
+        # the old sidecar is dropped first, if we stop before writing the new one
+        # the next incremental build rewrites the pack rather than trusting it
+        if os.path.exists(blobs_path):
+            os.remove(blobs_path)
+
+        os.replace(temp_path, path)
+    finally:
+        if os.path.exists(temp_path):
+            os.remove(temp_path)
+
+    with open(blobs_path + '.tmp', "w") as file:
+        json.dump({ 'version': PACK_BLOBS_VERSION, 'data_end': toc_offset, 'blobs': blobs }, file, indent=1)
+
+    os.replace(blobs_path + '.tmp', blobs_path)
+
+    unique = len({ digest for _, _, digest in files })
+    log.info(f'wrote pack {path} ({len(entries)} entries, {unique} unique blobs, {written} new)')
+
+def copy_prefix(src, dst, size):
+    while size > 0:
+        chunk = src.read(min(size, HASH_CHUNK_SIZE))
+        if not chunk:
+            raise OSError(f'pack ended {size} bytes early')
+
+        dst.write(chunk)
+        size -= len(chunk)
+
+# remove outputs of assets that are no longer in the bundle description
+def remove_stale_files():
+    pdbdir = pj(bundle_dir, "pdb")
+    for dirpath, _, filenames in os.walk(bundle_dir):
+        # pdb names are chosen by dxc
+        if os.path.commonpath([ dirpath, pdbdir ]) == pdbdir:
+            continue
+
+        for filename in filenames:
+            path = os.path.normpath(pj(dirpath, filename))
+            if path not in produced:
+                log.info(f'removing stale file {path}')
+                os.remove(path)
+
 def copy_redist_files():
     redist_dir = pj(outputdir, 'redist')
     os.makedirs(redist_dir, exist_ok=True)
@@ -265,8 +575,8 @@ def main():
         log.info(f"error: {inputdir} does not exist")
         tool_exit(1)
 
-    # delete output directorys contents
-    if os.path.exists(bundle_dir):
+    # delete output directorys contents, incremental builds reuse them
+    if os.path.exists(bundle_dir) and not args.incremental:
         # cant delete the dir itself because meson is watching it
         for root, dirs, files in os.walk(bundle_dir):
             for file in files:
@@ -350,13 +660,20 @@ def main():
         deps.add(itempath)
 
         outpath = os.path.join(texturedir, texture['name'] + '.dds')
-        result = run_command([compressor, '-fd', 'BC7', itempath, outpath, '-miplevels', mips])
+        result = build_step([ outpath ], [compressor, '-fd', 'BC7', itempath, outpath, '-miplevels', mips], [ itempath ])
         tool_exit(result)
 
+    if args.incremental:
+        remove_stale_files()
+
+    cache.save()
     deps.write()
 
-    with tarfile.open(outputfile, "w", format=tarfile.USTAR_FORMAT) as tar:
-        tar.add(bundle_dir, arcname=os.path.basename(bundle_dir))
+    if args.format == 'pack':
+        write_pack(outputfile, bundle_dir, args.incremental)
+    else:
+        with tarfile.open(outputfile, "w", format=tarfile.USTAR_FORMAT) as tar:
+            tar.add(bundle_dir, arcname=os.path.basename(bundle_dir))
 
 if __name__ == "__main__":
     main()
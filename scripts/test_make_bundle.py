@@ -0,0 +1,154 @@
+#!/usr/bin/python3
+
+# tests for the pack writer in make_bundle.py
+# run with python3 -m unittest scripts/test_make_bundle.py
+
+import os
+import sys
+import tempfile
+import unittest
+from unittest import mock
+
+pj = os.path.join
+
+# make_bundle parses its arguments and opens its log on import
+workdir = tempfile.TemporaryDirectory()
+cwd = os.getcwd()
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+sys.argv = [ 'make_bundle.py', '--outdir', workdir.name, '--config', pj(workdir.name, 'tools.ini') ]
+os.chdir(workdir.name)
+try:
+    import make_bundle as mb
+finally:
+    os.chdir(cwd)
+
+def read_file(path):
+    with open(path, 'rb') as file:
+        return file.read()
+
+def read_pack(path):
+    data = read_file(path)
+    magic, version, _, count, names_size, toc_offset, names_offset = mb.PACK_HEADER.unpack_from(data, 0)
+    assert magic == mb.PACK_MAGIC and version == mb.PACK_VERSION
+
+    names = data[names_offset:names_offset + names_size]
+
+    result = dict()
+    for i in range(count):
+        name_offset, name_size, compression, _, offset, stored, size, _ = mb.PACK_ENTRY.unpack_from(data, toc_offset + i * mb.PACK_ENTRY.size)
+        assert compression == mb.PACK_COMPRESS_NONE and stored == size
+
+        name = names[name_offset:name_offset + name_size].decode('utf-8')
+        result[name] = (offset, data[offset:offset + size])
+
+    return result
+
+# stored uncompressed so the test does not depend on zstandard or lz4 being installed
+@mock.patch.object(mb, 'get_pack_compressor', lambda: (mb.PACK_COMPRESS_NONE, None))
+class PackWriterTest(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.TemporaryDirectory()
+        self.root = pj(self.dir.name, 'bundle')
+        self.pack = pj(self.dir.name, 'bundle.pack')
+        os.makedirs(pj(self.root, 'textures'))
+
+    def tearDown(self):
+        self.dir.cleanup()
+
+    def write(self, name, data):
+        with open(pj(self.root, name), 'wb') as file:
+            file.write(data)
+
+    def check_contents(self, expected):
+        entries = read_pack(self.pack)
+        self.assertEqual(sorted(entries.keys()), sorted('bundle/' + it for it in expected.keys()))
+        for name, data in expected.items():
+            self.assertEqual(entries['bundle/' + name][1], data)
+
+        return entries
+
+    def test_identical_files_share_a_blob(self):
+        files = {
+            'a.bin': b'first' * 100,
+            'b.bin': b'first' * 100,
+            'textures/c.bin': b'second' * 100,
+            'empty.bin': b'',
+        }
+
+        for name, data in files.items():
+            self.write(name, data)
+
+        mb.write_pack(self.pack, self.root)
+
+        entries = self.check_contents(files)
+        self.assertEqual(entries['bundle/a.bin'][0], entries['bundle/b.bin'][0])
+        self.assertNotEqual(entries['bundle/a.bin'][0], entries['bundle/textures/c.bin'][0])
+
+        blobs = mb.load_pack_blobs(self.pack)
+        self.assertIsNotNone(blobs)
+        self.assertEqual(len(blobs['blobs']), 3)
+
+    def test_incremental_rebuild_appends_new_blobs(self):
+        files = {
+            'a.bin': b'first' * 100,
+            'b.bin': b'second' * 100,
+            'c.bin': b'third' * 100,
+        }
+
+        for name, data in files.items():
+            self.write(name, data)
+
+        mb.write_pack(self.pack, self.root)
+        before = read_pack(self.pack)
+        data_end = mb.load_pack_blobs(self.pack)['data_end']
+
+        # one changed file, one new duplicate and one new file
+        files['c.bin'] = b'changed' * 100
+        files['d.bin'] = b'first' * 100
+        files['e.bin'] = b'fourth' * 100
+
+        for name in [ 'c.bin', 'd.bin', 'e.bin' ]:
+            self.write(name, files[name])
+
+        mb.write_pack(self.pack, self.root, incremental = True)
+
+        after = self.check_contents(files)
+
+        # unchanged blobs stay where they were, new ones go after the old data
+        self.assertEqual(after['bundle/a.bin'][0], before['bundle/a.bin'][0])
+        self.assertEqual(after['bundle/b.bin'][0], before['bundle/b.bin'][0])
+        self.assertEqual(after['bundle/d.bin'][0], before['bundle/a.bin'][0])
+        self.assertGreaterEqual(after['bundle/c.bin'][0], data_end)
+        self.assertGreaterEqual(after['bundle/e.bin'][0], data_end)
+
+        self.assertIsNotNone(mb.load_pack_blobs(self.pack))
+
+    def test_interrupted_rebuild_keeps_the_old_pack(self):
+        files = {
+            'a.bin': b'first' * 100,
+            'b.bin': b'second' * 100,
+        }
+
+        for name, data in files.items():
+            self.write(name, data)
+
+        mb.write_pack(self.pack, self.root)
+        original = read_file(self.pack)
+
+        self.write('c.bin', b'third' * 100)
+
+        with mock.patch.object(mb, 'compress_entry', side_effect = OSError('interrupted')):
+            with self.assertRaises(OSError):
+                mb.write_pack(self.pack, self.root, incremental = True)
+
+        self.assertEqual(read_file(self.pack), original)
+        self.assertFalse(os.path.exists(self.pack + '.tmp'))
+        self.assertIsNotNone(mb.load_pack_blobs(self.pack))
+
+        # the next build picks up where the old pack left off
+        files['c.bin'] = b'third' * 100
+        mb.write_pack(self.pack, self.root, incremental = True)
+        self.check_contents(files)
+
+if __name__ == '__main__':
+    unittest.main()
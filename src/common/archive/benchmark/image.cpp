@@ -0,0 +1,87 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "archive/image.hpp"
+
+#include <fstream>
+
+using namespace sm;
+
+// run from the source root, see the benchmark workdir in meson.build
+static const fs::path kTextureRoot = "data/assets/textures";
+
+static std::vector<fs::path> findTextures() {
+    std::vector<fs::path> result;
+    for (const auto& entry : fs::recursive_directory_iterator(kTextureRoot)) {
+        if (entry.is_regular_file())
+            result.push_back(entry.path());
+    }
+
+    return result;
+}
+
+static std::vector<byte> readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+TEST_CASE("Decode textures") {
+    std::vector<fs::path> paths = findTextures();
+    REQUIRE(!paths.empty());
+
+    std::vector<std::vector<byte>> files;
+    for (const fs::path& path : paths) {
+        files.push_back(readFile(path));
+    }
+
+    BENCHMARK("Load into new image") {
+        size_t total = 0;
+        for (const auto& file : files) {
+            total += loadImage(file).value().sizeInBytes();
+        }
+        return total;
+    };
+
+    // the same buffer is reused so nothing is allocated after the first run
+    std::vector<byte> buffer;
+    auto sink = [&](const ImageInfo& info) {
+        if (buffer.size() < info.sizeInBytes())
+            buffer.resize(info.sizeInBytes());
+
+        return std::span(buffer);
+    };
+
+    BENCHMARK("Decode into reused buffer") {
+        size_t total = 0;
+        for (const auto& file : files) {
+            total += decodeImage(file, sink).value().sizeInBytes();
+        }
+        return total;
+    };
+
+    BENCHMARK("Stream from file") {
+        size_t total = 0;
+        for (const fs::path& path : paths) {
+            total += streamImage(path, sink).value().sizeInBytes();
+        }
+        return total;
+    };
+}
+
+TEST_CASE("Batch decode textures") {
+    // repeat the directory so there is enough work to spread across threads
+    std::vector<fs::path> paths;
+    for (int i = 0; i < 16; i++) {
+        for (const fs::path& path : findTextures()) {
+            paths.push_back(path);
+        }
+    }
+
+    BENCHMARK("Batch single thread") {
+        return openImages(paths, 1).size();
+    };
+
+    BENCHMARK("Batch all threads") {
+        return openImages(paths).size();
+    };
+}
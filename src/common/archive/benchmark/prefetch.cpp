@@ -0,0 +1,93 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "archive/bundle.hpp"
+
+using namespace sm;
+
+// run from the source root, see the benchmark workdir in meson.build
+static const fs::path kAssetRoot = "data/assets";
+
+struct AssetList {
+    std::vector<std::string> names;
+    std::vector<AssetRef> assets;
+    size_t totalSize = 0;
+};
+
+static AssetList findAssets() {
+    AssetList result;
+    for (const auto& entry : fs::recursive_directory_iterator(kAssetRoot)) {
+        if (!entry.is_regular_file())
+            continue;
+
+        result.names.push_back(fs::relative(entry.path(), kAssetRoot).generic_string());
+        result.totalSize += entry.file_size();
+    }
+
+    for (const std::string& name : result.names) {
+        result.assets.push_back(AssetRef { AssetType::eFile, name });
+    }
+
+    return result;
+}
+
+static size_t prefetchAll(Bundle& bundle, const AssetList& list) {
+    PrefetchHandle handle = bundle.prefetch(list.assets);
+    handle.wait();
+
+    REQUIRE(handle.getFailedCount() == 0);
+
+    size_t total = 0;
+    for (size_t i = 0; i < handle.getCount(); i++) {
+        total += handle.getData(i).size();
+    }
+
+    return total;
+}
+
+TEST_CASE("Prefetch asset tree") {
+    AssetList list = findAssets();
+    REQUIRE(!list.assets.empty());
+
+    // cold runs mount a fresh file system each time so nothing is cached
+    // in process, the os page cache will still be warm after the first run
+    BENCHMARK("Cold disk file system") {
+        Bundle bundle{mountFileSystem(kAssetRoot)};
+        return prefetchAll(bundle, list);
+    };
+
+    BENCHMARK("Cold mapped file system") {
+        Bundle bundle{mountMappedFileSystem(kAssetRoot, MappedConfig{})};
+        return prefetchAll(bundle, list);
+    };
+
+    BENCHMARK("Cold single worker") {
+        Bundle bundle{mountMappedFileSystem(kAssetRoot, MappedConfig{}), 1};
+        return prefetchAll(bundle, list);
+    };
+
+    Bundle disk{mountFileSystem(kAssetRoot)};
+    Bundle mapped{mountMappedFileSystem(kAssetRoot, MappedConfig{})};
+
+    REQUIRE(prefetchAll(disk, list) == list.totalSize);
+    REQUIRE(prefetchAll(mapped, list) == list.totalSize);
+
+    BENCHMARK("Warm disk file system") {
+        return prefetchAll(disk, list);
+    };
+
+    BENCHMARK("Warm mapped file system") {
+        return prefetchAll(mapped, list);
+    };
+
+    // baseline without the worker pool
+    std::unique_ptr<IFileSystem> sequential{mountMappedFileSystem(kAssetRoot, MappedConfig{})};
+
+    BENCHMARK("Warm sequential reads") {
+        size_t total = 0;
+        for (const AssetRef& asset : list.assets) {
+            total += sequential->openFileView(Bundle::getAssetPath(asset)).size();
+        }
+        return total;
+    };
+}
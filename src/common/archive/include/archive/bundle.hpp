@@ -8,20 +8,100 @@
 
 #include "archive/fs.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 typedef struct fs_t fs_t;
 typedef struct io_t io_t;
 
 namespace sm {
-    using ShaderIr = sm::View<byte>;
-    using TextureData = sm::View<byte>;
+    /// shader and texture data keep their file resident while held
+    using ShaderIr = FileView;
+    using TextureData = FileView;
+
+    enum class AssetType : uint8_t {
+        /// compiled shader, name is the shader name without its extension
+        eShader,
+
+        /// texture, name is the texture name without its extension
+        eTexture,
+
+        /// any file, name is the path relative to the root of the file system
+        eFile,
+    };
+
+    struct AssetRef {
+        AssetType type;
+        sm::StringView name;
+    };
+
+    class Bundle;
+
+    /// @brief tracks an in flight prefetch.
+    /// the prefetched data is kept resident for as long as the handle is alive.
+    class PrefetchHandle {
+        friend class Bundle;
+
+        struct State;
+        std::shared_ptr<State> mState;
+
+        PrefetchHandle(std::shared_ptr<State> state) noexcept
+            : mState(std::move(state))
+        { }
+
+    public:
+        PrefetchHandle() = default;
+
+        /// @brief block until every asset has been read
+        void wait() const;
+
+        bool isDone() const noexcept;
+
+        size_t getCount() const noexcept;
+        size_t getCompletedCount() const noexcept;
+        size_t getFailedCount() const noexcept;
+
+        /// @brief data of the asset at @p index in the prefetch request.
+        /// only valid once that asset has completed, invalid if it failed
+        FileView getData(size_t index) const;
+    };
 
     class Bundle {
+    public:
+        /// @brief invoked on a worker thread as each asset finishes reading.
+        /// @p data is invalid if the asset could not be read
+        using AssetCallback = std::function<void(size_t index, const AssetRef& asset, const FileView& data)>;
+
+    private:
         sm::UniquePtr<IFileSystem> mFileSystem;
 
-        sm::View<byte> getFileData(sm::StringView dir, sm::StringView name);
+        struct PrefetchJob {
+            std::shared_ptr<PrefetchHandle::State> state;
+            size_t index;
+        };
+
+        std::mutex mQueueMutex;
+        std::condition_variable_any mQueueReady;
+        std::deque<PrefetchJob> mQueue;
+
+        // started on the first prefetch
+        std::vector<std::jthread> mWorkers;
+        unsigned mWorkerCount;
+
+        FileView getFileData(const AssetRef& asset);
+
+        void startWorkers();
+        void workerMain(const std::stop_token& stop);
 
     public:
-        Bundle(IFileSystem *fs);
+        /// @param fs the file system to read from, must be safe to read from multiple threads
+        /// @param workers how many threads to read prefetched assets on, 0 for the hardware concurrency
+        Bundle(IFileSystem *fs, unsigned workers = 0);
+        ~Bundle() noexcept;
 
         ShaderIr get_shader_bytecode(const char *name);
         TextureData get_texture(const char *name);
@@ -29,6 +109,14 @@ namespace sm {
         ShaderIr getShaderBytecode(const char *name) { return get_shader_bytecode(name); }
         TextureData getTexture(const char *name) { return get_texture(name); }
 
+        /// @brief read assets in parallel.
+        /// reads are spread across the bundles worker threads, @p callback is
+        /// invoked on a worker as each asset completes. the names in @p assets
+        /// are copied so do not need to outlive the call.
+        PrefetchHandle prefetch(std::span<const AssetRef> assets, AssetCallback callback = nullptr);
+
+        static fs::path getAssetPath(const AssetRef& asset);
+
         // font::FontInfo get_font(const char *name);
     };
 }
@@ -1,16 +1,91 @@
 #pragma once
 
 #include "base/fs.hpp"
+#include "core/memory.hpp"
 #include "core/span.hpp"
 
+#include <memory>
+
 namespace sm {
+    /// @brief a view of file data that keeps its backing memory alive.
+    /// file systems may drop their own reference to the data at any time,
+    /// the data stays valid until every view of it is released.
+    class FileView {
+        std::shared_ptr<const void> mOwner;
+        sm::View<byte> mData;
+        bool mValid = false;
+
+    public:
+        /// @brief a view of a file that could not be read
+        FileView() = default;
+
+        FileView(std::shared_ptr<const void> owner, sm::View<byte> data) noexcept
+            : mOwner(std::move(owner))
+            , mData(data)
+            , mValid(true)
+        { }
+
+        const byte *data() const noexcept { return mData.data(); }
+        size_t size() const noexcept { return mData.size(); }
+        bool empty() const noexcept { return mData.empty(); }
+
+        /// @brief false if the file could not be read, an empty file is still valid
+        bool isValid() const noexcept { return mValid; }
+        explicit operator bool() const noexcept { return mValid; }
+
+        sm::View<byte> view() const noexcept { return mData; }
+        operator sm::View<byte>() const noexcept { return mData; }
+
+        /// @brief the reference keeping the data alive.
+        /// null if the data is borrowed from a file system that keeps it for its whole lifetime
+        const std::shared_ptr<const void>& owner() const noexcept { return mOwner; }
+    };
+
     class IFileSystem {
     public:
         virtual ~IFileSystem() noexcept = default;
 
-        virtual sm::View<byte> readFileData(const fs::path& path) = 0;
+        /// @brief read a file and hold a reference to its data.
+        /// the view is invalid if the file could not be read.
+        /// file systems with a bounded cache may evict the data while
+        /// views of it are alive, the view keeps it resident until released.
+        virtual FileView openFileView(const fs::path& path) = 0;
+    };
+
+    struct MappedConfig {
+        /// how much mapped file data the file system keeps cached.
+        /// views returned from @a IFileSystem::openFileView keep their
+        /// mapping alive after it is evicted
+        sm::Memory cacheBudget = sm::megabytes(512);
+
+        /// files smaller than this are copied into memory rather than mapped
+        sm::Memory minMappedSize = sm::kilobytes(64);
+
+        /// hint that files will be read front to back and should be read ahead
+        bool sequential = true;
+    };
+
+    struct ArchiveConfig {
+        /// how much decompressed data a pack keeps cached.
+        /// views returned from @a IFileSystem::openFileView keep their
+        /// entry alive after it is evicted
+        sm::Memory cacheBudget = sm::megabytes(256);
+
+        /// check the hash of each entry the first time it is read
+        bool verify = true;
     };
 
     IFileSystem *mountFileSystem(fs::path path);
+
+    /// @brief mount a directory, reading files by mapping them into memory.
+    IFileSystem *mountMappedFileSystem(fs::path path, const MappedConfig& config);
     IFileSystem *mountArchive(const fs::path& path);
+
+    /// @brief mount an indexed pack, or a tar archive if the file is not a pack.
+    /// packs are memory mapped and each entry is decompressed on first read,
+    /// tar archives are decompressed in full when mounted.
+    IFileSystem *mountArchive(const fs::path& path, const ArchiveConfig& config);
+
+    /// @brief mount an indexed pack, see archive/pack.hpp
+    IFileSystem *mountPack(const fs::path& path, const ArchiveConfig& config);
 }
@@ -4,6 +4,7 @@
 #include "base/fs.hpp"
 
 #include <expected>
+#include <functional>
 #include <span>
 
 #include "math/math.hpp"
@@ -41,6 +42,39 @@ namespace sm {
         }
     };
 
-    std::expected<ImageData, std::string> loadImage(std::span<const byte> data);
-    std::expected<ImageData, std::string> openImage(const fs::path& path);
+    struct ImageInfo {
+        Format pxformat;
+        math::uint2 size;
+
+        size_t sizeInBytes() const {
+            return size_t(size.x) * size.y * 4;
+        }
+    };
+
+    /// @brief chooses where a decoded image is written.
+    /// called once the image header has been read, the returned span
+    /// must hold at least @a ImageInfo::sizeInBytes bytes.
+    using ImageSink = std::function<std::span<byte>(const ImageInfo& info)>;
+
+    using ImageResult = std::expected<ImageData, std::string>;
+
+    /// @brief decode an image straight into memory chosen by @p sink.
+    /// images are always decoded to rgba8. pngs are decoded with wuffs
+    /// directly into the sink, other formats go through stb_image.
+    std::expected<ImageInfo, std::string> decodeImage(std::span<const byte> data, const ImageSink& sink);
+
+    /// @brief decode an image into a fixed buffer, fails if it is too small
+    std::expected<ImageInfo, std::string> decodeImage(std::span<const byte> data, std::span<byte> dst);
+
+    /// @brief decode an image file, pngs are streamed from the file in
+    /// small chunks rather than read or mapped whole.
+    std::expected<ImageInfo, std::string> streamImage(const fs::path& path, const ImageSink& sink);
+
+    ImageResult loadImage(std::span<const byte> data);
+    ImageResult openImage(const fs::path& path);
+
+    /// @brief open several images in parallel
+    /// @param threads how many threads to decode on, 0 for the hardware concurrency
+    /// @return the results in the same order as @p paths
+    std::vector<ImageResult> openImages(std::span<const fs::path> paths, unsigned threads = 0);
 }
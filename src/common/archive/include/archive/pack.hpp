@@ -0,0 +1,82 @@
+#pragma once
+
+#include "core/core.hpp"
+#include "core/endian.hpp"
+#include "core/span.hpp"
+
+/**
+ * Indexed bundle format.
+ *
+ * Laid out as
+ *   PackHeader
+ *   entry data, each entry compressed on its own
+ *   PackEntry[entryCount] sorted by name
+ *   names, referenced by offset from the entries
+ *
+ * The table of contents is at the end so the writer can stream entry data
+ * without knowing the final layout up front. Everything is little endian.
+ * scripts/make_bundle.py is the reference writer.
+ *
+ * Entry data is content addressed, entries with identical contents point
+ * at the same stored data. Incremental builds append new data and write a
+ * fresh table of contents, leaving unreferenced data in place until the
+ * pack is rewritten.
+ */
+namespace sm::pack {
+    static constexpr char kMagic[4] = { 'S', 'M', 'P', 'K' };
+    static constexpr uint16_t kVersion = 1;
+
+    enum class Compression : uint8_t {
+        eNone = 0,
+        eLz4 = 1,
+        eZstd = 2,
+
+        eCount
+    };
+
+    struct PackHeader {
+        char magic[4];
+        sm::le<uint16_t> version;
+        sm::le<uint16_t> flags;
+        sm::le<uint32_t> entryCount;
+        sm::le<uint32_t> namesSize;
+        sm::le<uint64_t> tocOffset;
+        sm::le<uint64_t> namesOffset;
+    };
+
+    struct PackEntry {
+        sm::le<uint32_t> nameOffset;
+        sm::le<uint16_t> nameSize;
+        Compression compression;
+        uint8_t reserved;
+
+        /// offset of the stored data from the start of the file
+        sm::le<uint64_t> offset;
+
+        /// size of the stored data
+        sm::le<uint64_t> storedSize;
+
+        /// size of the data once decompressed
+        sm::le<uint64_t> size;
+
+        /// hash of the decompressed data, see @a hashData
+        sm::le<uint64_t> hash;
+    };
+
+    static_assert(sizeof(PackHeader) == 32);
+    static_assert(sizeof(PackEntry) == 40);
+
+    /// @brief 64 bit FNV-1a, simple enough to match exactly in the bundle tools
+    constexpr uint64_t hashData(sm::View<byte> data) noexcept {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (byte b : data) {
+            hash ^= b;
+            hash *= 0x100000001b3;
+        }
+
+        return hash;
+    }
+
+    /// @brief check if the data starts with a pack header
+    bool isPackData(sm::View<byte> data) noexcept;
+}
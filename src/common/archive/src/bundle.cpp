@@ -9,29 +9,193 @@
 
 #include "logger/logs.hpp"
 
+#include <atomic>
+
 using namespace sm;
 
-Bundle::Bundle(IFileSystem *fs)
+///
+/// prefetch handle
+///
+
+struct PrefetchHandle::State {
+    /// copies of the requested names, the asset refs point into these
+    std::vector<std::string> names;
+    std::vector<AssetRef> assets;
+
+    /// written once by the worker that reads each asset
+    std::vector<FileView> data;
+
+    Bundle::AssetCallback callback;
+
+    std::atomic<size_t> completed{0};
+    std::atomic<size_t> failed{0};
+
+    std::mutex mutex;
+    std::condition_variable done;
+
+    size_t count() const noexcept { return assets.size(); }
+
+    void complete(size_t index, FileView view) {
+        if (!view.isValid()) {
+            LOG_WARN(IoLog, "failed to prefetch asset: {}", assets[index].name);
+            failed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        data[index] = std::move(view);
+
+        if (callback) {
+            try {
+                callback(index, assets[index], data[index]);
+            } catch (const std::exception& e) {
+                LOG_ERROR(IoLog, "prefetch callback for {} threw: {}", assets[index].name, e.what());
+            }
+        }
+
+        if (completed.fetch_add(1, std::memory_order_acq_rel) + 1 == count()) {
+            std::lock_guard guard(mutex);
+            done.notify_all();
+        }
+    }
+};
+
+void PrefetchHandle::wait() const {
+    if (mState == nullptr)
+        return;
+
+    std::unique_lock lock(mState->mutex);
+    mState->done.wait(lock, [&] { return isDone(); });
+}
+
+bool PrefetchHandle::isDone() const noexcept {
+    return mState == nullptr || mState->completed.load(std::memory_order_acquire) == mState->count();
+}
+
+size_t PrefetchHandle::getCount() const noexcept {
+    return mState ? mState->count() : 0;
+}
+
+size_t PrefetchHandle::getCompletedCount() const noexcept {
+    return mState ? mState->completed.load(std::memory_order_acquire) : 0;
+}
+
+size_t PrefetchHandle::getFailedCount() const noexcept {
+    return mState ? mState->failed.load(std::memory_order_acquire) : 0;
+}
+
+FileView PrefetchHandle::getData(size_t index) const {
+    CTASSERTF(mState != nullptr && index < mState->count(), "prefetch index out of bounds %zu", index);
+    return mState->data[index];
+}
+
+///
+/// bundle
+///
+
+Bundle::Bundle(IFileSystem *fs, unsigned workers)
     : mFileSystem(fs)
+    , mWorkerCount(workers == 0 ? std::max(1u, std::thread::hardware_concurrency()) : workers)
 { }
 
-std::span<const uint8_t> Bundle::getFileData(sm::StringView dir, sm::StringView name) {
-    auto path = fmt::format("bundle/{}/{}", dir, name);
-    sm::View data = mFileSystem->readFileData(path);
-    if (data.empty()) {
+Bundle::~Bundle() noexcept {
+    for (std::jthread& worker : mWorkers) {
+        worker.request_stop();
+    }
+
+    mQueueReady.notify_all();
+    mWorkers.clear();
+
+    // release anyone still waiting on a prefetch
+    for (PrefetchJob& job : mQueue) {
+        job.state->complete(job.index, FileView{});
+    }
+}
+
+fs::path Bundle::getAssetPath(const AssetRef& asset) {
+    auto build = [&](std::string_view dir, std::string_view ext) {
+        std::string path;
+        path.reserve(7 + dir.size() + 1 + asset.name.size() + ext.size());
+        path.append("bundle/").append(dir).append("/").append(asset.name).append(ext);
+        return fs::path{std::move(path)};
+    };
+
+    switch (asset.type) {
+    case AssetType::eShader: return build("shaders", ".cso");
+    case AssetType::eTexture: return build("textures", ".dds");
+    default: return fs::path{asset.name};
+    }
+}
+
+FileView Bundle::getFileData(const AssetRef& asset) {
+    fs::path path = getAssetPath(asset);
+    FileView data = mFileSystem->openFileView(path);
+    if (!data.isValid()) {
         LOG_ERROR(IoLog, "failed to read file: {}", path);
-        return {};
     }
 
     return data;
 }
 
 ShaderIr Bundle::get_shader_bytecode(const char *name) {
-    return getFileData("shaders", fmt::format("{}.cso", name));
+    return getFileData(AssetRef { AssetType::eShader, name });
 }
 
 TextureData Bundle::get_texture(const char *name) {
-    return getFileData("textures", fmt::format("{}.dds", name));
+    return getFileData(AssetRef { AssetType::eTexture, name });
+}
+
+void Bundle::startWorkers() {
+    mWorkers.reserve(mWorkerCount);
+    for (unsigned i = 0; i < mWorkerCount; i++) {
+        mWorkers.emplace_back([this](const std::stop_token& stop) { workerMain(stop); });
+    }
+}
+
+void Bundle::workerMain(const std::stop_token& stop) {
+    while (true) {
+        PrefetchJob job;
+
+        {
+            std::unique_lock lock(mQueueMutex);
+            // once the bundle is being destroyed queued jobs are left
+            // for the destructor to fail rather than read
+            if (!mQueueReady.wait(lock, stop, [&] { return !mQueue.empty(); }) || stop.stop_requested())
+                return;
+
+            job = std::move(mQueue.front());
+            mQueue.pop_front();
+        }
+
+        const AssetRef& asset = job.state->assets[job.index];
+        job.state->complete(job.index, mFileSystem->openFileView(getAssetPath(asset)));
+    }
+}
+
+PrefetchHandle Bundle::prefetch(std::span<const AssetRef> assets, AssetCallback callback) {
+    auto state = std::make_shared<PrefetchHandle::State>();
+    state->callback = std::move(callback);
+    state->names.reserve(assets.size());
+    state->assets.reserve(assets.size());
+    state->data.resize(assets.size());
+
+    for (const AssetRef& asset : assets) {
+        const std::string& name = state->names.emplace_back(asset.name);
+        state->assets.push_back(AssetRef { asset.type, name });
+    }
+
+    if (assets.empty())
+        return PrefetchHandle { state };
+
+    std::lock_guard guard(mQueueMutex);
+    if (mWorkers.empty())
+        startWorkers();
+
+    for (size_t i = 0; i < assets.size(); i++) {
+        mQueue.push_back(PrefetchJob { state, i });
+    }
+
+    mQueueReady.notify_all();
+
+    return PrefetchHandle { state };
 }
 
 #if 0
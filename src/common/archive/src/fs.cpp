@@ -5,24 +5,33 @@
 #include "core/adt/vector.hpp"
 
 #include "archive/fs.hpp"
+#include "archive/pack.hpp"
 
 #include "logger/logs.hpp"
 
+#include <mutex>
+
 using namespace sm;
 
 struct DiskFileSystem final : sm::IFileSystem {
     fs::path root;
 
+    std::mutex mutex;
     sm::HashMap<fs::path, sm::VectorBase<byte>> cache;
 
-    sm::View<byte> readFileData(const fs::path& path) override {
-        auto it = cache.find(path);
-        if (it != cache.end())
-            return it->second;
+    // files are kept for the lifetime of the file system, so views borrow them
+    FileView openFileView(const fs::path& path) override {
+        {
+            std::lock_guard guard(mutex);
+            auto it = cache.find(path);
+            if (it != cache.end())
+                return FileView { nullptr, it->second };
+        }
 
+        // read without holding the lock so other files can be read meanwhile
         std::ifstream file(root / path, std::ios::binary);
         if (!file)
-            return {};
+            return FileView { };
 
         file.seekg(0, std::ios::end);
         auto size = file.tellg();
@@ -31,9 +40,11 @@ struct DiskFileSystem final : sm::IFileSystem {
         sm::VectorBase<byte> data{size, noinit{}};
         file.read(reinterpret_cast<char *>(data.data()), size);
 
+        // another thread may have read the same file first, keep theirs
+        std::lock_guard guard(mutex);
         auto [result, _] = cache.emplace(path, std::move(data));
 
-        return result->second;
+        return FileView { nullptr, result->second };
     }
 
     DiskFileSystem(fs::path root)
@@ -50,12 +61,12 @@ struct ArchiveFileSystem final : sm::IFileSystem {
 
     sm::HashMap<fs::path, sm::VectorBase<byte>> cache;
 
-    sm::View<byte> readFileData(const fs::path& path) override {
+    FileView openFileView(const fs::path& path) override {
         auto it = cache.find(path.string());
         if (it == cache.end())
-            return {};
+            return FileView { };
 
-        return it->second;
+        return FileView { nullptr, it->second };
     }
 
     void init() {
@@ -105,6 +116,23 @@ struct ArchiveFileSystem final : sm::IFileSystem {
     }
 };
 
+static bool isPackFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+
+    pack::PackHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    return pack::isPackData({ reinterpret_cast<const byte*>(&header), sizeof(header) });
+}
+
 IFileSystem *sm::mountArchive(const fs::path& path) {
+    return mountArchive(path, ArchiveConfig{});
+}
+
+IFileSystem *sm::mountArchive(const fs::path& path, const ArchiveConfig& config) {
+    if (isPackFile(path))
+        return mountPack(path, config);
+
     return new ArchiveFileSystem(path);
 }
@@ -7,6 +7,13 @@
 
 #include "logger/logs.hpp"
 
+#include "base/defer.hpp"
+
+#include "wuffs.h"
+
+#include <atomic>
+#include <thread>
+
 using namespace sm;
 
 std::string_view sm::toString(Format format) {
@@ -35,25 +42,136 @@ static constexpr Format getChannelFormat(int channels) {
     }
 }
 
-std::expected<ImageData, std::string> sm::loadImage(std::span<const byte> data) {
+static constexpr byte kPngSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+/// how much of a file is read at a time when streaming a png
+static constexpr size_t kStreamChunkSize = 64 * 1024;
+
+static bool isPngData(std::span<const byte> data) {
+    return data.size() >= sizeof(kPngSignature)
+        && std::memcmp(data.data(), kPngSignature, sizeof(kPngSignature)) == 0;
+}
+
+static std::string bufferTooSmall(const ImageInfo& info, size_t size) {
+    return fmt::format("image buffer is too small, {} bytes for a {}x{} image", size, info.size.x, info.size.y);
+}
+
+/// the png decoder and its work buffer are both large, so each
+/// thread keeps one around rather than allocating them per image
+struct PngDecoder {
+    wuffs_png__decoder::unique_ptr decoder;
+    sm::VectorBase<byte> workbuf;
+
+    /// input chunk when streaming from a file
+    sm::VectorBase<byte> stream;
+};
+
+static PngDecoder& getPngDecoder() {
+    thread_local PngDecoder tls;
+    return tls;
+}
+
+static wuffs_base__slice_u8 getWorkbuf(PngDecoder& png, uint64_t size) {
+    if (png.workbuf.sizeInBytes() < size) {
+        png.workbuf = sm::VectorBase<byte>{int_cast<ssize_t>(size), noinit{}};
+    }
+
+    return wuffs_base__make_slice_u8(png.workbuf.data(), png.workbuf.sizeInBytes());
+}
+
+/// @param refill reads more input into the buffer, returns false once there is no more
+template<typename F>
+static std::expected<ImageInfo, std::string> decodePng(PngDecoder& png, wuffs_base__io_buffer& src, const ImageSink& sink, F&& refill) {
+    if (png.decoder == nullptr) {
+        png.decoder = wuffs_png__decoder::alloc();
+        if (png.decoder == nullptr)
+            return std::unexpected("failed to allocate png decoder");
+    } else {
+        wuffs_base__status status = png.decoder->initialize(sizeof__wuffs_png__decoder(), WUFFS_VERSION, WUFFS_INITIALIZE__LEAVE_INTERNAL_BUFFERS_UNINITIALIZED);
+        if (!status.is_ok())
+            return std::unexpected(fmt::format("failed to reset png decoder: {}", status.message()));
+    }
+
+    wuffs_base__image_config config = wuffs_base__null_image_config();
+    while (true) {
+        wuffs_base__status status = png.decoder->decode_image_config(&config, &src);
+        if (status.is_ok())
+            break;
+
+        if (status.repr != wuffs_base__suspension__short_read || !refill(src))
+            return std::unexpected(fmt::format("failed to read png header: {}", status.message()));
+    }
+
+    uint32_t width = config.pixcfg.width();
+    uint32_t height = config.pixcfg.height();
+
+    ImageInfo info = {
+        .pxformat = Format::rgba8byte,
+        .size = { width, height },
+    };
+
+    std::span<byte> dst = sink(info);
+    if (dst.size() < info.sizeInBytes())
+        return std::unexpected(bufferTooSmall(info, dst.size()));
+
+    // decode straight into the callers buffer
+    config.pixcfg.set(WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL, WUFFS_BASE__PIXEL_SUBSAMPLING__NONE, width, height);
+
+    wuffs_base__pixel_buffer pixels = {};
+    wuffs_base__status status = pixels.set_from_slice(&config.pixcfg, wuffs_base__make_slice_u8(dst.data(), dst.size()));
+    if (!status.is_ok())
+        return std::unexpected(fmt::format("failed to set up png pixel buffer: {}", status.message()));
+
+    wuffs_base__slice_u8 workbuf = getWorkbuf(png, png.decoder->workbuf_len().max_incl);
+
+    while (true) {
+        status = png.decoder->decode_frame(&pixels, &src, WUFFS_BASE__PIXEL_BLEND__SRC, workbuf, nullptr);
+        if (status.is_ok())
+            break;
+
+        if (status.repr != wuffs_base__suspension__short_read || !refill(src))
+            return std::unexpected(fmt::format("failed to decode png: {}", status.message()));
+    }
+
+    return info;
+}
+
+static std::expected<ImageInfo, std::string> decodeWithStb(std::span<const byte> data, const ImageSink& sink) {
     int width, height;
     stbi_uc *pixels = stbi_load_from_memory((const stbi_uc*)data.data(), int_cast<int>(data.size()), &width, &height, nullptr, 4);
     if (pixels == nullptr)
         return std::unexpected(fmt::format("stbi failed to load image {}", stbi_failure_reason()));
 
-    ImageData image = {
+    defer { stbi_image_free(pixels); };
+
+    ImageInfo info = {
         .pxformat = getChannelFormat(4),
         .size = { int_cast<uint32_t>(width), int_cast<uint32_t>(height) },
-        // TODO: this is a full copy, maybe theres a way to use a single buffer
-        .data = sm::Vector<uint8_t>(pixels, pixels + int_cast<ptrdiff_t>(width * height * 4)),
     };
 
-    stbi_image_free(pixels);
+    std::span<byte> dst = sink(info);
+    if (dst.size() < info.sizeInBytes())
+        return std::unexpected(bufferTooSmall(info, dst.size()));
 
-    return image;
+    std::memcpy(dst.data(), pixels, info.sizeInBytes());
+
+    return info;
 }
 
-std::expected<ImageData, std::string> sm::openImage(const fs::path& path) {
+std::expected<ImageInfo, std::string> sm::decodeImage(std::span<const byte> data, const ImageSink& sink) {
+    if (!isPngData(data))
+        return decodeWithStb(data, sink);
+
+    // the whole image is in memory, so there is never anything to refill
+    wuffs_base__io_buffer src = wuffs_base__ptr_u8__reader(const_cast<byte*>(data.data()), data.size(), true);
+    return decodePng(getPngDecoder(), src, sink, [](wuffs_base__io_buffer&) { return false; });
+}
+
+std::expected<ImageInfo, std::string> sm::decodeImage(std::span<const byte> data, std::span<byte> dst) {
+    return decodeImage(data, [&](const ImageInfo&) { return dst; });
+}
+
+std::expected<ImageInfo, std::string> sm::streamImage(const fs::path& path, const ImageSink& sink) {
     if (!fs::exists(path))
         return std::unexpected(fmt::format("Image file `{}` does not exist", path));
 
@@ -65,9 +183,90 @@ std::expected<ImageData, std::string> sm::openImage(const fs::path& path) {
     if (size == 0)
         return std::unexpected(fmt::format("Image file `{}` is empty", path));
 
+    PngDecoder& png = getPngDecoder();
+    if (png.stream.isEmpty()) {
+        png.stream = sm::VectorBase<byte>{int_cast<ssize_t>(kStreamChunkSize), noinit{}};
+    }
+
+    wuffs_base__io_buffer src = wuffs_base__make_io_buffer(
+        wuffs_base__make_slice_u8(png.stream.data(), png.stream.sizeInBytes()),
+        wuffs_base__make_io_buffer_meta(0, 0, 0, false)
+    );
+
+    auto refill = [&](wuffs_base__io_buffer& buffer) {
+        if (buffer.meta.closed)
+            return false;
+
+        buffer.compact();
+
+        size_t request = buffer.data.len - buffer.meta.wi;
+        size_t read = file.read_bytes(buffer.data.ptr + buffer.meta.wi, request);
+
+        buffer.meta.wi += read;
+        buffer.meta.closed = read < request;
+        return true;
+    };
+
+    refill(src);
+
+    if (isPngData({ src.data.ptr, src.meta.wi }))
+        return decodePng(png, src, sink, refill);
+
+    // stb needs the whole file
     void *data = io_map(*file, eOsProtectRead);
     if (data == nullptr)
         return std::unexpected(fmt::format("Failed to map image file `{}`: {}", path, file.error()));
 
-    return loadImage({ reinterpret_cast<const byte*>(data), size });
+    return decodeWithStb({ reinterpret_cast<const byte*>(data), size }, sink);
+}
+
+template<typename F>
+static ImageResult decodeImageData(F&& decode) {
+    ImageData image;
+    auto result = decode([&](const ImageInfo& info) {
+        image.data.resize(info.sizeInBytes());
+        return std::span<byte>(image.data);
+    });
+
+    if (!result.has_value())
+        return std::unexpected(std::move(result.error()));
+
+    image.pxformat = result->pxformat;
+    image.size = result->size;
+
+    return image;
+}
+
+ImageResult sm::loadImage(std::span<const byte> data) {
+    return decodeImageData([&](const ImageSink& sink) { return decodeImage(data, sink); });
+}
+
+ImageResult sm::openImage(const fs::path& path) {
+    return decodeImageData([&](const ImageSink& sink) { return streamImage(path, sink); });
+}
+
+std::vector<ImageResult> sm::openImages(std::span<const fs::path> paths, unsigned threads) {
+    std::vector<ImageResult> results(paths.size());
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<size_t> next = 0;
+    auto worker = [&] {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            results[i] = openImage(paths[i]);
+        }
+    };
+
+    // the calling thread decodes as well
+    size_t count = std::min<size_t>(threads, paths.size());
+    std::vector<std::jthread> pool;
+    for (size_t i = 1; i < count; i++) {
+        pool.emplace_back(worker);
+    }
+
+    worker();
+    pool.clear();
+
+    return results;
 }
@@ -0,0 +1,166 @@
+#include "stdafx.hpp"
+
+#include "archive/fs.hpp"
+#include "archive/io.hpp"
+
+#include "core/map.hpp"
+#include "core/adt/vector.hpp"
+
+#include <list>
+
+#if _WIN32
+#   include "core/win32.hpp"
+#else
+#   include <sys/mman.h>
+#endif
+
+using namespace sm;
+
+struct MappedFile {
+    /// keeps the mapping alive, unset for copied files
+    Io file;
+
+    /// small files are copied rather than mapped
+    sm::VectorBase<byte> copy;
+
+    sm::View<byte> data;
+};
+
+using MappedFilePtr = std::shared_ptr<const MappedFile>;
+
+static void adviseMapping(sm::View<byte> data, bool sequential) {
+#if _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range = { const_cast<byte*>(data.data()), data.size() };
+    if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0)) {
+        LOG_WARN(IoLog, "PrefetchVirtualMemory failed: {}", GetLastError());
+    }
+#else
+    // the whole file is mapped so the address is page aligned
+    void *address = const_cast<byte*>(data.data());
+
+    if (sequential && madvise(address, data.size(), MADV_SEQUENTIAL)) {
+        LOG_WARN(IoLog, "madvise(MADV_SEQUENTIAL) failed: {}", errno);
+    }
+
+    if (madvise(address, data.size(), MADV_WILLNEED)) {
+        LOG_WARN(IoLog, "madvise(MADV_WILLNEED) failed: {}", errno);
+    }
+#endif
+}
+
+static MappedFilePtr openMappedFile(const fs::path& path, const MappedConfig& config) {
+    if (!fs::exists(path))
+        return nullptr;
+
+    auto result = std::make_shared<MappedFile>();
+    result->file = Io::file(path.string().c_str(), eOsAccessRead);
+    if (!result->file.isValid()) {
+        LOG_ERROR(IoLog, "failed to open file {}", path);
+        return nullptr;
+    }
+
+    size_t size = result->file.size();
+    if (size == 0)
+        return result;
+
+    if (size < config.minMappedSize.asBytes()) {
+        result->copy = sm::VectorBase<byte>{int_cast<ssize_t>(size), noinit{}};
+        size_t read = result->file.read_bytes(result->copy.data(), size);
+        if (read != size) {
+            LOG_ERROR(IoLog, "failed to read file {}, read {} of {} bytes", path, read, size);
+            return nullptr;
+        }
+
+        result->data = result->copy;
+        result->file.reset();
+        return result;
+    }
+
+    const void *data = io_map(*result->file, eOsProtectRead);
+    if (data == nullptr) {
+        LOG_ERROR(IoLog, "failed to map file {}: {}", path, result->file.error());
+        return nullptr;
+    }
+
+    result->data = { reinterpret_cast<const byte*>(data), size };
+    adviseMapping(result->data, config.sequential);
+
+    return result;
+}
+
+struct MappedFileSystem final : sm::IFileSystem {
+    struct CachedFile {
+        MappedFilePtr file;
+        std::list<fs::path>::iterator lru;
+    };
+
+    fs::path root;
+    MappedConfig config;
+
+    std::mutex mutex;
+
+    sm::HashMap<fs::path, CachedFile> cache;
+
+    /// most recently opened files are at the front
+    std::list<fs::path> lru;
+    size_t cacheSize = 0;
+
+    // the newest file is never evicted, so a single file larger
+    // than the budget is still returned by openFileView
+    void evict(const fs::path& keep) {
+        while (cacheSize > config.cacheBudget.asBytes() && !lru.empty()) {
+            if (lru.back() == keep)
+                break;
+
+            auto it = cache.find(lru.back());
+            cacheSize -= it->second.file->data.size();
+            cache.erase(it);
+
+            lru.pop_back();
+        }
+    }
+
+    MappedFilePtr findCached(const fs::path& path) {
+        auto it = cache.find(path);
+        if (it == cache.end())
+            return nullptr;
+
+        lru.splice(lru.begin(), lru, it->second.lru);
+        return it->second.file;
+    }
+
+    FileView openFileView(const fs::path& path) override {
+        {
+            std::lock_guard guard(mutex);
+            if (MappedFilePtr file = findCached(path))
+                return FileView { file, file->data };
+        }
+
+        // open and map without holding the lock, this may touch the disk
+        MappedFilePtr file = openMappedFile(root / path, config);
+        if (file == nullptr)
+            return FileView { };
+
+        std::lock_guard guard(mutex);
+
+        // another thread may have opened the same file first
+        if (MappedFilePtr existing = findCached(path))
+            return FileView { existing, existing->data };
+
+        lru.push_front(path);
+        cacheSize += file->data.size();
+        cache.emplace(path, CachedFile { file, lru.begin() });
+        evict(path);
+
+        return FileView { file, file->data };
+    }
+
+    MappedFileSystem(fs::path root, const MappedConfig& config)
+        : root(std::move(root))
+        , config(config)
+    { }
+};
+
+IFileSystem *sm::mountMappedFileSystem(fs::path path, const MappedConfig& config) {
+    return new MappedFileSystem(std::move(path), config);
+}
@@ -0,0 +1,322 @@
+#include "stdafx.hpp"
+
+#include "archive/pack.hpp"
+#include "archive/fs.hpp"
+#include "archive/io.hpp"
+
+#include "core/map.hpp"
+#include "core/units.hpp"
+#include "core/adt/vector.hpp"
+
+#include <list>
+
+#include <lz4.h>
+#include <zstd.h>
+
+using namespace sm;
+using namespace sm::pack;
+
+bool pack::isPackData(sm::View<byte> data) noexcept {
+    if (data.size() < sizeof(PackHeader))
+        return false;
+
+    return std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+static std::string_view toString(Compression compression) {
+    switch (compression) {
+    case Compression::eNone: return "none";
+    case Compression::eLz4: return "lz4";
+    case Compression::eZstd: return "zstd";
+    default: return "unknown";
+    }
+}
+
+static bool decompressEntry(const PackEntry& entry, sm::View<byte> src, sm::Span<byte> dst) {
+    switch (entry.compression) {
+    case Compression::eLz4: {
+        int result = LZ4_decompress_safe(
+            reinterpret_cast<const char*>(src.data()), reinterpret_cast<char*>(dst.data()),
+            int_cast<int>(src.size()), int_cast<int>(dst.size())
+        );
+
+        return result >= 0 && size_t(result) == dst.size();
+    }
+    case Compression::eZstd: {
+        size_t result = ZSTD_decompress(dst.data(), dst.size(), src.data(), src.size());
+        return !ZSTD_isError(result) && result == dst.size();
+    }
+    default:
+        return false;
+    }
+}
+
+struct PackFileSystem final : sm::IFileSystem {
+    using EntryData = std::shared_ptr<const sm::VectorBase<byte>>;
+
+    struct CachedEntry {
+        /// shared with any open views so eviction does not invalidate them
+        EntryData data;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    Io file;
+    ArchiveConfig config;
+
+    sm::View<byte> mapping;
+    sm::View<PackEntry> entries;
+    std::string_view names;
+
+    std::mutex mutex;
+
+    /// decompressed blobs keyed by their offset in the pack.
+    /// entries with the same content share a blob, so are only
+    /// decompressed and cached once
+    sm::HashMap<uint64_t, CachedEntry> cache;
+
+    /// most recently read entries are at the front
+    std::list<uint64_t> lru;
+    size_t cacheSize = 0;
+
+    size_t blobCount = 0;
+
+    /// entries that have had their hash checked
+    std::vector<bool> verified;
+
+    std::string_view getEntryName(const PackEntry& entry) const {
+        return names.substr(entry.nameOffset, entry.nameSize);
+    }
+
+    const PackEntry *findEntry(std::string_view name) const {
+        auto it = std::lower_bound(entries.begin(), entries.end(), name, [&](const PackEntry& entry, std::string_view name) {
+            return getEntryName(entry) < name;
+        });
+
+        if (it == entries.end() || getEntryName(*it) != name)
+            return nullptr;
+
+        return &*it;
+    }
+
+    sm::View<byte> getStoredData(const PackEntry& entry) const {
+        return mapping.subspan(entry.offset, entry.storedSize);
+    }
+
+    bool checkHash(uint32_t index, const PackEntry& entry, sm::View<byte> data) {
+        if (!config.verify || verified[index])
+            return true;
+
+        if (hashData(data) != entry.hash) {
+            LOG_ERROR(IoLog, "pack entry {} is corrupt, hash mismatch", getEntryName(entry));
+            return false;
+        }
+
+        verified[index] = true;
+        return true;
+    }
+
+    // the newest entry is never evicted, so a single read larger
+    // than the budget still returns valid data
+    void evict(uint64_t keep) {
+        while (cacheSize > config.cacheBudget.asBytes() && !lru.empty()) {
+            uint64_t blob = lru.back();
+            if (blob == keep)
+                break;
+
+            lru.pop_back();
+
+            auto it = cache.find(blob);
+            cacheSize -= it->second.data->sizeInBytes();
+            cache.erase(it);
+        }
+    }
+
+    static FileView makeView(const EntryData& data) {
+        return FileView { data, *data };
+    }
+
+    FileView openFileView(const fs::path& path) override {
+        std::string name = path.generic_string();
+        const PackEntry *entry = findEntry(name);
+        if (entry == nullptr)
+            return {};
+
+        uint32_t index = int_cast<uint32_t>(entry - entries.data());
+        uint64_t blob = entry->offset;
+        sm::View<byte> stored = getStoredData(*entry);
+
+        // uncompressed entries are returned straight from the mapping
+        if (entry->compression == Compression::eNone) {
+            std::lock_guard guard(mutex);
+            return checkHash(index, *entry, stored) ? FileView { nullptr, stored } : FileView { };
+        }
+
+        {
+            std::lock_guard guard(mutex);
+            if (auto it = cache.find(blob); it != cache.end()) {
+                lru.splice(lru.begin(), lru, it->second.lru);
+                return makeView(it->second.data);
+            }
+        }
+
+        // decompress without holding the lock so other entries can be read meanwhile
+        auto data = std::make_shared<sm::VectorBase<byte>>(int_cast<ssize_t>(entry->size.load()), noinit{});
+        if (!decompressEntry(*entry, stored, *data)) {
+            LOG_ERROR(IoLog, "failed to decompress pack entry {} ({})", name, toString(entry->compression));
+            return {};
+        }
+
+        std::lock_guard guard(mutex);
+
+        // another thread may have decompressed the same entry first
+        if (auto it = cache.find(blob); it != cache.end()) {
+            lru.splice(lru.begin(), lru, it->second.lru);
+            return makeView(it->second.data);
+        }
+
+        if (!checkHash(index, *entry, *data))
+            return {};
+
+        lru.push_front(blob);
+        cacheSize += data->sizeInBytes();
+
+        cache.emplace(blob, CachedEntry { data, lru.begin() });
+        evict(blob);
+
+        return makeView(data);
+    }
+
+    bool validate(const fs::path& path) const {
+        const PackHeader *header = reinterpret_cast<const PackHeader*>(mapping.data());
+        if (header->version != kVersion) {
+            LOG_ERROR(IoLog, "pack {} has unsupported version {}", path, header->version.load());
+            return false;
+        }
+
+        // the toc is read in place so must be aligned
+        if (header->tocOffset % alignof(PackEntry) != 0) {
+            LOG_ERROR(IoLog, "pack {} table of contents is misaligned", path);
+            return false;
+        }
+
+        uint64_t tocSize = uint64_t(header->entryCount) * sizeof(PackEntry);
+        if (header->tocOffset > mapping.size() || tocSize > mapping.size() - header->tocOffset) {
+            LOG_ERROR(IoLog, "pack {} table of contents is out of bounds", path);
+            return false;
+        }
+
+        if (header->namesOffset > mapping.size() || header->namesSize > mapping.size() - header->namesOffset) {
+            LOG_ERROR(IoLog, "pack {} name table is out of bounds", path);
+            return false;
+        }
+
+        return true;
+    }
+
+    static bool isSameBlob(const PackEntry& lhs, const PackEntry& rhs) noexcept {
+        return lhs.storedSize == rhs.storedSize
+            && lhs.size == rhs.size
+            && lhs.compression == rhs.compression
+            && lhs.hash == rhs.hash;
+    }
+
+    bool validateEntries(const fs::path& path) {
+        // blobs are cached by offset, so entries sharing one must agree on what it holds
+        sm::HashMap<uint64_t, const PackEntry*> blobs;
+
+        std::string_view previous;
+        for (const PackEntry& entry : entries) {
+            if (uint64_t(entry.nameOffset) + entry.nameSize > names.size()) {
+                LOG_ERROR(IoLog, "pack {} entry name is out of bounds", path);
+                return false;
+            }
+
+            std::string_view name = getEntryName(entry);
+            if (entry.offset > mapping.size() || entry.storedSize > mapping.size() - entry.offset) {
+                LOG_ERROR(IoLog, "pack {} entry {} data is out of bounds", path, name);
+                return false;
+            }
+
+            if (entry.compression >= Compression::eCount) {
+                LOG_ERROR(IoLog, "pack {} entry {} has unknown compression {}", path, name, std::to_underlying(entry.compression));
+                return false;
+            }
+
+            if (entry.compression == Compression::eNone && entry.storedSize != entry.size) {
+                LOG_ERROR(IoLog, "pack {} entry {} is stored but has mismatched sizes", path, name);
+                return false;
+            }
+
+            // lookups binary search the toc
+            if (name <= previous && &entry != entries.data()) {
+                LOG_ERROR(IoLog, "pack {} table of contents is not sorted at {}", path, name);
+                return false;
+            }
+
+            // empty entries can sit at the same offset as the next blob
+            if (entry.storedSize != 0) {
+                auto [it, inserted] = blobs.emplace(entry.offset, &entry);
+                if (!inserted && !isSameBlob(*it->second, entry)) {
+                    LOG_ERROR(IoLog, "pack {} entries {} and {} share data but disagree on its contents", path, getEntryName(*it->second), name);
+                    return false;
+                }
+            }
+
+            previous = name;
+        }
+
+        blobCount = blobs.size();
+
+        return true;
+    }
+
+    bool init(const fs::path& path) {
+        if (!file.isValid()) {
+            LOG_ERROR(IoLog, "failed to open pack {}", path);
+            return false;
+        }
+
+        size_t size = file.size();
+        const void *data = io_map(*file, eOsProtectRead);
+        if (data == nullptr) {
+            LOG_ERROR(IoLog, "failed to map pack {}: {}", path, file.error());
+            return false;
+        }
+
+        mapping = { reinterpret_cast<const byte*>(data), size };
+        if (!isPackData(mapping)) {
+            LOG_ERROR(IoLog, "{} is not a pack", path);
+            return false;
+        }
+
+        if (!validate(path))
+            return false;
+
+        const PackHeader *header = reinterpret_cast<const PackHeader*>(mapping.data());
+        entries = { reinterpret_cast<const PackEntry*>(mapping.data() + header->tocOffset), header->entryCount };
+        names = { reinterpret_cast<const char*>(mapping.data() + header->namesOffset), header->namesSize };
+
+        if (!validateEntries(path))
+            return false;
+
+        verified.resize(entries.size());
+
+        LOG_INFO(IoLog, "mounted pack {} ({} entries, {} unique)", path, entries.size(), blobCount);
+        return true;
+    }
+
+    PackFileSystem(const fs::path& path, const ArchiveConfig& config)
+        : file(Io::file(path.string().c_str(), eOsAccessRead))
+        , config(config)
+    {
+        if (!init(path)) {
+            mapping = {};
+            entries = {};
+            names = {};
+        }
+    }
+};
+
+IFileSystem *sm::mountPack(const fs::path& path, const ArchiveConfig& config) {
+    return new PackFileSystem(path, config);
+}
@@ -0,0 +1,245 @@
+#include "test/common.hpp"
+
+#include "archive/bundle.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace sm;
+
+using namespace std::chrono_literals;
+
+namespace {
+    /// an in memory file system that records the order files are read in,
+    /// and can hold a read of one file until the test releases it
+    struct TestFileSystem final : IFileSystem {
+        std::map<fs::path, std::shared_ptr<const std::vector<byte>>> files;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<fs::path> reads;
+
+        fs::path blockedPath;
+        bool blocked = false;
+        bool waiting = false;
+
+        void add(const fs::path& path, std::vector<byte> data) {
+            files[path] = std::make_shared<const std::vector<byte>>(std::move(data));
+        }
+
+        void block(const fs::path& path) {
+            std::lock_guard guard(mutex);
+            blockedPath = path;
+            blocked = true;
+        }
+
+        void release() {
+            std::lock_guard guard(mutex);
+            blocked = false;
+            changed.notify_all();
+        }
+
+        /// wait until a worker is held reading the blocked file
+        bool waitUntilBlocked() {
+            std::unique_lock lock(mutex);
+            return changed.wait_for(lock, 5s, [&] { return waiting; });
+        }
+
+        std::vector<fs::path> getReads() {
+            std::lock_guard guard(mutex);
+            return reads;
+        }
+
+        FileView openFileView(const fs::path& path) override {
+            std::unique_lock lock(mutex);
+            reads.push_back(path);
+
+            if (blocked && path == blockedPath) {
+                waiting = true;
+                changed.notify_all();
+                changed.wait(lock, [&] { return !blocked; });
+            }
+
+            auto it = files.find(path);
+            if (it == files.end())
+                return FileView { };
+
+            const auto& data = it->second;
+            return FileView { data, sm::View<byte>{ data->data(), data->size() } };
+        }
+    };
+}
+
+static std::vector<byte> makeContent(size_t size, uint8_t seed) {
+    std::vector<byte> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = byte((i * 31 + seed) % 251);
+
+    return data;
+}
+
+static bool isSameData(const FileView& view, std::span<const byte> expected) {
+    return view.isValid()
+        && view.size() == expected.size()
+        && std::equal(expected.begin(), expected.end(), view.data());
+}
+
+static fs::path getFilePath(std::string_view name) {
+    return Bundle::getAssetPath(AssetRef { AssetType::eFile, name });
+}
+
+TEST_CASE("bundle prefetch") {
+    auto files = new TestFileSystem();
+
+    std::vector<std::string> names;
+    std::vector<std::vector<byte>> contents;
+    for (int i = 0; i < 16; i++) {
+        names.push_back(fmt::format("file{}.bin", i));
+        contents.push_back(makeContent(256 + i * 16, uint8_t(i)));
+        files->add(getFilePath(names.back()), contents.back());
+    }
+
+    std::vector<AssetRef> assets;
+    for (const std::string& name : names)
+        assets.push_back(AssetRef { AssetType::eFile, name });
+
+    GIVEN("several workers") {
+        Bundle bundle{files, 4};
+
+        // one asset that does not exist
+        assets.push_back(AssetRef { AssetType::eFile, "missing.bin" });
+
+        // callbacks run on the workers, so record what they saw and check it afterwards
+        struct Call {
+            size_t count = 0;
+            std::string name;
+            bool valid = false;
+            bool matches = false;
+        };
+
+        std::mutex mutex;
+        std::vector<Call> calls(assets.size());
+
+        PrefetchHandle handle = bundle.prefetch(assets, [&](size_t index, const AssetRef& asset, const FileView& data) {
+            std::lock_guard guard(mutex);
+            Call& call = calls[index];
+            call.count += 1;
+            call.name = asset.name;
+            call.valid = data.isValid();
+            call.matches = index < contents.size() && isSameData(data, contents[index]);
+        });
+
+        handle.wait();
+
+        THEN("every asset completes once") {
+            CHECK(handle.isDone());
+            CHECK(handle.getCount() == assets.size());
+            CHECK(handle.getCompletedCount() == assets.size());
+            CHECK(handle.getFailedCount() == 1);
+
+            std::lock_guard guard(mutex);
+            for (size_t i = 0; i < calls.size(); i++) {
+                CHECK(calls[i].count == 1);
+                CHECK(calls[i].name == std::string_view{assets[i].name});
+            }
+
+            for (size_t i = 0; i < contents.size(); i++)
+                CHECK(calls[i].matches);
+
+            CHECK(!calls.back().valid);
+        }
+
+        THEN("data is stored by request index whatever order it completes in") {
+            for (size_t i = 0; i < contents.size(); i++)
+                CHECK(isSameData(handle.getData(i), contents[i]));
+
+            CHECK(!handle.getData(contents.size()).isValid());
+        }
+    }
+
+    GIVEN("a single worker") {
+        Bundle bundle{files, 1};
+
+        THEN("assets are read in the order they were requested") {
+            PrefetchHandle first = bundle.prefetch(std::span(assets).first(8));
+            PrefetchHandle second = bundle.prefetch(std::span(assets).subspan(8));
+            first.wait();
+            second.wait();
+
+            std::vector<fs::path> reads = files->getReads();
+            REQUIRE(reads.size() == assets.size());
+            for (size_t i = 0; i < assets.size(); i++)
+                CHECK(reads[i] == getFilePath(names[i]));
+        }
+
+        THEN("the names do not need to outlive the request") {
+            PrefetchHandle handle;
+            {
+                std::string name = names[0];
+                AssetRef asset { AssetType::eFile, name };
+                handle = bundle.prefetch(std::span(&asset, 1));
+            }
+
+            handle.wait();
+            CHECK(isSameData(handle.getData(0), contents[0]));
+        }
+    }
+
+    GIVEN("a bundle destroyed with reads still queued") {
+        auto bundle = std::make_unique<Bundle>(files, 1);
+
+        // hold the only worker on the first asset so the rest stay queued
+        files->block(getFilePath(names[0]));
+
+        std::atomic<size_t> callbacks = 0;
+        PrefetchHandle handle = bundle->prefetch(assets, [&](size_t, const AssetRef&, const FileView&) {
+            callbacks += 1;
+        });
+
+        // not a require, the worker has to be released either way
+        CHECK(files->waitUntilBlocked());
+
+        // someone else is already waiting on the prefetch
+        std::jthread waiter{[&] { handle.wait(); }};
+
+        std::jthread destroy{[&] { bundle.reset(); }};
+
+        // give the destructor time to ask the worker to stop, assets
+        // it picks up before then are read rather than failed
+        std::this_thread::sleep_for(50ms);
+        files->release();
+
+        destroy.join();
+        waiter.join();
+
+        THEN("every asset is completed and waiters are released") {
+            CHECK(handle.isDone());
+            CHECK(handle.getCompletedCount() == assets.size());
+            CHECK(callbacks == assets.size());
+        }
+
+        THEN("the asset being read finishes and the rest are read or failed") {
+            CHECK(isSameData(handle.getData(0), contents[0]));
+
+            size_t failed = 0;
+            for (size_t i = 1; i < assets.size(); i++) {
+                FileView data = handle.getData(i);
+                if (data.isValid())
+                    CHECK(isSameData(data, contents[i]));
+                else
+                    failed += 1;
+            }
+
+            CHECK(handle.getFailedCount() == failed);
+        }
+
+        THEN("completed data outlives the bundle") {
+            FileView data = handle.getData(0);
+            CHECK(data.owner() != nullptr);
+            CHECK(isSameData(data, contents[0]));
+        }
+    }
+}
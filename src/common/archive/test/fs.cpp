@@ -0,0 +1,220 @@
+#include "test/common.hpp"
+
+#include "archive/fs.hpp"
+#include "archive/pack.hpp"
+
+#include <fstream>
+#include <random>
+
+#include <lz4.h>
+
+using namespace sm;
+using namespace sm::pack;
+
+namespace {
+    /// a fresh directory for each run, removed when the test finishes
+    struct TempDir {
+        fs::path path;
+
+        TempDir() {
+            std::random_device random{};
+            path = fs::temp_directory_path() / fmt::format("sm-archive-test-{:08x}", random());
+            fs::create_directories(path);
+        }
+
+        ~TempDir() noexcept {
+            std::error_code ec;
+            fs::remove_all(path, ec);
+        }
+    };
+}
+
+static std::vector<byte> makeContent(size_t size, uint8_t seed) {
+    std::vector<byte> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = byte((i * 31 + seed) % 251);
+
+    return data;
+}
+
+static void writeFile(const fs::path& path, std::span<const byte> data) {
+    std::ofstream os{path, std::ios::binary};
+    os.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+static bool isSameData(const FileView& view, std::span<const byte> expected) {
+    return view.isValid()
+        && view.size() == expected.size()
+        && std::equal(expected.begin(), expected.end(), view.data());
+}
+
+template<typename T>
+static void appendBytes(std::vector<byte>& out, const T& value) {
+    const byte *bytes = reinterpret_cast<const byte*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/// write a pack with every entry compressed with lz4, names must be sorted
+static void writePack(const fs::path& path, std::span<const std::pair<std::string, std::vector<byte>>> files) {
+    std::vector<byte> out(sizeof(PackHeader));
+    std::vector<PackEntry> entries;
+    std::string names;
+
+    for (const auto& [name, data] : files) {
+        std::vector<byte> stored(LZ4_compressBound(int(data.size())));
+        int size = LZ4_compress_default(
+            reinterpret_cast<const char*>(data.data()), reinterpret_cast<char*>(stored.data()),
+            int(data.size()), int(stored.size())
+        );
+
+        REQUIRE(size > 0);
+
+        PackEntry entry{};
+        entry.nameOffset = uint32_t(names.size());
+        entry.nameSize = uint16_t(name.size());
+        entry.compression = Compression::eLz4;
+        entry.offset = out.size();
+        entry.storedSize = uint64_t(size);
+        entry.size = data.size();
+        entry.hash = hashData(data);
+        entries.push_back(entry);
+
+        names += name;
+        out.insert(out.end(), stored.begin(), stored.begin() + size);
+    }
+
+    // the toc is read in place
+    out.resize((out.size() + alignof(PackEntry) - 1) / alignof(PackEntry) * alignof(PackEntry));
+
+    PackHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entryCount = uint32_t(entries.size());
+    header.namesSize = uint32_t(names.size());
+    header.tocOffset = out.size();
+
+    for (const PackEntry& entry : entries)
+        appendBytes(out, entry);
+
+    header.namesOffset = out.size();
+    const byte *text = reinterpret_cast<const byte*>(names.data());
+    out.insert(out.end(), text, text + names.size());
+
+    std::memcpy(out.data(), &header, sizeof(header));
+    writeFile(path, out);
+}
+
+TEST_CASE("mapped file system") {
+    TempDir dir;
+
+    auto a = makeContent(4096, 1);
+    auto b = makeContent(4096, 2);
+    auto c = makeContent(4096, 3);
+
+    writeFile(dir.path / "a.bin", a);
+    writeFile(dir.path / "b.bin", b);
+    writeFile(dir.path / "c.bin", c);
+    writeFile(dir.path / "empty.bin", {});
+
+    // room for two files, and map everything rather than copying small files
+    MappedConfig config { .cacheBudget = sm::kilobytes(8), .minMappedSize = sm::bytes(0) };
+    std::unique_ptr<IFileSystem> files{mountMappedFileSystem(dir.path, config)};
+
+    GIVEN("files that do not fit in the cache") {
+        FileView first = files->openFileView("a.bin");
+        std::weak_ptr<const void> owner = first.owner();
+
+        REQUIRE(isSameData(first, a));
+        CHECK(isSameData(files->openFileView("b.bin"), b));
+        CHECK(isSameData(files->openFileView("c.bin"), c));
+
+        THEN("an evicted file stays valid while it has a view") {
+            CHECK(!owner.expired());
+            CHECK(isSameData(first, a));
+        }
+
+        THEN("an evicted file is released once its views are") {
+            first = FileView{};
+            CHECK(owner.expired());
+        }
+
+        THEN("an evicted file can be read again") {
+            first = FileView{};
+            for (int i = 0; i < 8; i++) {
+                CHECK(isSameData(files->openFileView("a.bin"), a));
+                CHECK(isSameData(files->openFileView("b.bin"), b));
+                CHECK(isSameData(files->openFileView("c.bin"), c));
+            }
+
+            CHECK(owner.expired());
+        }
+    }
+
+    THEN("empty files are told apart from missing ones") {
+        FileView empty = files->openFileView("empty.bin");
+        CHECK(empty.isValid());
+        CHECK(empty.empty());
+
+        FileView missing = files->openFileView("missing.bin");
+        CHECK(!missing.isValid());
+    }
+}
+
+TEST_CASE("pack file system") {
+    TempDir dir;
+
+    std::pair<std::string, std::vector<byte>> files[] = {
+        { "bundle/a.bin", makeContent(4096, 1) },
+        { "bundle/b.bin", makeContent(4096, 2) },
+        { "bundle/c.bin", makeContent(4096, 3) },
+        { "bundle/empty.bin", {} },
+    };
+
+    writePack(dir.path / "test.pack", files);
+
+    ArchiveConfig config { .cacheBudget = sm::kilobytes(8) };
+    std::unique_ptr<IFileSystem> archive{mountPack(dir.path / "test.pack", config)};
+
+    const auto& [aName, a] = files[0];
+    const auto& [bName, b] = files[1];
+    const auto& [cName, c] = files[2];
+
+    GIVEN("entries that do not fit in the cache") {
+        FileView first = archive->openFileView(aName);
+        std::weak_ptr<const void> owner = first.owner();
+
+        REQUIRE(isSameData(first, a));
+        REQUIRE(!owner.expired());
+        CHECK(isSameData(archive->openFileView(bName), b));
+        CHECK(isSameData(archive->openFileView(cName), c));
+
+        THEN("an evicted entry stays valid while it has a view") {
+            CHECK(!owner.expired());
+            CHECK(isSameData(first, a));
+        }
+
+        THEN("an evicted entry is released once its views are") {
+            first = FileView{};
+            CHECK(owner.expired());
+        }
+
+        THEN("an evicted entry can be read again") {
+            first = FileView{};
+            for (int i = 0; i < 8; i++) {
+                CHECK(isSameData(archive->openFileView(aName), a));
+                CHECK(isSameData(archive->openFileView(bName), b));
+                CHECK(isSameData(archive->openFileView(cName), c));
+            }
+
+            CHECK(owner.expired());
+        }
+    }
+
+    THEN("empty entries are told apart from missing ones") {
+        FileView empty = archive->openFileView("bundle/empty.bin");
+        CHECK(empty.isValid());
+        CHECK(empty.empty());
+
+        CHECK(!archive->openFileView("bundle/missing.bin").isValid());
+    }
+}
@@ -0,0 +1,98 @@
+#include "test/common.hpp"
+
+#include "archive/image.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include <stb_image.h>
+
+using namespace sm;
+
+// run from the source root, see the test workdir in meson.build
+static const fs::path kTextureRoot = "data/assets/textures";
+
+static std::vector<fs::path> findPngTextures() {
+    std::vector<fs::path> result;
+    for (const auto& entry : fs::recursive_directory_iterator(kTextureRoot)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".png")
+            result.push_back(entry.path());
+    }
+
+    return result;
+}
+
+static std::vector<byte> readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+/// the reference decode, what every image went through before pngs were decoded with wuffs
+static ImageData decodeWithStb(std::span<const byte> data) {
+    int width, height;
+    stbi_uc *pixels = stbi_load_from_memory((const stbi_uc*)data.data(), int(data.size()), &width, &height, nullptr, 4);
+    REQUIRE(pixels != nullptr);
+
+    size_t size = size_t(width) * height * 4;
+
+    ImageData image { .pxformat = Format::rgba8byte, .size = { uint32_t(width), uint32_t(height) } };
+    image.data.resize(size);
+    std::memcpy(image.data.data(), pixels, size);
+
+    stbi_image_free(pixels);
+
+    return image;
+}
+
+static void checkSamePixels(const ImageData& image, const ImageData& expected) {
+    CHECK(image.pxformat == expected.pxformat);
+    CHECK(image.size == expected.size);
+    REQUIRE(image.sizeInBytes() == expected.sizeInBytes());
+
+    // report the first mismatch rather than every pixel
+    auto [it, _] = std::mismatch(image.data.begin(), image.data.end(), expected.data.begin());
+    size_t offset = std::distance(image.data.begin(), it);
+
+    INFO("first difference at byte " << offset << " of " << image.sizeInBytes());
+    CHECK(it == image.data.end());
+}
+
+TEST_CASE("wuffs and stb decode identical pixels") {
+    std::vector<fs::path> paths = findPngTextures();
+    REQUIRE(!paths.empty());
+
+    for (const fs::path& path : paths) {
+        DYNAMIC_SECTION(path.string()) {
+            std::vector<byte> file = readFile(path);
+            ImageData expected = decodeWithStb(file);
+
+            GIVEN("a png in memory") {
+                ImageResult image = loadImage(file);
+                REQUIRE(image.has_value());
+                checkSamePixels(*image, expected);
+            }
+
+            GIVEN("a png streamed from disk") {
+                ImageResult image = openImage(path);
+                REQUIRE(image.has_value());
+                checkSamePixels(*image, expected);
+            }
+
+            GIVEN("a png decoded into a caller buffer") {
+                // larger than needed and filled with a pattern, only the image is written
+                std::vector<byte> buffer(expected.sizeInBytes() + 64, byte(0xCD));
+                auto info = decodeImage(file, std::span(buffer));
+                REQUIRE(info.has_value());
+                CHECK(info->size == expected.size);
+
+                CHECK(std::equal(expected.data.begin(), expected.data.end(), buffer.begin()));
+                CHECK(std::all_of(buffer.begin() + expected.sizeInBytes(), buffer.end(), [](byte b) { return b == byte(0xCD); }));
+            }
+
+            GIVEN("a buffer that is too small") {
+                std::vector<byte> buffer(expected.sizeInBytes() - 1);
+                CHECK(!decodeImage(file, std::span(buffer)).has_value());
+            }
+        }
+    }
+}
@@ -27,4 +27,15 @@ namespace sm {
 
     template<template<typename...> class C, typename T>
     concept IsSpecialization = is_specialization<T, C>::value;
+
+    /// @brief check if a type can be moved to a new address by copying its bytes
+    ///
+    /// the source is then treated as destroyed without running its destructor.
+    /// true for all trivially copyable types, specialize this for types that
+    /// are not trivially copyable but do not point into themselves, like owning handles.
+    template<typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+    template<typename T>
+    concept IsTriviallyRelocatable = is_trivially_relocatable<T>::value;
 }
@@ -4,14 +4,16 @@
 
 #include "base/macros.hpp"
 #include "core/adt/vector.hpp"
+#include "core/map.hpp"
 
 #include "config/init.hpp"
 
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <span>
 #include <string_view>
-#include <unordered_map>
 
 #include <fmtlib/format.h>
 
@@ -24,6 +26,7 @@ namespace sm::config {
         eOutOfRange,
         eReadOnly,
         eSyntax,
+        eRestartRequired,
 
         eCount
     };
@@ -114,12 +117,14 @@ namespace sm::config {
 
             bool readonly = false;
             bool hidden = false;
+            bool restart = false;
 
             OptionType type;
             const Group* group = &getCommonGroup();
 
             void init(ReadOnly it) noexcept { readonly = it.readonly; }
             void init(Hidden it) noexcept { hidden = it.hidden; }
+            void init(RequiresRestart it) noexcept { restart = it.restart; }
             void init(Category it) noexcept { group = &it.group; }
         };
 
@@ -195,19 +200,32 @@ namespace sm::config {
         eIsEnumFlags = 1u << 3,
 
         /// this option requires a restart to take effect
-        eUpdateRequiresRestart = 1u << 0,
+        /// reloading a config file will not change it
+        eUpdateRequiresRestart = 1u << 4,
     };
 
     class OptionBase {
-        unsigned mFlags = eNone;
+    public:
+        /// @brief called after the value of an option changes
+        using ChangeCallback = std::function<void(const OptionBase& option)>;
+
+    private:
+        std::atomic<unsigned> mFlags = eNone;
+
+        std::mutex mCallbackMutex;
+        std::vector<std::pair<size_t, ChangeCallback>> mCallbacks;
+        size_t mNextCallback = 0;
 
         void verifyType(OptionType type) const noexcept;
 
     protected:
         OptionBase(detail::OptionBuilder config, OptionType type) noexcept;
 
-        void notifySet() noexcept { mFlags |= eIsSet; }
-        void notifyEnumFlags() noexcept { mFlags |= eIsEnumFlags; }
+        void notifySet() noexcept { mFlags.fetch_or(eIsSet, std::memory_order_relaxed); }
+        void notifyEnumFlags() noexcept { mFlags.fetch_or(eIsEnumFlags, std::memory_order_relaxed); }
+
+        /// @brief invoke every change callback, called by the setter after the value is stored
+        void notifyChanged();
 
     public:
         SM_NOCOPY(OptionBase);
@@ -218,13 +236,19 @@ namespace sm::config {
         const Group& parent;
         const OptionType type;
 
-        Flags getFlags() const noexcept { return static_cast<Flags>(mFlags); }
+        Flags getFlags() const noexcept { return static_cast<Flags>(mFlags.load(std::memory_order_relaxed)); }
+
+        bool isReadOnly() const noexcept { return getFlags() & eReadOnly; }
+        bool isHidden() const noexcept { return getFlags() & eHidden; }
+        bool isModified() const noexcept { return getFlags() & eIsSet; }
+        bool isEnumFlags() const noexcept { return getFlags() & eIsEnumFlags; }
+        bool shouldRestartOnUpdate() const noexcept { return getFlags() & eUpdateRequiresRestart; }
 
-        bool isReadOnly() const noexcept { return mFlags & eReadOnly; }
-        bool isHidden() const noexcept { return mFlags & eHidden; }
-        bool isModified() const noexcept { return mFlags & eIsSet; }
-        bool isEnumFlags() const noexcept { return mFlags & eIsEnumFlags; }
-        bool shouldRestartOnUpdate() const noexcept { return mFlags & eUpdateRequiresRestart; }
+        /// @brief register a callback for when this option changes.
+        /// callbacks run on whichever thread updated the option, such as a config file watcher
+        /// @return a handle to pass to @a removeChangeCallback
+        size_t addChangeCallback(ChangeCallback callback);
+        void removeChangeCallback(size_t handle);
     };
 
     class Context {
@@ -232,9 +256,12 @@ namespace sm::config {
             std::vector<OptionBase*> options;
         };
 
-        std::unordered_map<std::string_view, OptionBase*> mArgLookup;
-        std::unordered_map<std::string_view, const Group*> mGroupLookup;
-        std::unordered_map<const Group*, GroupInfo> mGroups;
+        sm::HashMap<std::string_view, OptionBase*> mArgLookup;
+        sm::HashMap<std::string_view, const Group*> mGroupLookup;
+        sm::HashMap<const Group*, GroupInfo> mGroups;
+
+        UpdateResult updateFromToml(std::istream& is, bool reload, bool atomic, bool dryRun) noexcept;
+
     public:
         const auto& groups() const noexcept { return mGroups; }
 
@@ -246,6 +273,21 @@ namespace sm::config {
 
         UpdateResult updateFromCommandLine(int argc, const char *const *argv) noexcept;
         UpdateResult updateFromConfigFile(std::istream& is) noexcept;
+
+        /// @brief apply a config file again after startup.
+        /// options that require a restart keep their current value, changing
+        /// one is reported as @a UpdateStatus::eRestartRequired
+        UpdateResult reloadFromConfigFile(std::istream& is) noexcept;
+
+        /// @brief apply a config file as a single update.
+        /// every value is checked before any option is written, if any value
+        /// is invalid then no options are changed. when @p reload is set options
+        /// that require a restart keep their value without failing the update
+        UpdateResult applyConfigFileAtomic(std::istream& is, bool reload) noexcept;
+
+        /// @brief check a config file without changing any options.
+        /// reports the same errors that @a applyConfigFileAtomic would
+        UpdateResult checkConfigFile(std::istream& is, bool reload) noexcept;
     };
 
     void addStaticVariable(Context& context, OptionBase *cvar, const Group* group) noexcept;
@@ -299,17 +341,21 @@ namespace sm::config {
                 : NumericOptionValue(detail::buildOptionKwargs<Builder, T>(args...))
             { }
 
-            T getCommonValue() const noexcept { return mValue.load(); }
+            // each option is independent, so there is no ordering to enforce
+            T getCommonValue() const noexcept { return mValue.load(std::memory_order_relaxed); }
             T getCommonInitialValue() const noexcept { return mInitialValue; }
 
             Range<T> getCommonRange() const noexcept { return mRange; }
 
-            void setCommonValue(T value) noexcept {
-                mValue.store(value);
+            void setCommonValue(T value) {
+                T previous = mValue.exchange(value, std::memory_order_relaxed);
                 notifySet();
+
+                if (previous != value)
+                    notifyChanged();
             }
 
-            void setValue(T value) noexcept {
+            void setValue(T value) {
                 setCommonValue(value);
             }
         };
@@ -356,19 +402,22 @@ namespace sm::config {
                 : EnumOptionValue(detail::buildOptionKwargs<Builder, T>(args...))
             { }
 
-            T getCommonValue() const noexcept { return mValue.load(); }
+            T getCommonValue() const noexcept { return mValue.load(std::memory_order_relaxed); }
             T getCommonInitialValue() const noexcept { return mInitialValue; }
 
             std::span<const EnumValue<T>> getCommonOptions() const noexcept {
                 return mValues;
             }
 
-            void setCommonValue(T value) noexcept {
-                mValue.store(value);
+            void setCommonValue(T value) {
+                T previous = mValue.exchange(value, std::memory_order_relaxed);
                 notifySet();
+
+                if (previous != value)
+                    notifyChanged();
             }
 
-            void setValue(T value) noexcept {
+            void setValue(T value) {
                 setCommonValue(value);
             }
         };
@@ -398,20 +447,28 @@ namespace sm::config {
             : BoolOption(detail::buildOptionKwargs<Builder, bool>(args...))
         { }
 
-        bool getValue() const noexcept { return mValue.load(); }
+        bool getValue() const noexcept { return mValue.load(std::memory_order_relaxed); }
         bool getInitialValue() const noexcept { return mInitialValue; }
 
-        void setValue(bool value) noexcept {
-            mValue.store(value);
+        void setValue(bool value) {
+            bool previous = mValue.exchange(value, std::memory_order_relaxed);
             notifySet();
+
+            if (previous != value)
+                notifyChanged();
         }
     };
 
+    /// @brief an immutable copy of a string options value.
+    /// stays valid after the option is updated
+    using StringSnapshot = std::shared_ptr<const std::string>;
+
     class StringOption : public OptionBase {
         const std::string_view mInitialValue;
 
-        mutable std::mutex mMutex;
-        std::string mValue;
+        /// replaced as a whole on every update, readers share the old
+        /// value until they drop it
+        std::atomic<StringSnapshot> mValue;
 
     protected:
         struct Builder : detail::OptionBuilder {
@@ -426,7 +483,7 @@ namespace sm::config {
         StringOption(Builder config) noexcept
             : OptionBase(config, OptionType::eString)
             , mInitialValue(config.initial)
-            , mValue(config.initial)
+            , mValue(std::make_shared<const std::string>(config.initial))
         { }
 
     public:
@@ -434,18 +491,24 @@ namespace sm::config {
             : StringOption(detail::buildOptionKwargs<Builder, std::string>(args...))
         { }
 
-        // has to copy for now
+        /// @brief get the current value without copying it
+        StringSnapshot getSnapshot() const noexcept {
+            return mValue.load(std::memory_order_acquire);
+        }
+
+        /// @brief get a copy of the current value, prefer @a getSnapshot
         std::string getValue() const noexcept {
-            std::lock_guard lock{mMutex};
-            return mValue;
+            return *getSnapshot();
         }
 
         std::string_view getInitialValue() const noexcept { return mInitialValue; }
 
-        void setValue(std::string_view value) noexcept {
-            std::lock_guard lock{mMutex};
-            mValue = value;
+        void setValue(std::string_view value) {
+            StringSnapshot previous = mValue.exchange(std::make_shared<const std::string>(value), std::memory_order_acq_rel);
             notifySet();
+
+            if (*previous != value)
+                notifyChanged();
         }
     };
 
@@ -670,6 +733,7 @@ namespace sm {
 
     constinit inline config::ConfigWrapper<config::ReadOnly,    bool>             readonly{};
     constinit inline config::ConfigWrapper<config::Hidden,      bool>             hidden{};
+    constinit inline config::ConfigWrapper<config::RequiresRestart, bool>         restart{};
     constinit inline config::ConfigWrapper<config::Name,        std::string_view> name{};
     constinit inline config::ConfigWrapper<config::Description, std::string_view> desc{};
     constinit inline config::ConfigWrapper<config::Category,    const config::Group&>   group{};
@@ -9,6 +9,7 @@ namespace sm::config {
     struct Description { std::string_view value; };
     struct ReadOnly { bool readonly = true; };
     struct Hidden { bool hidden = true; };
+    struct RequiresRestart { bool restart = true; };
     struct Category { const Group& group; };
 
     template<typename T>
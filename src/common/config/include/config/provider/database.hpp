@@ -0,0 +1,52 @@
+#pragma once
+
+#include "config/config.hpp"
+
+#include "db/connection.hpp"
+
+namespace sm::config {
+    /// @brief applies option values stored in a database shared between nodes.
+    /// values are stored as toml values keyed by the path of their option, every
+    /// write takes the next version. each poll only asks for rows newer than the
+    /// last version applied, so polling an unchanged database is a single indexed
+    /// lookup that returns nothing.
+    class DatabaseProvider {
+        Context& mContext;
+
+        db::PreparedStatement mSelectChanges;
+
+        /// newest version that has been applied to the context
+        uint64_t mVersion = 0;
+
+        /// the first poll applies options that require a restart
+        bool mLoaded = false;
+
+    public:
+        SM_NOCOPY(DatabaseProvider);
+
+        /// @param connection must outlive the provider, the option table is created if it does not exist
+        DatabaseProvider(db::Connection& connection, Context& context) throws(db::DbException);
+
+        /// @brief apply every change written since the last poll.
+        /// changes are applied as a single update, if any value is invalid none of
+        /// them are applied and the version is kept. publishing a fixed value for the
+        /// invalid option replaces it, so the next poll applies the whole batch.
+        /// rows with an invalid path or naming an option this node does not have
+        /// are reported and skipped without holding back the rest of the batch.
+        UpdateResult poll() throws(db::DbException);
+
+        uint64_t getVersion() const noexcept { return mVersion; }
+    };
+
+    /// @brief create the option value table if it does not exist
+    void createOptionTables(db::Connection& connection) throws(db::DbException);
+
+    /// @brief write a new value for an option, applied by the next poll of every provider.
+    /// concurrent writers may race for the same version, the loser fails on the unique
+    /// version constraint and can retry.
+    /// @param path the option path, `group.name` or `name` for common options
+    /// @param value the value formatted as a toml value, `"text"`, `42` or `{ flag = true }`
+    /// @return the version of the write
+    /// @throws std::invalid_argument if @p path is not a valid option path
+    uint64_t publishOption(db::Connection& connection, std::string_view path, std::string_view value) throws(db::DbException, std::invalid_argument);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "config/config.hpp"
+
+#include "base/fs.hpp"
+
+#include <optional>
+#include <thread>
+
+namespace sm::config {
+    /// @brief reapplies a config file to a context whenever it changes on disk.
+    /// uses inotify on linux and polls the files write time elsewhere.
+    class FileWatcher {
+    public:
+        /// @brief called on the watcher thread after every reload
+        using ReloadCallback = std::function<void(const UpdateResult& result)>;
+
+    private:
+        Context& mContext;
+        const fs::path mPath;
+        ReloadCallback mCallback;
+
+        std::mutex mReloadMutex;
+
+        /// inotify descriptor, -1 when polling
+        int mNotify = -1;
+
+        /// last seen write time when polling
+        std::optional<fs::file_time_type> mWriteTime;
+
+        std::jthread mThread;
+
+        // both set up the watch before the constructor returns
+        // so no change made after construction is missed
+        bool initNotify();
+        void initPolling();
+
+        void watchFile(const std::stop_token& stop);
+        void pollFile(const std::stop_token& stop);
+
+    public:
+        SM_NOCOPY(FileWatcher);
+        SM_NOMOVE(FileWatcher);
+
+        /// @warning the context must outlive the watcher
+        FileWatcher(Context& context, fs::path path, ReloadCallback callback = nullptr);
+        ~FileWatcher() noexcept;
+
+        /// @brief reapply the file now
+        UpdateResult reload();
+
+        const fs::path& getPath() const noexcept { return mPath; }
+    };
+}
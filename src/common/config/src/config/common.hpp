@@ -5,6 +5,27 @@
 namespace sm::config::detail {
     bool verifyWriteAccess(UpdateResult& errs, const OptionBase& option);
 
+    template<typename O, typename T>
+    bool isCurrentValue(const O& option, const T& value) {
+        if constexpr (std::derived_from<O, StringOption>) {
+            return *option.getSnapshot() == value;
+        } else if constexpr (std::derived_from<O, BoolOption>) {
+            return option.getValue() == value;
+        } else {
+            return option.getCommonValue() == static_cast<decltype(option.getCommonValue())>(value);
+        }
+    }
+
+    /// @brief options that need a restart keep their value when a config is reloaded
+    template<typename O, typename T>
+    bool verifyReloadAccess(UpdateResult& errs, const O& option, const T& value) {
+        if (!option.shouldRestartOnUpdate() || isCurrentValue(option, value))
+            return true;
+
+        errs.fmtError(UpdateStatus::eRestartRequired, "option {} requires a restart to change", option.name);
+        return false;
+    }
+
     template<typename O, typename T>
         requires (std::derived_from<O, NumericOptionValue<T>>)
     bool updateNumericOption(UpdateResult& errs, O& option, T value) {
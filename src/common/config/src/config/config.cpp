@@ -4,6 +4,8 @@
 #include "core/error.hpp"
 #include "config/config.hpp"
 
+#include <algorithm>
+
 using namespace sm;
 using namespace sm::config;
 
@@ -35,8 +37,27 @@ static std::string_view getNodeTypeString(toml::node_type type) noexcept {
 
 struct ConfigFileSource {
     UpdateResult& result;
-    std::unordered_map<std::string_view, OptionBase*> *argLookup;
-    std::unordered_map<std::string_view, const Group*> *groupLookup;
+    const sm::HashMap<std::string_view, OptionBase*> *argLookup;
+    const sm::HashMap<std::string_view, const Group*> *groupLookup;
+
+    /// the config has already been applied once
+    bool reload = false;
+
+    /// check every value without writing to any options
+    bool dryRun = false;
+
+    template<typename O, typename T>
+    bool canUpdate(const O& option, const T& value) noexcept {
+        return !reload || config::detail::verifyReloadAccess(result, option, value);
+    }
+
+    template<typename O, typename T>
+    void setValue(O& option, const T& value) noexcept {
+        if (dryRun)
+            config::detail::verifyWriteAccess(result, option);
+        else
+            config::detail::updateOption(result, option, value);
+    }
 
     void reportInvalidType(std::string_view key, std::string_view expected, toml::node_type found) noexcept {
         result.fmtError(UpdateStatus::eInvalidValue, "invalid value for {}. expected {} found {}", key, expected, getNodeTypeString(found));
@@ -45,7 +66,8 @@ struct ConfigFileSource {
     template<typename T, typename O>
     void checkedOptionUpdate(const toml::node& node, O& option, std::string_view key, toml::node_type expected) noexcept {
         if (const toml::value<T> *v = node.as<T>()) {
-            config::detail::updateOption(result, option, v->get());
+            if (canUpdate(option, v->get()))
+                setValue(option, v->get());
         } else {
             reportInvalidType(key, getNodeTypeString(expected), node.type());
         }
@@ -53,6 +75,7 @@ struct ConfigFileSource {
 
     template<typename O>
     void updateEnumFlagOption(O &option, std::string_view key, const toml::table& table) noexcept {
+        auto optionValue = option.getCommonValue();
         for (const auto& [key, value] : table) {
             if (const toml::value<bool> *asBool = value.as_boolean()) {
                 const auto *it = config::detail::getEnumValue(option.getCommonOptions(), key);
@@ -61,13 +84,15 @@ struct ConfigFileSource {
                     continue;
                 }
 
-                auto optionValue = option.getCommonValue();
                 sm::setMask(optionValue, *it, asBool->get());
-                option.setCommonValue(optionValue);
             } else {
                 reportInvalidType(key, "boolean", value.type());
             }
         }
+
+        // applied once so change callbacks see every flag at once
+        if (canUpdate(option, optionValue) && !dryRun)
+            option.setCommonValue(optionValue);
     }
 
     template<typename O>
@@ -79,12 +104,20 @@ struct ConfigFileSource {
                 return;
             }
 
-            option.setCommonValue(*it);
+            if (canUpdate(option, *it) && !dryRun)
+                option.setCommonValue(*it);
         } else {
             reportInvalidType(key, "string", node.type());
         }
     }
 
+    // never insert, the key points into the parsed document and groups
+    // are looked up from other threads while a reload is running
+    const Group *findGroup(std::string_view key) const noexcept {
+        auto it = groupLookup->find(key);
+        return (it != groupLookup->end()) ? it->second : nullptr;
+    }
+
     bool tryUpdateFlags(std::string_view key, const toml::table& table) noexcept {
         auto it = argLookup->find(key);
         if (it == argLookup->end()) {
@@ -117,7 +150,7 @@ struct ConfigFileSource {
         if (node.is_table()) {
             const toml::table& table = *node.as_table();
             if (!tryUpdateFlags(key, table)) {
-                updateFromTable((*groupLookup)[key], key, table);
+                updateFromTable(findGroup(key), key, table);
             }
         }
         else if (node.is_value()) {
@@ -175,14 +208,52 @@ struct ConfigFileSource {
             updateValue(group, key, value);
         }
     }
+
+    void updateFromRoot(const toml::table& root) noexcept {
+        for (const auto& [key, value] : root) {
+            if (value.is_table()) {
+                // if this is a flag option then we update the option rather than treating it as a group
+                if (!tryUpdateFlags(key, *value.as_table())) {
+                    updateFromTable(findGroup(key), key, *value.as_table());
+                }
+            } else {
+                updateValue(&getCommonGroup(), key, value);
+            }
+        }
+    }
 };
 
+// options that need a restart are skipped rather than rejected when reloading,
+// otherwise a single one would hold back every other change
+static bool isRejected(const UpdateResult& result) noexcept {
+    return std::ranges::any_of(result, [](const UpdateError& error) {
+        return error.error != UpdateStatus::eRestartRequired;
+    });
+}
+
 UpdateResult Context::updateFromConfigFile(std::istream& is) noexcept {
+    return updateFromToml(is, false, false, false);
+}
+
+UpdateResult Context::reloadFromConfigFile(std::istream& is) noexcept {
+    return updateFromToml(is, true, false, false);
+}
+
+UpdateResult Context::applyConfigFileAtomic(std::istream& is, bool reload) noexcept {
+    return updateFromToml(is, reload, true, false);
+}
+
+UpdateResult Context::checkConfigFile(std::istream& is, bool reload) noexcept {
+    return updateFromToml(is, reload, true, true);
+}
+
+UpdateResult Context::updateFromToml(std::istream& is, bool reload, bool atomic, bool dryRun) noexcept {
     UpdateResult result;
     ConfigFileSource source {
         .result = result,
         .argLookup = &mArgLookup,
-        .groupLookup = &mGroupLookup
+        .groupLookup = &mGroupLookup,
+        .reload = reload
     };
 
     toml::parse_result parsed = toml::parse(is);
@@ -194,16 +265,23 @@ UpdateResult Context::updateFromConfigFile(std::istream& is) noexcept {
 
     const toml::table& root = parsed.table();
 
-    for (const auto& [key, value] : root) {
-        if (value.is_table()) {
-            // if this is a flag option then we update the option rather than treating it as a group
-            if (!source.tryUpdateFlags(key, *value.as_table())) {
-                source.updateFromTable(mGroupLookup[key], key, *value.as_table());
-            }
-        } else {
-            source.updateValue(&getCommonGroup(), key, value);
-        }
+    if (atomic) {
+        UpdateResult check;
+        ConfigFileSource validate {
+            .result = check,
+            .argLookup = &mArgLookup,
+            .groupLookup = &mGroupLookup,
+            .reload = reload,
+            .dryRun = true
+        };
+
+        validate.updateFromRoot(root);
+
+        if (dryRun || isRejected(check))
+            return check;
     }
 
+    source.updateFromRoot(root);
+
     return result;
 }
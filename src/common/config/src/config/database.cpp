@@ -0,0 +1,125 @@
+#include "config/provider/database.hpp"
+
+#include "db/transaction.hpp"
+
+#include "config.dao.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace sm;
+using namespace sm::config;
+
+using OptionValue = sm::dao::config::OptionValue;
+
+// paths are written into a toml document as dotted keys,
+// so only allow characters that are valid in a bare key
+static bool isValidPath(std::string_view path) noexcept {
+    if (path.empty() || path.starts_with('.') || path.ends_with('.'))
+        return false;
+
+    return std::ranges::all_of(path, [](char c) {
+        return (c >= 'a' && c <= 'z')
+            || (c >= 'A' && c <= 'Z')
+            || (c >= '0' && c <= '9')
+            || c == '_' || c == '-' || c == '.';
+    });
+}
+
+static db::PreparedStatement prepareSelectChanges(db::Connection& connection) {
+    createOptionTables(connection);
+
+    // the unique constraint on version indexes this lookup
+    return connection.prepareQuery("SELECT * FROM option_value WHERE version > :version ORDER BY version");
+}
+
+DatabaseProvider::DatabaseProvider(db::Connection& connection, Context& context)
+    : mContext(context)
+    , mSelectChanges(prepareSelectChanges(connection))
+{ }
+
+// rows written by nodes with options this node does not have yet, such as during a rolling deploy
+static bool isUnknownOption(Context& context, std::string_view line, bool reload) {
+    std::istringstream is { std::string{line} };
+    UpdateResult check = context.checkConfigFile(is, reload);
+
+    return std::ranges::any_of(check, [](const UpdateError& error) {
+        return error.error == UpdateStatus::eMissingValue;
+    });
+}
+
+UpdateResult DatabaseProvider::poll() {
+    mSelectChanges.bind("version", int64_t(mVersion));
+    db::ResultSet results = db::throwIfFailed(mSelectChanges.start());
+
+    UpdateResult result;
+    std::ostringstream document;
+    uint64_t version = mVersion;
+
+    // rows that can never apply are reported and skipped, republishing
+    // them would not help so holding back the batch would stall every node
+    while (!results.isDone()) {
+        OptionValue row = results.getRow<OptionValue>();
+        version = std::max(version, row.version);
+
+        std::string line = fmt::format("{} = {}\n", row.path, row.value);
+
+        if (!isValidPath(row.path)) {
+            result.fmtError(UpdateStatus::eSyntax, "skipping invalid option path `{}`", row.path);
+        } else if (isUnknownOption(mContext, line, mLoaded)) {
+            result.fmtError(UpdateStatus::eMissingValue, "skipping unknown option `{}`", row.path);
+        } else {
+            document << line;
+        }
+
+        if (db::DbError error = results.next(); !error.isSuccess())
+            error.raise();
+    }
+
+    std::string text = std::move(document).str();
+    if (!text.empty()) {
+        std::istringstream is { text };
+        UpdateResult applied = mContext.applyConfigFileAtomic(is, mLoaded);
+
+        for (const UpdateError& error : applied)
+            result.addError(error.error, error.message);
+
+        // a rejected batch is retried on the next poll
+        bool rejected = std::ranges::any_of(applied, [](const UpdateError& error) {
+            return error.error != UpdateStatus::eRestartRequired;
+        });
+
+        if (rejected)
+            return result;
+    }
+
+    mVersion = version;
+    mLoaded = true;
+
+    return result;
+}
+
+void config::createOptionTables(db::Connection& connection) {
+    connection.createTable(OptionValue::table());
+}
+
+uint64_t config::publishOption(db::Connection& connection, std::string_view path, std::string_view value) {
+    if (!isValidPath(path))
+        throw std::invalid_argument(fmt::format("invalid option path `{}`", path));
+
+    db::Transaction tx(&connection);
+
+    db::ResultSet latest = connection.selectSql("SELECT COALESCE(MAX(version), 0) FROM option_value");
+    uint64_t version = latest.at<uint64_t>(0) + 1;
+
+    OptionValue row {
+        .path = std::string{path},
+        .value = std::string{value},
+        .version = version,
+    };
+
+    connection.insertOrUpdate(row);
+
+    return version;
+}
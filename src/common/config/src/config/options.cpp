@@ -46,6 +46,7 @@ std::string_view config::toString(UpdateStatus it) {
     case UpdateStatus::eOutOfRange: return "OUT OF RANGE";
     case UpdateStatus::eReadOnly: return "READ ONLY";
     case UpdateStatus::eSyntax: return "INVALID SYNTAX";
+    case UpdateStatus::eRestartRequired: return "RESTART REQUIRED";
     default: return "INVALID";
     }
 }
@@ -120,6 +121,37 @@ OptionBase::OptionBase(detail::OptionBuilder config, OptionType type) noexcept
 
     if (config.readonly)
         mFlags |= eReadOnly;
+
+    if (config.restart)
+        mFlags |= eUpdateRequiresRestart;
+}
+
+size_t OptionBase::addChangeCallback(ChangeCallback callback) {
+    std::lock_guard guard(mCallbackMutex);
+    size_t handle = mNextCallback++;
+    mCallbacks.emplace_back(handle, std::move(callback));
+    return handle;
+}
+
+void OptionBase::removeChangeCallback(size_t handle) {
+    std::lock_guard guard(mCallbackMutex);
+    std::erase_if(mCallbacks, [&](const auto& it) { return it.first == handle; });
+}
+
+void OptionBase::notifyChanged() {
+    // copied so callbacks can add or remove callbacks without deadlocking
+    std::vector<std::pair<size_t, ChangeCallback>> callbacks;
+    {
+        std::lock_guard guard(mCallbackMutex);
+        if (mCallbacks.empty())
+            return;
+
+        callbacks = mCallbacks;
+    }
+
+    for (const auto& [_, callback] : callbacks) {
+        callback(*this);
+    }
 }
 
 template struct sm::config::ConsoleVariable<bool>;
@@ -0,0 +1,145 @@
+#include "stdafx.hpp"
+
+#include "config/watch.hpp"
+
+#include <fstream>
+
+#if __linux__
+#   include <poll.h>
+#   include <unistd.h>
+#   include <sys/inotify.h>
+#endif
+
+using namespace sm;
+using namespace sm::config;
+
+/// how often the watcher checks if it has been asked to stop
+static constexpr std::chrono::milliseconds kStopInterval{100};
+
+/// how often the write time is checked when inotify is unavailable
+static constexpr std::chrono::milliseconds kPollInterval{250};
+
+static std::optional<fs::file_time_type> getWriteTime(const fs::path& path) {
+    std::error_code ec;
+    fs::file_time_type time = fs::last_write_time(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    return time;
+}
+
+FileWatcher::FileWatcher(Context& context, fs::path path, ReloadCallback callback)
+    : mContext(context)
+    , mPath(std::move(path))
+    , mCallback(std::move(callback))
+{
+    if (initNotify()) {
+        mThread = std::jthread([this](const std::stop_token& stop) { watchFile(stop); });
+    } else {
+        initPolling();
+        mThread = std::jthread([this](const std::stop_token& stop) { pollFile(stop); });
+    }
+}
+
+FileWatcher::~FileWatcher() noexcept {
+    mThread.request_stop();
+    mThread.join();
+
+#if __linux__
+    if (mNotify != -1)
+        close(mNotify);
+#endif
+}
+
+UpdateResult FileWatcher::reload() {
+    std::lock_guard guard(mReloadMutex);
+
+    UpdateResult result;
+    if (std::ifstream is{mPath}) {
+        result = mContext.reloadFromConfigFile(is);
+    } else {
+        result.fmtError(UpdateStatus::eMissingValue, "failed to open config file {}", mPath.string());
+    }
+
+    if (mCallback)
+        mCallback(result);
+
+    return result;
+}
+
+void FileWatcher::initPolling() {
+    mWriteTime = getWriteTime(mPath);
+}
+
+void FileWatcher::pollFile(const std::stop_token& stop) {
+    while (!stop.stop_requested()) {
+        std::this_thread::sleep_for(kPollInterval);
+
+        std::optional<fs::file_time_type> current = getWriteTime(mPath);
+        if (current == mWriteTime)
+            continue;
+
+        mWriteTime = current;
+
+        // the file may be mid replacement, it is reloaded once it exists again
+        if (current.has_value())
+            reload();
+    }
+}
+
+#if __linux__
+
+bool FileWatcher::initNotify() {
+    mNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mNotify == -1)
+        return false;
+
+    // editors often save by writing a new file and renaming it over the old one,
+    // so the directory is watched rather than the file itself
+    fs::path dir = mPath.has_parent_path() ? mPath.parent_path() : fs::path{"."};
+    if (inotify_add_watch(mNotify, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+        close(mNotify);
+        mNotify = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void FileWatcher::watchFile(const std::stop_token& stop) {
+    std::string filename = mPath.filename().string();
+    alignas(inotify_event) char buffer[4096];
+
+    while (!stop.stop_requested()) {
+        pollfd event = { .fd = mNotify, .events = POLLIN, .revents = 0 };
+        if (poll(&event, 1, int(kStopInterval.count())) <= 0)
+            continue;
+
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(mNotify, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; ptr < buffer + length;) {
+                const inotify_event *it = reinterpret_cast<const inotify_event*>(ptr);
+                if (it->len > 0 && filename == it->name)
+                    changed = true;
+
+                ptr += sizeof(inotify_event) + it->len;
+            }
+        }
+
+        if (changed)
+            reload();
+    }
+}
+
+#else
+
+bool FileWatcher::initNotify() {
+    return false;
+}
+
+void FileWatcher::watchFile(const std::stop_token& stop) {
+    pollFile(stop);
+}
+
+#endif
@@ -168,3 +168,92 @@ TEST_CASE("config files update options") {
         }
     }
 }
+
+TEST_CASE("reloading config files") {
+    GIVEN("options with change callbacks") {
+        Group core { name = "core" };
+
+        Option<int> opt1 { name = "opt1", desc = "test description", group = core };
+        Option<std::string> opt2 { name = "opt2", desc = "test description", group = core, init = "initial" };
+        Option<int> opt3 { name = "opt3", desc = "test description", group = core, restart = true };
+
+        Context ctx;
+        ctx.addToGroup(&opt1, &core);
+        ctx.addToGroup(&opt2, &core);
+        ctx.addToGroup(&opt3, &core);
+
+        int changes = 0;
+        opt1.addChangeCallback([&](const OptionBase& option) {
+            CHECK(&option == &opt1);
+            changes += 1;
+        });
+
+        std::istringstream first {
+            R"(
+            [core]
+            opt1 = 1
+            opt2 = "first"
+            opt3 = 1
+            )"
+        };
+
+        auto result = ctx.updateFromConfigFile(first);
+        reportContextErrors(result, true);
+
+        StringSnapshot snapshot = opt2.getSnapshot();
+
+        THEN("restart options can be set at startup") {
+            CHECK(opt3.shouldRestartOnUpdate());
+            CHECK(opt3.getValue() == 1);
+            CHECK(changes == 1);
+        }
+
+        AND_WHEN("the config is reloaded with new values") {
+            std::istringstream second {
+                R"(
+                [core]
+                opt1 = 2
+                opt2 = "second"
+                opt3 = 2
+                )"
+            };
+
+            auto reload = ctx.reloadFromConfigFile(second);
+
+            THEN("options that require a restart keep their value") {
+                CHECK(reload.isFailure());
+                CHECK(reload.getErrors().size() == 1);
+                CHECK(reload.getErrors()[0].error == UpdateStatus::eRestartRequired);
+                CHECK(opt3.getValue() == 1);
+            }
+
+            THEN("other options are updated") {
+                CHECK(opt1.getValue() == 2);
+                CHECK(opt2.getValue() == "second");
+                CHECK(changes == 2);
+            }
+
+            THEN("old snapshots are unchanged") {
+                CHECK(*snapshot == "first");
+            }
+        }
+
+        AND_WHEN("the config is reloaded with the same values") {
+            std::istringstream same {
+                R"(
+                [core]
+                opt1 = 1
+                opt2 = "first"
+                opt3 = 1
+                )"
+            };
+
+            auto reload = ctx.reloadFromConfigFile(same);
+
+            THEN("nothing is reported as changed") {
+                reportContextErrors(reload, true);
+                CHECK(changes == 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,207 @@
+#include "test/common.hpp"
+#include "test/db_test_common.hpp"
+
+#include "config/provider/database.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace sm;
+using namespace sm::config;
+
+static bool isRestartOnly(const UpdateResult& result) {
+    for (const auto& err : result) {
+        if (err.error != UpdateStatus::eRestartRequired)
+            return false;
+    }
+
+    return true;
+}
+
+TEST_CASE("database config provider") {
+    auto env = db::Environment::create(db::DbType::eSqlite3);
+    auto conn = env.connect(makeSqliteTestDb("config/provider"));
+    conn.updateSql("DROP TABLE IF EXISTS option_value");
+
+    GIVEN("options shared through a database") {
+        Group core { name = "core" };
+
+        Option<int> opt1 { name = "opt1", desc = "test description", group = core };
+        Option<std::string> opt2 { name = "opt2", desc = "test description", group = core, init = "initial" };
+        Option<int> opt3 { name = "opt3", desc = "test description", group = core, restart = true };
+
+        Context ctx;
+        ctx.addToGroup(&opt1, &core);
+        ctx.addToGroup(&opt2, &core);
+        ctx.addToGroup(&opt3, &core);
+
+        DatabaseProvider provider { conn, ctx };
+
+        THEN("polling an empty database changes nothing") {
+            auto result = provider.poll();
+            CHECK(result.isSuccess());
+            CHECK(provider.getVersion() == 0);
+            CHECK(opt2.getValue() == "initial");
+        }
+
+        THEN("invalid paths cannot be published") {
+            CHECK_THROWS_AS(publishOption(conn, "core opt1", "1"), std::invalid_argument);
+            CHECK_THROWS_AS(publishOption(conn, ".opt1", "1"), std::invalid_argument);
+            CHECK(provider.poll().isSuccess());
+            CHECK(provider.getVersion() == 0);
+        }
+
+        AND_WHEN("an empty first poll completes") {
+            CHECK(provider.poll().isSuccess());
+
+            publishOption(conn, "core.opt3", "5");
+            auto update = provider.poll();
+
+            THEN("options that require a restart are no longer applied live") {
+                CHECK(isRestartOnly(update));
+                CHECK(update.isFailure());
+                CHECK(provider.getVersion() == 1);
+                CHECK(opt3.getValue() == 0);
+            }
+        }
+
+        AND_WHEN("rows name options this node does not have") {
+            publishOption(conn, "core.opt1", "7");
+            publishOption(conn, "core.missing", "1");
+            publishOption(conn, "unknown.opt1", "1");
+
+            // written by something that bypassed publishOption
+            conn.updateSql("INSERT INTO option_value (path, value, version) VALUES ('bad path', '1', 4)");
+
+            publishOption(conn, "core.opt2", "\"after\"");
+
+            auto result = provider.poll();
+
+            THEN("they are reported and skipped") {
+                CHECK(result.isFailure());
+                CHECK(provider.getVersion() == 5);
+                CHECK(opt1.getValue() == 7);
+                CHECK(opt2.getValue() == "after");
+
+                size_t missing = 0;
+                size_t syntax = 0;
+                for (const auto& err : result) {
+                    missing += (err.error == UpdateStatus::eMissingValue);
+                    syntax += (err.error == UpdateStatus::eSyntax);
+                }
+
+                CHECK(missing == 2);
+                CHECK(syntax == 1);
+            }
+
+            THEN("later polls do not fetch them again") {
+                CHECK(provider.poll().isSuccess());
+                CHECK(provider.getVersion() == 5);
+            }
+        }
+
+        AND_WHEN("rows name many groups this node does not have") {
+            // enough distinct names to grow the group table if lookups inserted them
+            for (int poll = 0; poll < 8; poll++) {
+                for (int i = 0; i < 16; i++)
+                    publishOption(conn, fmt::format("unknown{}.opt1", poll * 16 + i), "1");
+
+                auto result = provider.poll();
+                CHECK(result.isFailure());
+                CHECK(std::ranges::count_if(result, [](const UpdateError& err) {
+                    return err.error == UpdateStatus::eMissingValue;
+                }) == 16);
+            }
+
+            publishOption(conn, "core.opt1", "9");
+            auto result = provider.poll();
+
+            THEN("known groups are still found") {
+                CHECK(result.isSuccess());
+                CHECK(provider.getVersion() == 129);
+                CHECK(opt1.getValue() == 9);
+            }
+        }
+
+        AND_WHEN("values are published") {
+            CHECK(publishOption(conn, "core.opt1", "1") == 1);
+            CHECK(publishOption(conn, "core.opt2", "\"first\"") == 2);
+            CHECK(publishOption(conn, "core.opt3", "3") == 3);
+
+            auto result = provider.poll();
+
+            THEN("the first poll applies every value") {
+                CHECK(result.isSuccess());
+                CHECK(provider.getVersion() == 3);
+                CHECK(opt1.getValue() == 1);
+                CHECK(opt2.getValue() == "first");
+                CHECK(opt3.getValue() == 3);
+            }
+
+            AND_WHEN("a single value changes") {
+                int changes = 0;
+                opt1.addChangeCallback([&](const OptionBase&) { changes += 1; });
+                opt2.addChangeCallback([&](const OptionBase&) { changes += 1; });
+
+                publishOption(conn, "core.opt2", "\"second\"");
+
+                auto update = provider.poll();
+
+                THEN("only the changed option is updated") {
+                    CHECK(update.isSuccess());
+                    CHECK(provider.getVersion() == 4);
+                    CHECK(opt2.getValue() == "second");
+                    CHECK(changes == 1);
+                }
+
+                THEN("polling again finds no changes") {
+                    CHECK(provider.poll().isSuccess());
+                    CHECK(provider.getVersion() == 4);
+                    CHECK(changes == 1);
+                }
+            }
+
+            AND_WHEN("a batch contains an invalid value") {
+                publishOption(conn, "core.opt1", "2");
+                publishOption(conn, "core.opt2", "5");
+
+                auto update = provider.poll();
+
+                THEN("none of the batch is applied") {
+                    CHECK(update.isFailure());
+                    CHECK(provider.getVersion() == 3);
+                    CHECK(opt1.getValue() == 1);
+                    CHECK(opt2.getValue() == "first");
+                }
+
+                AND_WHEN("the invalid value is replaced") {
+                    publishOption(conn, "core.opt2", "\"fixed\"");
+
+                    auto retry = provider.poll();
+
+                    THEN("the whole batch is applied") {
+                        CHECK(retry.isSuccess());
+                        CHECK(provider.getVersion() == 6);
+                        CHECK(opt1.getValue() == 2);
+                        CHECK(opt2.getValue() == "fixed");
+                    }
+                }
+            }
+
+            AND_WHEN("an option that requires a restart changes") {
+                publishOption(conn, "core.opt1", "4");
+                publishOption(conn, "core.opt3", "4");
+
+                auto update = provider.poll();
+
+                THEN("it keeps its value without holding back other changes") {
+                    CHECK(update.isFailure());
+                    CHECK(isRestartOnly(update));
+                    CHECK(provider.getVersion() == 5);
+                    CHECK(opt1.getValue() == 4);
+                    CHECK(opt3.getValue() == 3);
+                }
+            }
+        }
+    }
+}
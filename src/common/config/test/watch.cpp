@@ -0,0 +1,99 @@
+#include "test/common.hpp"
+
+#include "config/watch.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <random>
+
+using namespace sm;
+using namespace sm::config;
+
+static void writeConfig(const fs::path& path, std::string_view content) {
+    // written to a temporary and renamed over the original like most editors
+    fs::path temp = path;
+    temp += ".tmp";
+
+    {
+        std::ofstream os{temp};
+        os << content;
+    }
+
+    fs::rename(temp, path);
+}
+
+// a fresh name for each run so parallel or leftover runs dont share a file
+static fs::path getUniquePath() {
+    std::random_device random{};
+    return fs::temp_directory_path() / fmt::format("sm-config-watch-{:08x}.toml", random());
+}
+
+namespace {
+    struct RemoveOnExit {
+        fs::path path;
+
+        ~RemoveOnExit() noexcept {
+            std::error_code ec;
+            fs::remove(path, ec);
+        }
+    };
+}
+
+TEST_CASE("config file watcher") {
+    GIVEN("a watched config file") {
+        Group core { name = "core" };
+        Option<int> opt1 { name = "opt1", desc = "test description", group = core };
+
+        Context ctx;
+        ctx.addToGroup(&opt1, &core);
+
+        fs::path path = getUniquePath();
+        RemoveOnExit cleanup { path };
+        writeConfig(path, "[core]\nopt1 = 1\n");
+
+        {
+            std::ifstream is{path};
+            REQUIRE(ctx.updateFromConfigFile(is).isSuccess());
+        }
+
+        REQUIRE(opt1.getValue() == 1);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<UpdateResult> results;
+
+        // the callback runs on the watcher thread, so only record the result
+        // there and check it on the test thread
+        FileWatcher watcher{ctx, path, [&](const UpdateResult& result) {
+            std::lock_guard guard(mutex);
+            results.push_back(result);
+            cv.notify_all();
+        }};
+
+        auto checkResults = [&] {
+            for (const UpdateResult& result : results)
+                CHECK(result.isSuccess());
+        };
+
+        WHEN("the file changes") {
+            writeConfig(path, "[core]\nopt1 = 2\n");
+
+            THEN("the option is updated") {
+                std::unique_lock lock(mutex);
+                CHECK(cv.wait_for(lock, std::chrono::seconds(5), [&] { return !results.empty(); }));
+                CHECK(opt1.getValue() == 2);
+                checkResults();
+            }
+        }
+
+        WHEN("the file is reloaded manually") {
+            THEN("the current contents are applied") {
+                CHECK(watcher.reload().isSuccess());
+                CHECK(opt1.getValue() == 1);
+
+                std::lock_guard guard(mutex);
+                checkResults();
+            }
+        }
+    }
+}
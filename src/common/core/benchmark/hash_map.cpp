@@ -0,0 +1,136 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "core/map.hpp"
+
+#include <fmtlib/format.h>
+
+#include <unordered_map>
+
+// operations per timed batch, large enough to hide timer overhead
+static constexpr size_t kBatch = 1000;
+
+// keys past this were never inserted when the table was filled
+static constexpr uint64_t kMissBase = 1ull << 62;
+static constexpr uint64_t kFreshBase = 1ull << 63;
+
+// splitmix64 finalizer, a bijection so distinct inputs never collide
+static uint64_t scramble(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+template<typename M>
+static void benchmarkTable(const char *name, size_t size, const char *label) {
+    M map;
+    for (uint64_t i = 0; i < size; i++)
+        map.emplace(scramble(i), i);
+
+    std::vector<uint64_t> hits(kBatch);
+    std::vector<uint64_t> misses(kBatch);
+    for (uint64_t i = 0; i < kBatch; i++) {
+        hits[i] = scramble(scramble(i) % size);
+        misses[i] = scramble(kMissBase + i);
+    }
+
+    // unique across every sample so each insert adds a new key
+    uint64_t fresh = kFreshBase;
+
+    BENCHMARK(fmt::format("{} lookup hit {}", name, label)) {
+        uint64_t sum = 0;
+        for (uint64_t key : hits)
+            sum += map.find(key)->second;
+
+        return sum;
+    };
+
+    BENCHMARK(fmt::format("{} lookup miss {}", name, label)) {
+        size_t found = 0;
+        for (uint64_t key : misses)
+            found += map.contains(key);
+
+        return found;
+    };
+
+    BENCHMARK_ADVANCED(fmt::format("{} insert {}", name, label))(Catch::Benchmark::Chronometer meter) {
+        std::vector<uint64_t> keys(meter.runs() * kBatch);
+        for (uint64_t& key : keys)
+            key = scramble(fresh++);
+
+        meter.measure([&](int run) {
+            for (size_t i = 0; i < kBatch; i++)
+                map.emplace(keys[run * kBatch + i], i);
+
+            return map.size();
+        });
+
+        for (uint64_t key : keys)
+            map.erase(key);
+    };
+
+    BENCHMARK_ADVANCED(fmt::format("{} erase {}", name, label))(Catch::Benchmark::Chronometer meter) {
+        std::vector<uint64_t> keys(meter.runs() * kBatch);
+        for (uint64_t& key : keys) {
+            key = scramble(fresh++);
+            map.emplace(key, 0);
+        }
+
+        meter.measure([&](int run) {
+            size_t erased = 0;
+            for (size_t i = 0; i < kBatch; i++)
+                erased += map.erase(keys[run * kBatch + i]);
+
+            return erased;
+        });
+    };
+}
+
+TEST_CASE("Hash map throughput") {
+    using FlatMap = sm::HashMap<uint64_t, uint64_t>;
+    using NodeMap = std::unordered_map<uint64_t, uint64_t>;
+
+    struct Size { size_t count; const char *label; };
+
+    for (auto [count, label] : { Size{1000, "1K"}, Size{100000, "100K"}, Size{10000000, "10M"} }) {
+        benchmarkTable<NodeMap>("std::unordered_map", count, label);
+        benchmarkTable<FlatMap>("sm::HashMap", count, label);
+    }
+}
+
+TEST_CASE("String key lookup") {
+    static constexpr size_t kCount = 100000;
+
+    sm::HashMap<std::string, size_t> flat;
+    std::unordered_map<std::string, size_t> node;
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < kCount; i++) {
+        names.push_back(fmt::format("config.group{}.option{}", i % 97, i));
+        flat.emplace(names.back(), i);
+        node.emplace(names.back(), i);
+    }
+
+    std::vector<std::string_view> lookups;
+    for (size_t i = 0; i < kBatch; i++)
+        lookups.push_back(names[scramble(i) % kCount]);
+
+    // without heterogeneous lookup every search has to build a string first
+    BENCHMARK("std::unordered_map string_view lookup 100K") {
+        size_t sum = 0;
+        for (std::string_view key : lookups)
+            sum += node.find(std::string{key})->second;
+
+        return sum;
+    };
+
+    BENCHMARK("sm::HashMap string_view lookup 100K") {
+        size_t sum = 0;
+        for (std::string_view key : lookups)
+            sum += flat.find(key)->second;
+
+        return sum;
+    };
+}
@@ -0,0 +1,109 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "core/random.hpp"
+
+#include <random>
+
+using namespace sm;
+
+static constexpr size_t kBytes = 1 << 20;
+static constexpr size_t kDraws = 100'000;
+
+TEST_CASE("Random bytes") {
+    std::vector<uint8_t> buffer(kBytes);
+
+    // what nextBytes used to do, one distribution sample per byte
+    BENCHMARK("mt19937 per byte") {
+        std::mt19937 rng{1234};
+        std::uniform_int_distribution<short> dist(0, UINT8_MAX);
+        for (uint8_t& byte : buffer)
+            byte = dist(rng) & UINT8_MAX;
+        return buffer[kBytes - 1];
+    };
+
+    BENCHMARK("xoshiro256**") {
+        Random rng{1234};
+        rng.nextBytes(buffer);
+        return buffer[kBytes - 1];
+    };
+
+    BENCHMARK("wyrand") {
+        WyRand rng{1234};
+        rng.nextBytes(buffer);
+        return buffer[kBytes - 1];
+    };
+
+    BENCHMARK("secure") {
+        getSecureRandomBytes(buffer);
+        return buffer[kBytes - 1];
+    };
+}
+
+TEST_CASE("Random words") {
+    std::vector<uint64_t> buffer(kDraws);
+
+    BENCHMARK("mt19937_64") {
+        std::mt19937_64 rng{1234};
+        for (uint64_t& word : buffer)
+            word = rng();
+        return buffer[kDraws - 1];
+    };
+
+    BENCHMARK("xoshiro256**") {
+        Random rng{1234};
+        rng.nextU64(buffer);
+        return buffer[kDraws - 1];
+    };
+
+    BENCHMARK("wyrand") {
+        WyRand rng{1234};
+        rng.nextU64(buffer);
+        return buffer[kDraws - 1];
+    };
+}
+
+TEST_CASE("Random range") {
+    // a dice roll, a range that does not divide 2^64
+    BENCHMARK("mt19937 uniform_int_distribution") {
+        std::mt19937 rng{1234};
+        std::uniform_int_distribution<uint64_t> dist(1, 6);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kDraws; i++)
+            sum += dist(rng);
+        return sum;
+    };
+
+    BENCHMARK("xoshiro256** uniform_int_distribution") {
+        Random rng{1234};
+        std::uniform_int_distribution<uint64_t> dist(1, 6);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kDraws; i++)
+            sum += dist(rng);
+        return sum;
+    };
+
+    BENCHMARK("xoshiro256** nextInRange") {
+        Random rng{1234};
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kDraws; i++)
+            sum += rng.nextInRange(1, 6);
+        return sum;
+    };
+
+    BENCHMARK("wyrand nextInRange") {
+        WyRand rng{1234};
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kDraws; i++)
+            sum += rng.nextInRange(1, 6);
+        return sum;
+    };
+
+    BENCHMARK("thread local nextInRange") {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kDraws; i++)
+            sum += Random::getThreadLocal().nextInRange(1, 6);
+        return sum;
+    };
+}
@@ -0,0 +1,82 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "core/allocators/slab.hpp"
+
+#include <fmtlib/format.h>
+
+#include <thread>
+
+using namespace sm;
+
+static constexpr size_t kBlockSize = 64;
+
+// each thread keeps this many blocks alive and replaces one per operation,
+// close to a queue of in flight packets or log messages
+static constexpr size_t kLiveBlocks = 256;
+static constexpr size_t kOperations = 100000;
+
+template<typename Alloc, typename Free>
+static size_t churn(Alloc&& alloc, Free&& free) {
+    void *live[kLiveBlocks];
+    for (void *&block : live)
+        block = alloc();
+
+    size_t checksum = 0;
+    for (size_t i = 0; i < kOperations; i++) {
+        void *&slot = live[i % kLiveBlocks];
+        free(slot);
+        slot = alloc();
+
+        *static_cast<size_t*>(slot) = i;
+        checksum += *static_cast<size_t*>(live[(i * 7) % kLiveBlocks]);
+    }
+
+    for (void *block : live)
+        free(block);
+
+    return checksum;
+}
+
+template<typename F>
+static size_t runThreads(size_t count, F&& fn) {
+    std::vector<size_t> results(count);
+
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < count; i++)
+            threads.emplace_back([&, i] { results[i] = fn(); });
+    }
+
+    size_t total = 0;
+    for (size_t result : results)
+        total += result;
+
+    return total;
+}
+
+TEST_CASE("Slab allocator throughput") {
+    SlabCache cache{kBlockSize};
+    SlabMemoryResource resource;
+
+    for (size_t threads : { 1, 4, 16 }) {
+        BENCHMARK(fmt::format("malloc {} threads", threads)) {
+            return runThreads(threads, [] {
+                return churn([] { return std::malloc(kBlockSize); }, [](void *ptr) { std::free(ptr); });
+            });
+        };
+
+        BENCHMARK(fmt::format("SlabCache {} threads", threads)) {
+            return runThreads(threads, [&] {
+                return churn([&] { return cache.allocate(); }, [&](void *ptr) { cache.deallocate(ptr); });
+            });
+        };
+
+        BENCHMARK(fmt::format("SlabMemoryResource {} threads", threads)) {
+            return runThreads(threads, [&] {
+                return churn([&] { return resource.allocate(kBlockSize); }, [&](void *ptr) { resource.deallocate(ptr, kBlockSize); });
+            });
+        };
+    }
+}
@@ -0,0 +1,87 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "core/slotmap.hpp"
+
+#include <fmtlib/format.h>
+
+#include <random>
+#include <thread>
+
+using namespace sm;
+
+static constexpr size_t kCapacity = 4096;
+static constexpr size_t kOperations = 10000;
+
+// each operation frees a random live entry and allocates a new one,
+// so occupancy holds steady for the whole run
+template<typename Alloc, typename Release>
+static size_t churn(size_t live, uint32_t seed, Alloc&& alloc, Release&& release) {
+    std::mt19937 rng{seed};
+
+    std::vector<decltype(alloc())> handles;
+    for (size_t i = 0; i < live; i++)
+        handles.push_back(alloc());
+
+    for (size_t i = 0; i < kOperations; i++) {
+        auto& slot = handles[rng() % handles.size()];
+        release(slot);
+        slot = alloc();
+    }
+
+    for (auto handle : handles)
+        release(handle);
+
+    return handles.size();
+}
+
+TEST_CASE("Slot map occupancy") {
+    for (size_t percent : { 50, 90, 99 }) {
+        size_t live = kCapacity * percent / 100;
+
+        BENCHMARK(fmt::format("SlotMap {}%", percent)) {
+            SlotMap<uint32_t> map{kCapacity};
+            return churn(live, 0,
+                [&] { return map.alloc(1); },
+                [&](auto index) { map.release(index); }
+            );
+        };
+
+        BENCHMARK(fmt::format("GenerationalSlotMap {}%", percent)) {
+            GenerationalSlotMap<uint32_t> map{kCapacity};
+            return churn(live, 0,
+                [&] { return map.alloc(1); },
+                [&](auto handle) { map.release(handle); }
+            );
+        };
+    }
+}
+
+TEST_CASE("Generational slot map contention") {
+    for (size_t threads : { 1, 4, 8 }) {
+        for (size_t percent : { 50, 90, 99 }) {
+            // each thread keeps its share of the live entries
+            size_t live = kCapacity * percent / 100 / threads;
+
+            BENCHMARK(fmt::format("GenerationalSlotMap {}% {} threads", percent, threads)) {
+                GenerationalSlotMap<uint32_t> map{kCapacity};
+                std::atomic<size_t> total = 0;
+
+                {
+                    std::vector<std::jthread> workers;
+                    for (size_t t = 0; t < threads; t++) {
+                        workers.emplace_back([&, t] {
+                            total += churn(live, uint32_t(t),
+                                [&] { return map.alloc(uint32_t(t)); },
+                                [&](auto handle) { map.release(handle); }
+                            );
+                        });
+                    }
+                }
+
+                return total.load();
+            };
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "core/utf8.hpp"
+#include "core/string.hpp"
+
+#include <fmtlib/format.h>
+
+#include <filesystem>
+
+using namespace sm;
+
+static constexpr size_t kTextSize = 0x100000;
+
+// the byte at a time implementation that was replaced, kept for comparison
+static size_t legacyCodepointLength(const char8_t *text) {
+    if ((text[0] & 0x80) == 0) {
+        return 1;
+    } else if ((text[0] & 0xE0) == 0xC0) {
+        return 2;
+    } else if ((text[0] & 0xF0) == 0xE0) {
+        return 3;
+    } else if ((text[0] & 0xF8) == 0xF0) {
+        return 4;
+    } else {
+        return 0;
+    }
+}
+
+static size_t legacyValidate(const char8_t *text, size_t length) {
+    size_t offset = 0;
+    while (offset < length) {
+        char8_t byte = text[offset];
+        if (byte == 0xFE || byte == 0xFF)
+            return offset;
+
+        size_t size = legacyCodepointLength(text + offset);
+        if (size == 0)
+            return offset;
+
+        offset += size;
+    }
+    return SIZE_MAX;
+}
+
+static size_t legacyCount(const char8_t *text, size_t length) {
+    size_t count = 0;
+    for (size_t offset = 0; offset < length; count++) {
+        size_t size = legacyCodepointLength(text + offset);
+        if (size == 0)
+            break;
+
+        offset += size;
+    }
+    return count;
+}
+
+// narrow and widen used to go through std::filesystem::path
+static std::wstring legacyWiden(std::string_view text) {
+    return std::filesystem::path(text).wstring();
+}
+
+static std::string legacyNarrow(std::wstring_view text) {
+    return std::filesystem::path(text).string();
+}
+
+static std::u8string createAsciiText() {
+    std::u8string text;
+    while (text.size() < kTextSize)
+        text += u8"the quick brown fox jumps over the lazy dog. ";
+
+    return text;
+}
+
+// mostly ascii with accents, cjk and emoji scattered through it
+static std::u8string createMixedText() {
+    std::u8string text;
+    while (text.size() < kTextSize)
+        text += u8"naïve café, 日本語のテキスト, emoji \U0001F600 and plain words. ";
+
+    return text;
+}
+
+static void benchmarkText(const char *name, const std::u8string& text) {
+    const char8_t *data = text.data();
+    size_t size = text.size();
+
+    BENCHMARK(fmt::format("Legacy validate {}", name)) {
+        return legacyValidate(data, size);
+    };
+
+    BENCHMARK(fmt::format("Validate {}", name)) {
+        return utf8::validate(data, size);
+    };
+
+    BENCHMARK(fmt::format("Legacy count {}", name)) {
+        return legacyCount(data, size);
+    };
+
+    BENCHMARK(fmt::format("Count {}", name)) {
+        return utf8::countCodepoints(data, size);
+    };
+
+    std::string_view narrow{reinterpret_cast<const char*>(data), size};
+    std::wstring wide = sm::widen(narrow);
+
+    BENCHMARK(fmt::format("Widen {}", name)) {
+        return sm::widen(narrow);
+    };
+
+    BENCHMARK(fmt::format("Narrow {}", name)) {
+        return sm::narrow(wide);
+    };
+}
+
+// the path conversions throw on anything outside the C locale, so only ascii is comparable
+static void benchmarkLegacyTranscode(const char *name, const std::u8string& text) {
+    std::string_view narrow{reinterpret_cast<const char*>(text.data()), text.size()};
+    std::wstring wide = legacyWiden(narrow);
+
+    BENCHMARK(fmt::format("Legacy widen {}", name)) {
+        return legacyWiden(narrow);
+    };
+
+    BENCHMARK(fmt::format("Legacy narrow {}", name)) {
+        return legacyNarrow(wide);
+    };
+}
+
+TEST_CASE("UTF-8 throughput") {
+    std::u8string ascii = createAsciiText();
+    std::u8string mixed = createMixedText();
+
+    REQUIRE(utf8::validate(ascii.data(), ascii.size()) == SIZE_MAX);
+    REQUIRE(utf8::validate(mixed.data(), mixed.size()) == SIZE_MAX);
+
+    benchmarkText("ascii 1MiB", ascii);
+    benchmarkLegacyTranscode("ascii 1MiB", ascii);
+    benchmarkText("mixed 1MiB", mixed);
+}
@@ -0,0 +1,112 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "core/uuid.hpp"
+#include "core/random.hpp"
+
+#include <unordered_map>
+
+using namespace sm;
+
+static constexpr size_t kCount = 10'000;
+
+static std::vector<uuid> getRandomUuids(size_t count) {
+    Random rng{1234};
+
+    std::vector<uuid> result(count);
+    for (uuid& it : result)
+        rng.nextBytes(it.octets);
+
+    return result;
+}
+
+/// the hash std::hash<uuid> used to be, kept to compare against
+struct PolynomialHash {
+    size_t operator()(const uuid& guid) const noexcept {
+        size_t hash = 0;
+        for (uint8_t byte : guid.octets)
+            hash = hash * 31 + byte;
+
+        return hash;
+    }
+};
+
+TEST_CASE("Uuid format and parse") {
+    std::vector<uuid> uuids = getRandomUuids(kCount);
+    std::vector<std::array<char, uuid::kStringSize>> strings(kCount);
+
+    BENCHMARK("strfuid") {
+        for (size_t i = 0; i < kCount; i++)
+            uuid::strfuid(strings[i].data(), uuids[i]);
+        return strings[kCount - 1][0];
+    };
+
+    BENCHMARK("parse") {
+        size_t parsed = 0;
+        for (size_t i = 0; i < kCount; i++)
+            parsed += uuid::parse(strings[i].data(), uuids[i]);
+        return parsed;
+    };
+
+    std::vector<std::array<char, uuid::kHexStringSize>> hex(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+        const auto& src = strings[i];
+        std::copy_if(src.begin(), src.end(), hex[i].begin(), [](char c) { return c != '-'; });
+    }
+
+    BENCHMARK("parseHex") {
+        size_t parsed = 0;
+        for (size_t i = 0; i < kCount; i++)
+            parsed += uuid::parseHex(hex[i].data(), uuids[i]);
+        return parsed;
+    };
+}
+
+template<typename Hash>
+static size_t lookupAll(const std::unordered_map<uuid, int, Hash>& map, const std::vector<uuid>& keys) {
+    size_t found = 0;
+    for (const uuid& key : keys)
+        found += map.contains(key);
+    return found;
+}
+
+TEST_CASE("Uuid map lookup") {
+    // sequential ids sharing a timestamp prefix, like a batch of v7 session ids
+    std::vector<uuid> keys;
+    for (size_t i = 0; i < kCount; i++) {
+        uuid it = uuid::of(0x0193d338, 0x17d8, 0x7ff3, 0x9a19, 0);
+        it.octets[15] = uint8_t(i);
+        it.octets[14] = uint8_t(i >> 8);
+        keys.push_back(it);
+    }
+
+    std::unordered_map<uuid, int, PolynomialHash> polynomial;
+    std::unordered_map<uuid, int> mixed;
+    for (size_t i = 0; i < kCount; i++) {
+        polynomial[keys[i]] = int(i);
+        mixed[keys[i]] = int(i);
+    }
+
+    BENCHMARK("polynomial hash") {
+        return lookupAll(polynomial, keys);
+    };
+
+    BENCHMARK("std::hash<uuid>") {
+        return lookupAll(mixed, keys);
+    };
+
+    BENCHMARK("hash only polynomial") {
+        size_t sum = 0;
+        for (const uuid& key : keys)
+            sum += PolynomialHash{}(key);
+        return sum;
+    };
+
+    BENCHMARK("hash only std::hash<uuid>") {
+        size_t sum = 0;
+        for (const uuid& key : keys)
+            sum += std::hash<uuid>{}(key);
+        return sum;
+    };
+}
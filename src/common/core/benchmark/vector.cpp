@@ -0,0 +1,124 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "core/adt/vector.hpp"
+#include "core/memory/unique.hpp"
+
+#include <string>
+
+#include <string.h>
+
+using namespace sm;
+
+static constexpr ssize_t kCount = 100'000;
+
+/// the way VectorBase used to grow, every slot is default constructed
+/// and then move assigned over, kept to compare against
+template<typename T>
+class NewArrayVector {
+    T *mData = new T[4];
+    ssize_t mSize = 0;
+    ssize_t mCapacity = 4;
+
+    void ensureGrowth(ssize_t size) {
+        if (size > mCapacity) {
+            ssize_t newCapacity = (std::max)(mCapacity * 2, size);
+            T *newData = new T[newCapacity];
+            std::move(mData, mData + mSize, newData);
+
+            delete[] mData;
+            mData = newData;
+            mCapacity = newCapacity;
+        }
+    }
+
+public:
+    ~NewArrayVector() { delete[] mData; }
+
+    void push_back(T &&value) {
+        ensureGrowth(mSize + 1);
+        mData[mSize++] = std::move(value);
+    }
+
+    void resize(ssize_t size) {
+        ensureGrowth(size);
+        std::fill(mData + mSize, mData + size, T());
+        mSize = size;
+    }
+
+    T *data() { return mData; }
+    ssize_t ssize() const { return mSize; }
+};
+
+template<typename V, typename F>
+static auto fillVector(F&& make) {
+    V vec;
+    for (ssize_t i = 0; i < kCount; i++)
+        vec.push_back(make(i));
+
+    return vec.ssize();
+}
+
+TEST_CASE("Vector growth") {
+    BENCHMARK("new[] int") {
+        return fillVector<NewArrayVector<int>>([](ssize_t i) { return int(i); });
+    };
+
+    BENCHMARK("VectorBase int") {
+        return fillVector<VectorBase<int>>([](ssize_t i) { return int(i); });
+    };
+
+    // moved one element at a time
+    BENCHMARK("new[] std::string") {
+        return fillVector<NewArrayVector<std::string>>([](ssize_t) { return std::string(32, 'a'); });
+    };
+
+    BENCHMARK("VectorBase std::string") {
+        return fillVector<VectorBase<std::string>>([](ssize_t) { return std::string(32, 'a'); });
+    };
+
+    // trivially relocatable by specialization, grown with memcpy
+    BENCHMARK("new[] UniquePtr") {
+        return fillVector<NewArrayVector<UniquePtr<int>>>([](ssize_t i) { return UniquePtr<int>(new int(int(i))); });
+    };
+
+    BENCHMARK("VectorBase UniquePtr") {
+        return fillVector<VectorBase<UniquePtr<int>>>([](ssize_t i) { return UniquePtr<int>(new int(int(i))); });
+    };
+}
+
+TEST_CASE("Byte buffer fill") {
+    // 16 MiB arriving in 64 KiB reads, like a file or socket buffer
+    static constexpr ssize_t kChunkSize = 64 * 1024;
+    static constexpr ssize_t kChunks = 256;
+
+    std::vector<byte> chunk(kChunkSize, 0x55);
+
+    BENCHMARK("new[] resize") {
+        NewArrayVector<byte> buffer;
+        for (ssize_t i = 0; i < kChunks; i++) {
+            ssize_t offset = buffer.ssize();
+            buffer.resize(offset + kChunkSize);
+            memcpy(buffer.data() + offset, chunk.data(), kChunkSize);
+        }
+        return buffer.ssize();
+    };
+
+    BENCHMARK("VectorBase resize") {
+        VectorBase<byte> buffer;
+        for (ssize_t i = 0; i < kChunks; i++) {
+            ssize_t offset = buffer.ssize();
+            buffer.resize(offset + kChunkSize);
+            memcpy(buffer.data() + offset, chunk.data(), kChunkSize);
+        }
+        return buffer.ssize();
+    };
+
+    BENCHMARK("VectorBase appendUninitialized") {
+        VectorBase<byte> buffer;
+        for (ssize_t i = 0; i < kChunks; i++)
+            memcpy(buffer.appendUninitialized(kChunkSize), chunk.data(), kChunkSize);
+        return buffer.ssize();
+    };
+}
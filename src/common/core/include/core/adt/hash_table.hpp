@@ -0,0 +1,936 @@
+#pragma once
+
+#include "base/macros.hpp"
+#include "base/panic.h"
+#include "base/throws.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define SM_HASH_TABLE_SSE2 1
+#   include <emmintrin.h>
+#else
+#   define SM_HASH_TABLE_SSE2 0
+#endif
+
+namespace sm::adt {
+    /// @brief the default hasher for hash tables.
+    /// strings hash through their view type so tables keyed by strings can be searched with views
+    template<typename T>
+    struct DefaultHash : std::hash<T> { };
+
+    template<typename C, typename Traits, typename A>
+    struct DefaultHash<std::basic_string<C, Traits, A>> {
+        using is_transparent = void;
+
+        size_t operator()(std::basic_string_view<C, Traits> text) const noexcept {
+            return std::hash<std::basic_string_view<C, Traits>>{}(text);
+        }
+    };
+
+    template<typename C, typename Traits>
+    struct DefaultHash<std::basic_string_view<C, Traits>> : DefaultHash<std::basic_string<C, Traits>> { };
+
+    template<typename T>
+    struct DefaultEqual : std::equal_to<T> { };
+
+    template<typename C, typename Traits, typename A>
+    struct DefaultEqual<std::basic_string<C, Traits, A>> : std::equal_to<> { };
+
+    template<typename C, typename Traits>
+    struct DefaultEqual<std::basic_string_view<C, Traits>> : std::equal_to<> { };
+
+    namespace detail {
+        /// @brief one control byte per slot.
+        /// full slots store the low 7 bits of the hash, every other state has the top bit set
+        using Control = int8_t;
+
+        static constexpr Control kEmpty = -128;
+        static constexpr Control kDeleted = -2;
+        static constexpr Control kSentinel = -1;
+
+        constexpr bool isFull(Control control) noexcept { return control >= 0; }
+        constexpr bool isEmptyOrDeleted(Control control) noexcept { return control < kSentinel; }
+
+        /// @brief a set of matching slots within a group
+        /// @tparam Shift log2 of the number of mask bits per slot
+        template<typename T, int Shift>
+        class BitMask {
+            T mMask;
+
+        public:
+            constexpr BitMask(T mask) noexcept
+                : mMask(mask)
+            { }
+
+            constexpr explicit operator bool() const noexcept { return mMask != 0; }
+
+            constexpr unsigned lowest() const noexcept { return std::countr_zero(mMask) >> Shift; }
+            constexpr unsigned trailingZeros() const noexcept { return std::countr_zero(mMask) >> Shift; }
+            constexpr unsigned leadingZeros() const noexcept { return std::countl_zero(mMask) >> Shift; }
+
+            constexpr unsigned operator*() const noexcept { return lowest(); }
+
+            constexpr BitMask& operator++() noexcept {
+                mMask &= (mMask - 1);
+                return *this;
+            }
+
+            constexpr BitMask begin() const noexcept { return *this; }
+            constexpr BitMask end() const noexcept { return BitMask(0); }
+
+            constexpr bool operator==(const BitMask& other) const noexcept { return mMask == other.mMask; }
+        };
+
+#if SM_HASH_TABLE_SSE2
+        /// @brief 16 control bytes compared at once
+        class Group {
+            __m128i mControl;
+
+        public:
+            static constexpr size_t kWidth = 16;
+
+            using Mask = BitMask<uint16_t, 0>;
+
+            Group(const Control *control) noexcept
+                : mControl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(control)))
+            { }
+
+            Mask match(Control hash) const noexcept {
+                return uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), mControl)));
+            }
+
+            Mask matchEmpty() const noexcept {
+                return match(kEmpty);
+            }
+
+            Mask matchEmptyOrDeleted() const noexcept {
+                return uint16_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(kSentinel), mControl)));
+            }
+        };
+#else
+        /// @brief 8 control bytes compared at once in a general purpose register
+        class Group {
+            static constexpr uint64_t kLsbs = 0x0101010101010101ull;
+            static constexpr uint64_t kMsbs = 0x8080808080808080ull;
+
+            uint64_t mControl;
+
+        public:
+            static constexpr size_t kWidth = 8;
+
+            using Mask = BitMask<uint64_t, 3>;
+
+            Group(const Control *control) noexcept {
+                memcpy(&mControl, control, sizeof(mControl));
+                if constexpr (std::endian::native == std::endian::big)
+                    mControl = std::byteswap(mControl);
+            }
+
+            // may report a slot whose control byte is hash ^ 1 next to a real match,
+            // that slot is still full so comparing its key rejects it
+            Mask match(Control hash) const noexcept {
+                uint64_t x = mControl ^ (kLsbs * uint8_t(hash));
+                return (x - kLsbs) & ~x & kMsbs;
+            }
+
+            Mask matchEmpty() const noexcept {
+                return (mControl & ~(mControl << 6)) & kMsbs;
+            }
+
+            Mask matchEmptyOrDeleted() const noexcept {
+                return (mControl & ~(mControl << 7)) & kMsbs;
+            }
+        };
+#endif
+
+        /// the control bytes of a table with no capacity, searches stop at the first empty
+        alignas(16) inline constexpr Control kEmptyGroup[16] = {
+            kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+            kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+        };
+
+        /// @brief triangular probing over groups, visits every group once when the capacity is a power of two minus one
+        class ProbeSequence {
+            size_t mMask;
+            size_t mOffset;
+            size_t mIndex = 0;
+
+        public:
+            constexpr ProbeSequence(size_t hash, size_t mask) noexcept
+                : mMask(mask)
+                , mOffset(hash & mask)
+            { }
+
+            constexpr size_t offset() const noexcept { return mOffset; }
+            constexpr size_t offset(size_t i) const noexcept { return (mOffset + i) & mMask; }
+
+            constexpr void next() noexcept {
+                mIndex += Group::kWidth;
+                mOffset = (mOffset + mIndex) & mMask;
+            }
+        };
+
+        /// spread the hash so identity hashes of integers still fill every bit
+        constexpr size_t mixHash(size_t hash) noexcept {
+            constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 product = (unsigned __int128)hash * kMultiplier;
+            return size_t(uint64_t(product) ^ uint64_t(product >> 64));
+#else
+            uint64_t x = hash;
+            x ^= x >> 33;
+            x *= kMultiplier;
+            x ^= x >> 29;
+            return size_t(x);
+#endif
+        }
+
+        constexpr size_t h1(size_t hash) noexcept { return hash >> 7; }
+        constexpr Control h2(size_t hash) noexcept { return Control(hash & 0x7F); }
+
+        /// round up to the next power of two minus one
+        constexpr size_t normalizeCapacity(size_t n) noexcept {
+            return n ? SIZE_MAX >> std::countl_zero(n) : 1;
+        }
+
+        /// tables are kept at most 7/8 full
+        constexpr size_t capacityToGrowth(size_t capacity) noexcept {
+            if (Group::kWidth == 8 && capacity == 7)
+                return 6;
+
+            return capacity - capacity / 8;
+        }
+
+        constexpr size_t growthToLowerBoundCapacity(size_t growth) noexcept {
+            if (Group::kWidth == 8 && growth == 7)
+                return 8;
+
+            return growth + (growth - 1) / 7;
+        }
+
+        template<typename K, typename V>
+        struct MapPolicy {
+            using KeyType = K;
+            using ValueType = std::pair<const K, V>;
+
+            static const K& key(const ValueType& value) noexcept { return value.first; }
+
+            static void relocate(ValueType *dst, ValueType *src) noexcept {
+                // the source is destroyed immediately after so moving out of its key is safe
+                std::construct_at(dst, std::move(const_cast<K&>(src->first)), std::move(src->second));
+                std::destroy_at(src);
+            }
+        };
+
+        template<typename T>
+        struct SetPolicy {
+            using KeyType = T;
+            using ValueType = T;
+
+            static const T& key(const ValueType& value) noexcept { return value; }
+
+            static void relocate(ValueType *dst, ValueType *src) noexcept {
+                std::construct_at(dst, std::move(*src));
+                std::destroy_at(src);
+            }
+        };
+    }
+
+    /// @brief an open addressing hash table with swiss table style control bytes.
+    ///
+    /// values are stored inline in a single allocation alongside a control byte per slot,
+    /// lookups compare a group of control bytes at once and only touch slots whose
+    /// hash fragment matches. unlike std::unordered_map, inserting may move existing
+    /// values so references and iterators are invalidated by any insertion that grows the table.
+    template<typename Policy, typename H, typename EQ>
+    class HashTable {
+        using Control = detail::Control;
+        using Group = detail::Group;
+
+        template<typename A>
+        static constexpr bool kIsTransparent = requires {
+            typename A::is_transparent;
+        };
+
+    protected:
+        /// heterogeneous lookup needs both the hash and equality to accept other key types
+        static constexpr bool kTransparent = kIsTransparent<H> && kIsTransparent<EQ>;
+
+    public:
+        using key_type = typename Policy::KeyType;
+        using value_type = typename Policy::ValueType;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using hasher = H;
+        using key_equal = EQ;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+
+        template<bool IsConst>
+        class Iterator {
+            friend HashTable;
+
+            template<bool>
+            friend class Iterator;
+
+            using Slot = std::conditional_t<IsConst, const typename Policy::ValueType, typename Policy::ValueType>;
+
+            const Control *mControl = nullptr;
+            Slot *mSlot = nullptr;
+
+            constexpr Iterator(const Control *control, Slot *slot) noexcept
+                : mControl(control)
+                , mSlot(slot)
+            {
+                skipEmpty();
+            }
+
+            // the sentinel after the last slot stops the scan
+            constexpr void skipEmpty() noexcept {
+                while (detail::isEmptyOrDeleted(*mControl)) {
+                    ++mControl;
+                    ++mSlot;
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename Policy::ValueType;
+            using difference_type = ptrdiff_t;
+            using reference = Slot&;
+            using pointer = Slot*;
+
+            constexpr Iterator() noexcept = default;
+
+            constexpr operator Iterator<true>() const noexcept requires (!IsConst) {
+                Iterator<true> it;
+                it.mControl = mControl;
+                it.mSlot = mSlot;
+                return it;
+            }
+
+            constexpr reference operator*() const noexcept { return *mSlot; }
+            constexpr pointer operator->() const noexcept { return mSlot; }
+
+            constexpr Iterator& operator++() noexcept {
+                ++mControl;
+                ++mSlot;
+                skipEmpty();
+                return *this;
+            }
+
+            constexpr Iterator operator++(int) noexcept {
+                Iterator it = *this;
+                ++*this;
+                return it;
+            }
+
+            constexpr bool operator==(const Iterator& other) const noexcept { return mControl == other.mControl; }
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+    private:
+        static constexpr size_t kNotFound = SIZE_MAX;
+        static constexpr size_t kClonedBytes = Group::kWidth - 1;
+        static constexpr size_t kAlignment = std::max(alignof(value_type), alignof(size_t));
+
+        Control *mControl = const_cast<Control*>(detail::kEmptyGroup);
+        value_type *mSlots = nullptr;
+        size_t mSize = 0;
+        size_t mCapacity = 0;
+        size_t mGrowthLeft = 0;
+
+        SM_NO_UNIQUE_ADDRESS H mHash;
+        SM_NO_UNIQUE_ADDRESS EQ mEqual;
+
+        static constexpr size_t slotOffset(size_t capacity) noexcept {
+            size_t controlSize = capacity + Group::kWidth;
+            return (controlSize + alignof(value_type) - 1) & ~(alignof(value_type) - 1);
+        }
+
+        static constexpr size_t allocationSize(size_t capacity) noexcept {
+            return slotOffset(capacity) + capacity * sizeof(value_type);
+        }
+
+        template<typename Q>
+        size_t hashOf(const Q& key) const noexcept {
+            return detail::mixHash(mHash(key));
+        }
+
+        /// the first bytes of the control array are mirrored after the sentinel so a
+        /// group can be loaded from any slot without wrapping
+        void setControl(size_t index, Control control) noexcept {
+            mControl[index] = control;
+            mControl[((index - kClonedBytes) & mCapacity) + (kClonedBytes & mCapacity)] = control;
+        }
+
+        void resetControl() noexcept {
+            memset(mControl, detail::kEmpty, mCapacity + Group::kWidth);
+            mControl[mCapacity] = detail::kSentinel;
+            mGrowthLeft = detail::capacityToGrowth(mCapacity) - mSize;
+        }
+
+        void allocate(size_t capacity) throws(std::bad_alloc) {
+            void *memory = ::operator new(allocationSize(capacity), std::align_val_t{kAlignment});
+
+            mControl = static_cast<Control*>(memory);
+            mSlots = reinterpret_cast<value_type*>(static_cast<char*>(memory) + slotOffset(capacity));
+            mCapacity = capacity;
+            resetControl();
+        }
+
+        void deallocate() noexcept {
+            if (mCapacity == 0)
+                return;
+
+            ::operator delete(mControl, allocationSize(mCapacity), std::align_val_t{kAlignment});
+        }
+
+        void destroyAll() noexcept {
+            if constexpr (!std::is_trivially_destructible_v<value_type>) {
+                for (size_t i = 0; i < mCapacity; i++) {
+                    if (detail::isFull(mControl[i]))
+                        std::destroy_at(mSlots + i);
+                }
+            }
+        }
+
+        void resetEmpty() noexcept {
+            mControl = const_cast<Control*>(detail::kEmptyGroup);
+            mSlots = nullptr;
+            mSize = 0;
+            mCapacity = 0;
+            mGrowthLeft = 0;
+        }
+
+        template<typename Q>
+        size_t findIndex(const Q& key, size_t hash) const {
+            detail::ProbeSequence sequence{detail::h1(hash), mCapacity};
+            while (true) {
+                Group group{mControl + sequence.offset()};
+                for (unsigned i : group.match(detail::h2(hash))) {
+                    size_t index = sequence.offset(i);
+                    if (mEqual(Policy::key(mSlots[index]), key)) [[likely]]
+                        return index;
+                }
+
+                if (group.matchEmpty())
+                    return kNotFound;
+
+                sequence.next();
+            }
+        }
+
+        size_t findFirstNonFull(size_t hash) const noexcept {
+            detail::ProbeSequence sequence{detail::h1(hash), mCapacity};
+            while (true) {
+                Group group{mControl + sequence.offset()};
+                if (auto mask = group.matchEmptyOrDeleted())
+                    return sequence.offset(mask.lowest());
+
+                sequence.next();
+            }
+        }
+
+        void resize(size_t capacity) throws(std::bad_alloc) {
+            Control *oldControl = mControl;
+            value_type *oldSlots = mSlots;
+            size_t oldCapacity = mCapacity;
+
+            allocate(capacity);
+
+            for (size_t i = 0; i < oldCapacity; i++) {
+                if (!detail::isFull(oldControl[i]))
+                    continue;
+
+                size_t hash = hashOf(Policy::key(oldSlots[i]));
+                size_t index = findFirstNonFull(hash);
+                setControl(index, detail::h2(hash));
+                Policy::relocate(mSlots + index, oldSlots + i);
+            }
+
+            if (oldCapacity != 0)
+                ::operator delete(oldControl, allocationSize(oldCapacity), std::align_val_t{kAlignment});
+        }
+
+        void growIfNeeded() throws(std::bad_alloc) {
+            if (mCapacity == 0) {
+                resize(1);
+            } else if (mCapacity > Group::kWidth && mSize * 32 <= mCapacity * 25) {
+                // mostly tombstones, rebuild at the same size to clear them
+                resize(mCapacity);
+            } else {
+                resize(mCapacity * 2 + 1);
+            }
+        }
+
+        /// claim a slot for a key that is known not to be in the table
+        size_t prepareInsert(size_t hash) throws(std::bad_alloc) {
+            size_t index = findFirstNonFull(hash);
+            if (mGrowthLeft == 0 && mControl[index] != detail::kDeleted) [[unlikely]] {
+                growIfNeeded();
+                index = findFirstNonFull(hash);
+            }
+
+            mSize += 1;
+            mGrowthLeft -= (mControl[index] == detail::kEmpty);
+            setControl(index, detail::h2(hash));
+            return index;
+        }
+
+        void eraseControl(size_t index) noexcept {
+            mSize -= 1;
+
+            // if no probe sequence ever saw this group full there is no need for a tombstone
+            size_t before = (index - Group::kWidth) & mCapacity;
+            auto emptyAfter = Group{mControl + index}.matchEmpty();
+            auto emptyBefore = Group{mControl + before}.matchEmpty();
+
+            bool wasNeverFull = emptyBefore && emptyAfter
+                && (emptyAfter.trailingZeros() + emptyBefore.leadingZeros()) < Group::kWidth;
+
+            setControl(index, wasNeverFull ? detail::kEmpty : detail::kDeleted);
+            mGrowthLeft += wasNeverFull;
+        }
+
+        void eraseAt(size_t index) noexcept {
+            std::destroy_at(mSlots + index);
+            eraseControl(index);
+        }
+
+        template<typename... A>
+        void constructAt(size_t index, A&&... args) {
+            try {
+                std::construct_at(mSlots + index, std::forward<A>(args)...);
+            } catch (...) {
+                eraseControl(index);
+                throw;
+            }
+        }
+
+        void copyFrom(const HashTable& other) {
+            reserve(other.mSize);
+            for (const value_type& value : other) {
+                size_t hash = hashOf(Policy::key(value));
+                constructAt(prepareInsert(hash), value);
+            }
+        }
+
+        iterator iteratorAt(size_t index) noexcept { return { mControl + index, mSlots + index }; }
+        const_iterator iteratorAt(size_t index) const noexcept { return { mControl + index, mSlots + index }; }
+
+    protected:
+        /// @brief insert a value constructed from @p args if @p key is not present.
+        /// @p args must construct a value whose key equals @p key
+        template<typename Q, typename... A>
+        std::pair<iterator, bool> emplaceKey(const Q& key, A&&... args) {
+            size_t hash = hashOf(key);
+            size_t index = findIndex(key, hash);
+            if (index != kNotFound)
+                return { iteratorAt(index), false };
+
+            index = prepareInsert(hash);
+            constructAt(index, std::forward<A>(args)...);
+            return { iteratorAt(index), true };
+        }
+
+        template<typename Q>
+        iterator findKey(const Q& key) {
+            size_t index = findIndex(key, hashOf(key));
+            return index == kNotFound ? end() : iteratorAt(index);
+        }
+
+        template<typename Q>
+        const_iterator findKey(const Q& key) const {
+            size_t index = findIndex(key, hashOf(key));
+            return index == kNotFound ? end() : iteratorAt(index);
+        }
+
+        template<typename Q>
+        size_t eraseKey(const Q& key) {
+            size_t index = findIndex(key, hashOf(key));
+            if (index == kNotFound)
+                return 0;
+
+            eraseAt(index);
+            return 1;
+        }
+
+    public:
+        HashTable() noexcept = default;
+
+        explicit HashTable(size_t capacity, const H& hash = H(), const EQ& equal = EQ())
+            : mHash(hash)
+            , mEqual(equal)
+        {
+            reserve(capacity);
+        }
+
+        HashTable(const HashTable& other)
+            : mHash(other.mHash)
+            , mEqual(other.mEqual)
+        {
+            copyFrom(other);
+        }
+
+        HashTable(HashTable&& other) noexcept
+            : mControl(std::exchange(other.mControl, const_cast<Control*>(detail::kEmptyGroup)))
+            , mSlots(std::exchange(other.mSlots, nullptr))
+            , mSize(std::exchange(other.mSize, 0))
+            , mCapacity(std::exchange(other.mCapacity, 0))
+            , mGrowthLeft(std::exchange(other.mGrowthLeft, 0))
+            , mHash(std::move(other.mHash))
+            , mEqual(std::move(other.mEqual))
+        { }
+
+        HashTable& operator=(const HashTable& other) {
+            if (this != &other) {
+                HashTable copy{other};
+                swap(copy);
+            }
+
+            return *this;
+        }
+
+        HashTable& operator=(HashTable&& other) noexcept {
+            HashTable moved{std::move(other)};
+            swap(moved);
+            return *this;
+        }
+
+        ~HashTable() noexcept {
+            destroyAll();
+            deallocate();
+        }
+
+        void swap(HashTable& other) noexcept {
+            std::swap(mControl, other.mControl);
+            std::swap(mSlots, other.mSlots);
+            std::swap(mSize, other.mSize);
+            std::swap(mCapacity, other.mCapacity);
+            std::swap(mGrowthLeft, other.mGrowthLeft);
+            std::swap(mHash, other.mHash);
+            std::swap(mEqual, other.mEqual);
+        }
+
+        friend void swap(HashTable& lhs, HashTable& rhs) noexcept { lhs.swap(rhs); }
+
+        iterator begin() noexcept { return iteratorAt(0); }
+        iterator end() noexcept { return iteratorAt(mCapacity); }
+        const_iterator begin() const noexcept { return iteratorAt(0); }
+        const_iterator end() const noexcept { return iteratorAt(mCapacity); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        bool empty() const noexcept { return mSize == 0; }
+        size_t size() const noexcept { return mSize; }
+        size_t capacity() const noexcept { return mCapacity; }
+        size_t max_size() const noexcept { return SIZE_MAX / sizeof(value_type); }
+
+        size_t bucket_count() const noexcept { return mCapacity; }
+        float load_factor() const noexcept { return mCapacity ? float(mSize) / float(mCapacity) : 0.f; }
+
+        /// the table grows once it is 7/8 full, this is not configurable
+        float max_load_factor() const noexcept { return 0.875f; }
+
+        hasher hash_function() const { return mHash; }
+        key_equal key_eq() const { return mEqual; }
+
+        /// @brief destroy every value, the capacity is kept
+        void clear() noexcept {
+            destroyAll();
+            mSize = 0;
+            if (mCapacity != 0)
+                resetControl();
+        }
+
+        /// @brief make space for at least @p count values without growing
+        void reserve(size_t count) throws(std::bad_alloc) {
+            if (count > mSize + mGrowthLeft)
+                resize(detail::normalizeCapacity(detail::growthToLowerBoundCapacity(count)));
+        }
+
+        /// @brief resize to hold at least @p count slots, removing tombstones.
+        /// a count of 0 shrinks the table to fit its current size
+        void rehash(size_t count) throws(std::bad_alloc) {
+            if (count == 0 && mSize == 0) {
+                destroyAll();
+                deallocate();
+                resetEmpty();
+                return;
+            }
+
+            size_t capacity = detail::normalizeCapacity(std::max(count, detail::growthToLowerBoundCapacity(mSize)));
+            if (count == 0 || capacity > mCapacity)
+                resize(capacity);
+        }
+
+        iterator find(const key_type& key) { return findKey(key); }
+        const_iterator find(const key_type& key) const { return findKey(key); }
+
+        template<typename Q> requires (kTransparent)
+        iterator find(const Q& key) { return findKey(key); }
+
+        template<typename Q> requires (kTransparent)
+        const_iterator find(const Q& key) const { return findKey(key); }
+
+        bool contains(const key_type& key) const { return findKey(key) != end(); }
+
+        template<typename Q> requires (kTransparent)
+        bool contains(const Q& key) const { return findKey(key) != end(); }
+
+        size_t count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+        template<typename Q> requires (kTransparent)
+        size_t count(const Q& key) const { return contains(key) ? 1 : 0; }
+
+        size_t erase(const key_type& key) { return eraseKey(key); }
+
+        template<typename Q> requires (kTransparent && !std::is_convertible_v<Q, const_iterator>)
+        size_t erase(const Q& key) { return eraseKey(key); }
+
+        /// @return the iterator after @p it
+        iterator erase(const_iterator it) noexcept {
+            size_t index = it.mControl - mControl;
+            eraseAt(index);
+
+            iterator next = iteratorAt(index);
+            return next;
+        }
+
+        iterator erase(iterator it) noexcept {
+            return erase(const_iterator(it));
+        }
+    };
+
+    /// @brief a flat hash map, @see HashTable
+    template<typename K, typename V, typename H = DefaultHash<K>, typename EQ = DefaultEqual<K>>
+    class FlatHashMap : public HashTable<detail::MapPolicy<K, V>, H, EQ> {
+        using Super = HashTable<detail::MapPolicy<K, V>, H, EQ>;
+        using Super::kTransparent;
+
+    public:
+        using mapped_type = V;
+        using typename Super::key_type;
+        using typename Super::value_type;
+        using typename Super::iterator;
+        using typename Super::const_iterator;
+
+        using Super::Super;
+
+        FlatHashMap() noexcept = default;
+
+        FlatHashMap(std::initializer_list<value_type> values) {
+            insert(values);
+        }
+
+        template<typename It>
+        FlatHashMap(It first, It last) {
+            insert(first, last);
+        }
+
+        template<typename... A>
+        std::pair<iterator, bool> try_emplace(const key_type& key, A&&... args) {
+            return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<A>(args)...));
+        }
+
+        template<typename... A>
+        std::pair<iterator, bool> try_emplace(key_type&& key, A&&... args) {
+            return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<A>(args)...));
+        }
+
+        template<typename Q, typename... A> requires (kTransparent && !std::is_convertible_v<Q, key_type>)
+        std::pair<iterator, bool> try_emplace(Q&& key, A&&... args) {
+            return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(std::forward<Q>(key)), std::forward_as_tuple(std::forward<A>(args)...));
+        }
+
+        template<typename... A>
+        std::pair<iterator, bool> emplace(A&&... args) {
+            if constexpr (sizeof...(A) == 2) {
+                return try_emplace(std::forward<A>(args)...);
+            } else {
+                value_type value(std::forward<A>(args)...);
+                return this->emplaceKey(value.first, std::move(value));
+            }
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            return this->emplaceKey(value.first, value);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            return this->emplaceKey(value.first, std::move(value));
+        }
+
+        template<typename It>
+        void insert(It first, It last) {
+            for (; first != last; ++first)
+                emplace(*first);
+        }
+
+        void insert(std::initializer_list<value_type> values) {
+            insert(values.begin(), values.end());
+        }
+
+        template<typename T>
+        std::pair<iterator, bool> insert_or_assign(const key_type& key, T&& value) {
+            auto result = try_emplace(key, std::forward<T>(value));
+            if (!result.second)
+                result.first->second = std::forward<T>(value);
+
+            return result;
+        }
+
+        template<typename T>
+        std::pair<iterator, bool> insert_or_assign(key_type&& key, T&& value) {
+            auto result = try_emplace(std::move(key), std::forward<T>(value));
+            if (!result.second)
+                result.first->second = std::forward<T>(value);
+
+            return result;
+        }
+
+        V& operator[](const key_type& key) { return try_emplace(key).first->second; }
+        V& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+        template<typename Q> requires (kTransparent && !std::is_convertible_v<Q, key_type>)
+        V& operator[](Q&& key) { return try_emplace(std::forward<Q>(key)).first->second; }
+
+        V& at(const key_type& key) throws(std::out_of_range) {
+            auto it = this->find(key);
+            if (it == this->end())
+                throw std::out_of_range("key not found in hash map");
+
+            return it->second;
+        }
+
+        const V& at(const key_type& key) const throws(std::out_of_range) {
+            auto it = this->find(key);
+            if (it == this->end())
+                throw std::out_of_range("key not found in hash map");
+
+            return it->second;
+        }
+
+        template<typename Q> requires (kTransparent)
+        V& at(const Q& key) throws(std::out_of_range) {
+            auto it = this->find(key);
+            if (it == this->end())
+                throw std::out_of_range("key not found in hash map");
+
+            return it->second;
+        }
+
+        template<typename Q> requires (kTransparent)
+        const V& at(const Q& key) const throws(std::out_of_range) {
+            auto it = this->find(key);
+            if (it == this->end())
+                throw std::out_of_range("key not found in hash map");
+
+            return it->second;
+        }
+
+        friend bool operator==(const FlatHashMap& lhs, const FlatHashMap& rhs) {
+            if (lhs.size() != rhs.size())
+                return false;
+
+            for (const value_type& value : lhs) {
+                auto it = rhs.find(value.first);
+                if (it == rhs.end() || !(it->second == value.second))
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+    /// @brief a flat hash set, @see HashTable
+    template<typename T, typename H = DefaultHash<T>, typename EQ = DefaultEqual<T>>
+    class FlatHashSet : public HashTable<detail::SetPolicy<T>, H, EQ> {
+        using Super = HashTable<detail::SetPolicy<T>, H, EQ>;
+
+    public:
+        using typename Super::key_type;
+        using typename Super::value_type;
+        using typename Super::const_iterator;
+
+        /// values are keys, so they can never be modified in place
+        using iterator = const_iterator;
+
+        using Super::Super;
+
+        FlatHashSet() noexcept = default;
+
+        FlatHashSet(std::initializer_list<value_type> values) {
+            insert(values);
+        }
+
+        template<typename It>
+        FlatHashSet(It first, It last) {
+            insert(first, last);
+        }
+
+        const_iterator begin() const noexcept { return Super::begin(); }
+        const_iterator end() const noexcept { return Super::end(); }
+
+        const_iterator find(const key_type& key) const { return Super::find(key); }
+
+        template<typename Q> requires (Super::kTransparent)
+        const_iterator find(const Q& key) const { return Super::find(key); }
+
+        std::pair<const_iterator, bool> insert(const value_type& value) {
+            return this->emplaceKey(value, value);
+        }
+
+        std::pair<const_iterator, bool> insert(value_type&& value) {
+            return this->emplaceKey(value, std::move(value));
+        }
+
+        template<typename It>
+        void insert(It first, It last) {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        void insert(std::initializer_list<value_type> values) {
+            insert(values.begin(), values.end());
+        }
+
+        template<typename... A>
+        std::pair<const_iterator, bool> emplace(A&&... args) {
+            value_type value(std::forward<A>(args)...);
+            return this->emplaceKey(value, std::move(value));
+        }
+
+        friend bool operator==(const FlatHashSet& lhs, const FlatHashSet& rhs) {
+            if (lhs.size() != rhs.size())
+                return false;
+
+            for (const value_type& value : lhs) {
+                if (!rhs.contains(value))
+                    return false;
+            }
+
+            return true;
+        }
+    };
+}
@@ -3,6 +3,7 @@
 #include "base/macros.hpp"
 
 #include "core/adt/range.hpp"
+#include "core/memory/relocate.hpp"
 #include "core/core.hpp"
 
 #include "base/panic.h"
@@ -47,17 +48,21 @@ namespace sm {
         }
 
         constexpr void initByCopy(const T *first, const T *last) noexcept {
-            resize(last - first);
-            std::copy(first, last, this->mFront);
+            verifySize(last - first);
+            clear();
+            this->mBack = std::uninitialized_copy(first, last, this->mFront);
         }
 
-        constexpr void constructByMove(T *first, T *last) noexcept {
-            std::uninitialized_move(first, last, this->mFront);
+        // take the elements of other, leaving it empty
+        constexpr void constructByRelocate(SmallVectorBase& other) noexcept {
+            this->mBack = uninitializedRelocate(other.mFront, other.mBack, this->mFront);
+            other.mBack = other.mFront;
         }
 
-        constexpr void initByMove(T *first, T *last) noexcept {
-            resize(last - first);
-            std::move(first, last, this->mFront);
+        constexpr void initByRelocate(SmallVectorBase& other) noexcept {
+            verifySize(other.ssize());
+            clear();
+            constructByRelocate(other);
         }
 
     public:
@@ -163,6 +168,27 @@ namespace sm {
 
             return false;
         }
+
+        /// @brief change the size without initializing new elements
+        constexpr void resizeUninitialized(ssize_t size) noexcept requires (std::is_trivially_default_constructible_v<T>) {
+            verifySize(size);
+
+            if (size < this->ssize())
+                std::destroy(this->mFront + size, this->mBack);
+
+            this->mBack = this->mFront + size;
+        }
+
+        /// @brief grow the size by @a count without initializing the new elements
+        /// @return the first new element
+        constexpr T *appendUninitialized(ssize_t count) noexcept requires (std::is_trivially_default_constructible_v<T>) {
+            CTASSERTF(count >= 0, "Count must be non-negative: %zd", count);
+            ensureExtra(count);
+
+            T *result = this->mBack;
+            this->mBack += count;
+            return result;
+        }
     };
 
     /// @brief A small vector with a fixed capacity
@@ -214,8 +240,7 @@ namespace sm {
         constexpr SmallVector(Super&& other) noexcept
             : SmallVector(other.ssize(), noinit{})
         {
-            Super::constructByMove(other.begin(), other.end());
-            other.clear();
+            Super::constructByRelocate(other);
         }
 
         constexpr SmallVector(SmallVector&& other) noexcept
@@ -228,15 +253,14 @@ namespace sm {
             if (this == &other)
                 return *this;
 
-            Super::initByMove(other.begin(), other.end());
-            other.clear();
+            Super::initByRelocate(other);
 
             return *this;
         }
 
         // NOLINTNEXTLINE(cert-oop54-cpp) - operator=(Super&&) handles self assignment
         constexpr SmallVector& operator=(SmallVector&& other) noexcept {
-            return *this = (Super)other;
+            return *this = (Super&&)other;
         }
 
         /// Copy constructor
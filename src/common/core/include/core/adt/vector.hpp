@@ -4,6 +4,7 @@
 #include "base/macros.hpp"
 
 #include "core/adt/range.hpp"
+#include "core/memory/relocate.hpp"
 
 #include "base/panic.h"
 
@@ -26,10 +27,19 @@ namespace sm {
 
         T *mCapacity = nullptr;
 
+        static constexpr T *allocate(SizeType capacity) throws(std::bad_alloc) {
+            return std::allocator<T>{}.allocate(capacity);
+        }
+
+        static constexpr void deallocate(T *data, SizeType capacity) noexcept {
+            if (data != nullptr)
+                std::allocator<T>{}.deallocate(data, capacity);
+        }
+
         // destroy the data and release the memory
         constexpr void releaseData() noexcept {
             std::destroy(this->mFront, this->mBack);
-            delete[] this->mFront;
+            deallocate(this->mFront, capacity());
         }
 
         // set new data pointers
@@ -39,33 +49,39 @@ namespace sm {
             mCapacity = front + capacity;
         }
 
+        // release the old memory, its elements must already be relocated or destroyed
         constexpr void replaceData(T *front, SizeType used, SizeType capacity) noexcept {
-            releaseData();
+            deallocate(this->mFront, this->capacity());
             updateData(front, used, capacity);
         }
 
-        constexpr void init(SizeType capacity, SizeType used = 0) throws(std::bad_alloc) {
+        constexpr void init(SizeType capacity) throws(std::bad_alloc) {
             CTASSERTF(capacity >= 0, "Capacity must be non-negative: %zd", capacity);
-            CTASSERTF(used >= 0, "Used must be non-negative: %zd", used);
-            CTASSERTF(used <= capacity, "Used must be less than or equal to capacity: %zd <= %zd", used, capacity);
 
-            T *data = new T[capacity];
+            updateData(allocate(capacity), 0, capacity);
+        }
 
-            updateData(data, used, capacity);
+        constexpr SizeType getGrowth(SizeType size) const noexcept {
+            return (std::max)(capacity() * 2, size);
+        }
+
+        // move the elements that fit into new memory with exactly cap elements
+        constexpr void reallocate(SizeType cap) throws(std::bad_alloc) {
+            SizeType count = (std::min)(this->ssize(), cap);
+
+            // allocate first so a failure leaves the vector untouched
+            T *newData = allocate(cap);
+
+            shrinkSize(count);
+            uninitializedRelocate(this->mFront, this->mBack, newData);
+
+            replaceData(newData, count, cap);
         }
 
         // only ever grows the backing data
         constexpr void ensureGrowth(SizeType size) throws(std::bad_alloc) {
             if (size > capacity()) {
-                SizeType newCapacity = (std::max)(capacity() * 2, size);
-                SizeType oldSize = this->ssize();
-
-                // copy over the old data
-                T *newData = new T[newCapacity];
-                std::uninitialized_move(this->begin(), this->end(), newData);
-
-                // release old data and update the pointers
-                replaceData(newData, oldSize, newCapacity);
+                reallocate(getGrowth(size));
             }
         }
 
@@ -74,6 +90,38 @@ namespace sm {
             ensureGrowth(this->ssize() + extra);
         }
 
+        // grow and construct the new element in the same pass.
+        // the element is constructed before the old data is relocated
+        // so args may refer to elements already in the vector.
+        template<typename... A>
+        constexpr T& growAndEmplace(A&&... args) throws(std::bad_alloc) {
+            SizeType size = this->ssize();
+            SizeType newCapacity = getGrowth(size + 1);
+
+            T *newData = allocate(newCapacity);
+            T *result = nullptr;
+
+            try {
+                result = std::construct_at(newData + size, std::forward<A>(args)...);
+            } catch (...) {
+                deallocate(newData, newCapacity);
+                throw;
+            }
+
+            uninitializedRelocate(this->mFront, this->mBack, newData);
+            replaceData(newData, size + 1, newCapacity);
+
+            return *result;
+        }
+
+        template<typename... A>
+        constexpr T& emplaceImpl(A&&... args) {
+            if (this->mBack == mCapacity)
+                return growAndEmplace(std::forward<A>(args)...);
+
+            return *std::construct_at(this->mBack++, std::forward<A>(args)...);
+        }
+
         // shrink the backing data, dont release memory
         constexpr void shrinkSize(SizeType size) noexcept {
             CTASSERTF(size >= 0, "Size must be non-negative: %zd", size);
@@ -89,16 +137,7 @@ namespace sm {
             CTASSERTF(size >= 0, "Size must be non-negative: %zd", size);
 
             if (size < capacity()) {
-                SizeType oldSize = this->ssize();
-
-                SizeType count = (std::min)(oldSize, size);
-
-                // copy over the old data
-                T *newData = new T[size];
-                std::uninitialized_move(this->begin(), this->begin() + count, newData);
-
-                // release old data and update the pointers
-                replaceData(newData, count, size);
+                reallocate(size);
             }
         }
 
@@ -106,17 +145,7 @@ namespace sm {
             CTASSERTF(cap >= 0, "Capacity must be non-negative: %zd", cap);
 
             if (cap != capacity()) {
-                SizeType oldSize = this->ssize();
-
-                // number of elements to copy
-                SizeType count = (std::min)(oldSize, cap);
-
-                // copy over the old data
-                T *newData = new T[cap];
-                std::uninitialized_move(this->begin(), this->begin() + count, newData);
-
-                // release old data and update the pointers
-                replaceData(newData, count, cap);
+                reallocate(cap);
             }
         }
 
@@ -125,30 +154,33 @@ namespace sm {
             , mCapacity(capacity)
         { }
 
-        constexpr VectorBase(SizeType initialSize, SizeType used)
+        // allocate memory for capacity elements and construct none of them
+        constexpr VectorBase(SizeType capacity, sm::init)
             : Super(nullptr, nullptr)
         {
-            init(initialSize, used);
+            init(capacity);
         }
 
     public:
         constexpr ~VectorBase() noexcept {
-            delete[] this->mFront;
+            releaseData();
         }
 
+        // default construct size elements, trivial types are left uninitialized
         constexpr VectorBase(SizeType initialSize, noinit)
-            : VectorBase(initialSize, initialSize)
-        { }
+            : VectorBase(initialSize, sm::init{})
+        {
+            std::uninitialized_default_construct(this->mFront, this->mFront + initialSize);
+            this->mBack = this->mFront + initialSize;
+        }
 
         constexpr VectorBase()
-            : VectorBase(4, 0)
+            : VectorBase(4, sm::init{})
         { }
 
         explicit constexpr VectorBase(const VectorBase &other)
-            : VectorBase(other.size(), other.size())
-        {
-            std::uninitialized_copy(other.begin(), other.end(), this->begin());
-        }
+            : VectorBase(other.begin(), other.end())
+        { }
 
         constexpr VectorBase(VectorBase &&other) noexcept
             : Super(nullptr, nullptr)
@@ -161,6 +193,8 @@ namespace sm {
             : VectorBase(init.begin(), init.end())
         { }
 
+        /// @brief take ownership of memory allocated with std::allocator<T>
+        /// the first @a size elements must be constructed
         static constexpr VectorBase consume(T *data, SizeType size, SizeType capacity) noexcept {
             return VectorBase{data, data + size, data + capacity};
         }
@@ -183,9 +217,9 @@ namespace sm {
         }
 
         constexpr VectorBase(const T *first, const T *last)
-            : VectorBase(last - first, last - first)
+            : VectorBase(last - first, sm::init{})
         {
-            std::uninitialized_copy(first, last, this->begin());
+            this->mBack = std::uninitialized_copy(first, last, this->mFront);
         }
 
         template<size_t N>
@@ -199,6 +233,9 @@ namespace sm {
 
         // element access
 
+        /// @brief give up ownership of the elements and memory
+        /// the memory must be released with std::allocator<T>::deallocate,
+        /// read capacity() before calling this to know its size
         constexpr T *release() noexcept {
             T *data = this->mFront;
             updateData(nullptr, 0, 0);
@@ -252,33 +289,57 @@ namespace sm {
             this->mBack = this->mFront + count;
         }
 
+        /// @brief change the size without initializing new elements
+        ///
+        /// for buffers that are about to be filled by recv, fread, or a blob read,
+        /// zeroing them first is wasted bandwidth.
+        constexpr void resizeUninitialized(SizeType count) requires (std::is_trivially_default_constructible_v<T>) {
+            CTASSERTF(count >= 0, "Size must be non-negative: %zd", count);
+
+            if (count > this->ssize()) {
+                ensureGrowth(count);
+            } else if (count < this->ssize()) {
+                shrinkSize(count);
+            }
+
+            this->mBack = this->mFront + count;
+        }
+
+        /// @brief grow the size by @a count without initializing the new elements
+        ///
+        /// @return the first new element, valid until the vector next grows
+        constexpr T *appendUninitialized(SizeType count) requires (std::is_trivially_default_constructible_v<T>) {
+            CTASSERTF(count >= 0, "Count must be non-negative: %zd", count);
+
+            ensureExtra(count);
+
+            T *result = this->mBack;
+            this->mBack += count;
+            return result;
+        }
+
         // appending
 
         constexpr T& emplace_back(auto&&... args) {
-            ensureExtra(1);
-            return *new (this->mBack++) T(std::forward<decltype(args)>(args)...);
+            return emplaceImpl(std::forward<decltype(args)>(args)...);
         }
 
         constexpr T& emplace_back(T &&value) requires (std::is_move_constructible_v<T>) {
-            ensureExtra(1);
-            return (*this->mBack++ = std::move(value));
+            return emplaceImpl(std::move(value));
         }
 
         constexpr void push_back(const T &value) {
-            ensureExtra(1);
-            new (this->mBack++) T{value};
+            emplaceImpl(value);
         }
 
         constexpr void push_back(T &&value) requires (std::is_move_constructible_v<T>) {
-            ensureExtra(1);
-            new (this->mBack++) T{std::move(value)};
+            emplaceImpl(std::move(value));
         }
 
         constexpr void assign(const T *first, const T *last) {
             SizeType count = last - first;
             ensureExtra(count);
-            std::move(first, last, this->mBack);
-            this->mBack += count;
+            this->mBack = std::uninitialized_copy(first, last, this->mBack);
         }
 
         // swap
@@ -1,34 +1,182 @@
 #pragma once
 
 #include "base/macros.hpp"
+#include "base/throws.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <stdint.h>
 
 namespace sm {
+    namespace detail {
+        struct SlabThreadCaches;
+    }
+
+    /// @brief fixed size block allocator over a single region of memory.
+    ///
+    /// freed blocks are kept on an intrusive list threaded through the blocks themselves,
+    /// blocks that have never been handed out are carved from the region on demand so
+    /// construction does not touch the memory. not thread safe, @see SlabCache
     class SlabAllocator {
         using This = SlabAllocator;
 
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
         void *mMemory;
         size_t mCapacity;
         size_t mBlockSize;
+        bool mOwnsMemory;
+
+        FreeBlock *mFreeList = nullptr;
+
+        /// number of blocks that have been carved from the region
+        size_t mWatermark = 0;
+
+        size_t mUsed = 0;
+
+        SlabAllocator(void *memory, size_t capacity, size_t blockSize, bool owned) noexcept;
 
     public:
+        /// blocks hold a free list link while unused
+        static constexpr size_t kMinBlockSize = sizeof(FreeBlock);
+
+        /// @brief manage memory owned by the caller
+        /// @param memory at least @p capacity * @p blockSize bytes
+        /// @param blockSize must be a multiple of @a kMinBlockSize
         SlabAllocator(void *memory, size_t capacity, size_t blockSize) noexcept
-            : mMemory(memory)
-            , mCapacity(capacity)
-            , mBlockSize(blockSize)
+            : This(memory, capacity, blockSize, false)
         { }
 
-        SlabAllocator(size_t capacity, size_t blockSize);
+        /// @brief allocate and own memory for @p capacity blocks
+        SlabAllocator(size_t capacity, size_t blockSize) throws(std::bad_alloc);
 
         ~SlabAllocator() noexcept;
 
         SM_NOCOPY(SlabAllocator);
         SM_NOMOVE(SlabAllocator);
 
+        /// @return a block or nullptr when every block is in use
         void *allocate() noexcept;
+
+        /// @param ptr a block from this allocator, may be nullptr
         void deallocate(void *ptr) noexcept;
 
+        /// @brief check if @p ptr points into the region managed by this allocator
+        bool contains(const void *ptr) const noexcept;
+
         size_t capacity() const noexcept { return mCapacity; }
         size_t blockSize() const noexcept { return mBlockSize; }
         size_t totalSize() const noexcept { return mCapacity * mBlockSize; }
+
+        size_t used() const noexcept { return mUsed; }
+        size_t available() const noexcept { return mCapacity - mUsed; }
+    };
+
+    /// @brief thread caching front end for fixed size blocks.
+    ///
+    /// each thread keeps two magazines of free blocks, allocation and deallocation only touch
+    /// shared state when both are empty or both are full. magazines are then exchanged whole with
+    /// a shared depot, which grows by allocating another slab when it runs dry. blocks may be
+    /// freed on a different thread than they were allocated on. memory is only returned to the
+    /// system when the cache is destroyed, at which point no thread may still be using it.
+    class SlabCache {
+        friend detail::SlabThreadCaches;
+
+    public:
+        static constexpr size_t kMagazineSize = 64;
+
+        struct Magazine {
+            size_t count = 0;
+            void *blocks[kMagazineSize];
+        };
+
+        struct ThreadCache {
+            Magazine *loaded;
+            Magazine *previous;
+        };
+
+    private:
+        uint64_t mId;
+        size_t mBlockSize;
+        size_t mSlabCapacity;
+
+        std::mutex mDepotMutex;
+
+        /// every slab, blocks are carved from the last one
+        std::vector<std::unique_ptr<SlabAllocator>> mSlabs;
+
+        std::vector<std::unique_ptr<Magazine>> mMagazines;
+        std::vector<Magazine*> mStocked;
+        std::vector<Magazine*> mEmpty;
+
+        std::vector<std::unique_ptr<ThreadCache>> mCaches;
+
+        /// blocks freed while a magazine could not be allocated, linked through the blocks
+        void *mOverflow = nullptr;
+
+        ThreadCache& getThreadCache() throws(std::bad_alloc);
+        ThreadCache& createThreadCache() throws(std::bad_alloc);
+
+        Magazine *newMagazine() throws(std::bad_alloc);
+        void fillMagazine(Magazine *magazine) throws(std::bad_alloc);
+
+        void *refill(ThreadCache& cache) throws(std::bad_alloc);
+        void spill(ThreadCache& cache, void *ptr) throws(std::bad_alloc);
+
+        /// return a threads magazines to the depot and destroy its cache
+        void releaseCache(ThreadCache *cache) noexcept;
+
+    public:
+        /// @param blockSize rounded up to a multiple of @a SlabAllocator::kMinBlockSize
+        /// @param slabCapacity number of blocks in each slab the depot allocates
+        SlabCache(size_t blockSize, size_t slabCapacity = 1024) throws(std::bad_alloc);
+        ~SlabCache() noexcept;
+
+        SM_NOCOPY(SlabCache);
+        SM_NOMOVE(SlabCache);
+
+        void *allocate() throws(std::bad_alloc);
+        void deallocate(void *ptr) noexcept;
+
+        /// @brief return the calling threads magazines to the depot.
+        /// threads do this on exit, calling it earlier lets other threads use the blocks
+        void releaseThreadCache() noexcept;
+
+        size_t blockSize() const noexcept { return mBlockSize; }
+        uint64_t getId() const noexcept { return mId; }
+    };
+
+    /// @brief a memory resource serving small allocations from per size class slab caches.
+    ///
+    /// size classes are powers of two from @a kMinClassSize up to the configured maximum,
+    /// larger or over aligned requests are passed to the upstream resource.
+    class SlabMemoryResource final : public std::pmr::memory_resource {
+        std::vector<std::unique_ptr<SlabCache>> mClasses;
+        size_t mMaxBlockSize;
+        std::pmr::memory_resource *mUpstream;
+
+        SlabCache *getClass(size_t bytes, size_t alignment) const noexcept;
+
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    public:
+        static constexpr size_t kMinClassSize = 16;
+
+        /// @param maxBlockSize rounded up to a power of two
+        SlabMemoryResource(size_t maxBlockSize = 4096, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+
+        SM_NOCOPY(SlabMemoryResource);
+        SM_NOMOVE(SlabMemoryResource);
+
+        size_t maxBlockSize() const noexcept { return mMaxBlockSize; }
+        std::pmr::memory_resource *upstream() const noexcept { return mUpstream; }
     };
 }
@@ -16,5 +16,17 @@ namespace sm {
         static CpuId count(int leaf, int subleaf) noexcept;
 
         static bool getBrandString(char dst[kBrandStringSize]) noexcept;
+
+        /// @brief check if avx2 is supported by both the cpu and the os
+        static bool hasAvx2() noexcept;
+
+        /// @brief check if fused multiply add is supported by the cpu
+        static bool hasFma() noexcept;
+
+        /// @brief check if half precision float conversion is supported by the cpu
+        static bool hasF16c() noexcept;
+
+        /// @brief check if avx512f is supported by both the cpu and the os
+        static bool hasAvx512() noexcept;
     };
 }
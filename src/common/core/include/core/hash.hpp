@@ -1,7 +1,11 @@
 #pragma once
 
+#include <functional>
 #include <type_traits> // IWYU pragma: export
 
+#include <stddef.h>
+#include <stdint.h>
+
 namespace sm {
     template<typename T>
     void hash_combine(size_t &seed, const T &value) {
@@ -12,4 +16,44 @@ namespace sm {
     void hash_combine(size_t &seed, const T &... values) {
         (hash_combine(seed, values), ...);
     }
+
+    namespace detail {
+        /// @brief full 64x64 bit multiply
+        /// @return the low 64 bits of the product, the high bits are written to @a hi
+        constexpr uint64_t mul128(uint64_t a, uint64_t b, uint64_t& hi) noexcept {
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 product = (unsigned __int128)a * b;
+            hi = uint64_t(product >> 64);
+            return uint64_t(product);
+#else
+            uint64_t aLo = a & 0xFFFF'FFFF, aHi = a >> 32;
+            uint64_t bLo = b & 0xFFFF'FFFF, bHi = b >> 32;
+
+            uint64_t ll = aLo * bLo;
+            uint64_t lh = aLo * bHi;
+            uint64_t hl = aHi * bLo;
+            uint64_t hh = aHi * bHi;
+
+            uint64_t mid = (ll >> 32) + (lh & 0xFFFF'FFFF) + (hl & 0xFFFF'FFFF);
+            hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+            return (mid << 32) | (ll & 0xFFFF'FFFF);
+#endif
+        }
+
+        /// @brief multiply and fold the halves of the product together
+        constexpr uint64_t mulFold(uint64_t a, uint64_t b) noexcept {
+            uint64_t hi;
+            uint64_t lo = mul128(a, b, hi);
+            return lo ^ hi;
+        }
+    }
+
+    /// @brief hash 128 bits down to 64, for identifiers such as uuids
+    ///
+    /// two rounds of the wyhash multiply and fold, flipping any input bit flips
+    /// each output bit about half the time so the low bits are fine for bucketing.
+    constexpr uint64_t hashMix128(uint64_t lo, uint64_t hi) noexcept {
+        uint64_t first = detail::mulFold(lo ^ 0xA076'1D64'78BD'642Full, hi ^ 0xE703'7ED1'A0B4'28DBull);
+        return detail::mulFold(first ^ 0x8EBC'6AF0'9C88'C6E3ull, first ^ hi ^ 0x5899'65CC'7537'4CC3ull);
+    }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "core/adt/hash_table.hpp"
+
 #include <map>
 #include <unordered_map>
 
@@ -10,8 +12,10 @@ namespace sm {
     template<typename K, typename V>
     using MultiMap = std::multimap<K, V, std::less<K>>;
 
-    template<typename K, typename V, typename H = std::hash<K>, typename EQ = std::equal_to<K>>
-    using HashMap = std::unordered_map<K, V, H, EQ>;
+    /// @brief flat open addressing map.
+    /// inserting may move existing entries, references into the map do not survive growth
+    template<typename K, typename V, typename H = adt::DefaultHash<K>, typename EQ = adt::DefaultEqual<K>>
+    using HashMap = adt::FlatHashMap<K, V, H, EQ>;
 
     template<typename K, typename V, typename H = std::hash<K>, typename EQ = std::equal_to<K>>
     using MultiHashMap = std::unordered_multimap<K, V, H, EQ>;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "base/traits.hpp"
+
+#include <memory>
+
+#include <string.h>
+
+namespace sm {
+    /// @brief move [@a first, @a last) into uninitialized storage at @a dst and destroy the originals
+    ///
+    /// trivially relocatable types are copied with a single memcpy.
+    /// types that may throw when moved are copied instead if they can be,
+    /// the same choice std::move_if_noexcept makes. if a copy throws the
+    /// source range is left untouched.
+    /// the ranges must not overlap.
+    ///
+    /// @return one past the last element constructed at @a dst
+    template<typename T>
+    constexpr T *uninitializedRelocate(T *first, T *last, T *dst)
+        noexcept(IsTriviallyRelocatable<T> || std::is_nothrow_move_constructible_v<T>)
+    {
+        if constexpr (IsTriviallyRelocatable<T>) {
+            if (!std::is_constant_evaluated()) {
+                size_t count = last - first;
+                if (count > 0)
+                    memcpy((void*)dst, (const void*)first, count * sizeof(T));
+
+                return dst + count;
+            }
+        }
+
+        T *result;
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+            result = std::uninitialized_move(first, last, dst);
+        else
+            result = std::uninitialized_copy(first, last, dst);
+
+        std::destroy(first, last);
+        return result;
+    }
+}
@@ -190,6 +190,17 @@ namespace sm {
         return UniquePtr<T, TDelete>(new ElementType[size], size);
     }
 
+    // the handle is only ever read back out, so moving the bytes is as good as a move and reset
+    template<typename T, typename TDelete, T TEmpty>
+    struct is_trivially_relocatable<UniqueHandle<T, TDelete, TEmpty>>
+        : std::bool_constant<IsTriviallyRelocatable<T> && IsTriviallyRelocatable<TDelete>>
+    { };
+
+    template<typename T, typename TDelete>
+    struct is_trivially_relocatable<UniquePtr<T, TDelete>>
+        : is_trivially_relocatable<UniqueHandle<std::remove_extent_t<T>*, TDelete, nullptr>>
+    { };
+
     DBG_STATIC_ASSERT(sizeof(sm::UniquePtr<int>) == sizeof(int*),
         "UniquePtr<T> should be the same size as T* in release"
         "a compiler that supports (and implements) [[no_unique_address]] or [[msvc::no_unique_address]] is required");
@@ -1,16 +1,167 @@
 #pragma once
 
-#include <random>
+#include "core/hash.hpp"
+
+#include <bit>
 #include <span>
 
+#include <stdint.h>
+#include <string.h>
+
 namespace sm {
-    class Random {
-        std::mt19937 mSource;
+    /// @brief fill @a buffer from the operating system's cryptographically secure generator
+    ///
+    /// use this for anything an attacker must not be able to predict, salts, session ids, keys.
+    /// the generators below are fast but their output can be reconstructed from a few samples.
+    /// blocks until the system generator is seeded, panics if it is unavailable.
+    void getSecureRandomBytes(std::span<uint8_t> buffer) noexcept;
+
+    namespace detail {
+        /// @brief splitmix64, expands a single seed into well mixed generator state
+        constexpr uint64_t splitmix64(uint64_t& state) noexcept {
+            uint64_t z = (state += 0x9E37'79B9'7F4A'7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58'476D'1CE4'E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D0'49BB'1331'11EBull;
+            return z ^ (z >> 31);
+        }
+
+        /// @brief everything built on top of a generator that produces 64 random bits at a time
+        /// @tparam Super the generator, provides uint64_t next() noexcept
+        template<typename Super>
+        class RandomEngine {
+            constexpr Super& self() noexcept { return static_cast<Super&>(*this); }
+
+        public:
+            // satisfies std::uniform_random_bit_generator so the std distributions still work
+            using result_type = uint64_t;
+
+            static constexpr uint64_t min() noexcept { return 0; }
+            static constexpr uint64_t max() noexcept { return UINT64_MAX; }
+
+            constexpr uint64_t operator()() noexcept { return self().next(); }
+
+            constexpr uint64_t nextU64() noexcept { return self().next(); }
+
+            /// @brief the upper bits, they are the strongest in every generator here
+            constexpr uint32_t nextU32() noexcept { return uint32_t(self().next() >> 32); }
+
+            void nextU64(std::span<uint64_t> buffer) noexcept {
+                for (uint64_t& word : buffer)
+                    word = self().next();
+            }
+
+            /// @brief fill @a buffer with random bytes, 8 bytes per generator step
+            void nextBytes(std::span<uint8_t> buffer) noexcept {
+                uint8_t *dst = buffer.data();
+                size_t size = buffer.size();
+
+                for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), dst += sizeof(uint64_t)) {
+                    uint64_t word = self().next();
+                    memcpy(dst, &word, sizeof(uint64_t));
+                }
+
+                if (size > 0) {
+                    uint64_t word = self().next();
+                    memcpy(dst, &word, size);
+                }
+            }
+
+            /// @brief a uniformly distributed integer in [@a min, @a max], both inclusive
+            ///
+            /// Lemire's multiply and reject, there is no modulo bias and
+            /// a division is only needed on the rare path where a sample may be rejected.
+            constexpr uint64_t nextInRange(uint64_t min, uint64_t max) noexcept {
+                uint64_t range = max - min + 1;
+                if (range == 0)
+                    return self().next(); // the full 64 bit range
+
+                uint64_t hi;
+                uint64_t lo = mul128(self().next(), range, hi);
+                if (lo < range) {
+                    uint64_t threshold = (0 - range) % range;
+                    while (lo < threshold)
+                        lo = mul128(self().next(), range, hi);
+                }
+
+                return min + hi;
+            }
+
+            /// @brief a uniformly distributed float in [0, 1)
+            constexpr float nextFloat() noexcept {
+                return float(self().next() >> 40) * 0x1.0p-24f;
+            }
+
+            /// @brief a uniformly distributed double in [0, 1)
+            constexpr double nextDouble() noexcept {
+                return double(self().next() >> 11) * 0x1.0p-53;
+            }
+        };
+    }
+
+    /// @brief xoshiro256**, the default generator
+    ///
+    /// 32 bytes of state and a period of 2^256 - 1, fast and passes BigCrush.
+    /// not suitable for anything security sensitive, see getSecureRandomBytes.
+    class Random : public detail::RandomEngine<Random> {
+        uint64_t mState[4];
+
+    public:
+        /// @brief seeded from the secure generator
+        Random() noexcept;
+
+        /// @brief the same seed produces the same sequence on every platform
+        constexpr Random(uint64_t seed) noexcept {
+            // splitmix64 never produces four zero words in a row, so the state is never all zero
+            for (uint64_t& word : mState)
+                word = detail::splitmix64(seed);
+        }
+
+        constexpr uint64_t next() noexcept {
+            uint64_t result = std::rotl(mState[1] * 5, 7) * 9;
+            uint64_t t = mState[1] << 17;
+
+            mState[2] ^= mState[0];
+            mState[3] ^= mState[1];
+            mState[1] ^= mState[2];
+            mState[0] ^= mState[3];
+
+            mState[2] ^= t;
+            mState[3] = std::rotl(mState[3], 45);
+
+            return result;
+        }
+
+        /// @brief advance the state by 2^128 steps
+        /// calling this once per worker on copies of one generator gives non overlapping streams
+        void jump() noexcept;
+
+        /// @brief the generator for the calling thread, seeded from the secure generator on first use
+        /// @note the lookup costs about as much as a step, keep the reference outside of hot loops
+        static Random& getThreadLocal() noexcept;
+    };
+
+    /// @brief wyrand, 8 bytes of state and the fastest step here
+    ///
+    /// a period of 2^64, prefer it where many generators are kept around, one per entity or per job.
+    /// not suitable for anything security sensitive, see getSecureRandomBytes.
+    class WyRand : public detail::RandomEngine<WyRand> {
+        uint64_t mState;
 
     public:
-        Random();
-        Random(unsigned seed);
+        /// @brief seeded from the secure generator
+        WyRand() noexcept;
+
+        /// @brief the same seed produces the same sequence on every platform
+        constexpr WyRand(uint64_t seed) noexcept
+            : mState(seed)
+        { }
+
+        constexpr uint64_t next() noexcept {
+            mState += 0xA076'1D64'78BD'642Full;
+            return detail::mulFold(mState, mState ^ 0xE703'7ED1'A0B4'28DBull);
+        }
 
-        void nextBytes(std::span<uint8_t> buffer) noexcept;
+        /// @brief the generator for the calling thread, seeded from the secure generator on first use
+        static WyRand& getThreadLocal() noexcept;
     };
 }
@@ -1,8 +1,15 @@
 #pragma once
 
+#include "core/adt/hash_table.hpp"
+
 #include <set>
 
 namespace sm {
     template<typename T>
     using Set = std::set<T, std::less<T>>;
+
+    /// @brief flat open addressing set.
+    /// inserting may move existing values, references into the set do not survive growth
+    template<typename T, typename H = adt::DefaultHash<T>, typename EQ = adt::DefaultEqual<T>>
+    using HashSet = adt::FlatHashSet<T, H, EQ>;
 }
@@ -2,8 +2,11 @@
 
 #include "core/adt/array.hpp"
 #include "core/error.hpp"
+#include "core/units.hpp"
 
 #include <atomic>
+#include <bit>
+#include <memory>
 #include <stdint.h>
 
 namespace sm {
@@ -21,7 +24,7 @@ namespace sm {
                 : mStorage(count, TEmpty)
             { }
 
-            constexpr size_t length() const noexcept { return mStorage.length(); }
+            constexpr size_t length() const noexcept { return mStorage.size(); }
 
             constexpr const T& operator[](size_t index) const noexcept { verifyIndex(index); return mStorage[index]; }
             constexpr T& operator[](size_t index) noexcept { verifyIndex(index); return mStorage[index]; }
@@ -58,6 +61,8 @@ namespace sm {
                 return length() - popcount();
             }
 
+            /// @note this scans for an empty slot, prefer @a GenerationalSlotMap when
+            /// allocation is frequent or the map runs close to full
             constexpr Index alloc(size_t limit, T value) noexcept {
                 Super *super = static_cast<Super*>(this);
                 for (size_t i = 0; i < limit; i++) {
@@ -125,4 +130,239 @@ namespace sm {
             return value;
         }
     };
+
+    /// @brief a fixed capacity slot map with lock free allocation and release.
+    /// free slots are kept on a lock free stack, so allocation is O(1) regardless
+    /// of occupancy. each slot carries a generation that is bumped on every alloc and
+    /// release, handles that outlive their slot are rejected rather than aliasing the
+    /// slots next occupant. live entries are tracked in a bitmap for iteration.
+    /// @note handles only detect stale use, reading a value while another thread releases
+    /// it must still be synchronized by the caller.
+    template<typename T>
+    class GenerationalSlotMap {
+    public:
+        struct Handle {
+            uint32_t index = UINT32_MAX;
+            uint32_t generation = 0;
+
+            constexpr bool isValid() const noexcept { return index != UINT32_MAX; }
+            constexpr bool operator==(const Handle&) const noexcept = default;
+        };
+
+    private:
+        static constexpr uint32_t kNil = UINT32_MAX;
+        static constexpr size_t kBitsPerWord = 64;
+
+        // keep the free list head away from the slot metadata it points into
+        static constexpr size_t kCacheLineSize = 64;
+
+        // an even generation is free, an odd generation is live
+        struct Slot {
+            std::atomic<uint32_t> generation;
+            std::atomic<uint32_t> next;
+        };
+
+        struct Storage {
+            alignas(T) std::byte data[sizeof(T)];
+        };
+
+        // the free list head is an index tagged with a counter that changes on every
+        // push and pop, so a stale head can never be swapped in after an ABA reuse
+        alignas(kCacheLineSize) std::atomic<uint64_t> mFreeHead;
+
+        alignas(kCacheLineSize) uint32_t mCapacity;
+        sm::UniquePtr<Slot[]> mSlots;
+        sm::UniquePtr<Storage[]> mStorage;
+        sm::UniquePtr<std::atomic<uint64_t>[]> mLive;
+
+        static constexpr uint64_t pack(uint32_t tag, uint32_t index) noexcept {
+            return (uint64_t(tag) << 32) | index;
+        }
+
+        static constexpr uint32_t indexOf(uint64_t head) noexcept { return uint32_t(head); }
+        static constexpr uint32_t tagOf(uint64_t head) noexcept { return uint32_t(head >> 32); }
+
+        constexpr size_t wordCount() const noexcept {
+            return (mCapacity + kBitsPerWord - 1) / kBitsPerWord;
+        }
+
+        T *valueAt(size_t index) const noexcept {
+            return std::launder(reinterpret_cast<T*>(mStorage[index].data));
+        }
+
+        uint32_t pop() noexcept {
+            uint64_t head = mFreeHead.load(std::memory_order_acquire);
+            while (indexOf(head) != kNil) {
+                // may read a link that is being rewritten, the tag makes the exchange fail if so
+                uint32_t next = mSlots[indexOf(head)].next.load(std::memory_order_relaxed);
+                if (mFreeHead.compare_exchange_weak(head, pack(tagOf(head) + 1, next), std::memory_order_acquire, std::memory_order_acquire))
+                    return indexOf(head);
+            }
+
+            return kNil;
+        }
+
+        void push(uint32_t index) noexcept {
+            uint64_t head = mFreeHead.load(std::memory_order_relaxed);
+            do {
+                mSlots[index].next.store(indexOf(head), std::memory_order_relaxed);
+            } while (!mFreeHead.compare_exchange_weak(head, pack(tagOf(head) + 1, index), std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        size_t nextLive(size_t index) const noexcept {
+            size_t word = index / kBitsPerWord;
+            if (word >= wordCount())
+                return mCapacity;
+
+            uint64_t bits = mLive[word].load(std::memory_order_acquire) & (~uint64_t(0) << (index % kBitsPerWord));
+            while (bits == 0) {
+                if (++word >= wordCount())
+                    return mCapacity;
+
+                bits = mLive[word].load(std::memory_order_acquire);
+            }
+
+            return word * kBitsPerWord + std::countr_zero(bits);
+        }
+
+        template<bool IsConst>
+        class Iterator {
+            using Map = std::conditional_t<IsConst, const GenerationalSlotMap, GenerationalSlotMap>;
+            using Value = std::conditional_t<IsConst, const T, T>;
+
+            Map *mMap;
+            size_t mIndex;
+
+        public:
+            constexpr Iterator(Map *map, size_t index) noexcept
+                : mMap(map)
+                , mIndex(index)
+            { }
+
+            Value& operator*() const noexcept { return *mMap->valueAt(mIndex); }
+            Value *operator->() const noexcept { return mMap->valueAt(mIndex); }
+
+            /// @brief the handle of the entry this iterator points at
+            Handle handle() const noexcept {
+                return Handle { uint32_t(mIndex), mMap->mSlots[mIndex].generation.load(std::memory_order_acquire) };
+            }
+
+            Iterator& operator++() noexcept {
+                mIndex = mMap->nextLive(mIndex + 1);
+                return *this;
+            }
+
+            constexpr bool operator==(const Iterator& other) const noexcept { return mIndex == other.mIndex; }
+        };
+
+    public:
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        GenerationalSlotMap(size_t capacity) noexcept
+            : mCapacity(uint32_t(capacity))
+            , mSlots(sm::makeUnique<Slot[]>(capacity))
+            , mStorage(sm::makeUnique<Storage[]>(capacity))
+            , mLive(sm::makeUnique<std::atomic<uint64_t>[]>(wordCount()))
+        {
+            CTASSERTF(capacity > 0 && capacity < kNil, "slot map capacity %zu out of range", capacity);
+
+            for (uint32_t i = 0; i < mCapacity; i++) {
+                mSlots[i].generation.store(0, std::memory_order_relaxed);
+                mSlots[i].next.store(i + 1 < mCapacity ? i + 1 : kNil, std::memory_order_relaxed);
+            }
+
+            for (size_t i = 0; i < wordCount(); i++)
+                mLive[i].store(0, std::memory_order_relaxed);
+
+            mFreeHead.store(pack(0, 0), std::memory_order_release);
+        }
+
+        ~GenerationalSlotMap() noexcept {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (T& value : *this)
+                    value.~T();
+            }
+        }
+
+        SM_NOCOPY(GenerationalSlotMap);
+        SM_NOMOVE(GenerationalSlotMap);
+
+        /// @brief construct a value in a free slot
+        /// @return the handle of the new entry, or an invalid handle if the map is full
+        template<typename... A>
+        Handle alloc(A&&... args) noexcept(std::is_nothrow_constructible_v<T, A...>) {
+            uint32_t index = pop();
+            if (index == kNil)
+                return Handle { };
+
+            try {
+                std::construct_at(valueAt(index), std::forward<A>(args)...);
+            } catch (...) {
+                push(index);
+                throw;
+            }
+
+            Slot& slot = mSlots[index];
+            uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+            slot.generation.store(generation, std::memory_order_release);
+            mLive[index / kBitsPerWord].fetch_or(uint64_t(1) << (index % kBitsPerWord), std::memory_order_release);
+
+            return Handle { index, generation };
+        }
+
+        /// @brief destroy an entry and return its slot to the free list
+        /// @return false if the handle is stale or was already released
+        bool release(Handle handle) noexcept {
+            if (!contains(handle))
+                return false;
+
+            // only one releaser can win this exchange, which also retires every copy of the handle
+            uint32_t expected = handle.generation;
+            if (!mSlots[handle.index].generation.compare_exchange_strong(expected, expected + 1, std::memory_order_acq_rel))
+                return false;
+
+            mLive[handle.index / kBitsPerWord].fetch_and(~(uint64_t(1) << (handle.index % kBitsPerWord)), std::memory_order_relaxed);
+            std::destroy_at(valueAt(handle.index));
+            push(handle.index);
+            return true;
+        }
+
+        /// @brief test if a handle still refers to a live entry
+        bool contains(Handle handle) const noexcept {
+            if (handle.index >= mCapacity || (handle.generation & 1) == 0)
+                return false;
+
+            return mSlots[handle.index].generation.load(std::memory_order_acquire) == handle.generation;
+        }
+
+        /// @return the value for a handle, or nullptr if the handle is stale
+        T *get(Handle handle) noexcept {
+            return contains(handle) ? valueAt(handle.index) : nullptr;
+        }
+
+        const T *get(Handle handle) const noexcept {
+            return contains(handle) ? valueAt(handle.index) : nullptr;
+        }
+
+        size_t capacity() const noexcept { return mCapacity; }
+
+        /// @brief count the live entries
+        /// @note this is a snapshot and may be stale by the time it returns
+        size_t size() const noexcept {
+            size_t count = 0;
+            for (size_t i = 0; i < wordCount(); i++)
+                count += std::popcount(mLive[i].load(std::memory_order_relaxed));
+
+            return count;
+        }
+
+        /// @note iteration skips free slots a word at a time, it is safe alongside
+        /// concurrent alloc but not alongside release of the entries being visited
+        iterator begin() noexcept { return iterator(this, nextLive(0)); }
+        iterator end() noexcept { return iterator(this, mCapacity); }
+
+        const_iterator begin() const noexcept { return const_iterator(this, nextLive(0)); }
+        const_iterator end() const noexcept { return const_iterator(this, mCapacity); }
+    };
 }
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdlib.h>
 
 namespace sm::utf8 {
-    // utf8 codepoint iterator, doesnt handle invalid utf8, surrogates, etc
+    // utf8 codepoint iterator, expects valid utf8. invalid lead bytes
+    // are stepped over one byte at a time rather than decoded
     class TextIterator {
         const char8_t *mText;
         size_t mOffset;
@@ -24,10 +26,30 @@ namespace sm::utf8 {
         char32_t operator*() const;
     };
 
-    /// validate a utf8 string
+    /// validate a utf8 string.
+    /// rejects overlong encodings, surrogates, codepoints past U+10FFFF
+    /// and sequences cut off by the end of the text
     /// @return the offset of the first invalid codepoint, or SIZE_MAX if valid
     size_t validate(const char8_t *text, size_t length);
 
+    /// count the codepoints in valid utf8 text
+    size_t countCodepoints(const char8_t *text, size_t length) noexcept;
+
+    /// the transcoding functions replace invalid sequences with U+FFFD
+    /// and return the number of code units written to @p dst
+
+    /// @param dst must have space for @p length units
+    size_t toUtf16(const char8_t *text, size_t length, char16_t *dst) noexcept;
+
+    /// @param dst must have space for @p length units
+    size_t toUtf32(const char8_t *text, size_t length, char32_t *dst) noexcept;
+
+    /// @param dst must have space for 3 * @p length bytes
+    size_t fromUtf16(const char16_t *text, size_t length, char8_t *dst) noexcept;
+
+    /// @param dst must have space for 4 * @p length bytes
+    size_t fromUtf32(const char32_t *text, size_t length, char8_t *dst) noexcept;
+
     // static utf8 string
     class StaticText {
         const char8_t *mText;
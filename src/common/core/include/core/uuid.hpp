@@ -2,6 +2,9 @@
 
 #include "core/digit.hpp"
 #include "core/endian.hpp"
+#include "core/hash.hpp"
+
+#include "core/adt/small_string.hpp"
 
 #include <stdint.h>
 #include <string.h>
@@ -260,9 +263,12 @@ namespace sm {
         /// @brief Convert the uuid to a string
         /// Converts the uuid to a string in the format 8-4-4-4-12
         /// @param dst the buffer to write the string to
-        /// @note The buffer must be at least kStringSize + 1 bytes long
+        /// @note Writes exactly kStringSize characters, no nul terminator is written
         static void strfuid(char dst[kStringSize], uuid uuid) noexcept;
 
+        /// @brief Convert the uuid to a string in the format 8-4-4-4-12 without allocating
+        SmallString<kStringSize> toString() const noexcept;
+
         /// @brief parse a uuid from a string
         /// Only supports 8-4-4-4-12 hex format with hyphens, use @a parseMicrosoft for microsoft format
         /// or @a parseHex for raw hex format. On success the result will be written to @a result.
@@ -308,11 +314,8 @@ namespace sm {
 template<>
 struct std::hash<sm::uuid> {
     size_t operator()(const sm::uuid& guid) const noexcept {
-        size_t hash = 0;
-        for (uint8_t byte : guid.octets) {
-            hash = hash * 31 + byte;
-        }
-
-        return hash;
+        uint64_t words[2];
+        memcpy(words, guid.octets, sizeof(words));
+        return size_t(sm::hashMix128(words[0], words[1]));
     }
 };
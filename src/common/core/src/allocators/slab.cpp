@@ -2,7 +2,15 @@
 
 #include "core/allocators/slab.hpp"
 
+#include "base/panic.h"
+
+#include <unordered_set>
+
+using namespace sm;
+
 using SlabAllocator = sm::SlabAllocator;
+using SlabCache = sm::SlabCache;
+using SlabMemoryResource = sm::SlabMemoryResource;
 
 static void *slabMalloc(size_t size) {
     void *ptr = std::malloc(size);
@@ -12,19 +20,337 @@ static void *slabMalloc(size_t size) {
     return ptr;
 }
 
+static constexpr size_t roundUp(size_t value, size_t multiple) noexcept {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+///
+/// slab allocator
+///
+
+SlabAllocator::SlabAllocator(void *memory, size_t capacity, size_t blockSize, bool owned) noexcept
+    : mMemory(memory)
+    , mCapacity(capacity)
+    , mBlockSize(blockSize)
+    , mOwnsMemory(owned)
+{
+    CTASSERTF(blockSize >= kMinBlockSize && blockSize % alignof(FreeBlock) == 0, "block size %zu must be a multiple of %zu", blockSize, kMinBlockSize);
+    CTASSERTF(reinterpret_cast<uintptr_t>(memory) % alignof(FreeBlock) == 0, "slab memory %p is misaligned", memory);
+}
+
 SlabAllocator::SlabAllocator(size_t capacity, size_t blockSize)
-    : This(slabMalloc(capacity * blockSize), capacity, blockSize)
+    : This(slabMalloc(capacity * blockSize), capacity, blockSize, true)
 { }
 
 SlabAllocator::~SlabAllocator() noexcept {
-    std::free(mMemory);
+    if (mOwnsMemory)
+        std::free(mMemory);
 }
 
-
 void *SlabAllocator::allocate() noexcept {
+    if (FreeBlock *block = mFreeList) {
+        mFreeList = block->next;
+        mUsed += 1;
+        return block;
+    }
+
+    // nothing freed yet, carve the next untouched block
+    if (mWatermark < mCapacity) {
+        void *block = static_cast<char*>(mMemory) + (mWatermark * mBlockSize);
+        mWatermark += 1;
+        mUsed += 1;
+        return block;
+    }
+
     return nullptr;
 }
 
 void SlabAllocator::deallocate(void *ptr) noexcept {
+    if (ptr == nullptr)
+        return;
+
+    CTASSERTF(contains(ptr), "pointer %p was not allocated by this slab", ptr);
+    CTASSERTF((static_cast<char*>(ptr) - static_cast<char*>(mMemory)) % mBlockSize == 0, "pointer %p is not the start of a block", ptr);
+
+    FreeBlock *block = static_cast<FreeBlock*>(ptr);
+    block->next = mFreeList;
+    mFreeList = block;
+    mUsed -= 1;
+}
+
+bool SlabAllocator::contains(const void *ptr) const noexcept {
+    const char *begin = static_cast<const char*>(mMemory);
+    const char *it = static_cast<const char*>(ptr);
+    return it >= begin && it < begin + totalSize();
+}
+
+///
+/// thread cache registry
+///
+
+namespace {
+    struct CacheEntry {
+        uint64_t id;
+        SlabCache *owner;
+        SlabCache::ThreadCache *cache;
+    };
+
+    // ids are never reused, so a thread holding an entry for a destroyed
+    // cache can tell it is stale even if another cache reuses the address
+    std::atomic<uint64_t> gNextCacheId = 1;
+
+    std::mutex& getRegistryMutex() noexcept {
+        static std::mutex sMutex;
+        return sMutex;
+    }
+
+    std::unordered_set<uint64_t>& getLiveCaches() noexcept {
+        static std::unordered_set<uint64_t> sCaches;
+        return sCaches;
+    }
+}
+
+struct sm::detail::SlabThreadCaches {
+    std::vector<CacheEntry> entries;
+
+    void removeStale() noexcept {
+        std::lock_guard guard(getRegistryMutex());
+        const auto& live = getLiveCaches();
+        std::erase_if(entries, [&](const CacheEntry& entry) { return !live.contains(entry.id); });
+    }
+
+    ~SlabThreadCaches() noexcept {
+        std::lock_guard guard(getRegistryMutex());
+        const auto& live = getLiveCaches();
+        for (const CacheEntry& entry : entries) {
+            if (live.contains(entry.id))
+                entry.owner->releaseCache(entry.cache);
+        }
+    }
+};
+
+// the last cache used on this thread, checked before searching every entry
+static thread_local CacheEntry tlsLastCache = { 0, nullptr, nullptr };
+static thread_local sm::detail::SlabThreadCaches tlsCaches;
+
+///
+/// slab cache
+///
+
+SlabCache::SlabCache(size_t blockSize, size_t slabCapacity)
+    : mId(gNextCacheId.fetch_add(1))
+    , mBlockSize(roundUp(std::max(blockSize, SlabAllocator::kMinBlockSize), SlabAllocator::kMinBlockSize))
+    , mSlabCapacity(std::max(slabCapacity, kMagazineSize))
+{
+    std::lock_guard guard(getRegistryMutex());
+    getLiveCaches().insert(mId);
+}
+
+SlabCache::~SlabCache() noexcept {
+    std::lock_guard guard(getRegistryMutex());
+    getLiveCaches().erase(mId);
+}
+
+SlabCache::ThreadCache& SlabCache::getThreadCache() noexcept(false) {
+    if (tlsLastCache.id == mId)
+        return *tlsLastCache.cache;
+
+    for (const CacheEntry& entry : tlsCaches.entries) {
+        if (entry.id == mId) {
+            tlsLastCache = entry;
+            return *entry.cache;
+        }
+    }
+
+    return createThreadCache();
+}
+
+SlabCache::ThreadCache& SlabCache::createThreadCache() noexcept(false) {
+    ThreadCache *cache = nullptr;
+
+    {
+        std::lock_guard guard(mDepotMutex);
+        auto owned = std::make_unique<ThreadCache>(ThreadCache { newMagazine(), newMagazine() });
+        cache = owned.get();
+        mCaches.push_back(std::move(owned));
+    }
+
+    // threads that outlive many caches would otherwise collect dead entries
+    tlsCaches.removeStale();
+
+    CacheEntry entry = { mId, this, cache };
+    tlsCaches.entries.push_back(entry);
+    tlsLastCache = entry;
+
+    return *cache;
+}
+
+SlabCache::Magazine *SlabCache::newMagazine() noexcept(false) {
+    if (!mEmpty.empty()) {
+        Magazine *magazine = mEmpty.back();
+        mEmpty.pop_back();
+        return magazine;
+    }
+
+    return mMagazines.emplace_back(std::make_unique<Magazine>()).get();
+}
+
+void SlabCache::fillMagazine(Magazine *magazine) noexcept(false) {
+    while (magazine->count < kMagazineSize && mOverflow != nullptr) {
+        void *block = mOverflow;
+        mOverflow = *static_cast<void**>(block);
+        magazine->blocks[magazine->count++] = block;
+    }
+
+    while (magazine->count < kMagazineSize) {
+        void *block = mSlabs.empty() ? nullptr : mSlabs.back()->allocate();
+        if (block == nullptr) {
+            mSlabs.emplace_back(std::make_unique<SlabAllocator>(mSlabCapacity, mBlockSize));
+            continue;
+        }
+
+        magazine->blocks[magazine->count++] = block;
+    }
+}
+
+void *SlabCache::refill(ThreadCache& cache) noexcept(false) {
+    if (cache.previous->count == 0) {
+        std::lock_guard guard(mDepotMutex);
+        if (mStocked.empty()) {
+            fillMagazine(cache.loaded);
+        } else {
+            // both magazines are empty, swap one for a stocked magazine
+            mEmpty.push_back(cache.previous);
+            cache.previous = cache.loaded;
+            cache.loaded = mStocked.back();
+            mStocked.pop_back();
+        }
+    } else {
+        std::swap(cache.loaded, cache.previous);
+    }
+
+    Magazine *loaded = cache.loaded;
+    return loaded->blocks[--loaded->count];
+}
+
+void SlabCache::spill(ThreadCache& cache, void *ptr) noexcept(false) {
+    if (cache.previous->count == kMagazineSize) {
+        // both magazines are full, hand one to the depot for other threads
+        std::lock_guard guard(mDepotMutex);
+        Magazine *empty = newMagazine();
+        mStocked.push_back(cache.previous);
+        cache.previous = cache.loaded;
+        cache.loaded = empty;
+    } else {
+        std::swap(cache.loaded, cache.previous);
+    }
+
+    Magazine *loaded = cache.loaded;
+    loaded->blocks[loaded->count++] = ptr;
+}
+
+void SlabCache::releaseCache(ThreadCache *cache) noexcept {
+    std::lock_guard guard(mDepotMutex);
+    for (Magazine *magazine : { cache->loaded, cache->previous }) {
+        if (magazine->count > 0) {
+            mStocked.push_back(magazine);
+        } else {
+            mEmpty.push_back(magazine);
+        }
+    }
+
+    std::erase_if(mCaches, [&](const auto& it) { return it.get() == cache; });
+}
+
+void *SlabCache::allocate() noexcept(false) {
+    ThreadCache& cache = getThreadCache();
+
+    Magazine *loaded = cache.loaded;
+    if (loaded->count > 0)
+        return loaded->blocks[--loaded->count];
+
+    return refill(cache);
+}
+
+void SlabCache::deallocate(void *ptr) noexcept {
+    if (ptr == nullptr)
+        return;
+
+    try {
+        ThreadCache& cache = getThreadCache();
+
+        Magazine *loaded = cache.loaded;
+        if (loaded->count < kMagazineSize) {
+            loaded->blocks[loaded->count++] = ptr;
+            return;
+        }
+
+        spill(cache, ptr);
+    } catch (const std::bad_alloc&) {
+        // no memory for a cache or magazine, keep the block in the depot
+        std::lock_guard guard(mDepotMutex);
+        *static_cast<void**>(ptr) = mOverflow;
+        mOverflow = ptr;
+    }
+}
+
+void SlabCache::releaseThreadCache() noexcept {
+    auto it = std::find_if(tlsCaches.entries.begin(), tlsCaches.entries.end(), [&](const CacheEntry& entry) {
+        return entry.id == mId;
+    });
+
+    if (it == tlsCaches.entries.end())
+        return;
+
+    releaseCache(it->cache);
+    tlsCaches.entries.erase(it);
+
+    if (tlsLastCache.id == mId)
+        tlsLastCache = { 0, nullptr, nullptr };
+}
+
+///
+/// slab memory resource
+///
+
+// each size class allocates slabs of roughly this size
+static constexpr size_t kSlabBytes = 0x10000;
+
+SlabMemoryResource::SlabMemoryResource(size_t maxBlockSize, std::pmr::memory_resource *upstream)
+    : mMaxBlockSize(std::bit_ceil(std::max(maxBlockSize, kMinClassSize)))
+    , mUpstream(upstream)
+{
+    for (size_t size = kMinClassSize; size <= mMaxBlockSize; size *= 2) {
+        mClasses.emplace_back(std::make_unique<SlabCache>(size, kSlabBytes / size));
+    }
+}
+
+SlabCache *SlabMemoryResource::getClass(size_t bytes, size_t alignment) const noexcept {
+    // slabs come from malloc, blocks are only aligned to max_align_t
+    if (bytes > mMaxBlockSize || alignment > alignof(std::max_align_t))
+        return nullptr;
+
+    size_t size = std::max(bytes, kMinClassSize);
+    size_t index = std::bit_width(size - 1) - std::countr_zero(kMinClassSize);
+    return mClasses[index].get();
+}
+
+void *SlabMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    if (SlabCache *cache = getClass(bytes, alignment))
+        return cache->allocate();
+
+    return mUpstream->allocate(bytes, alignment);
+}
+
+void SlabMemoryResource::do_deallocate(void *ptr, size_t bytes, size_t alignment) {
+    if (SlabCache *cache = getClass(bytes, alignment)) {
+        cache->deallocate(ptr);
+        return;
+    }
+
+    mUpstream->deallocate(ptr, bytes, alignment);
+}
 
+bool SlabMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
 }
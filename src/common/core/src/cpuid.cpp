@@ -32,3 +32,45 @@ bool CpuId::getBrandString(char dst[kBrandStringSize]) noexcept {
 
     return true;
 }
+
+// the os has to save the ymm registers on context switches for avx to be usable
+static uint64_t readXcr0() noexcept {
+    uint32_t eax, edx;
+    __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t(edx) << 32) | eax;
+}
+
+bool CpuId::hasAvx2() noexcept {
+    if (CpuId::of(0).eax < 7)
+        return false;
+
+    CpuId features = CpuId::of(1);
+    bool osxsave = features.ecx & (1 << 27);
+    bool avx = features.ecx & (1 << 28);
+    if (!osxsave || !avx)
+        return false;
+
+    if ((readXcr0() & 0x6) != 0x6)
+        return false;
+
+    return CpuId::count(7, 0).ebx & (1 << 5);
+}
+
+bool CpuId::hasFma() noexcept {
+    return CpuId::of(1).ecx & (1 << 12);
+}
+
+bool CpuId::hasF16c() noexcept {
+    return CpuId::of(1).ecx & (1 << 29);
+}
+
+bool CpuId::hasAvx512() noexcept {
+    if (!hasAvx2())
+        return false;
+
+    // the opmask and both halves of the zmm registers also need saving
+    if ((readXcr0() & 0xE6) != 0xE6)
+        return false;
+
+    return CpuId::count(7, 0).ebx & (1 << 16);
+}
@@ -0,0 +1,26 @@
+#include "stdafx.hpp"
+
+#include "core/random.hpp"
+
+#include "base/panic.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/random.h>
+
+void sm::getSecureRandomBytes(std::span<uint8_t> buffer) noexcept {
+    uint8_t *dst = buffer.data();
+    size_t size = buffer.size();
+
+    // large requests may be split up, and a signal may interrupt the wait for the pool to be seeded
+    while (size > 0) {
+        ssize_t result = getrandom(dst, size, 0);
+        if (result < 0) {
+            CTASSERTF(errno == EINTR, "getrandom failed: %s", strerror(errno));
+            continue;
+        }
+
+        dst += result;
+        size -= size_t(result);
+    }
+}
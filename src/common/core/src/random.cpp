@@ -2,17 +2,53 @@
 
 using namespace sm;
 
-Random::Random()
-    : Random(std::random_device{}())
-{ }
+template<typename T>
+static T getSecureValue() noexcept {
+    T value;
+    getSecureRandomBytes({ reinterpret_cast<uint8_t*>(&value), sizeof(T) });
+    return value;
+}
 
-Random::Random(unsigned seed)
-    : mSource(seed)
+// xoshiro256**
+
+Random::Random() noexcept
+    : Random(getSecureValue<uint64_t>())
 { }
 
-void Random::nextBytes(std::span<uint8_t> buffer) noexcept {
-    std::uniform_int_distribution<short> dist(0, std::numeric_limits<uint8_t>::max());
-    for (uint8_t& byte : buffer) {
-        byte = dist(mSource) & UCHAR_MAX;
+void Random::jump() noexcept {
+    static constexpr uint64_t kJump[] = {
+        0x180E'C6D3'3CFD'0ABAull, 0xD5A6'1266'F0C9'392Cull,
+        0xA958'2618'E03F'C9AAull, 0x39AB'DC45'29B1'661Cull,
+    };
+
+    uint64_t state[4] = { 0, 0, 0, 0 };
+    for (uint64_t word : kJump) {
+        for (int bit = 0; bit < 64; bit++) {
+            if (word & (1ull << bit)) {
+                for (int i = 0; i < 4; i++)
+                    state[i] ^= mState[i];
+            }
+
+            next();
+        }
     }
+
+    for (int i = 0; i < 4; i++)
+        mState[i] = state[i];
+}
+
+Random& Random::getThreadLocal() noexcept {
+    static thread_local Random tRandom;
+    return tRandom;
+}
+
+// wyrand
+
+WyRand::WyRand() noexcept
+    : WyRand(getSecureValue<uint64_t>())
+{ }
+
+WyRand& WyRand::getThreadLocal() noexcept {
+    static thread_local WyRand tRandom;
+    return tRandom;
 }
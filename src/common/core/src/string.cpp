@@ -3,9 +3,9 @@
 
 #include "core/string.hpp"
 
-#include "base/panic.h"
+#include "core/utf8.hpp"
 
-#include <filesystem>
+#include "base/panic.h"
 
 using namespace sm;
 
@@ -37,21 +37,47 @@ std::string sm::vformat(const char *fmt, va_list args) {
     return result;
 }
 
+// wchar_t is utf16 on windows and utf32 everywhere else
+using WideUnit = std::conditional_t<sizeof(wchar_t) == 2, char16_t, char32_t>;
+
+static constexpr size_t kMaxNarrowUnits = (sizeof(wchar_t) == 2) ? 3 : 4;
+
+// templates so that only the transcoder for this platform's wchar_t is instantiated
+
+template<typename T>
+static size_t toWide(const char8_t *text, size_t length, T *dst) noexcept {
+    if constexpr (sizeof(T) == 2) {
+        return utf8::toUtf16(text, length, dst);
+    } else {
+        return utf8::toUtf32(text, length, dst);
+    }
+}
+
 template<typename T>
-constexpr std::basic_string<T> convertString(const std::filesystem::path& path) {
-    if constexpr (std::is_same_v<T, char>) {
-        return path.string();
-    } else if constexpr (std::is_same_v<T, wchar_t>) {
-        return path.wstring();
+static size_t fromWide(const T *text, size_t length, char8_t *dst) noexcept {
+    if constexpr (sizeof(T) == 2) {
+        return utf8::fromUtf16(text, length, dst);
+    } else {
+        return utf8::fromUtf32(text, length, dst);
     }
 }
 
 std::string sm::narrow(std::wstring_view wstr) {
-    return convertString<char>(wstr);
+    std::string result;
+    result.resize_and_overwrite(wstr.size() * kMaxNarrowUnits, [&](char *data, size_t) {
+        return fromWide(reinterpret_cast<const WideUnit*>(wstr.data()), wstr.size(), reinterpret_cast<char8_t*>(data));
+    });
+
+    return result;
 }
 
 std::wstring sm::widen(std::string_view str) {
-    return convertString<wchar_t>(str);
+    std::wstring result;
+    result.resize_and_overwrite(str.size(), [&](wchar_t *data, size_t) {
+        return toWide(reinterpret_cast<const char8_t*>(str.data()), str.size(), reinterpret_cast<WideUnit*>(data));
+    });
+
+    return result;
 }
 
 std::string sm::trimIndent(StringView str) {
@@ -1,13 +1,35 @@
 #include "stdafx.hpp"
 
 #include "core/utf8.hpp"
+#include "core/cpuid.hpp"
 #include "base/panic.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+
 #include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define SM_UTF8_X86 1
+#   include <immintrin.h>
+#else
+#   define SM_UTF8_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define SM_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#else
+#   define SM_TARGET_AVX2
+#endif
 
 using namespace sm;
 using namespace sm::utf8;
 
+static constexpr char32_t kReplacement = 0xFFFD;
+
 /// get the length of a utf8 string in bytes
 static constexpr size_t utf8_size_bytes(const char8_t *text) {
     size_t length = 0;
@@ -17,41 +39,572 @@ static constexpr size_t utf8_size_bytes(const char8_t *text) {
     return length;
 }
 
-/// get the length of a single codepoint in bytes
-static constexpr size_t utf8_codepoint_length(const char8_t *text) {
-    if ((text[0] & 0x80) == 0) {
+/// expected sequence length for each lead byte, 0 for bytes that cannot start a sequence.
+/// C0 and C1 can only start overlong sequences, F5 and above are past U+10FFFF
+static constexpr auto kLeadLength = [] {
+    std::array<uint8_t, 256> table{};
+    for (int i = 0x00; i <= 0x7F; i++) table[i] = 1;
+    for (int i = 0xC2; i <= 0xDF; i++) table[i] = 2;
+    for (int i = 0xE0; i <= 0xEF; i++) table[i] = 3;
+    for (int i = 0xF0; i <= 0xF4; i++) table[i] = 4;
+    return table;
+}();
+
+static constexpr bool isContinuation(char8_t byte) {
+    return (byte & 0xC0) == 0x80;
+}
+
+/// decode one well formed codepoint
+/// @return the length of the sequence, or the negated length of the
+///         invalid prefix that should be replaced as a single unit
+static int decodeScalar(const char8_t *text, size_t remaining, char32_t& codepoint) {
+    char8_t lead = text[0];
+    int length = kLeadLength[lead];
+    if (length == 1) {
+        codepoint = lead;
+        return 1;
+    }
+
+    if (length == 0 || remaining < 2)
+        return -1;
+
+    // the second byte has a narrower range after some leads, this is what
+    // rules out overlong forms, surrogates, and values past U+10FFFF
+    char8_t lo = 0x80;
+    char8_t hi = 0xBF;
+    switch (lead) {
+    case 0xE0: lo = 0xA0; break;
+    case 0xED: hi = 0x9F; break;
+    case 0xF0: lo = 0x90; break;
+    case 0xF4: hi = 0x8F; break;
+    default: break;
+    }
+
+    if (text[1] < lo || text[1] > hi)
+        return -1;
+
+    char32_t result = ((lead & (0x7F >> length)) << 6) | (text[1] & 0x3F);
+    for (int i = 2; i < length; i++) {
+        if (size_t(i) >= remaining || !isContinuation(text[i]))
+            return -i;
+
+        result = (result << 6) | (text[i] & 0x3F);
+    }
+
+    codepoint = result;
+    return length;
+}
+
+static size_t encodeScalar(char32_t codepoint, char8_t *dst) {
+    if (codepoint < 0x80) {
+        dst[0] = char8_t(codepoint);
         return 1;
-    } else if ((text[0] & 0xE0) == 0xC0) {
+    } else if (codepoint < 0x800) {
+        dst[0] = char8_t(0xC0 | (codepoint >> 6));
+        dst[1] = char8_t(0x80 | (codepoint & 0x3F));
         return 2;
-    } else if ((text[0] & 0xF0) == 0xE0) {
+    } else if (codepoint < 0x10000) {
+        dst[0] = char8_t(0xE0 | (codepoint >> 12));
+        dst[1] = char8_t(0x80 | ((codepoint >> 6) & 0x3F));
+        dst[2] = char8_t(0x80 | (codepoint & 0x3F));
         return 3;
-    } else if ((text[0] & 0xF8) == 0xF0) {
-        return 4;
     } else {
-        return 0;
+        dst[0] = char8_t(0xF0 | (codepoint >> 18));
+        dst[1] = char8_t(0x80 | ((codepoint >> 12) & 0x3F));
+        dst[2] = char8_t(0x80 | ((codepoint >> 6) & 0x3F));
+        dst[3] = char8_t(0x80 | (codepoint & 0x3F));
+        return 4;
     }
 }
 
-size_t sm::utf8::validate(const char8_t *text, size_t length) {
+static bool isSurrogate(char32_t codepoint) {
+    return codepoint >= 0xD800 && codepoint <= 0xDFFF;
+}
+
+///
+/// scalar
+///
+
+static size_t validateScalar(const char8_t *text, size_t offset, size_t length) {
+    while (offset < length) {
+        // skip ascii a word at a time
+        if (offset + sizeof(uint64_t) <= length) {
+            uint64_t word;
+            memcpy(&word, text + offset, sizeof(word));
+            if ((word & 0x8080808080808080ull) == 0) {
+                offset += sizeof(uint64_t);
+                continue;
+            }
+        }
+
+        char32_t codepoint;
+        int size = decodeScalar(text + offset, length - offset, codepoint);
+        if (size <= 0)
+            return offset;
+
+        offset += size;
+    }
+
+    return SIZE_MAX;
+}
+
+static size_t countScalar(const char8_t *text, size_t length) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        count += !isContinuation(text[i]);
+    }
+
+    return count;
+}
+
+/// find where to resume scalar validation after the vector path stopped at @p offset.
+/// everything before @p offset has been validated, apart from a sequence
+/// that may have started in the last 3 bytes and runs past @p offset
+static size_t findSequenceStart(const char8_t *text, size_t offset) {
+    for (size_t i = 1; i <= 3 && i <= offset; i++) {
+        char8_t byte = text[offset - i];
+        if (!isContinuation(byte))
+            return (byte >= 0xC0) ? offset - i : offset;
+    }
+
+    return offset;
+}
+
+#if SM_UTF8_X86
+
+///
+/// sse2, every x64 cpu has this so it is only dispatched to over avx2
+///
+
+static size_t validateSse2(const char8_t *text, size_t length) {
     size_t offset = 0;
     while (offset < length) {
-        // check for invalid bytes
-        char8_t byte = text[offset];
-        switch (byte) {
-        case 0xFE:
-        case 0xFF:
+        while (offset + 16 <= length) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset));
+            unsigned mask = unsigned(_mm_movemask_epi8(chunk));
+            if (mask != 0) {
+                offset += std::countr_zero(mask);
+                break;
+            }
+
+            offset += 16;
+        }
+
+        if (offset >= length)
+            break;
+
+        char32_t codepoint;
+        int size = decodeScalar(text + offset, length - offset, codepoint);
+        if (size <= 0)
             return offset;
-        default:
+
+        offset += size;
+    }
+
+    return SIZE_MAX;
+}
+
+static size_t countSse2(const char8_t *text, size_t length) {
+    // continuation bytes are -128 to -65 as signed bytes
+    const __m128i threshold = _mm_set1_epi8(-65);
+
+    size_t count = 0;
+    size_t offset = 0;
+    for (; offset + 16 <= length; offset += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset));
+        unsigned mask = unsigned(_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, threshold)));
+        count += std::popcount(mask);
+    }
+
+    return count + countScalar(text + offset, length - offset);
+}
+
+///
+/// avx2, the lookup algorithm from Keiser and Lemire, "Validating UTF-8 in less than one instruction per byte".
+/// each byte is classified by the high nibble of the previous byte, the low nibble of the
+/// previous byte, and the high nibble of itself. any bit set in all three is an error
+///
+
+static constexpr uint8_t kTooShort = 1 << 0; // lead followed by a lead or ascii
+static constexpr uint8_t kTooLong = 1 << 1; // ascii followed by a continuation
+static constexpr uint8_t kOverlong3 = 1 << 2; // E0 80..9F
+static constexpr uint8_t kTooLarge = 1 << 3; // F4 90..BF, or F5 and above
+static constexpr uint8_t kSurrogate = 1 << 4; // ED A0..BF
+static constexpr uint8_t kOverlong2 = 1 << 5; // C0 or C1
+static constexpr uint8_t kTooLarge1000 = 1 << 6; // F5 and above followed by 80..8F
+static constexpr uint8_t kOverlong4 = 1 << 6; // F0 80..8F
+static constexpr uint8_t kTwoConts = 1 << 7; // continuation after continuation, checked against the lengths
+static constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+alignas(16) static constexpr uint8_t kByte1High[16] = {
+    // 0_______ ascii
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    // 10______ continuation
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    // 1100____ two byte lead, C0 and C1 are overlong
+    kTooShort | kOverlong2,
+    // 1101____ two byte lead
+    kTooShort,
+    // 1110____ three byte lead
+    kTooShort | kOverlong3 | kSurrogate,
+    // 1111____ four byte lead
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+};
+
+alignas(16) static constexpr uint8_t kByte1Low[16] = {
+    // ____0000
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    // ____0001
+    kCarry | kOverlong2,
+    // ____001_
+    kCarry,
+    kCarry,
+    // ____0100
+    kCarry | kTooLarge,
+    // ____0101
+    kCarry | kTooLarge | kTooLarge1000,
+    // ____011_
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    // ____1___
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    // ____1101
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+};
+
+alignas(16) static constexpr uint8_t kByte2High[16] = {
+    // 0_______ ascii
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    // 1000____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+    // 1001____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    // 101_____
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    // 11______ lead
+    kTooShort, kTooShort, kTooShort, kTooShort,
+};
+
+// a lead in the last 3 bytes of a block whose sequence continues into the next block
+alignas(32) static constexpr uint8_t kIncompleteMax[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+SM_TARGET_AVX2
+static __m256i loadTable(const uint8_t table[16]) {
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+/// the block shifted back by N bytes, with the end of the previous block shifted in
+template<int N>
+SM_TARGET_AVX2
+static __m256i shiftIn(__m256i input, __m256i previous) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+SM_TARGET_AVX2
+static __m256i highNibble(__m256i value) {
+    return _mm256_and_si256(_mm256_srli_epi16(value, 4), _mm256_set1_epi8(0x0F));
+}
+
+SM_TARGET_AVX2
+static __m256i checkBlock(__m256i input, __m256i previous) {
+    __m256i prev1 = shiftIn<1>(input, previous);
+
+    __m256i byte1High = _mm256_shuffle_epi8(loadTable(kByte1High), highNibble(prev1));
+    __m256i byte1Low = _mm256_shuffle_epi8(loadTable(kByte1Low), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+    __m256i byte2High = _mm256_shuffle_epi8(loadTable(kByte2High), highNibble(input));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+    // the third and fourth bytes of a sequence must be continuations, and those
+    // are the only places two continuations in a row are allowed
+    __m256i prev2 = shiftIn<2>(input, previous);
+    __m256i prev3 = shiftIn<3>(input, previous);
+    __m256i isThird = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xE0 - 0x80)));
+    __m256i isFourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xF0 - 0x80)));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(isThird, isFourth), _mm256_set1_epi8(char(0x80)));
+
+    return _mm256_xor_si256(must23, special);
+}
+
+SM_TARGET_AVX2
+static size_t validateAvx2(const char8_t *text, size_t length) {
+    const __m256i incompleteMax = _mm256_load_si256(reinterpret_cast<const __m256i*>(kIncompleteMax));
+
+    __m256i error = _mm256_setzero_si256();
+    __m256i previous = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+
+    size_t offset = 0;
+    for (; offset + 32 <= length; offset += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + offset));
+
+        if (_mm256_movemask_epi8(input) == 0) {
+            // an ascii block is only an error if it cuts off the previous block
+            error = _mm256_or_si256(error, incomplete);
+            incomplete = _mm256_setzero_si256();
+        } else {
+            error = _mm256_or_si256(error, checkBlock(input, previous));
+            incomplete = _mm256_subs_epu8(input, incompleteMax);
+        }
+
+        // the scalar path finds exactly where the error is
+        if (!_mm256_testz_si256(error, error))
             break;
+
+        previous = input;
+    }
+
+    // also covers the tail and a sequence cut off by the end of the text
+    return validateScalar(text, findSequenceStart(text, offset), length);
+}
+
+SM_TARGET_AVX2
+static size_t countAvx2(const char8_t *text, size_t length) {
+    const __m256i threshold = _mm256_set1_epi8(-65);
+
+    size_t count = 0;
+    size_t offset = 0;
+    for (; offset + 32 <= length; offset += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + offset));
+        unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_cmpgt_epi8(chunk, threshold)));
+        count += std::popcount(mask);
+    }
+
+    return count + countScalar(text + offset, length - offset);
+}
+
+#endif
+
+///
+/// dispatch
+///
+
+struct Kernels {
+    size_t(*validate)(const char8_t *text, size_t length);
+    size_t(*count)(const char8_t *text, size_t length);
+};
+
+#if SM_UTF8_X86
+static constexpr Kernels kAvx2Kernels = { validateAvx2, countAvx2 };
+static constexpr Kernels kSse2Kernels = { validateSse2, countSse2 };
+#else
+static constexpr Kernels kScalarKernels = {
+    [](const char8_t *text, size_t length) { return validateScalar(text, 0, length); },
+    countScalar
+};
+#endif
+
+static const Kernels *selectKernels() {
+#if SM_UTF8_X86
+    return CpuId::hasAvx2() ? &kAvx2Kernels : &kSse2Kernels;
+#else
+    return &kScalarKernels;
+#endif
+}
+
+// constant initialized rather than a function local static, those are not
+// thread safe when built with -fno-threadsafe-statics. every thread selects
+// the same table so racing stores are harmless
+static constinit std::atomic<const Kernels*> gKernels = nullptr;
+
+static const Kernels& getKernels() {
+    const Kernels *kernels = gKernels.load(std::memory_order_relaxed);
+    if (kernels == nullptr) [[unlikely]] {
+        kernels = selectKernels();
+        gKernels.store(kernels, std::memory_order_relaxed);
+    }
+
+    return *kernels;
+}
+
+size_t sm::utf8::validate(const char8_t *text, size_t length) {
+    return getKernels().validate(text, length);
+}
+
+size_t sm::utf8::countCodepoints(const char8_t *text, size_t length) noexcept {
+    return getKernels().count(text, length);
+}
+
+///
+/// transcoding, ascii runs are widened and narrowed 16 units at a time.
+/// sse2 is always available on x64 so these are not dispatched
+///
+
+size_t sm::utf8::toUtf16(const char8_t *text, size_t length, char16_t *dst) noexcept {
+    size_t offset = 0;
+    size_t written = 0;
+
+    while (offset < length) {
+#if SM_UTF8_X86
+        const __m128i zero = _mm_setzero_si128();
+        while (offset + 16 <= length) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset));
+            if (_mm_movemask_epi8(chunk) != 0)
+                break;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written), _mm_unpacklo_epi8(chunk, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written + 8), _mm_unpackhi_epi8(chunk, zero));
+            offset += 16;
+            written += 16;
         }
 
-        size_t size = utf8_codepoint_length(text + offset);
-        if (size == 0) {
-            return offset;
+        if (offset >= length)
+            break;
+#endif
+
+        char32_t codepoint;
+        int size = decodeScalar(text + offset, length - offset, codepoint);
+        if (size <= 0) {
+            codepoint = kReplacement;
+            size = -size;
+        }
+
+        if (codepoint >= 0x10000) {
+            codepoint -= 0x10000;
+            dst[written++] = char16_t(0xD800 + (codepoint >> 10));
+            dst[written++] = char16_t(0xDC00 + (codepoint & 0x3FF));
+        } else {
+            dst[written++] = char16_t(codepoint);
         }
+
         offset += size;
     }
-    return SIZE_MAX;
+
+    return written;
+}
+
+size_t sm::utf8::toUtf32(const char8_t *text, size_t length, char32_t *dst) noexcept {
+    size_t offset = 0;
+    size_t written = 0;
+
+    while (offset < length) {
+#if SM_UTF8_X86
+        const __m128i zero = _mm_setzero_si128();
+        while (offset + 16 <= length) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset));
+            if (_mm_movemask_epi8(chunk) != 0)
+                break;
+
+            __m128i lo = _mm_unpacklo_epi8(chunk, zero);
+            __m128i hi = _mm_unpackhi_epi8(chunk, zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written + 12), _mm_unpackhi_epi16(hi, zero));
+            offset += 16;
+            written += 16;
+        }
+
+        if (offset >= length)
+            break;
+#endif
+
+        char32_t codepoint;
+        int size = decodeScalar(text + offset, length - offset, codepoint);
+        if (size <= 0) {
+            codepoint = kReplacement;
+            size = -size;
+        }
+
+        dst[written++] = codepoint;
+        offset += size;
+    }
+
+    return written;
+}
+
+size_t sm::utf8::fromUtf16(const char16_t *text, size_t length, char8_t *dst) noexcept {
+    size_t offset = 0;
+    size_t written = 0;
+
+    while (offset < length) {
+#if SM_UTF8_X86
+        const __m128i nonAscii = _mm_set1_epi16(short(0xFF80));
+        const __m128i zero = _mm_setzero_si128();
+        while (offset + 16 <= length) {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset + 8));
+            __m128i high = _mm_and_si128(_mm_or_si128(lo, hi), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+                break;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written), _mm_packus_epi16(lo, hi));
+            offset += 16;
+            written += 16;
+        }
+
+        if (offset >= length)
+            break;
+#endif
+
+        char32_t codepoint = text[offset];
+        size_t size = 1;
+
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF && offset + 1 < length && text[offset + 1] >= 0xDC00 && text[offset + 1] <= 0xDFFF) {
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (text[offset + 1] - 0xDC00);
+            size = 2;
+        } else if (isSurrogate(codepoint)) {
+            // unpaired surrogate
+            codepoint = kReplacement;
+        }
+
+        written += encodeScalar(codepoint, dst + written);
+        offset += size;
+    }
+
+    return written;
+}
+
+size_t sm::utf8::fromUtf32(const char32_t *text, size_t length, char8_t *dst) noexcept {
+    size_t offset = 0;
+    size_t written = 0;
+
+    while (offset < length) {
+#if SM_UTF8_X86
+        const __m128i nonAscii = _mm_set1_epi32(int(0xFFFFFF80));
+        const __m128i zero = _mm_setzero_si128();
+        while (offset + 16 <= length) {
+            const __m128i *src = reinterpret_cast<const __m128i*>(text + offset);
+            __m128i a = _mm_loadu_si128(src + 0);
+            __m128i b = _mm_loadu_si128(src + 1);
+            __m128i c = _mm_loadu_si128(src + 2);
+            __m128i d = _mm_loadu_si128(src + 3);
+            __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF)
+                break;
+
+            __m128i lo = _mm_packs_epi32(a, b);
+            __m128i hi = _mm_packs_epi32(c, d);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + written), _mm_packus_epi16(lo, hi));
+            offset += 16;
+            written += 16;
+        }
+
+        if (offset >= length)
+            break;
+#endif
+
+        char32_t codepoint = text[offset++];
+        if (codepoint > 0x10FFFF || isSurrogate(codepoint))
+            codepoint = kReplacement;
+
+        written += encodeScalar(codepoint, dst + written);
+    }
+
+    return written;
 }
 
 // text iterator
@@ -70,39 +623,32 @@ bool TextIterator::operator!=(const TextIterator& other) const {
 }
 
 TextIterator& TextIterator::operator++() {
-    if ((mText[mOffset] & 0x80) == 0) {
-        mOffset += 1;
-    } else if ((mText[mOffset] & 0xE0) == 0xC0) {
-        mOffset += 2;
-    } else if ((mText[mOffset] & 0xF0) == 0xE0) {
-        mOffset += 3;
-    } else if ((mText[mOffset] & 0xF8) == 0xF0) {
-        mOffset += 4;
-    }
-
+    // invalid lead bytes are stepped over so iteration always makes progress
+    mOffset += std::max<size_t>(kLeadLength[mText[mOffset]], 1);
     return *this;
 }
 
 char32_t TextIterator::operator*() const {
-    char32_t codepoint = 0;
-
-    if ((mText[mOffset] & 0x80) == 0) {
-        codepoint = mText[mOffset];
-    } else if ((mText[mOffset] & 0xE0) == 0xC0) {
-        codepoint = (mText[mOffset] & 0x1F) << 6;
-        codepoint |= (mText[mOffset + 1] & 0x3F);
-    } else if ((mText[mOffset] & 0xF0) == 0xE0) {
-        codepoint = (mText[mOffset] & 0x0F) << 12;
-        codepoint |= (mText[mOffset + 1] & 0x3F) << 6;
-        codepoint |= (mText[mOffset + 2] & 0x3F);
-    } else if ((mText[mOffset] & 0xF8) == 0xF0) {
-        codepoint = (mText[mOffset] & 0x07) << 18;
-        codepoint |= (mText[mOffset + 1] & 0x3F) << 12;
-        codepoint |= (mText[mOffset + 2] & 0x3F) << 6;
-        codepoint |= (mText[mOffset + 3] & 0x3F);
-    }
-
-    return codepoint;
+    const char8_t *text = mText + mOffset;
+
+    switch (kLeadLength[text[0]]) {
+    case 1:
+        return text[0];
+    case 2:
+        return ((text[0] & 0x1F) << 6)
+            | (text[1] & 0x3F);
+    case 3:
+        return ((text[0] & 0x0F) << 12)
+            | ((text[1] & 0x3F) << 6)
+            | (text[2] & 0x3F);
+    case 4:
+        return ((text[0] & 0x07) << 18)
+            | ((text[1] & 0x3F) << 12)
+            | ((text[2] & 0x3F) << 6)
+            | (text[3] & 0x3F);
+    default:
+        return kReplacement;
+    }
 }
 
 // static text
@@ -3,6 +3,8 @@
 #include <fmtlib/format.h>
 #include <fmt/chrono.h>
 
+#include <array>
+
 using namespace sm;
 
 namespace chrono = std::chrono;
@@ -113,59 +115,73 @@ std::chrono::system_clock::time_point uuid::v7Time() const noexcept {
 
 // string formatting
 
-void uuid::strfuid(char dst[kStringSize], uuid uuid) noexcept {
-    auto writeOctets = [&](size_t start, size_t n, size_t o) {
-        constexpr char kHex[] = "0123456789abcdef";
-        for (size_t i = start; i < n; i++) {
-            dst[i * 2 + o + 0] = kHex[uuid.octets[i] >> 4];
-            dst[i * 2 + o + 1] = kHex[uuid.octets[i] & 0x0F];
-        }
-    };
+/// two lowercase hex digits for every byte value
+static constexpr auto kHexPairs = [] {
+    constexpr char kHex[] = "0123456789abcdef";
+
+    std::array<std::array<char, 2>, 256> result{};
+    for (size_t i = 0; i < 256; i++)
+        result[i] = { kHex[i >> 4], kHex[i & 0x0F] };
+
+    return result;
+}();
 
-    writeOctets(0, 4, 0);
+/// write @a n octets as hex to @a dst
+static void writeOctets(char *dst, const uint8_t *octets, size_t n) noexcept {
+    for (size_t i = 0; i < n; i++)
+        memcpy(dst + (i * 2), kHexPairs[octets[i]].data(), 2);
+}
+
+void uuid::strfuid(char dst[kStringSize], uuid uuid) noexcept {
+    writeOctets(dst, uuid.octets, 4);
     dst[8] = '-';
-    writeOctets(4, 6, 1);
+    writeOctets(dst + 9, uuid.octets + 4, 2);
     dst[13] = '-';
-    writeOctets(6, 8, 2);
+    writeOctets(dst + 14, uuid.octets + 6, 2);
     dst[18] = '-';
-    writeOctets(8, 10, 3);
+    writeOctets(dst + 19, uuid.octets + 8, 2);
     dst[23] = '-';
-    writeOctets(10, 16, 4);
+    writeOctets(dst + 24, uuid.octets + 10, 6);
+}
+
+SmallString<uuid::kStringSize> uuid::toString() const noexcept {
+    char buffer[kStringSize];
+    strfuid(buffer, *this);
+    return SmallString<kStringSize>(buffer, buffer + kStringSize);
 }
 
 // parsing
 
-static bool isHex(char c) {
-    return (c >= '0' && c <= '9')
-        || (c >= 'a' && c <= 'f')
-        || (c >= 'A' && c <= 'F');
-}
+/// the value of every hex digit, anything else has the high bits set
+static constexpr auto kHexValues = [] {
+    std::array<uint8_t, 256> result{};
+    result.fill(0xFF);
 
-static uint8_t fromHex(char c) {
-    if (c >= '0' && c <= '9') {
-        return c - '0';
-    } else if (c >= 'a' && c <= 'f') {
-        return c - 'a' + 10;
-    } else if (c >= 'A' && c <= 'F') {
-        return c - 'A' + 10;
-    }
+    for (uint8_t c = '0'; c <= '9'; c++)
+        result[c] = c - '0';
 
-    return 0;
-}
+    for (uint8_t c = 'a'; c <= 'f'; c++)
+        result[c] = c - 'a' + 10;
 
+    for (uint8_t c = 'A'; c <= 'F'; c++)
+        result[c] = c - 'A' + 10;
+
+    return result;
+}();
+
+/// decode @a n octets from hex, every digit in the group is decoded and checked once at the end.
+/// a failed parse reads no further than the end of the group it failed in
 static bool readOctets(const char *str, size_t n, uint8_t *dst) {
+    uint8_t invalid = 0;
     for (size_t i = 0; i < n; i++) {
-        char c0 = str[(i * 2) + 0];
-        char c1 = str[(i * 2) + 1];
+        uint8_t hi = kHexValues[uint8_t(str[(i * 2) + 0])];
+        uint8_t lo = kHexValues[uint8_t(str[(i * 2) + 1])];
 
-        if (!isHex(c0) || !isHex(c1)) {
-            return false;
-        }
-
-        dst[i] = (fromHex(c0) << 4) | fromHex(c1);
+        invalid |= hi | lo;
+        dst[i] = uint8_t(hi << 4) | lo;
     }
 
-    return true;
+    return (invalid & 0xF0) == 0;
 }
 
 bool uuid::parse(const char str[kStringSize], uuid& result) noexcept {
@@ -0,0 +1,22 @@
+#include "stdafx.hpp"
+
+#include "core/random.hpp"
+
+#include "base/panic.h"
+
+#include <bcrypt.h>
+
+void sm::getSecureRandomBytes(std::span<uint8_t> buffer) noexcept {
+    uint8_t *dst = buffer.data();
+    size_t size = buffer.size();
+
+    // the size is a ULONG, so very large requests go in pieces
+    while (size > 0) {
+        ULONG chunk = ULONG(std::min<size_t>(size, ULONG_MAX));
+        NTSTATUS status = BCryptGenRandom(nullptr, dst, chunk, BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+        CTASSERTF(BCRYPT_SUCCESS(status), "BCryptGenRandom failed: 0x%lx", (unsigned long)status);
+
+        dst += chunk;
+        size -= chunk;
+    }
+}
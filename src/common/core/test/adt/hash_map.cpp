@@ -0,0 +1,252 @@
+#include "test/gtest_common.hpp"
+
+#include "core/map.hpp"
+#include "core/set.hpp"
+
+#include <random>
+#include <unordered_map>
+
+using namespace std::string_view_literals;
+
+// counts live instances so leaks and double destroys show up
+struct Tracked {
+    static inline int gLive = 0;
+
+    int value;
+
+    Tracked(int value) noexcept : value(value) { gLive += 1; }
+    Tracked(const Tracked& other) noexcept : value(other.value) { gLive += 1; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { gLive += 1; }
+    ~Tracked() noexcept { gLive -= 1; }
+
+    Tracked& operator=(const Tracked&) noexcept = default;
+
+    bool operator==(const Tracked& other) const noexcept { return value == other.value; }
+};
+
+// every key lands in the same probe sequence
+struct CollidingHash {
+    size_t operator()(int) const noexcept { return 0; }
+};
+
+TEST(HashMapTest, InsertFindErase) {
+    sm::HashMap<int, std::string> map;
+    ASSERT_TRUE(map.empty());
+    ASSERT_EQ(map.find(1), map.end());
+
+    for (int i = 0; i < 1000; i++) {
+        auto [it, inserted] = map.emplace(i, std::to_string(i));
+        ASSERT_TRUE(inserted);
+        ASSERT_EQ(it->first, i);
+    }
+
+    ASSERT_EQ(map.size(), 1000);
+    ASSERT_FALSE(map.emplace(5, "duplicate").second);
+    ASSERT_EQ(map.at(5), "5");
+    ASSERT_THROW(map.at(1000), std::out_of_range);
+
+    for (int i = 0; i < 1000; i += 2)
+        ASSERT_EQ(map.erase(i), 1);
+
+    ASSERT_EQ(map.erase(0), 0);
+    ASSERT_EQ(map.size(), 500);
+
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(map.contains(i), (i % 2) == 1);
+    }
+
+    size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        ASSERT_EQ(value, std::to_string(key));
+        visited += 1;
+    }
+
+    ASSERT_EQ(visited, map.size());
+}
+
+TEST(HashMapTest, SubscriptAndAssign) {
+    sm::HashMap<std::string, int> map;
+    map["one"] = 1;
+    map["two"] += 2;
+    map["two"] += 2;
+
+    ASSERT_EQ(map.at("one"), 1);
+    ASSERT_EQ(map.at("two"), 4);
+
+    auto [it, inserted] = map.insert_or_assign("one", 11);
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(it->second, 11);
+
+    ASSERT_TRUE(map.try_emplace("three", 3).second);
+    ASSERT_FALSE(map.try_emplace("three", 33).second);
+    ASSERT_EQ(map.at("three"), 3);
+}
+
+TEST(HashMapTest, HeterogeneousLookup) {
+    sm::HashMap<std::string, int> map = {
+        { "alpha", 1 },
+        { "beta", 2 },
+    };
+
+    std::string_view key = "alpha"sv;
+    ASSERT_NE(map.find(key), map.end());
+    ASSERT_TRUE(map.contains("beta"sv));
+    ASSERT_FALSE(map.contains("gamma"sv));
+    ASSERT_EQ(map.at("beta"sv), 2);
+
+    map["gamma"sv] = 3;
+    ASSERT_EQ(map.at("gamma"), 3);
+
+    ASSERT_EQ(map.erase("alpha"sv), 1);
+    ASSERT_FALSE(map.contains("alpha"));
+}
+
+TEST(HashMapTest, EraseDuringIteration) {
+    sm::HashMap<int, int> map;
+    for (int i = 0; i < 100; i++)
+        map[i] = i;
+
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->first % 3 == 0) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    ASSERT_EQ(map.size(), 66);
+    for (const auto& [key, value] : map)
+        ASSERT_NE(key % 3, 0);
+}
+
+TEST(HashMapTest, Collisions) {
+    sm::HashMap<int, int, CollidingHash> map;
+    for (int i = 0; i < 200; i++)
+        map[i] = i * 2;
+
+    for (int i = 0; i < 200; i += 3)
+        map.erase(i);
+
+    for (int i = 0; i < 200; i++) {
+        auto it = map.find(i);
+        if (i % 3 == 0) {
+            ASSERT_EQ(it, map.end());
+        } else {
+            ASSERT_EQ(it->second, i * 2);
+        }
+    }
+}
+
+TEST(HashMapTest, ReserveAndRehash) {
+    sm::HashMap<int, int> map;
+    map.reserve(1000);
+
+    size_t capacity = map.capacity();
+    ASSERT_GE(capacity * map.max_load_factor(), 1000);
+
+    for (int i = 0; i < 1000; i++)
+        map[i] = i;
+
+    ASSERT_EQ(map.capacity(), capacity);
+
+    for (int i = 0; i < 990; i++)
+        map.erase(i);
+
+    map.rehash(0);
+    ASSERT_LT(map.capacity(), capacity);
+    ASSERT_EQ(map.size(), 10);
+    for (int i = 990; i < 1000; i++)
+        ASSERT_EQ(map.at(i), i);
+
+    map.clear();
+    map.rehash(0);
+    ASSERT_EQ(map.capacity(), 0);
+    ASSERT_EQ(map.begin(), map.end());
+}
+
+TEST(HashMapTest, ChurnKeepsCapacity) {
+    // inserting and erasing the same number of keys reuses tombstones rather than growing forever
+    sm::HashMap<uint64_t, uint64_t> map;
+    map.reserve(100);
+    for (uint64_t i = 0; i < 100; i++)
+        map[i] = i;
+
+    size_t capacity = map.capacity();
+    for (uint64_t i = 100; i < 100000; i++) {
+        map.erase(i - 100);
+        map[i] = i;
+    }
+
+    ASSERT_EQ(map.size(), 100);
+    ASSERT_LE(map.capacity(), capacity * 2 + 1);
+}
+
+TEST(HashMapTest, Lifetimes) {
+    {
+        sm::HashMap<int, Tracked> map;
+        for (int i = 0; i < 500; i++)
+            map.try_emplace(i, i);
+
+        for (int i = 0; i < 500; i += 5)
+            map.erase(i);
+
+        ASSERT_EQ(Tracked::gLive, 400);
+
+        sm::HashMap<int, Tracked> copy = map;
+        ASSERT_EQ(Tracked::gLive, 800);
+        ASSERT_TRUE(copy == map);
+
+        sm::HashMap<int, Tracked> moved = std::move(copy);
+        ASSERT_EQ(Tracked::gLive, 800);
+        ASSERT_TRUE(copy.empty());
+
+        moved.clear();
+        ASSERT_EQ(Tracked::gLive, 400);
+    }
+
+    ASSERT_EQ(Tracked::gLive, 0);
+}
+
+TEST(HashMapTest, MatchesUnorderedMap) {
+    std::mt19937_64 rng{1234};
+    std::uniform_int_distribution<uint64_t> keys{0, 5000};
+
+    sm::HashMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> expected;
+
+    for (size_t i = 0; i < 100000; i++) {
+        uint64_t key = keys(rng);
+        switch (rng() % 3) {
+        case 0:
+            map[key] = i;
+            expected[key] = i;
+            break;
+        case 1:
+            ASSERT_EQ(map.erase(key), expected.erase(key));
+            break;
+        default:
+            ASSERT_EQ(map.contains(key), expected.contains(key));
+            break;
+        }
+    }
+
+    ASSERT_EQ(map.size(), expected.size());
+    for (const auto& [key, value] : expected)
+        ASSERT_EQ(map.at(key), value);
+}
+
+TEST(HashSetTest, InsertFindErase) {
+    sm::HashSet<std::string> set = { "a", "b", "c" };
+    ASSERT_EQ(set.size(), 3);
+
+    ASSERT_FALSE(set.insert("a").second);
+    ASSERT_TRUE(set.emplace("d").second);
+    ASSERT_TRUE(set.contains("d"sv));
+    ASSERT_EQ(*set.find("b"sv), "b");
+
+    ASSERT_EQ(set.erase("a"sv), 1);
+    ASSERT_FALSE(set.contains("a"));
+
+    sm::HashSet<std::string> other = { "b", "c", "d" };
+    ASSERT_TRUE(set == other);
+}
@@ -2,6 +2,8 @@
 
 #include "core/adt/small_vector.hpp"
 
+#include <string.h>
+
 TEST(VectorTest, DefaultInitialization) {
     sm::SmallVector<int, 4> vec;
 
@@ -179,3 +181,71 @@ TEST(VectorTest, NonCopyableEmplace) {
     ASSERT_EQ(vec.size(), 4);
     ASSERT_FALSE(vec.isEmpty());
 }
+
+namespace {
+    struct Tracked {
+        static inline int gLive = 0;
+
+        int value;
+
+        Tracked(int v) noexcept : value(v) { gLive += 1; }
+        Tracked(const Tracked& other) noexcept : value(other.value) { gLive += 1; }
+        Tracked(Tracked&& other) noexcept : value(other.value) { gLive += 1; }
+        Tracked& operator=(const Tracked&) noexcept = default;
+        Tracked& operator=(Tracked&&) noexcept = default;
+        ~Tracked() noexcept { gLive -= 1; }
+    };
+}
+
+TEST(VectorTest, MoveLifetime) {
+    Tracked::gLive = 0;
+
+    {
+        sm::SmallVector<Tracked, 4> vec;
+        vec.emplace_back(1);
+        vec.emplace_back(2);
+
+        sm::SmallVector<Tracked, 4> moved = std::move(vec);
+        ASSERT_EQ(Tracked::gLive, 2);
+        ASSERT_TRUE(vec.isEmpty());
+
+        sm::SmallVector<Tracked, 4> other;
+        other.emplace_back(3);
+        other.emplace_back(4);
+        other.emplace_back(5);
+
+        // the old elements are destroyed and the moved ones are taken
+        other = std::move(moved);
+        ASSERT_EQ(Tracked::gLive, 2);
+        ASSERT_TRUE(moved.isEmpty());
+        ASSERT_EQ(other.size(), 2);
+        ASSERT_EQ(other[0].value, 1);
+        ASSERT_EQ(other[1].value, 2);
+
+        sm::SmallVector<Tracked, 4> copy = other.clone();
+        ASSERT_EQ(Tracked::gLive, 4);
+
+        const sm::SmallVectorBase<Tracked>& base = other;
+        copy = base;
+        ASSERT_EQ(Tracked::gLive, 4);
+    }
+
+    ASSERT_EQ(Tracked::gLive, 0);
+}
+
+TEST(VectorTest, AppendUninitialized) {
+    sm::SmallVector<char, 16> vec;
+
+    memcpy(vec.appendUninitialized(5), "hello", 5);
+    memcpy(vec.appendUninitialized(6), " world", 6);
+
+    ASSERT_EQ(vec.size(), 11);
+    ASSERT_EQ(memcmp(vec.data(), "hello world", 11), 0);
+
+    vec.resizeUninitialized(5);
+    ASSERT_EQ(vec.size(), 5);
+    ASSERT_EQ(vec[4], 'o');
+
+    vec.resizeUninitialized(16);
+    ASSERT_EQ(vec.size(), 16);
+}
@@ -2,6 +2,9 @@
 
 #include "core/adt/vector.hpp"
 
+#include <stdexcept>
+#include <string>
+
 TEST(VectorTest, Construction) {
     sm::VectorBase<int> vec;
 
@@ -151,3 +154,209 @@ TEST(VectorTest, Emplace) {
     EXPECT_EQ(vec[2].a, 5);
     EXPECT_EQ(vec[2].b, 6);
 }
+
+namespace {
+    // counts live objects, so leaks and double destruction show up as a non zero count
+    struct Tracked {
+        static inline int gLive = 0;
+        static inline int gMoves = 0;
+
+        int value;
+
+        Tracked(int v) noexcept : value(v) { gLive += 1; }
+        Tracked(const Tracked& other) noexcept : value(other.value) { gLive += 1; }
+        Tracked(Tracked&& other) noexcept : value(other.value) { gLive += 1; gMoves += 1; }
+        Tracked& operator=(const Tracked&) noexcept = default;
+        Tracked& operator=(Tracked&&) noexcept = default;
+        ~Tracked() noexcept { gLive -= 1; }
+    };
+
+    // the same as Tracked but growth may copy its bytes instead of moving it
+    struct Relocatable : Tracked {
+        using Tracked::Tracked;
+    };
+}
+
+template<>
+struct sm::is_trivially_relocatable<Relocatable> : std::true_type { };
+
+static_assert(sm::IsTriviallyRelocatable<int>);
+static_assert(!sm::IsTriviallyRelocatable<Tracked>);
+static_assert(sm::IsTriviallyRelocatable<Relocatable>);
+
+template<typename T>
+class VectorLifetimeTest : public testing::Test {
+    void SetUp() override {
+        Tracked::gLive = 0;
+        Tracked::gMoves = 0;
+    }
+
+    void TearDown() override {
+        EXPECT_EQ(Tracked::gLive, 0);
+    }
+};
+
+using LifetimeTypes = testing::Types<Tracked, Relocatable>;
+TYPED_TEST_SUITE(VectorLifetimeTest, LifetimeTypes);
+
+TYPED_TEST(VectorLifetimeTest, Growth) {
+    sm::VectorBase<TypeParam> vec;
+    for (int i = 0; i < 1000; i++)
+        vec.emplace_back(i);
+
+    ASSERT_EQ(vec.size(), 1000);
+    ASSERT_EQ(Tracked::gLive, 1000);
+
+    for (int i = 0; i < 1000; i++)
+        ASSERT_EQ(vec[i].value, i);
+
+    // relocatable types are copied as bytes, the others are moved one by one
+    if constexpr (sm::IsTriviallyRelocatable<TypeParam>)
+        ASSERT_EQ(Tracked::gMoves, 0);
+    else
+        ASSERT_GT(Tracked::gMoves, 0);
+}
+
+TYPED_TEST(VectorLifetimeTest, ResizeAndReserve) {
+    sm::VectorBase<TypeParam> vec;
+    for (int i = 0; i < 100; i++)
+        vec.push_back(TypeParam{i});
+
+    vec.reserveExact(200);
+    ASSERT_EQ(vec.capacity(), 200);
+    ASSERT_EQ(Tracked::gLive, 100);
+
+    // shrinking the capacity below the size destroys the tail
+    vec.reserveExact(50);
+    ASSERT_EQ(vec.size(), 50);
+    ASSERT_EQ(Tracked::gLive, 50);
+
+    for (int i = 0; i < 50; i++)
+        ASSERT_EQ(vec[i].value, i);
+
+    sm::VectorBase<TypeParam> copy = vec.clone();
+    ASSERT_EQ(Tracked::gLive, 100);
+
+    copy.clear();
+    ASSERT_EQ(Tracked::gLive, 50);
+}
+
+TYPED_TEST(VectorLifetimeTest, PushSelfReference) {
+    sm::VectorBase<TypeParam> vec;
+    vec.reserveExact(4);
+    for (int i = 0; i < 4; i++)
+        vec.emplace_back(i);
+
+    // the vector is full, so this grows while the argument still points into the old data
+    for (int i = 0; i < 100; i++)
+        vec.push_back(vec[0]);
+
+    for (size_t i = 4; i < vec.size(); i++)
+        ASSERT_EQ(vec[i].value, 0);
+}
+
+namespace {
+    // a move that may throw, so relocation copies it instead
+    struct ThrowingMove {
+        static inline int gCopies = 0;
+        static inline int gFailAt = -1;
+
+        int value;
+
+        ThrowingMove(int v) : value(v) { }
+        ThrowingMove(const ThrowingMove& other) : value(other.value) {
+            if (gCopies++ == gFailAt)
+                throw std::runtime_error("copy failed");
+        }
+        ThrowingMove(ThrowingMove&& other) : value(other.value) { other.value = -1; }
+    };
+}
+
+static_assert(!noexcept(sm::uninitializedRelocate<ThrowingMove>(nullptr, nullptr, nullptr)));
+static_assert(noexcept(sm::uninitializedRelocate<Tracked>(nullptr, nullptr, nullptr)));
+
+TEST(VectorTest, RelocateThrowingMove) {
+    std::allocator<ThrowingMove> alloc;
+    ThrowingMove *src = alloc.allocate(4);
+    ThrowingMove *dst = alloc.allocate(4);
+
+    for (int i = 0; i < 4; i++)
+        std::construct_at(src + i, i);
+
+    // a failed copy leaves the source as it was
+    ThrowingMove::gCopies = 0;
+    ThrowingMove::gFailAt = 2;
+    ASSERT_THROW(sm::uninitializedRelocate(src, src + 4, dst), std::runtime_error);
+
+    for (int i = 0; i < 4; i++)
+        ASSERT_EQ(src[i].value, i);
+
+    ThrowingMove::gFailAt = -1;
+    ASSERT_EQ(sm::uninitializedRelocate(src, src + 4, dst), dst + 4);
+
+    for (int i = 0; i < 4; i++)
+        ASSERT_EQ(dst[i].value, i);
+
+    std::destroy(dst, dst + 4);
+    alloc.deallocate(src, 4);
+    alloc.deallocate(dst, 4);
+}
+
+TEST(VectorTest, NoInit) {
+    sm::VectorBase<std::string> strings{8, sm::noinit{}};
+    ASSERT_EQ(strings.size(), 8);
+
+    // non trivial types are still default constructed
+    for (const std::string& str : strings)
+        ASSERT_TRUE(str.empty());
+}
+
+TEST(VectorTest, ResizeUninitialized) {
+    sm::VectorBase<uint8_t> vec;
+    vec.resizeUninitialized(1000);
+    ASSERT_EQ(vec.size(), 1000);
+    ASSERT_GE(vec.capacity(), 1000);
+
+    memset(vec.data(), 0x55, vec.size());
+
+    vec.resizeUninitialized(10);
+    ASSERT_EQ(vec.size(), 10);
+    ASSERT_EQ(vec[9], 0x55);
+}
+
+TEST(VectorTest, AppendUninitialized) {
+    static constexpr char kData[] = "a packet worth of bytes";
+    sm::VectorBase<char> vec;
+
+    // the way a recv loop would use it
+    for (int i = 0; i < 100; i++) {
+        char *dst = vec.appendUninitialized(sizeof(kData));
+        memcpy(dst, kData, sizeof(kData));
+    }
+
+    ASSERT_EQ(vec.size(), sizeof(kData) * 100);
+
+    for (size_t i = 0; i < 100; i++)
+        ASSERT_EQ(memcmp(vec.data() + i * sizeof(kData), kData, sizeof(kData)), 0) << i;
+
+    // and short reads are trimmed afterwards
+    vec.appendUninitialized(64);
+    vec.resizeUninitialized(vec.ssize() - 64 + 5);
+    ASSERT_EQ(vec.size(), sizeof(kData) * 100 + 5);
+}
+
+TEST(VectorTest, ReleaseConsume) {
+    sm::VectorBase<int> vec = { 1, 2, 3, 4 };
+    ssize_t capacity = vec.capacity();
+
+    int *data = vec.release();
+    ASSERT_TRUE(vec.empty());
+
+    sm::VectorBase<int> other = sm::VectorBase<int>::consume(data, 4, capacity);
+    ASSERT_EQ(other.size(), 4);
+    ASSERT_EQ(other[3], 4);
+
+    // a released vector can still be used
+    vec.push_back(5);
+    ASSERT_EQ(vec[0], 5);
+}
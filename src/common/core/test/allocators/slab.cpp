@@ -0,0 +1,215 @@
+#include "test/gtest_common.hpp"
+
+#include "core/allocators/slab.hpp"
+
+#include <set>
+#include <thread>
+
+using namespace sm;
+
+static constexpr size_t kBlockSize = 48;
+
+// counts what reaches it so tests can tell which allocations bypassed the slabs
+class CountingResource final : public std::pmr::memory_resource {
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        allocations += 1;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+        deallocations += 1;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+};
+
+TEST(SlabTest, AllocateUntilExhausted) {
+    SlabAllocator slab{16, kBlockSize};
+    std::set<void*> blocks;
+
+    for (size_t i = 0; i < slab.capacity(); i++) {
+        void *block = slab.allocate();
+        ASSERT_NE(block, nullptr);
+        ASSERT_TRUE(slab.contains(block));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignof(void*), 0);
+
+        memset(block, 0xCD, kBlockSize);
+        blocks.insert(block);
+    }
+
+    ASSERT_EQ(blocks.size(), slab.capacity());
+    ASSERT_EQ(slab.used(), slab.capacity());
+    ASSERT_EQ(slab.allocate(), nullptr);
+
+    void *first = *blocks.begin();
+    slab.deallocate(first);
+    ASSERT_EQ(slab.available(), 1);
+    ASSERT_EQ(slab.allocate(), first);
+
+    for (void *block : blocks)
+        slab.deallocate(block);
+
+    ASSERT_EQ(slab.used(), 0);
+}
+
+TEST(SlabTest, CallerOwnedMemory) {
+    alignas(16) char memory[kBlockSize * 4];
+
+    SlabAllocator slab{memory, 4, kBlockSize};
+    void *block = slab.allocate();
+    ASSERT_EQ(block, memory);
+    ASSERT_FALSE(slab.contains(memory + sizeof(memory)));
+
+    slab.deallocate(block);
+}
+
+TEST(SlabCacheTest, ReusesBlocks) {
+    SlabCache cache{kBlockSize, 128};
+    ASSERT_EQ(cache.blockSize(), kBlockSize);
+
+    std::vector<void*> blocks;
+    std::set<void*> unique;
+    for (size_t i = 0; i < 1000; i++) {
+        void *block = cache.allocate();
+        memset(block, int(i), kBlockSize);
+        blocks.push_back(block);
+        unique.insert(block);
+    }
+
+    ASSERT_EQ(unique.size(), blocks.size());
+
+    for (void *block : blocks)
+        cache.deallocate(block);
+
+    // everything freed is handed out again before any new slab is needed
+    std::set<void*> reused;
+    for (size_t i = 0; i < 1000; i++)
+        reused.insert(cache.allocate());
+
+    ASSERT_EQ(reused, unique);
+
+    for (void *block : reused)
+        cache.deallocate(block);
+}
+
+TEST(SlabCacheTest, RoundsBlockSize) {
+    SlabCache cache{3};
+    ASSERT_EQ(cache.blockSize(), SlabAllocator::kMinBlockSize);
+}
+
+TEST(SlabCacheTest, CrossThreadFree) {
+    static constexpr size_t kThreads = 8;
+    static constexpr size_t kBlocks = 5000;
+
+    SlabCache cache{kBlockSize};
+    std::vector<std::vector<void*>> allocated(kThreads);
+
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 0; t < kThreads; t++) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < kBlocks; i++) {
+                    void *block = cache.allocate();
+                    *static_cast<size_t*>(block) = t * kBlocks + i;
+                    allocated[t].push_back(block);
+                }
+            });
+        }
+    }
+
+    std::set<void*> unique;
+    for (size_t t = 0; t < kThreads; t++) {
+        for (size_t i = 0; i < kBlocks; i++) {
+            void *block = allocated[t][i];
+            ASSERT_EQ(*static_cast<size_t*>(block), t * kBlocks + i);
+            unique.insert(block);
+        }
+    }
+
+    ASSERT_EQ(unique.size(), kThreads * kBlocks);
+
+    // free each threads blocks on a different thread, with churn in between
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 0; t < kThreads; t++) {
+            threads.emplace_back([&, t] {
+                for (void *block : allocated[(t + 1) % kThreads]) {
+                    cache.deallocate(block);
+                    cache.deallocate(cache.allocate());
+                }
+            });
+        }
+    }
+
+    // exited threads returned their magazines, so the blocks are all available here
+    std::set<void*> reused;
+    for (size_t i = 0; i < kThreads * kBlocks; i++)
+        reused.insert(cache.allocate());
+
+    ASSERT_EQ(reused, unique);
+
+    for (void *block : reused)
+        cache.deallocate(block);
+
+    cache.releaseThreadCache();
+}
+
+TEST(SlabCacheTest, OutlivedByThread) {
+    // the same thread uses caches that are destroyed before it exits
+    for (size_t i = 0; i < 64; i++) {
+        SlabCache cache{kBlockSize};
+        void *block = cache.allocate();
+        cache.deallocate(block);
+    }
+
+    std::jthread thread = std::jthread([] {
+        for (size_t i = 0; i < 64; i++) {
+            SlabCache cache{kBlockSize};
+            cache.deallocate(cache.allocate());
+        }
+    });
+}
+
+TEST(SlabMemoryResourceTest, SizeClasses) {
+    CountingResource upstream;
+    SlabMemoryResource resource{1000, &upstream};
+
+    ASSERT_EQ(resource.maxBlockSize(), 1024);
+
+    for (size_t size : { 0, 1, 16, 17, 100, 512, 1024 }) {
+        void *ptr = resource.allocate(size, alignof(std::max_align_t));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), 0);
+        memset(ptr, 0xAB, size);
+        resource.deallocate(ptr, size, alignof(std::max_align_t));
+    }
+
+    ASSERT_EQ(upstream.allocations, 0);
+
+    void *large = resource.allocate(1025);
+    resource.deallocate(large, 1025);
+
+    void *aligned = resource.allocate(64, 64);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+    resource.deallocate(aligned, 64, 64);
+
+    ASSERT_EQ(upstream.allocations, 2);
+    ASSERT_EQ(upstream.deallocations, 2);
+}
+
+TEST(SlabMemoryResourceTest, PmrContainers) {
+    SlabMemoryResource resource;
+
+    std::pmr::vector<std::pmr::string> strings{&resource};
+    for (size_t i = 0; i < 1000; i++)
+        strings.emplace_back(fmt::format("a string long enough to need an allocation {}", i));
+
+    for (size_t i = 0; i < strings.size(); i++)
+        ASSERT_EQ(std::string_view{strings[i]}, fmt::format("a string long enough to need an allocation {}", i));
+}
@@ -0,0 +1,316 @@
+#include "gtest_common.hpp"
+
+#include "core/random.hpp"
+
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace sm;
+
+// statistical checks use a fixed seed, so they either always pass or always fail
+static constexpr uint64_t kSeed = 42;
+
+/// pearson's chi squared statistic for @a counts against a uniform distribution
+static double chiSquared(std::span<const size_t> counts, size_t total) {
+    double expected = double(total) / double(counts.size());
+
+    double sum = 0.0;
+    for (size_t count : counts) {
+        double delta = double(count) - expected;
+        sum += delta * delta / expected;
+    }
+
+    return sum;
+}
+
+/// a generous upper bound on chi squared for @a dof degrees of freedom, about 5 standard deviations.
+/// good generators land near @a dof, a biased one lands far past this
+static double getChiSquaredLimit(size_t dof) {
+    return double(dof) + 5.0 * std::sqrt(2.0 * double(dof));
+}
+
+template<typename T>
+class RandomEngineTest : public testing::Test { };
+
+using Engines = testing::Types<Random, WyRand>;
+TYPED_TEST_SUITE(RandomEngineTest, Engines);
+
+TEST(RandomTest, Splitmix) {
+    // reference output for seed 1234567
+    uint64_t state = 1234567;
+    ASSERT_EQ(detail::splitmix64(state), 6457827717110365317ull);
+    ASSERT_EQ(detail::splitmix64(state), 3203168211198807973ull);
+    ASSERT_EQ(detail::splitmix64(state), 9817491932198370423ull);
+}
+
+TEST(RandomTest, KnownSequence) {
+    // the sequences are part of the contract, saved seeds must replay the same on every platform
+    Random xoshiro{kSeed};
+    ASSERT_EQ(xoshiro.next(), 0x1578'0B2E'0C2E'C716ull);
+    ASSERT_EQ(xoshiro.next(), 0x6104'D986'6D11'3A7Eull);
+    ASSERT_EQ(xoshiro.next(), 0xAE17'5332'39E4'99A1ull);
+    ASSERT_EQ(xoshiro.next(), 0xECB8'AD47'03B3'60A1ull);
+
+    WyRand wyrand{kSeed};
+    ASSERT_EQ(wyrand.next(), 0xAE4A'7CBF'DDA9'B434ull);
+    ASSERT_EQ(wyrand.next(), 0xE9CC'09D3'3D38'D9D2ull);
+    ASSERT_EQ(wyrand.next(), 0xCB57'5651'2B93'433Aull);
+    ASSERT_EQ(wyrand.next(), 0xEB29'B2A1'320E'1A71ull);
+}
+
+TEST(RandomTest, Mul128) {
+    uint64_t hi;
+    ASSERT_EQ(detail::mul128(UINT64_MAX, UINT64_MAX, hi), 1u);
+    ASSERT_EQ(hi, UINT64_MAX - 1);
+
+    ASSERT_EQ(detail::mul128(0x1'0000'0000ull, 0x1'0000'0000ull, hi), 0u);
+    ASSERT_EQ(hi, 1u);
+}
+
+TEST(RandomTest, Jump) {
+    Random a{kSeed};
+    Random b{kSeed};
+    a.jump();
+    b.jump();
+
+    // jumping is deterministic
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ(a.next(), b.next());
+
+    // and lands far enough away that the streams do not overlap
+    Random base{kSeed};
+    Random jumped{kSeed};
+    jumped.jump();
+
+    std::set<uint64_t> seen;
+    for (int i = 0; i < 10000; i++)
+        seen.insert(base.next());
+
+    for (int i = 0; i < 10000; i++)
+        ASSERT_FALSE(seen.contains(jumped.next())) << i;
+}
+
+TYPED_TEST(RandomEngineTest, SameSeedSameSequence) {
+    TypeParam a{1234};
+    TypeParam b{1234};
+    TypeParam c{1235};
+
+    size_t same = 0;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t value = a.next();
+        ASSERT_EQ(value, b.next());
+        same += (value == c.next());
+    }
+
+    ASSERT_EQ(same, 0);
+}
+
+TYPED_TEST(RandomEngineTest, DefaultSeedsDiffer) {
+    TypeParam a;
+    TypeParam b;
+
+    ASSERT_NE(a.next(), b.next());
+}
+
+TYPED_TEST(RandomEngineTest, BitBalance) {
+    static constexpr size_t kSamples = 100'000;
+    TypeParam rng{kSeed};
+
+    size_t counts[64] = {};
+    for (size_t i = 0; i < kSamples; i++) {
+        uint64_t value = rng.next();
+        for (size_t bit = 0; bit < 64; bit++)
+            counts[bit] += (value >> bit) & 1;
+    }
+
+    // each bit is a coin flip, 5 standard deviations either side of half
+    double deviation = 5.0 * std::sqrt(kSamples * 0.25);
+    for (size_t bit = 0; bit < 64; bit++)
+        ASSERT_NEAR(double(counts[bit]), kSamples / 2.0, deviation) << bit;
+}
+
+TYPED_TEST(RandomEngineTest, NextBytes) {
+    // the bytes are the generator words in order, the tail from one extra word
+    for (size_t size : { 0, 1, 7, 8, 9, 15, 16, 17, 100 }) {
+        SCOPED_TRACE(size);
+
+        TypeParam rng{kSeed};
+        TypeParam reference{kSeed};
+
+        std::vector<uint8_t> buffer(size + 1, 0xAA);
+        rng.nextBytes({ buffer.data(), size });
+        ASSERT_EQ(buffer[size], 0xAA);
+
+        for (size_t i = 0; i < size; i += 8) {
+            uint64_t word = reference.next();
+            ASSERT_EQ(memcmp(buffer.data() + i, &word, std::min<size_t>(8, size - i)), 0) << i;
+        }
+
+        // nothing was drawn past the last word used
+        ASSERT_EQ(rng.next(), reference.next());
+    }
+}
+
+TYPED_TEST(RandomEngineTest, ByteDistribution) {
+    static constexpr size_t kSize = 1 << 20;
+    TypeParam rng{kSeed};
+
+    std::vector<uint8_t> buffer(kSize);
+    rng.nextBytes(buffer);
+
+    size_t counts[256] = {};
+    for (uint8_t byte : buffer)
+        counts[byte] += 1;
+
+    ASSERT_LT(chiSquared(counts, kSize), getChiSquaredLimit(255));
+}
+
+TYPED_TEST(RandomEngineTest, NextU64Span) {
+    TypeParam rng{kSeed};
+    TypeParam reference{kSeed};
+
+    std::vector<uint64_t> words(100);
+    rng.nextU64(words);
+
+    for (uint64_t word : words)
+        ASSERT_EQ(word, reference.next());
+}
+
+TYPED_TEST(RandomEngineTest, RangeBounds) {
+    TypeParam rng{kSeed};
+
+    for (int i = 0; i < 1000; i++) {
+        uint64_t value = rng.nextInRange(10, 20);
+        ASSERT_GE(value, 10);
+        ASSERT_LE(value, 20);
+    }
+
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ(rng.nextInRange(7, 7), 7);
+
+    // the full range takes the raw word
+    TypeParam reference = rng;
+    ASSERT_EQ(rng.nextInRange(0, UINT64_MAX), reference.next());
+
+    // a range just past half of 2^64 rejects almost half of all samples, it must still terminate and stay in range
+    uint64_t max = (UINT64_MAX / 2) + 1;
+    for (int i = 0; i < 1000; i++)
+        ASSERT_LE(rng.nextInRange(0, max), max);
+}
+
+TYPED_TEST(RandomEngineTest, RangeDistribution) {
+    static constexpr size_t kSamples = 600'000;
+
+    // small ranges that do not divide 2^64, a modulo would bias them
+    for (uint64_t range : { 3, 6, 10, 100 }) {
+        SCOPED_TRACE(range);
+        TypeParam rng{kSeed};
+
+        std::vector<size_t> counts(range);
+        for (size_t i = 0; i < kSamples; i++)
+            counts[rng.nextInRange(0, range - 1)] += 1;
+
+        ASSERT_LT(chiSquared(counts, kSamples), getChiSquaredLimit(range - 1));
+    }
+
+    // a range where a plain modulo would make the lower third twice as likely as the rest
+    {
+        TypeParam rng{kSeed};
+        uint64_t max = (UINT64_MAX / 3) * 2;
+
+        size_t lower = 0;
+        for (size_t i = 0; i < kSamples; i++)
+            lower += rng.nextInRange(0, max) < max / 2;
+
+        ASSERT_NEAR(double(lower), kSamples / 2.0, 5.0 * std::sqrt(kSamples * 0.25));
+    }
+}
+
+TYPED_TEST(RandomEngineTest, Floats) {
+    static constexpr size_t kSamples = 100'000;
+    TypeParam rng{kSeed};
+
+    double floatSum = 0.0;
+    double doubleSum = 0.0;
+    for (size_t i = 0; i < kSamples; i++) {
+        float f = rng.nextFloat();
+        double d = rng.nextDouble();
+
+        ASSERT_GE(f, 0.f);
+        ASSERT_LT(f, 1.f);
+        ASSERT_GE(d, 0.0);
+        ASSERT_LT(d, 1.0);
+
+        floatSum += f;
+        doubleSum += d;
+    }
+
+    // the mean of a uniform [0, 1) has a standard deviation of sqrt(1/12n)
+    double deviation = 5.0 * std::sqrt(1.0 / (12.0 * kSamples));
+    ASSERT_NEAR(floatSum / kSamples, 0.5, deviation);
+    ASSERT_NEAR(doubleSum / kSamples, 0.5, deviation);
+}
+
+TYPED_TEST(RandomEngineTest, StdDistribution) {
+    static_assert(std::uniform_random_bit_generator<TypeParam>);
+
+    TypeParam rng{kSeed};
+    std::uniform_int_distribution<int> dist{-5, 5};
+
+    for (int i = 0; i < 1000; i++) {
+        int value = dist(rng);
+        ASSERT_GE(value, -5);
+        ASSERT_LE(value, 5);
+    }
+}
+
+TYPED_TEST(RandomEngineTest, ThreadLocal) {
+    TypeParam *main = &TypeParam::getThreadLocal();
+    ASSERT_EQ(main, &TypeParam::getThreadLocal());
+
+    TypeParam *other = nullptr;
+    uint64_t otherValue = 0;
+    std::thread thread([&] {
+        other = &TypeParam::getThreadLocal();
+        otherValue = other->next();
+    });
+    thread.join();
+
+    ASSERT_NE(main, other);
+    ASSERT_NE(main->next(), otherValue);
+}
+
+TEST(SecureRandomTest, Fill) {
+    getSecureRandomBytes({});
+
+    for (size_t size : { 1, 16, 255, 256, 257, 4096, 1 << 20 }) {
+        SCOPED_TRACE(size);
+
+        std::vector<uint8_t> a(size + 1, 0);
+        std::vector<uint8_t> b(size, 0);
+        getSecureRandomBytes({ a.data(), size });
+        getSecureRandomBytes(b);
+
+        // a single byte can collide by chance, anything larger should not
+        if (size >= 16) {
+            ASSERT_NE(memcmp(a.data(), b.data(), size), 0);
+        }
+
+        ASSERT_EQ(a[size], 0);
+    }
+}
+
+TEST(SecureRandomTest, ByteDistribution) {
+    static constexpr size_t kSize = 1 << 20;
+
+    std::vector<uint8_t> buffer(kSize);
+    getSecureRandomBytes(buffer);
+
+    size_t counts[256] = {};
+    for (uint8_t byte : buffer)
+        counts[byte] += 1;
+
+    // not seeded so this is not deterministic, the wider limit keeps false failures negligible
+    ASSERT_LT(chiSquared(counts, kSize), getChiSquaredLimit(255) * 1.5);
+}
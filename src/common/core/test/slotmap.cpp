@@ -0,0 +1,193 @@
+#include "gtest_common.hpp"
+
+#include "core/slotmap.hpp"
+
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace sm;
+
+using Handle = GenerationalSlotMap<int>::Handle;
+
+// counts live instances so leaked or double destroyed entries show up
+struct Counted {
+    static inline std::atomic<int> gLive = 0;
+
+    size_t value;
+
+    Counted(size_t value) noexcept : value(value) { gLive += 1; }
+    ~Counted() noexcept { gLive -= 1; }
+};
+
+TEST(GenerationalSlotMapTest, AllocAndRelease) {
+    GenerationalSlotMap<int> map{100};
+    ASSERT_EQ(map.capacity(), 100);
+    ASSERT_EQ(map.size(), 0);
+
+    std::vector<Handle> handles;
+    for (int i = 0; i < 100; i++) {
+        Handle handle = map.alloc(i);
+        ASSERT_TRUE(handle.isValid());
+        ASSERT_EQ(*map.get(handle), i);
+        handles.push_back(handle);
+    }
+
+    ASSERT_EQ(map.size(), 100);
+    ASSERT_FALSE(map.alloc(100).isValid());
+
+    for (Handle handle : handles)
+        ASSERT_TRUE(map.release(handle));
+
+    ASSERT_EQ(map.size(), 0);
+    ASSERT_TRUE(map.alloc(0).isValid());
+}
+
+TEST(GenerationalSlotMapTest, StaleHandles) {
+    GenerationalSlotMap<int> map{1};
+
+    Handle first = map.alloc(1);
+    ASSERT_TRUE(map.release(first));
+    ASSERT_FALSE(map.release(first));
+    ASSERT_EQ(map.get(first), nullptr);
+
+    // the slot is reused, but the old handle does not see the new value
+    Handle second = map.alloc(2);
+    ASSERT_EQ(second.index, first.index);
+    ASSERT_NE(second, first);
+    ASSERT_FALSE(map.contains(first));
+    ASSERT_FALSE(map.release(first));
+    ASSERT_EQ(*map.get(second), 2);
+
+    ASSERT_FALSE(map.contains(Handle { }));
+    ASSERT_FALSE(map.contains(Handle { 5, 1 }));
+}
+
+TEST(GenerationalSlotMapTest, IterateLiveEntries) {
+    GenerationalSlotMap<int> map{300};
+
+    std::vector<Handle> handles;
+    for (int i = 0; i < 300; i++)
+        handles.push_back(map.alloc(i));
+
+    for (int i = 0; i < 300; i++) {
+        if (i % 7 != 0)
+            map.release(handles[i]);
+    }
+
+    std::vector<int> seen;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        ASSERT_EQ(it.handle(), handles[*it]);
+        seen.push_back(*it);
+    }
+
+    ASSERT_EQ(seen.size(), map.size());
+    for (size_t i = 0; i < seen.size(); i++)
+        ASSERT_EQ(seen[i], int(i * 7));
+
+    GenerationalSlotMap<int> empty{10};
+    ASSERT_EQ(empty.begin(), empty.end());
+}
+
+TEST(GenerationalSlotMapTest, Lifetimes) {
+    {
+        GenerationalSlotMap<Counted> map{64};
+        std::vector<GenerationalSlotMap<Counted>::Handle> handles;
+        for (size_t i = 0; i < 64; i++)
+            handles.push_back(map.alloc(i));
+
+        for (size_t i = 0; i < 64; i += 2)
+            map.release(handles[i]);
+
+        ASSERT_EQ(Counted::gLive, 32);
+    }
+
+    ASSERT_EQ(Counted::gLive, 0);
+}
+
+TEST(GenerationalSlotMapTest, ConcurrentAllocRelease) {
+    static constexpr size_t kThreads = 8;
+    static constexpr size_t kCapacity = 1024;
+    static constexpr size_t kOperations = 200000;
+
+    GenerationalSlotMap<Counted> map{kCapacity};
+    std::atomic<size_t> failures = 0;
+
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 0; t < kThreads; t++) {
+            threads.emplace_back([&, t] {
+                std::mt19937 rng{uint32_t(t)};
+                std::vector<std::pair<GenerationalSlotMap<Counted>::Handle, size_t>> owned;
+                std::vector<GenerationalSlotMap<Counted>::Handle> released;
+
+                for (size_t i = 0; i < kOperations; i++) {
+                    // more threads want slots than there are slots, so the map runs full
+                    if (owned.empty() || rng() % 2 == 0) {
+                        size_t value = t * kOperations + i;
+                        auto handle = map.alloc(value);
+                        if (handle.isValid())
+                            owned.emplace_back(handle, value);
+
+                        continue;
+                    }
+
+                    size_t pick = rng() % owned.size();
+                    auto [handle, value] = owned[pick];
+                    owned[pick] = owned.back();
+                    owned.pop_back();
+
+                    // nobody else can have reused our slot while we still own it
+                    const Counted *entry = map.get(handle);
+                    if (entry == nullptr || entry->value != value || !map.release(handle))
+                        failures += 1;
+
+                    released.push_back(handle);
+
+                    // every handle we already released must stay dead, even after the slot is reused
+                    auto stale = released[rng() % released.size()];
+                    if (map.release(stale))
+                        failures += 1;
+                }
+
+                for (auto [handle, value] : owned) {
+                    if (!map.release(handle))
+                        failures += 1;
+                }
+            });
+        }
+    }
+
+    ASSERT_EQ(failures, 0);
+    ASSERT_EQ(map.size(), 0);
+    ASSERT_EQ(Counted::gLive, 0);
+
+    // every slot made it back onto the free list exactly once
+    std::set<uint32_t> indices;
+    for (size_t i = 0; i < kCapacity; i++)
+        indices.insert(map.alloc(i).index);
+
+    ASSERT_EQ(indices.size(), kCapacity);
+    ASSERT_FALSE(map.alloc(0).isValid());
+}
+
+TEST(GenerationalSlotMapTest, RacingRelease) {
+    static constexpr size_t kThreads = 8;
+
+    GenerationalSlotMap<int> map{16};
+
+    for (size_t round = 0; round < 1000; round++) {
+        Handle handle = map.alloc(int(round));
+        std::atomic<size_t> wins = 0;
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t t = 0; t < kThreads; t++)
+                threads.emplace_back([&] { wins += map.release(handle); });
+        }
+
+        ASSERT_EQ(wins, 1);
+    }
+
+    ASSERT_EQ(map.size(), 0);
+}
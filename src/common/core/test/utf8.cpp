@@ -0,0 +1,195 @@
+#include "gtest_common.hpp"
+
+#include "core/utf8.hpp"
+
+#include <stdint.h>
+
+using namespace sm;
+
+using Bytes = std::u8string;
+
+// straight from the table of well formed byte sequences in the unicode standard
+static size_t referenceValidate(const Bytes& text) {
+    size_t i = 0;
+    while (i < text.size()) {
+        uint8_t b = text[i];
+        size_t length;
+        uint8_t lo = 0x80, hi = 0xBF;
+
+        if (b <= 0x7F) { i += 1; continue; }
+        else if (b >= 0xC2 && b <= 0xDF) { length = 2; }
+        else if (b == 0xE0) { length = 3; lo = 0xA0; }
+        else if (b >= 0xE1 && b <= 0xEC) { length = 3; }
+        else if (b == 0xED) { length = 3; hi = 0x9F; }
+        else if (b >= 0xEE && b <= 0xEF) { length = 3; }
+        else if (b == 0xF0) { length = 4; lo = 0x90; }
+        else if (b >= 0xF1 && b <= 0xF3) { length = 4; }
+        else if (b == 0xF4) { length = 4; hi = 0x8F; }
+        else { return i; }
+
+        if (i + length > text.size())
+            return i;
+
+        if (text[i + 1] < lo || text[i + 1] > hi)
+            return i;
+
+        for (size_t j = 2; j < length; j++) {
+            if ((text[i + j] & 0xC0) != 0x80)
+                return i;
+        }
+
+        i += length;
+    }
+
+    return SIZE_MAX;
+}
+
+static size_t validate(const Bytes& text) {
+    return utf8::validate(text.data(), text.size());
+}
+
+static Bytes encode(char32_t codepoint) {
+    char8_t buffer[4];
+    size_t size = utf8::fromUtf32(&codepoint, 1, buffer);
+    return Bytes(buffer, size);
+}
+
+TEST(Utf8Test, ValidText) {
+    ASSERT_EQ(validate(u8""), SIZE_MAX);
+    ASSERT_EQ(validate(u8"hello world"), SIZE_MAX);
+    ASSERT_EQ(validate(u8"été € \U0001F600 日本語"), SIZE_MAX);
+    ASSERT_EQ(validate(Bytes(1000, u8'a') + u8"\U0010FFFF"), SIZE_MAX);
+}
+
+TEST(Utf8Test, RejectsMalformed) {
+    struct Case { Bytes text; size_t offset; };
+
+    Case cases[] = {
+        // overlong
+        { { 0xC0, 0x80 }, 0 },
+        { { 0xC1, 0xBF }, 0 },
+        { { 'a', 0xE0, 0x80, 0x80 }, 1 },
+        { { 0xE0, 0x9F, 0xBF }, 0 },
+        { { 0xF0, 0x80, 0x80, 0x80 }, 0 },
+        { { 0xF0, 0x8F, 0xBF, 0xBF }, 0 },
+
+        // surrogates
+        { { 0xED, 0xA0, 0x80 }, 0 },
+        { { 0xED, 0xBF, 0xBF }, 0 },
+
+        // past U+10FFFF
+        { { 0xF4, 0x90, 0x80, 0x80 }, 0 },
+        { { 0xF5, 0x80, 0x80, 0x80 }, 0 },
+        { { 0xFF }, 0 },
+
+        // truncated
+        { { 'a', 'b', 0xE2, 0x82 }, 2 },
+        { { 0xF0, 0x9F, 0x98 }, 0 },
+        { { 0xC3 }, 0 },
+        { { 0xE2, 0x82, 'a' }, 0 },
+
+        // stray continuation
+        { { 'a', 0x80 }, 1 },
+        { { 0xC3, 0xA9, 0xA9 }, 2 },
+    };
+
+    for (const Case& c : cases) {
+        ASSERT_EQ(referenceValidate(c.text), c.offset);
+        ASSERT_EQ(validate(c.text), c.offset);
+    }
+}
+
+// move every short sequence across the vector block boundaries
+TEST(Utf8Test, MatchesReferenceAtEveryOffset) {
+    // the edges of every second byte range in the well formed table
+    static constexpr uint8_t kSecond[] = { 0x00, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xFF };
+
+    std::vector<Bytes> sequences;
+    for (int a = 0x80; a <= 0xFF; a++) {
+        sequences.push_back({ char8_t(a) });
+        for (uint8_t b : kSecond) {
+            sequences.push_back({ char8_t(a), char8_t(b) });
+            sequences.push_back({ char8_t(a), char8_t(b), 0x80 });
+            sequences.push_back({ char8_t(a), char8_t(b), 0x80, 0xBF });
+        }
+    }
+
+    for (const Bytes& sequence : sequences) {
+        for (size_t offset = 0; offset < 70; offset++) {
+            for (size_t tail : { 0, 40 }) {
+                Bytes text = Bytes(offset, u8'x') + sequence + Bytes(tail, u8'y');
+                ASSERT_EQ(validate(text), referenceValidate(text)) << "offset " << offset << " tail " << tail;
+            }
+        }
+    }
+}
+
+TEST(Utf8Test, CountCodepoints) {
+    Bytes text;
+    size_t expected = 0;
+    for (char32_t c = 0; c < 0x110000; c += 97) {
+        if (c >= 0xD800 && c <= 0xDFFF)
+            continue;
+
+        text += encode(c);
+        expected += 1;
+    }
+
+    ASSERT_EQ(utf8::countCodepoints(text.data(), text.size()), expected);
+
+    size_t iterated = 0;
+    for (char32_t c : utf8::StaticText(text.data(), text.size())) {
+        (void)c;
+        iterated += 1;
+    }
+
+    ASSERT_EQ(iterated, expected);
+}
+
+TEST(Utf8Test, RoundTripEveryCodepoint) {
+    std::u32string codepoints;
+    for (char32_t c = 0; c < 0x110000; c++) {
+        if (c >= 0xD800 && c <= 0xDFFF)
+            continue;
+
+        codepoints.push_back(c);
+    }
+
+    Bytes text(codepoints.size() * 4, 0);
+    text.resize(utf8::fromUtf32(codepoints.data(), codepoints.size(), text.data()));
+    ASSERT_EQ(validate(text), SIZE_MAX);
+
+    std::u32string wide(text.size(), 0);
+    wide.resize(utf8::toUtf32(text.data(), text.size(), wide.data()));
+    ASSERT_EQ(wide, codepoints);
+
+    std::u16string utf16(text.size(), 0);
+    utf16.resize(utf8::toUtf16(text.data(), text.size(), utf16.data()));
+
+    Bytes back(utf16.size() * 3, 0);
+    back.resize(utf8::fromUtf16(utf16.data(), utf16.size(), back.data()));
+    ASSERT_EQ(back, text);
+}
+
+TEST(Utf8Test, ReplacesInvalidSequences) {
+    // a truncated sequence is replaced once, not once per byte
+    Bytes text = { 'a', 0xE2, 0x82, 'b', 0xFF, 0xED, 0xA0, 0x80 };
+
+    std::u16string utf16(text.size(), 0);
+    utf16.resize(utf8::toUtf16(text.data(), text.size(), utf16.data()));
+    ASSERT_EQ(utf16, u"a�b����");
+
+    // unpaired surrogates
+    std::u16string surrogates = { u'a', char16_t(0xD800), u'b', char16_t(0xDC00) };
+    Bytes narrow(surrogates.size() * 3, 0);
+    narrow.resize(utf8::fromUtf16(surrogates.data(), surrogates.size(), narrow.data()));
+    ASSERT_EQ(narrow, u8"a�b�");
+}
+
+TEST(Utf8Test, NarrowWiden) {
+    std::string text = "plain ascii, then \xc3\xa9t\xc3\xa9 and \xf0\x9f\x98\x80";
+    std::wstring wide = sm::widen(text);
+
+    ASSERT_EQ(wide, L"plain ascii, then été and \U0001F600");
+    ASSERT_EQ(sm::narrow(wide), text);
+}
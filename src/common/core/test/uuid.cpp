@@ -1,8 +1,11 @@
 #include "gtest_common.hpp"
 
 #include "core/uuid.hpp"
+#include "core/random.hpp"
 
 #include <array>
+#include <cmath>
+#include <unordered_set>
 
 using uuid = sm::uuid;
 using rfc9562_clock = sm::detail::rfc9562_clock;
@@ -230,3 +233,161 @@ TEST(UuidTest, ParseMicrosoftNoPartialWrite) {
         EXPECT_EQ(uuid::max(), out);
     }
 }
+
+static std::vector<uuid> getRandomUuids(size_t count) {
+    sm::Random rng{1234};
+
+    std::vector<uuid> result(count);
+    for (uuid& it : result)
+        rng.nextBytes(it.octets);
+
+    return result;
+}
+
+TEST(UuidTest, FormatRoundTrip) {
+    for (const uuid& before : getRandomUuids(10000)) {
+        char buffer[uuid::kStringSize + 1] = {};
+        uuid::strfuid(buffer, before);
+
+        ASSERT_EQ(std::string_view(before.toString().c_str()), buffer);
+
+        uuid after = uuid::nil();
+        ASSERT_TRUE(uuid::parse(buffer, after)) << buffer;
+        ASSERT_EQ(before, after) << buffer;
+
+        // upper case digits parse the same
+        std::string upper = buffer;
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) { return (char)std::toupper(c); });
+        ASSERT_TRUE(uuid::parse(upper.c_str(), after)) << upper;
+        ASSERT_EQ(before, after) << upper;
+
+        std::string microsoft = fmt::format("{{{}}}", buffer);
+        ASSERT_TRUE(uuid::parseMicrosoft(microsoft.c_str(), after)) << microsoft;
+        ASSERT_EQ(before, after) << microsoft;
+
+        std::string hex = buffer;
+        std::erase(hex, '-');
+        ASSERT_TRUE(uuid::parseHex(hex.c_str(), after)) << hex;
+        ASSERT_EQ(before, after) << hex;
+
+        for (const std::string& any : { std::string(buffer), microsoft, hex }) {
+            std::array<char, uuid::kMaxStringSize> padded{};
+            std::copy(any.begin(), any.end(), padded.begin());
+
+            ASSERT_TRUE(uuid::parseAny(padded.data(), after)) << any;
+            ASSERT_EQ(before, after) << any;
+        }
+    }
+}
+
+static bool isSeparator(size_t index) {
+    return index == 8 || index == 13 || index == 18 || index == 23;
+}
+
+TEST(UuidTest, ParseEveryCharacter) {
+    // every byte value at every position, only hex digits and separators in the right places are accepted
+    static constexpr std::string_view kValid = "10b11760-bb0b-11ef-9234-bca3230a8f12";
+
+    for (size_t index = 0; index < uuid::kStringSize; index++) {
+        for (int c = 0; c < 256; c++) {
+            std::array<char, uuid::kStringSize> buffer;
+            std::copy(kValid.begin(), kValid.end(), buffer.begin());
+            buffer[index] = char(c);
+
+            bool expected = isSeparator(index) ? (c == '-') : (std::isxdigit(c) != 0);
+
+            uuid out = uuid::max();
+            ASSERT_EQ(expected, uuid::parse(buffer.data(), out)) << index << " " << c;
+
+            if (!expected)
+                ASSERT_EQ(uuid::max(), out);
+        }
+    }
+}
+
+TEST(UuidTest, ParseHexEveryCharacter) {
+    static constexpr std::string_view kValid = "10b11760bb0b11ef9234bca3230a8f12";
+
+    for (size_t index = 0; index < uuid::kHexStringSize; index++) {
+        for (int c = 0; c < 256; c++) {
+            std::array<char, uuid::kHexStringSize> buffer;
+            std::copy(kValid.begin(), kValid.end(), buffer.begin());
+            buffer[index] = char(c);
+
+            uuid out = uuid::nil();
+            ASSERT_EQ(std::isxdigit(c) != 0, uuid::parseHex(buffer.data(), out)) << index << " " << c;
+        }
+    }
+}
+
+TEST(UuidTest, HashAvalanche) {
+    // flipping any input bit should flip each output bit about half the time
+    static constexpr size_t kSamples = 2000;
+    std::hash<uuid> hash;
+
+    std::vector<uuid> inputs = getRandomUuids(kSamples);
+    for (size_t bit = 0; bit < 128; bit++) {
+        size_t flips[64] = {};
+        for (const uuid& input : inputs) {
+            uuid flipped = input;
+            flipped.octets[bit / 8] ^= uint8_t(1 << (bit % 8));
+
+            size_t diff = hash(input) ^ hash(flipped);
+            for (size_t out = 0; out < 64; out++)
+                flips[out] += (diff >> out) & 1;
+        }
+
+        for (size_t out = 0; out < 64; out++) {
+            double ratio = double(flips[out]) / kSamples;
+            ASSERT_NEAR(ratio, 0.5, 0.1) << "input bit " << bit << " output bit " << out;
+        }
+    }
+}
+
+TEST(UuidTest, HashCollisions) {
+    // structured keys, v7 style ids that share a timestamp and count up, and ids that differ in one field
+    static constexpr size_t kCount = 1 << 18;
+    static constexpr size_t kBuckets = 1 << 12;
+
+    auto check = [](auto&& make) {
+        std::hash<uuid> hash;
+        std::unordered_set<size_t> seen;
+        std::vector<size_t> buckets(kBuckets);
+
+        for (size_t i = 0; i < kCount; i++) {
+            size_t value = hash(make(i));
+            ASSERT_TRUE(seen.insert(value).second) << i;
+
+            // the low bits are what hash tables bucket on
+            buckets[value % kBuckets] += 1;
+        }
+
+        double expected = double(kCount) / kBuckets;
+        double chi = 0.0;
+        for (size_t count : buckets)
+            chi += (count - expected) * (count - expected) / expected;
+
+        // about 5 standard deviations above the expected value
+        ASSERT_LT(chi, kBuckets + 5.0 * std::sqrt(2.0 * kBuckets));
+    };
+
+    check([](size_t i) {
+        uuid it = uuid::of(0x0193d338, 0x17d8, 0x7ff3, 0x9a19, 0);
+        it.octets[15] = uint8_t(i);
+        it.octets[14] = uint8_t(i >> 8);
+        it.octets[13] = uint8_t(i >> 16);
+        return it;
+    });
+
+    check([](size_t i) {
+        return uuid::of(uint32_t(i), 0xbb0b, 0x11ef, 0x9234, 0xbca3230a8f12);
+    });
+
+    check([](size_t i) {
+        uuid it = uuid::nil();
+        it.octets[0] = uint8_t(i);
+        it.octets[8] = uint8_t(i >> 8);
+        it.octets[15] = uint8_t(i >> 16);
+        return it;
+    });
+}
@@ -0,0 +1,191 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "math/batch.hpp"
+
+#include <fmtlib/format.h>
+
+#include <random>
+
+using namespace sm::math;
+
+using batch::Isa;
+
+// a large scene worth of entities
+static constexpr size_t kCount = 100'000;
+
+static const char *getIsaName(Isa isa) {
+    switch (isa) {
+    case Isa::eScalar: return "scalar";
+    case Isa::eSse2: return "sse2";
+    case Isa::eAvx2: return "avx2";
+    case Isa::eAvx512: return "avx512";
+    default: return "unknown";
+    }
+}
+
+struct Scene {
+    // the same data both ways, per element types for the operator overloads and split arrays for the kernels
+    std::vector<float3> positions;
+    std::vector<float> radii;
+    std::vector<quatf> rotations;
+    std::vector<degf> angles;
+
+    std::vector<float> x, y, z, r;
+    std::vector<float> qx, qy, qz, qw;
+
+    std::vector<float3> outPositions;
+    std::vector<float> outX, outY, outZ;
+    std::vector<uint8_t> visible;
+    std::vector<radf> outAngles;
+
+    float4x4 transform = float4x4::transform(float3(1.f, 2.f, 3.f), quatf::fromAxisAngle(float3(0.f, 1.f, 0.f), radf(0.5f)), float3(2.f));
+
+    Frustum frustum = [] {
+        float4x4 view = float4x4::lookToRH(float3(0.f, 0.f, 10.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f));
+        float4x4 projection = float4x4::perspectiveRH(radf(1.2f), 1.5f, 0.1f, 100.f);
+        return Frustum::fromViewProjection((view * projection).transpose());
+    }();
+
+    Scene() {
+        std::mt19937 rng{1234};
+        std::uniform_real_distribution<float> dist{-50.f, 50.f};
+        std::uniform_real_distribution<float> unit{-1.f, 1.f};
+
+        for (size_t i = 0; i < kCount; i++) {
+            float3 position = { dist(rng), dist(rng), dist(rng) };
+            float radius = std::abs(unit(rng)) * 5.f;
+            quatf rotation = { unit(rng), unit(rng), unit(rng), unit(rng) };
+
+            positions.push_back(position);
+            radii.push_back(radius);
+            rotations.push_back(rotation);
+            angles.push_back(degf(dist(rng) * 7.f));
+
+            x.push_back(position.x);
+            y.push_back(position.y);
+            z.push_back(position.z);
+            r.push_back(radius);
+
+            qx.push_back(rotation.v.x);
+            qy.push_back(rotation.v.y);
+            qz.push_back(rotation.v.z);
+            qw.push_back(rotation.w);
+        }
+
+        outPositions.resize(kCount);
+        outX.resize(kCount);
+        outY.resize(kCount);
+        outZ.resize(kCount);
+        visible.resize(kCount);
+        outAngles.resize(kCount);
+    }
+
+    SoaVec3<const float> points() const { return { x.data(), y.data(), z.data() }; }
+    SoaVec4<const float> spheres() const { return { x.data(), y.data(), z.data(), r.data() }; }
+    SoaVec4<float> quats() { return { qx.data(), qy.data(), qz.data(), qw.data() }; }
+};
+
+TEST_CASE("Batch transform") {
+    Scene scene;
+
+    BENCHMARK("per element operators") {
+        for (size_t i = 0; i < kCount; i++)
+            scene.outPositions[i] = scene.transform.mul(float4(scene.positions[i], 1.f)).xyz();
+        return scene.outPositions[kCount - 1];
+    };
+
+    Isa supported = batch::getSupportedIsa();
+    for (Isa isa : { Isa::eScalar, Isa::eSse2, Isa::eAvx2, Isa::eAvx512 }) {
+        if (!batch::setIsa(isa))
+            continue;
+
+        BENCHMARK(fmt::format("batch {}", getIsaName(isa))) {
+            batch::transformPoints(scene.transform, scene.points(), { scene.outX.data(), scene.outY.data(), scene.outZ.data() }, kCount);
+            return scene.outX[kCount - 1];
+        };
+    }
+
+    batch::setIsa(supported);
+}
+
+TEST_CASE("Batch sphere culling") {
+    Scene scene;
+
+    BENCHMARK("per element operators") {
+        size_t total = 0;
+        for (size_t i = 0; i < kCount; i++) {
+            float4 center = float4(scene.positions[i], 1.f);
+            bool inside = true;
+            for (const float4& plane : scene.frustum.planes)
+                inside &= float4::dot(plane, center).x >= -scene.radii[i];
+
+            scene.visible[i] = inside;
+            total += inside;
+        }
+        return total;
+    };
+
+    Isa supported = batch::getSupportedIsa();
+    for (Isa isa : { Isa::eScalar, Isa::eSse2, Isa::eAvx2, Isa::eAvx512 }) {
+        if (!batch::setIsa(isa))
+            continue;
+
+        BENCHMARK(fmt::format("batch {}", getIsaName(isa))) {
+            return batch::cullSpheres(scene.frustum, scene.spheres(), scene.visible.data(), kCount);
+        };
+    }
+
+    batch::setIsa(supported);
+}
+
+TEST_CASE("Batch quaternion normalize") {
+    Scene scene;
+
+    // normalizing is idempotent, so every run after the first does the same work on the same data
+    BENCHMARK("per element operators") {
+        for (size_t i = 0; i < kCount; i++) {
+            quatf& q = scene.rotations[i];
+            float4 n = float4(q.v, q.w).normalized();
+            q = quatf(n.x, n.y, n.z, n.w);
+        }
+        return scene.rotations[kCount - 1].w;
+    };
+
+    Isa supported = batch::getSupportedIsa();
+    for (Isa isa : { Isa::eScalar, Isa::eSse2, Isa::eAvx2, Isa::eAvx512 }) {
+        if (!batch::setIsa(isa))
+            continue;
+
+        BENCHMARK(fmt::format("batch {}", getIsaName(isa))) {
+            batch::normalizeQuats(scene.quats(), kCount);
+            return scene.qw[kCount - 1];
+        };
+    }
+
+    batch::setIsa(supported);
+}
+
+TEST_CASE("Batch angle conversion") {
+    Scene scene;
+
+    BENCHMARK("per element operators") {
+        for (size_t i = 0; i < kCount; i++)
+            scene.outAngles[i] = scene.angles[i];
+        return scene.outAngles[kCount - 1];
+    };
+
+    Isa supported = batch::getSupportedIsa();
+    for (Isa isa : { Isa::eScalar, Isa::eSse2, Isa::eAvx2, Isa::eAvx512 }) {
+        if (!batch::setIsa(isa))
+            continue;
+
+        BENCHMARK(fmt::format("batch {}", getIsaName(isa))) {
+            batch::toRadians(scene.angles.data(), scene.outAngles.data(), kCount);
+            return scene.outAngles[kCount - 1];
+        };
+    }
+
+    batch::setIsa(supported);
+}
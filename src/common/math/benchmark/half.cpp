@@ -0,0 +1,142 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "math/half.hpp"
+#include "math/batch.hpp"
+
+#include <fmtlib/format.h>
+
+#include <random>
+
+using namespace sm::math;
+
+using batch::Isa;
+
+// about the size of a large vertex buffer
+static constexpr size_t kCount = 1'000'000;
+
+static const char *getIsaName(Isa isa) {
+    switch (isa) {
+    case Isa::eScalar: return "scalar";
+    case Isa::eSse2: return "sse2";
+    case Isa::eAvx2: return "avx2";
+    case Isa::eAvx512: return "avx512";
+    default: return "unknown";
+    }
+}
+
+/// benchmark @a fn once for each instruction set this machine supports
+template<typename F>
+static void benchEachIsa(F&& fn) {
+    Isa supported = batch::getSupportedIsa();
+    for (Isa isa : { Isa::eScalar, Isa::eAvx2, Isa::eAvx512 }) {
+        if (!batch::setIsa(isa))
+            continue;
+
+        BENCHMARK(fmt::format("bulk {}", getIsaName(isa))) {
+            return fn();
+        };
+    }
+
+    batch::setIsa(supported);
+}
+
+static std::vector<float> getValues(float min, float max) {
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> dist{min, max};
+
+    std::vector<float> values(kCount);
+    for (float& value : values)
+        value = dist(rng);
+
+    return values;
+}
+
+TEST_CASE("Float to half") {
+    std::vector<float> values = getValues(-1000.f, 1000.f);
+    std::vector<half> halves(kCount);
+
+    BENCHMARK("per element compiler conversion") {
+        for (size_t i = 0; i < kCount; i++)
+            halves[i] = half(values[i]);
+        return halves[kCount - 1];
+    };
+
+    benchEachIsa([&] {
+        toHalf(values, halves);
+        return halves[kCount - 1];
+    });
+}
+
+TEST_CASE("Half to float") {
+    std::vector<float> values = getValues(-1000.f, 1000.f);
+    std::vector<half> halves(kCount);
+    std::vector<float> floats(kCount);
+    toHalf(values, halves);
+
+    BENCHMARK("per element compiler conversion") {
+        for (size_t i = 0; i < kCount; i++)
+            floats[i] = float(halves[i]);
+        return floats[kCount - 1];
+    };
+
+    benchEachIsa([&] {
+        fromHalf(halves, floats);
+        return floats[kCount - 1];
+    });
+}
+
+TEST_CASE("Float to bfloat16") {
+    std::vector<float> values = getValues(-1000.f, 1000.f);
+    std::vector<bfloat16> packed(kCount);
+
+    benchEachIsa([&] {
+        toBFloat16(values, packed);
+        return packed[kCount - 1].bits;
+    });
+}
+
+TEST_CASE("Snorm8 quantize") {
+    std::vector<float> values = getValues(-1.2f, 1.2f);
+    std::vector<int8_t> quantized(kCount);
+    std::vector<float> floats(kCount);
+
+    BENCHMARK("per element quantize") {
+        for (size_t i = 0; i < kCount; i++)
+            quantized[i] = toSnorm<int8_t>(values[i]);
+        return quantized[kCount - 1];
+    };
+
+    benchEachIsa([&] {
+        toSnorm(values, quantized);
+        return quantized[kCount - 1];
+    });
+
+    BENCHMARK("per element dequantize") {
+        for (size_t i = 0; i < kCount; i++)
+            floats[i] = fromSnorm(quantized[i]);
+        return floats[kCount - 1];
+    };
+
+    benchEachIsa([&] {
+        fromSnorm(quantized, floats);
+        return floats[kCount - 1];
+    });
+}
+
+TEST_CASE("Unorm16 quantize") {
+    std::vector<float> values = getValues(-0.2f, 1.2f);
+    std::vector<uint16_t> quantized(kCount);
+
+    BENCHMARK("per element quantize") {
+        for (size_t i = 0; i < kCount; i++)
+            quantized[i] = toUnorm<uint16_t>(values[i]);
+        return quantized[kCount - 1];
+    };
+
+    benchEachIsa([&] {
+        toUnorm(values, quantized);
+        return quantized[kCount - 1];
+    });
+}
@@ -0,0 +1,121 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "math/math.hpp"
+
+#include <random>
+
+using namespace sm::math;
+
+// enough transforms to leave the l1 cache, like a frame of physics bodies
+static constexpr size_t kCount = 4096;
+
+struct Inputs {
+    std::vector<float4x4> lhs;
+    std::vector<float4x4> rhs;
+    std::vector<float4> points;
+    std::vector<float4x4> out;
+    std::vector<float4> outPoints;
+
+    Inputs() {
+        std::mt19937 rng{1234};
+        std::uniform_real_distribution<float> dist{-1.f, 1.f};
+        auto vec = [&] { return float4(dist(rng), dist(rng), dist(rng), dist(rng)); };
+        auto mat = [&] {
+            float4x4 m = float4x4(vec(), vec(), vec(), vec());
+            for (size_t i = 0; i < 4; i++)
+                m[i, i] += 4.f;
+            return m;
+        };
+
+        for (size_t i = 0; i < kCount; i++) {
+            lhs.push_back(mat());
+            rhs.push_back(mat());
+            points.push_back(vec());
+        }
+
+        out.resize(kCount);
+        outPoints.resize(kCount);
+    }
+};
+
+TEST_CASE("Matrix throughput") {
+    Inputs in;
+
+    BENCHMARK("mul scalar") {
+        for (size_t i = 0; i < kCount; i++)
+            in.out[i] = in.lhs[i].mul_scalar(in.rhs[i]);
+        return in.out[kCount - 1];
+    };
+
+    BENCHMARK("mul") {
+        for (size_t i = 0; i < kCount; i++)
+            in.out[i] = in.lhs[i].mul(in.rhs[i]);
+        return in.out[kCount - 1];
+    };
+
+    BENCHMARK("mul vector scalar") {
+        for (size_t i = 0; i < kCount; i++)
+            in.outPoints[i] = in.lhs[i].mul_scalar(in.points[i]);
+        return in.outPoints[kCount - 1];
+    };
+
+    BENCHMARK("mul vector") {
+        for (size_t i = 0; i < kCount; i++)
+            in.outPoints[i] = in.lhs[i].mul(in.points[i]);
+        return in.outPoints[kCount - 1];
+    };
+
+    BENCHMARK("transpose scalar") {
+        for (size_t i = 0; i < kCount; i++)
+            in.out[i] = in.lhs[i].transpose_scalar();
+        return in.out[kCount - 1];
+    };
+
+    BENCHMARK("transpose") {
+        for (size_t i = 0; i < kCount; i++)
+            in.out[i] = in.lhs[i].transpose();
+        return in.out[kCount - 1];
+    };
+
+    BENCHMARK("inverse scalar") {
+        for (size_t i = 0; i < kCount; i++)
+            in.out[i] = in.lhs[i].inverse_scalar();
+        return in.out[kCount - 1];
+    };
+
+    BENCHMARK("inverse") {
+        for (size_t i = 0; i < kCount; i++)
+            in.out[i] = in.lhs[i].inverse();
+        return in.out[kCount - 1];
+    };
+}
+
+TEST_CASE("Vector throughput") {
+    Inputs in;
+
+    BENCHMARK("dot scalar") {
+        for (size_t i = 0; i < kCount; i++)
+            in.outPoints[i] = float4::dot_scalar(in.points[i], in.lhs[i].rows[0]);
+        return in.outPoints[kCount - 1];
+    };
+
+    BENCHMARK("dot") {
+        for (size_t i = 0; i < kCount; i++)
+            in.outPoints[i] = float4::dot(in.points[i], in.lhs[i].rows[0]);
+        return in.outPoints[kCount - 1];
+    };
+
+    BENCHMARK("cross scalar") {
+        for (size_t i = 0; i < kCount; i++)
+            in.outPoints[i] = float4::cross_scalar(in.points[i], in.lhs[i].rows[0]);
+        return in.outPoints[kCount - 1];
+    };
+
+    BENCHMARK("cross") {
+        for (size_t i = 0; i < kCount; i++)
+            in.outPoints[i] = float4::cross(in.points[i], in.lhs[i].rows[0]);
+        return in.outPoints[kCount - 1];
+    };
+}
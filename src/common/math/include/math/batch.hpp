@@ -0,0 +1,93 @@
+#pragma once
+
+#include "math/math.hpp"
+
+namespace sm::math {
+    /// @brief a structure of arrays view over vectors, every component has its own array
+    template<typename T>
+    struct SoaVec3 {
+        T *x;
+        T *y;
+        T *z;
+    };
+
+    template<typename T>
+    struct SoaVec4 {
+        T *x;
+        T *y;
+        T *z;
+        T *w;
+    };
+
+    /// @brief the six planes of a view frustum
+    ///
+    /// planes are normalized and face inwards, xyz is the normal and w the distance.
+    /// a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+    struct Frustum {
+        enum Plane { eLeft, eRight, eBottom, eTop, eNear, eFar, eCount };
+
+        float4 planes[eCount];
+
+        /// @brief extract the planes from a view projection matrix
+        ///
+        /// the matrix is applied the same way as Mat4x4::mul, clip = viewProjection * p.
+        /// clip space depth is expected to be in [0, 1] as produced by perspectiveRH,
+        /// matrices built for row vectors such as view * projection need to be transposed first.
+        static Frustum fromViewProjection(const float4x4& viewProjection) noexcept;
+    };
+}
+
+/// bulk operations over structure of arrays data.
+/// every function picks the widest kernel the cpu supports the first time any of them is called.
+/// results match the per element scalar code exactly on the scalar and sse2 kernels,
+/// the avx2 and avx512 kernels use fused multiply add and may differ by a few ulps.
+/// arrays are fastest when they all have the same offset from a 64 byte boundary.
+namespace sm::math::batch {
+    enum class Isa {
+        eScalar,
+        eSse2,
+        eAvx2,
+        eAvx512
+    };
+
+    /// @brief the widest instruction set the kernels can use on this machine
+    /// @note the avx2 kernels also need fma and f16c
+    Isa getSupportedIsa() noexcept;
+
+    /// @brief the instruction set the kernels are currently using
+    Isa getIsa() noexcept;
+
+    /// @brief limit the kernels to a narrower instruction set, for testing and benchmarking
+    /// @return false if @a isa is not supported on this machine, the kernels are unchanged
+    bool setIsa(Isa isa) noexcept;
+
+    /// @brief transform points by a matrix, dst = matrix * float4(src, 1)
+    /// @note @a dst may alias @a src, the w component of the result is dropped
+    void transformPoints(const float4x4& matrix, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) noexcept;
+
+    /// @brief transform directions by a matrix, dst = matrix * float4(src, 0)
+    /// @note @a dst may alias @a src
+    void transformVectors(const float4x4& matrix, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) noexcept;
+
+    /// @brief test bounding spheres against a frustum
+    /// @param spheres centers in xyz and radius in w
+    /// @param visible written with 1 for every sphere that touches the frustum and 0 otherwise
+    /// @return the number of visible spheres
+    size_t cullSpheres(const Frustum& frustum, SoaVec4<const float> spheres, uint8_t *visible, size_t count) noexcept;
+
+    /// @brief test axis aligned bounding boxes against a frustum
+    /// @param centers the center of each box
+    /// @param extents the half size of each box along each axis
+    /// @param visible written with 1 for every box that touches the frustum and 0 otherwise
+    /// @return the number of visible boxes
+    size_t cullBoxes(const Frustum& frustum, SoaVec3<const float> centers, SoaVec3<const float> extents, uint8_t *visible, size_t count) noexcept;
+
+    /// @brief normalize quaternions in place, the same as Vec4::normalized on each one
+    void normalizeQuats(SoaVec4<float> quats, size_t count) noexcept;
+
+    /// @note @a dst may alias @a src
+    void toRadians(const degf *src, radf *dst, size_t count) noexcept;
+
+    /// @note @a dst may alias @a src
+    void toDegrees(const radf *src, degf *dst, size_t count) noexcept;
+}
@@ -1,5 +1,165 @@
 #pragma once
 
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <span>
+
+#include <stdint.h>
+
 namespace sm::math {
     using half = _Float16; // NOLINT
+
+    /// @brief brain float storage, the upper 16 bits of a float
+    struct bfloat16 { // NOLINT
+        uint16_t bits;
+
+        constexpr bool operator==(const bfloat16&) const = default;
+    };
+
+    static_assert(sizeof(half) == sizeof(uint16_t));
+    static_assert(sizeof(bfloat16) == sizeof(uint16_t));
+
+    /// @brief convert a float to half bits, rounding to nearest even
+    ///
+    /// values too large for a half become infinity, values too small become
+    /// half denormals or zero. nans stay nans, become quiet, and keep the top of their payload
+    constexpr uint16_t toHalfBits(float value) {
+        uint32_t bits = std::bit_cast<uint32_t>(value);
+        uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t abs = bits & 0x7FFF'FFFF;
+
+        // infinity and nan
+        if (abs >= 0x7F80'0000)
+            return uint16_t(sign | (abs > 0x7F80'0000 ? 0x7E00 | ((abs >> 13) & 0x3FF) : 0x7C00));
+
+        // 65520 is halfway between the largest half and the next power of two, it rounds up to infinity
+        if (abs >= 0x477F'F000)
+            return uint16_t(sign | 0x7C00);
+
+        // smaller than the smallest normal half, 2^-14
+        if (abs < 0x3880'0000) {
+            // the value in units of the smallest denormal 2^-24 is mantissa * 2^(exponent - 126)
+            uint32_t shift = 126 - (abs >> 23);
+            if (shift > 24)
+                return uint16_t(sign);
+
+            uint32_t mantissa = (abs & 0x7F'FFFF) | 0x80'0000;
+            uint32_t result = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+
+            // may carry into the smallest normal, which is the correct encoding
+            if (rest > halfway || (rest == halfway && (result & 1)))
+                result += 1;
+
+            return uint16_t(sign | result);
+        }
+
+        // rebias the exponent and round on the 13 bits that get dropped,
+        // a carry out of the mantissa correctly bumps the exponent
+        uint32_t odd = (abs >> 13) & 1;
+        abs += 0xC800'0000 + 0xFFF + odd; // (15 - 127) << 23, wrapped
+        return uint16_t(sign | (abs >> 13));
+    }
+
+    /// @brief convert half bits to a float, every half is exactly representable
+    /// @note signaling nans become quiet, the same as hardware conversion
+    constexpr float fromHalfBits(uint16_t bits) {
+        uint32_t sign = uint32_t(bits & 0x8000) << 16;
+        uint32_t exponent = (bits >> 10) & 0x1F;
+        uint32_t mantissa = bits & 0x3FF;
+
+        if (exponent == 0x1F) {
+            uint32_t nan = mantissa != 0 ? 0x40'0000 : 0;
+            return std::bit_cast<float>(sign | 0x7F80'0000 | nan | (mantissa << 13));
+        }
+
+        if (exponent == 0) {
+            if (mantissa == 0)
+                return std::bit_cast<float>(sign);
+
+            // denormal, shift the leading bit up to where the implicit bit goes
+            uint32_t shift = std::countl_zero(mantissa) - 21;
+            mantissa = (mantissa << shift) & 0x3FF;
+            exponent = 1 - shift;
+        }
+
+        return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+
+    constexpr half toHalf(float value) { return std::bit_cast<half>(toHalfBits(value)); }
+    constexpr float fromHalf(half value) { return fromHalfBits(std::bit_cast<uint16_t>(value)); }
+
+    /// @brief convert a float to bfloat16, rounding to nearest even
+    /// @note denormals are kept rather than flushed, nans become quiet
+    constexpr bfloat16 toBFloat16(float value) {
+        uint32_t bits = std::bit_cast<uint32_t>(value);
+        if ((bits & 0x7FFF'FFFF) > 0x7F80'0000)
+            return { uint16_t((bits >> 16) | 0x40) };
+
+        bits += 0x7FFF + ((bits >> 16) & 1);
+        return { uint16_t(bits >> 16) };
+    }
+
+    constexpr float fromBFloat16(bfloat16 value) {
+        return std::bit_cast<float>(uint32_t(value.bits) << 16);
+    }
+
+    /// @brief convert a float in [-1, 1] to a signed normalized integer
+    ///
+    /// out of range values are clamped, nan becomes 0. rounds to nearest even.
+    template<std::signed_integral T>
+    T toSnorm(float value) {
+        constexpr float kScale = float(std::numeric_limits<T>::max());
+        bool nan = (std::bit_cast<uint32_t>(value) & 0x7FFF'FFFF) > 0x7F80'0000;
+        float clamped = nan ? 0.f : std::fmin(std::fmax(value, -1.f), 1.f);
+        return T(std::lrint(clamped * kScale));
+    }
+
+    /// @brief convert a float in [0, 1] to an unsigned normalized integer
+    ///
+    /// out of range values are clamped, nan becomes 0. rounds to nearest even.
+    template<std::unsigned_integral T>
+    T toUnorm(float value) {
+        constexpr float kScale = float(std::numeric_limits<T>::max());
+        bool nan = (std::bit_cast<uint32_t>(value) & 0x7FFF'FFFF) > 0x7F80'0000;
+        float clamped = nan ? 0.f : std::fmin(std::fmax(value, 0.f), 1.f);
+        return T(std::lrint(clamped * kScale));
+    }
+
+    /// @brief the minimum integer and the one above it both map to -1
+    template<std::signed_integral T>
+    constexpr float fromSnorm(T value) {
+        constexpr float kScale = float(std::numeric_limits<T>::max());
+        float result = float(value) / kScale;
+        return result < -1.f ? -1.f : result;
+    }
+
+    template<std::unsigned_integral T>
+    constexpr float fromUnorm(T value) {
+        constexpr float kScale = float(std::numeric_limits<T>::max());
+        return float(value) / kScale;
+    }
+
+    /// bulk conversions, each of these is the same as calling the single value
+    /// version on every element. source and destination must be the same size.
+    /// the kernels follow the instruction set picked for the batch kernels, see batch::setIsa
+
+    void toHalf(std::span<const float> src, std::span<half> dst) noexcept;
+    void fromHalf(std::span<const half> src, std::span<float> dst) noexcept;
+
+    void toBFloat16(std::span<const float> src, std::span<bfloat16> dst) noexcept;
+    void fromBFloat16(std::span<const bfloat16> src, std::span<float> dst) noexcept;
+
+    void toSnorm(std::span<const float> src, std::span<int8_t> dst) noexcept;
+    void toSnorm(std::span<const float> src, std::span<int16_t> dst) noexcept;
+    void toUnorm(std::span<const float> src, std::span<uint8_t> dst) noexcept;
+    void toUnorm(std::span<const float> src, std::span<uint16_t> dst) noexcept;
+
+    void fromSnorm(std::span<const int8_t> src, std::span<float> dst) noexcept;
+    void fromSnorm(std::span<const int16_t> src, std::span<float> dst) noexcept;
+    void fromUnorm(std::span<const uint8_t> src, std::span<float> dst) noexcept;
+    void fromUnorm(std::span<const uint16_t> src, std::span<float> dst) noexcept;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "math/quat.hpp"
+#include "math/simd.hpp"
 #include "math/units.hpp"
 #include "math/vector.hpp"
 
@@ -18,6 +19,13 @@ namespace sm::math {
         static constexpr size_t kColumnCount = 4;
         static constexpr size_t kSize = kRowCount * kColumnCount;
 
+        /// float matrices use the kernels in math/simd.hpp at runtime when the build enables them
+        static constexpr bool kUseSimd = SM_MATH_SSE41 && std::is_same_v<T, float>;
+
+        /// with avx2 the compiler already vectorizes the scalar transpose and inverse
+        /// across 256 bit registers, which measures faster than the 128 bit kernels
+        static constexpr bool kUseSimdShuffles = kUseSimd && !SM_MATH_AVX2;
+
         union {
             T fields[16];
             T matrix[4][4];
@@ -64,6 +72,28 @@ namespace sm::math {
         constexpr const T *data() const { return fields; }
 
         constexpr Vec4 mul(const Vec4& other) const {
+#if SM_MATH_SSE41
+            if constexpr (kUseSimd) {
+                if (!std::is_constant_evaluated())
+                    return simd::mul4x4(*this, other);
+            }
+#endif
+
+            return mul_scalar(other);
+        }
+
+        constexpr Mat4x4 mul(const Mat4x4& other) const {
+#if SM_MATH_SSE41
+            if constexpr (kUseSimd) {
+                if (!std::is_constant_evaluated())
+                    return simd::mul4x4(*this, other);
+            }
+#endif
+
+            return mul_scalar(other);
+        }
+
+        constexpr Vec4 mul_scalar(const Vec4& other) const {
             auto row0 = at(0);
             auto row1 = at(1);
             auto row2 = at(2);
@@ -77,7 +107,7 @@ namespace sm::math {
             return { x, y, z, w };
         }
 
-        constexpr Mat4x4 mul(const Mat4x4& other) const {
+        constexpr Mat4x4 mul_scalar(const Mat4x4& other) const {
             auto row0 = at(0);
             auto row1 = at(1);
             auto row2 = at(2);
@@ -268,6 +298,28 @@ namespace sm::math {
         }
 
         constexpr Mat4x4 transpose() const {
+#if SM_MATH_SSE41
+            if constexpr (kUseSimdShuffles) {
+                if (!std::is_constant_evaluated())
+                    return simd::transpose4x4(*this);
+            }
+#endif
+
+            return transpose_scalar();
+        }
+
+        constexpr Mat4x4 inverse() const {
+#if SM_MATH_SSE41
+            if constexpr (kUseSimdShuffles) {
+                if (!std::is_constant_evaluated())
+                    return simd::inverse4x4(*this);
+            }
+#endif
+
+            return inverse_scalar();
+        }
+
+        constexpr Mat4x4 transpose_scalar() const {
             Vec4 r0 = { rows[0].x, rows[1].x, rows[2].x, rows[3].x };
             Vec4 r1 = { rows[0].y, rows[1].y, rows[2].y, rows[3].y };
             Vec4 r2 = { rows[0].z, rows[1].z, rows[2].z, rows[3].z };
@@ -275,8 +327,8 @@ namespace sm::math {
             return { r0, r1, r2, r3 };
         }
 
-        constexpr Mat4x4 inverse() const {
-            Mat4x4 mt = transpose();
+        constexpr Mat4x4 inverse_scalar() const {
+            Mat4x4 mt = transpose_scalar();
 
             Vec4 v0[4];
             Vec4 v1[4];
@@ -346,7 +398,7 @@ namespace sm::math {
             Vec4 c3 = c2 + (v0[1] * v1[1]);
             c2 -= v0[1] * v1[1];
 
-            Vec4 c5 = c4 + (v0[2] * v1[2]);
+            Vec4 c5 = c4 - (v0[2] * v1[2]);
             c4 += v0[2] * v1[2];
 
             Vec4 c7 = c6 + (v0[3] * v1[3]);
@@ -359,7 +411,7 @@ namespace sm::math {
                 select(c6, c7, A, B, A, B)
             };
 
-            Vec4 det = Vec4::dot(r.row(0), mt.row(0));
+            Vec4 det = Vec4::dot_scalar(r.row(0), mt.row(0));
 
             Vec4 reciprocal = det.reciprocal();
 
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <simcoe_math_config.h>
+
+// SMC_MATH_SIMD is the build option, the compiler flags it adds decide which tier is available
+#if SMC_MATH_SIMD && (defined(__SSE4_1__) || defined(__AVX__))
+#   define SM_MATH_SSE41 1
+#else
+#   define SM_MATH_SSE41 0
+#endif
+
+#if SM_MATH_SSE41 && defined(__AVX2__)
+#   define SM_MATH_AVX2 1
+#else
+#   define SM_MATH_AVX2 0
+#endif
+
+#if SM_MATH_AVX2 && defined(__FMA__)
+#   define SM_MATH_FMA 1
+#else
+#   define SM_MATH_FMA 0
+#endif
+
+#if SM_MATH_SSE41
+#   include <immintrin.h>
+#endif
+
+/// vectorized kernels for float vectors and row major 4x4 matrices.
+/// the vector and matrix types call into these outside of constant evaluation,
+/// each kernel performs the same operations in the same order as the scalar code
+/// it replaces unless noted. kernels use aligned loads, matrices must be 32 byte
+/// aligned and vectors 16 byte aligned, which the types already guarantee.
+namespace sm::math::simd {
+#if SM_MATH_SSE41
+    template<int X, int Y, int Z, int W>
+    inline __m128 swizzle(__m128 v) noexcept {
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+    }
+
+    /// @brief pick lanes from two vectors, indices 0-3 select from @a lhs and 4-7 from @a rhs
+    template<int X, int Y, int Z, int W>
+    inline __m128 permute(__m128 lhs, __m128 rhs) noexcept {
+        constexpr int kMask = (X > 3 ? 1 : 0) | (Y > 3 ? 2 : 0) | (Z > 3 ? 4 : 0) | (W > 3 ? 8 : 0);
+
+        if constexpr (kMask == 0b0000) {
+            return swizzle<X, Y, Z, W>(lhs);
+        } else if constexpr (kMask == 0b1111) {
+            return swizzle<X & 3, Y & 3, Z & 3, W & 3>(rhs);
+        } else if constexpr (kMask == 0b1100) {
+            return _mm_shuffle_ps(lhs, rhs, _MM_SHUFFLE(W & 3, Z & 3, Y, X));
+        } else {
+            __m128 a = swizzle<X & 3, Y & 3, Z & 3, W & 3>(lhs);
+            __m128 b = swizzle<X & 3, Y & 3, Z & 3, W & 3>(rhs);
+            return _mm_blend_ps(a, b, kMask);
+        }
+    }
+
+    /// @brief a * b + c, fused when the build allows it
+    inline __m128 madd(__m128 a, __m128 b, __m128 c) noexcept {
+#if SM_MATH_FMA
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+
+    /// @brief c - a * b, fused when the build allows it
+    inline __m128 msub(__m128 a, __m128 b, __m128 c) noexcept {
+#if SM_MATH_FMA
+        return _mm_fnmadd_ps(a, b, c);
+#else
+        return _mm_sub_ps(c, _mm_mul_ps(a, b));
+#endif
+    }
+
+    /// @brief horizontal sum of lane products, broadcast to every lane.
+    /// sums as (x + y) + (z + w) rather than left to right
+    inline __m128 dot4(__m128 lhs, __m128 rhs) noexcept {
+        __m128 product = _mm_mul_ps(lhs, rhs);
+        __m128 pairs = _mm_add_ps(product, swizzle<1, 0, 3, 2>(product));
+        return _mm_add_ps(pairs, swizzle<2, 3, 0, 1>(pairs));
+    }
+
+    template<typename V>
+    V dot4(const V& lhs, const V& rhs) noexcept {
+        V result;
+        _mm_store_ps(result.data(), dot4(_mm_load_ps(lhs.data()), _mm_load_ps(rhs.data())));
+        return result;
+    }
+
+    /// @brief cross product of the xyz lanes, w is zero
+    template<typename V>
+    V cross3(const V& lhs, const V& rhs) noexcept {
+        __m128 a = _mm_load_ps(lhs.data());
+        __m128 b = _mm_load_ps(rhs.data());
+
+        __m128 lhsYZX = swizzle<1, 2, 0, 3>(a);
+        __m128 rhsZXY = swizzle<2, 0, 1, 3>(b);
+        __m128 lhsZXY = swizzle<2, 0, 1, 3>(a);
+        __m128 rhsYZX = swizzle<1, 2, 0, 3>(b);
+
+        __m128 cross = _mm_sub_ps(_mm_mul_ps(lhsYZX, rhsZXY), _mm_mul_ps(lhsZXY, rhsYZX));
+
+        V result;
+        _mm_store_ps(result.data(), _mm_blend_ps(cross, _mm_setzero_ps(), 0b1000));
+        return result;
+    }
+
+    template<typename M>
+    M transpose4x4(const M& mat) noexcept {
+        const float *in = mat.data();
+        M result;
+        float *out = result.data();
+
+        __m128 r0 = _mm_load_ps(in + 0);
+        __m128 r1 = _mm_load_ps(in + 4);
+        __m128 r2 = _mm_load_ps(in + 8);
+        __m128 r3 = _mm_load_ps(in + 12);
+
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        _mm_store_ps(out + 0, r0);
+        _mm_store_ps(out + 4, r1);
+        _mm_store_ps(out + 8, r2);
+        _mm_store_ps(out + 12, r3);
+
+        return result;
+    }
+
+    /// @brief matrix times column vector
+    template<typename M, typename V>
+    V mul4x4(const M& mat, const V& vec) noexcept {
+        __m128 c0 = _mm_load_ps(mat.data() + 0);
+        __m128 c1 = _mm_load_ps(mat.data() + 4);
+        __m128 c2 = _mm_load_ps(mat.data() + 8);
+        __m128 c3 = _mm_load_ps(mat.data() + 12);
+
+        // as columns each output lane accumulates its row left to right
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        __m128 v = _mm_load_ps(vec.data());
+        __m128 acc = _mm_mul_ps(c0, swizzle<0, 0, 0, 0>(v));
+        acc = madd(c1, swizzle<1, 1, 1, 1>(v), acc);
+        acc = madd(c2, swizzle<2, 2, 2, 2>(v), acc);
+        acc = madd(c3, swizzle<3, 3, 3, 3>(v), acc);
+
+        V result;
+        _mm_store_ps(result.data(), acc);
+        return result;
+    }
+
+    /// @brief row major matrix product lhs * rhs
+    template<typename M>
+    M mul4x4(const M& lhsMat, const M& rhsMat) noexcept {
+        const float *lhs = lhsMat.data();
+        const float *rhs = rhsMat.data();
+        M result;
+        float *out = result.data();
+
+#if SM_MATH_AVX2
+        // two rows of the output per iteration, each 128 bit lane holds one row
+        __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs + 0));
+        __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs + 4));
+        __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs + 8));
+        __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs + 12));
+
+        __m256 a01 = _mm256_load_ps(lhs + 0);
+        __m256 a23 = _mm256_load_ps(lhs + 8);
+
+        auto row = [&](__m256 a) {
+            __m256 acc = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), b0);
+#if SM_MATH_FMA
+            acc = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0x55), b1, acc);
+            acc = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xAA), b2, acc);
+            acc = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xFF), b3, acc);
+#else
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x55), b1));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xAA), b2));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xFF), b3));
+#endif
+            return acc;
+        };
+
+        _mm256_store_ps(out + 0, row(a01));
+        _mm256_store_ps(out + 8, row(a23));
+#else
+        __m128 b0 = _mm_load_ps(rhs + 0);
+        __m128 b1 = _mm_load_ps(rhs + 4);
+        __m128 b2 = _mm_load_ps(rhs + 8);
+        __m128 b3 = _mm_load_ps(rhs + 12);
+
+        auto row = [&](__m128 a) {
+            __m128 acc = _mm_mul_ps(swizzle<0, 0, 0, 0>(a), b0);
+            acc = madd(swizzle<1, 1, 1, 1>(a), b1, acc);
+            acc = madd(swizzle<2, 2, 2, 2>(a), b2, acc);
+            return madd(swizzle<3, 3, 3, 3>(a), b3, acc);
+        };
+
+        __m128 a0 = _mm_load_ps(lhs + 0);
+        __m128 a1 = _mm_load_ps(lhs + 4);
+        __m128 a2 = _mm_load_ps(lhs + 8);
+        __m128 a3 = _mm_load_ps(lhs + 12);
+
+        _mm_store_ps(out + 0, row(a0));
+        _mm_store_ps(out + 4, row(a1));
+        _mm_store_ps(out + 8, row(a2));
+        _mm_store_ps(out + 12, row(a3));
+#endif
+
+        return result;
+    }
+
+    /// @brief general 4x4 inverse by cofactor expansion, the same steps as Mat4x4::inverse_scalar
+    template<typename M>
+    M inverse4x4(const M& mat) noexcept {
+        __m128 r0 = _mm_load_ps(mat.data() + 0);
+        __m128 r1 = _mm_load_ps(mat.data() + 4);
+        __m128 r2 = _mm_load_ps(mat.data() + 8);
+        __m128 r3 = _mm_load_ps(mat.data() + 12);
+
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        __m128 d0 = _mm_mul_ps(swizzle<0, 0, 1, 1>(r2), swizzle<2, 3, 2, 3>(r3));
+        __m128 d1 = _mm_mul_ps(swizzle<0, 0, 1, 1>(r0), swizzle<2, 3, 2, 3>(r1));
+        __m128 d2 = _mm_mul_ps(permute<0, 2, 4, 6>(r2, r0), permute<1, 3, 5, 7>(r3, r1));
+
+        d0 = msub(swizzle<2, 3, 2, 3>(r2), swizzle<0, 0, 1, 1>(r3), d0);
+        d1 = msub(swizzle<2, 3, 2, 3>(r0), swizzle<0, 0, 1, 1>(r1), d1);
+        d2 = msub(permute<1, 3, 5, 7>(r2, r0), permute<0, 2, 4, 6>(r3, r1), d2);
+
+        __m128 c0 = _mm_mul_ps(swizzle<1, 2, 0, 1>(r1), permute<5, 1, 3, 0>(d0, d2));
+        __m128 c2 = _mm_mul_ps(swizzle<2, 0, 1, 0>(r0), permute<3, 5, 1, 2>(d0, d2));
+        __m128 c4 = _mm_mul_ps(swizzle<1, 2, 0, 1>(r3), permute<7, 1, 3, 0>(d1, d2));
+        __m128 c6 = _mm_mul_ps(swizzle<2, 0, 1, 0>(r2), permute<3, 7, 1, 2>(d1, d2));
+
+        c0 = msub(swizzle<2, 3, 1, 2>(r1), permute<3, 0, 1, 4>(d0, d2), c0);
+        c2 = msub(swizzle<3, 2, 3, 1>(r0), permute<2, 1, 4, 0>(d0, d2), c2);
+        c4 = msub(swizzle<2, 3, 1, 2>(r3), permute<3, 0, 1, 6>(d1, d2), c4);
+        c6 = msub(swizzle<3, 2, 3, 1>(r2), permute<2, 1, 6, 0>(d1, d2), c6);
+
+        __m128 s0 = swizzle<3, 0, 3, 0>(r1), p0 = permute<2, 5, 4, 2>(d0, d2);
+        __m128 s1 = swizzle<1, 3, 0, 2>(r0), p1 = permute<5, 0, 3, 4>(d0, d2);
+        __m128 s2 = swizzle<3, 0, 3, 0>(r3), p2 = permute<2, 7, 6, 2>(d1, d2);
+        __m128 s3 = swizzle<1, 3, 0, 2>(r2), p3 = permute<7, 0, 3, 6>(d1, d2);
+
+        __m128 c1 = msub(s0, p0, c0);
+        c0 = madd(s0, p0, c0);
+
+        __m128 c3 = madd(s1, p1, c2);
+        c2 = msub(s1, p1, c2);
+
+        __m128 c5 = msub(s2, p2, c4);
+        c4 = madd(s2, p2, c4);
+
+        __m128 c7 = madd(s3, p3, c6);
+        c6 = msub(s3, p3, c6);
+
+        __m128 i0 = _mm_blend_ps(c0, c1, 0b1010);
+        __m128 i1 = _mm_blend_ps(c2, c3, 0b1010);
+        __m128 i2 = _mm_blend_ps(c4, c5, 0b1010);
+        __m128 i3 = _mm_blend_ps(c6, c7, 0b1010);
+
+        // summed left to right like Vec4::dot so the determinant matches the scalar path
+        __m128 product = _mm_mul_ps(i0, r0);
+        __m128 det = _mm_add_ss(product, swizzle<1, 1, 1, 1>(product));
+        det = _mm_add_ss(det, swizzle<2, 2, 2, 2>(product));
+        det = _mm_add_ss(det, swizzle<3, 3, 3, 3>(product));
+
+        __m128 reciprocal = _mm_div_ps(_mm_set1_ps(1.f), swizzle<0, 0, 0, 0>(det));
+
+        M result;
+        _mm_store_ps(result.data() + 0, _mm_mul_ps(i0, reciprocal));
+        _mm_store_ps(result.data() + 4, _mm_mul_ps(i1, reciprocal));
+        _mm_store_ps(result.data() + 8, _mm_mul_ps(i2, reciprocal));
+        _mm_store_ps(result.data() + 12, _mm_mul_ps(i3, reciprocal));
+        return result;
+    }
+#endif
+}
@@ -2,6 +2,7 @@
 
 #include "base/panic.h"
 
+#include "math/simd.hpp"
 #include "math/utils.hpp"
 
 namespace sm::math {
@@ -272,6 +273,7 @@ namespace sm::math {
     template<typename T>
     struct alignas(sizeof(T) * 4) Vec4 {
         static constexpr size_t kSize = 4;
+        static constexpr bool kUseSimd = SM_MATH_SSE41 && std::is_same_v<T, float>;
         using Vec2 = Vec2<T>;
         using Vec3 = Vec3<T>;
         using Type = T;
@@ -339,9 +341,41 @@ namespace sm::math {
         }
 
         static constexpr Vec4 dot(const Vec4& lhs, const Vec4& rhs) {
+#if SM_MATH_SSE41
+            if constexpr (kUseSimd) {
+                if (!std::is_constant_evaluated())
+                    return simd::dot4(lhs, rhs);
+            }
+#endif
+
+            return dot_scalar(lhs, rhs);
+        }
+
+        static constexpr Vec4 dot_scalar(const Vec4& lhs, const Vec4& rhs) {
             return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
         }
 
+        /// @brief cross product of the xyz components, w is zero
+        static constexpr Vec4 cross(const Vec4& lhs, const Vec4& rhs) {
+#if SM_MATH_SSE41
+            if constexpr (kUseSimd) {
+                if (!std::is_constant_evaluated())
+                    return simd::cross3(lhs, rhs);
+            }
+#endif
+
+            return cross_scalar(lhs, rhs);
+        }
+
+        static constexpr Vec4 cross_scalar(const Vec4& lhs, const Vec4& rhs) {
+            return Vec4(
+                lhs.y * rhs.z - lhs.z * rhs.y,
+                lhs.z * rhs.x - lhs.x * rhs.z,
+                lhs.x * rhs.y - lhs.y * rhs.x,
+                0
+            );
+        }
+
         constexpr const T& operator[](size_t index) const { return at(index); }
         constexpr T& operator[](size_t index) { return at(index); }
 
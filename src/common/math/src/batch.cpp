@@ -0,0 +1,771 @@
+#include "math/batch.hpp"
+
+#include "core/cpuid.hpp"
+
+#include <simcoe_math_config.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+
+#include <stdint.h>
+#include <string.h>
+
+#if SMC_MATH_SIMD && (defined(__x86_64__) || defined(_M_X64))
+#   define SM_BATCH_X86 1
+#   include <immintrin.h>
+#else
+#   define SM_BATCH_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define SM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#   define SM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#   define SM_TARGET_AVX2
+#   define SM_TARGET_AVX512
+#endif
+
+using namespace sm;
+using namespace sm::math;
+using namespace sm::math::batch;
+
+Frustum Frustum::fromViewProjection(const float4x4& viewProjection) noexcept {
+    // Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix".
+    // each clip space bound -w <= x <= w is a plane made from the w row and one other row
+    const float4 *rows = viewProjection.rows;
+
+    auto normalize = [](float4 plane) {
+        return plane / float4(plane.xyz().length());
+    };
+
+    Frustum frustum;
+    frustum.planes[eLeft] = normalize(rows[3] + rows[0]);
+    frustum.planes[eRight] = normalize(rows[3] - rows[0]);
+    frustum.planes[eBottom] = normalize(rows[3] + rows[1]);
+    frustum.planes[eTop] = normalize(rows[3] - rows[1]);
+    frustum.planes[eNear] = normalize(rows[2]);
+    frustum.planes[eFar] = normalize(rows[3] - rows[2]);
+    return frustum;
+}
+
+template<typename T>
+static SoaVec3<T> advance(SoaVec3<T> soa, size_t offset) {
+    return { soa.x + offset, soa.y + offset, soa.z + offset };
+}
+
+template<typename T>
+static SoaVec4<T> advance(SoaVec4<T> soa, size_t offset) {
+    return { soa.x + offset, soa.y + offset, soa.z + offset, soa.w + offset };
+}
+
+///
+/// scalar, these are the reference for every other kernel. they also handle the
+/// elements before the first aligned group and after the last full group in the others
+///
+
+/// @param w the w component of every input, the translation is scaled by it once up front
+static void transformScalar(const float4x4& matrix, float w, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) {
+    const float4 r0 = matrix.rows[0];
+    const float4 r1 = matrix.rows[1];
+    const float4 r2 = matrix.rows[2];
+
+    const float tx = r0.w * w;
+    const float ty = r1.w * w;
+    const float tz = r2.w * w;
+
+    for (size_t i = 0; i < count; i++) {
+        float x = src.x[i];
+        float y = src.y[i];
+        float z = src.z[i];
+
+        dst.x[i] = r0.x * x + r0.y * y + r0.z * z + tx;
+        dst.y[i] = r1.x * x + r1.y * y + r1.z * z + ty;
+        dst.z[i] = r2.x * x + r2.y * y + r2.z * z + tz;
+    }
+}
+
+static size_t cullSpheresScalar(const Frustum& frustum, SoaVec4<const float> spheres, uint8_t *visible, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        float x = spheres.x[i];
+        float y = spheres.y[i];
+        float z = spheres.z[i];
+        float r = spheres.w[i];
+
+        // no early out, so the result is the same as the kernels that test every plane
+        bool inside = true;
+        for (const float4& plane : frustum.planes)
+            inside &= (plane.x * x + plane.y * y + plane.z * z + plane.w >= -r);
+
+        visible[i] = inside;
+        total += inside;
+    }
+
+    return total;
+}
+
+static size_t cullBoxesScalar(const Frustum& frustum, SoaVec3<const float> centers, SoaVec3<const float> extents, uint8_t *visible, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        float x = centers.x[i];
+        float y = centers.y[i];
+        float z = centers.z[i];
+
+        float ex = extents.x[i];
+        float ey = extents.y[i];
+        float ez = extents.z[i];
+
+        bool inside = true;
+        for (const float4& plane : frustum.planes) {
+            // the furthest the box reaches along the plane normal
+            float r = std::abs(plane.x) * ex + std::abs(plane.y) * ey + std::abs(plane.z) * ez;
+            inside &= (plane.x * x + plane.y * y + plane.z * z + plane.w >= -r);
+        }
+
+        visible[i] = inside;
+        total += inside;
+    }
+
+    return total;
+}
+
+static void normalizeQuatsScalar(SoaVec4<float> quats, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float x = quats.x[i];
+        float y = quats.y[i];
+        float z = quats.z[i];
+        float w = quats.w[i];
+
+        float length = std::sqrt(x * x + y * y + z * z + w * w);
+
+        quats.x[i] = x / length;
+        quats.y[i] = y / length;
+        quats.z[i] = z / length;
+        quats.w[i] = w / length;
+    }
+}
+
+static void scaleScalar(const float *src, float *dst, float scale, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        dst[i] = src[i] * scale;
+}
+
+#if SM_BATCH_X86
+
+/// number of leading elements to process one at a time so that @a ptr lands on an @a align byte boundary.
+/// wide loads and stores that straddle cache lines cost more than the arithmetic in these loops,
+/// arrays from the same allocator usually share their offset so aligning one aligns them all
+static size_t getAlignHead(const float *ptr, size_t align, size_t count) {
+    size_t offset = (align - (uintptr_t(ptr) % align)) % align;
+    return std::min(offset / sizeof(float), count);
+}
+
+/// byte i is 1 if bit i of the index is set, turns a compare mask into visibility bytes
+static constexpr auto kMaskBytes = [] {
+    std::array<uint64_t, 256> table{};
+    for (size_t mask = 0; mask < 256; mask++) {
+        for (size_t bit = 0; bit < 8; bit++) {
+            if (mask & (1 << bit))
+                table[mask] |= uint64_t(1) << (bit * 8);
+        }
+    }
+    return table;
+}();
+
+///
+/// sse2, every x64 cpu has this so it is only dispatched to over avx2.
+/// the operations are the same as the scalar code in the same order, so the results are identical
+///
+
+static void transformSse2(const float4x4& matrix, float w, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) {
+    __m128 m[3][4];
+    for (size_t r = 0; r < 3; r++) {
+        const float4& row = matrix.rows[r];
+        m[r][0] = _mm_set1_ps(row.x);
+        m[r][1] = _mm_set1_ps(row.y);
+        m[r][2] = _mm_set1_ps(row.z);
+        m[r][3] = _mm_set1_ps(row.w * w);
+    }
+
+    auto transformRow = [&](size_t r, __m128 x, __m128 y, __m128 z) {
+        __m128 acc = _mm_mul_ps(m[r][0], x);
+        acc = _mm_add_ps(acc, _mm_mul_ps(m[r][1], y));
+        acc = _mm_add_ps(acc, _mm_mul_ps(m[r][2], z));
+        return _mm_add_ps(acc, m[r][3]);
+    };
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(src.x + i);
+        __m128 y = _mm_loadu_ps(src.y + i);
+        __m128 z = _mm_loadu_ps(src.z + i);
+
+        _mm_storeu_ps(dst.x + i, transformRow(0, x, y, z));
+        _mm_storeu_ps(dst.y + i, transformRow(1, x, y, z));
+        _mm_storeu_ps(dst.z + i, transformRow(2, x, y, z));
+    }
+
+    transformScalar(matrix, w, advance(src, i), advance(dst, i), count - i);
+}
+
+static __m128 planeDistanceSse2(const __m128 *plane, __m128 x, __m128 y, __m128 z) {
+    __m128 d = _mm_mul_ps(plane[0], x);
+    d = _mm_add_ps(d, _mm_mul_ps(plane[1], y));
+    d = _mm_add_ps(d, _mm_mul_ps(plane[2], z));
+    return _mm_add_ps(d, plane[3]);
+}
+
+static size_t cullSpheresSse2(const Frustum& frustum, SoaVec4<const float> spheres, uint8_t *visible, size_t count) {
+    __m128 planes[Frustum::eCount][4];
+    for (size_t p = 0; p < Frustum::eCount; p++) {
+        for (size_t c = 0; c < 4; c++)
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t total = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(spheres.x + i);
+        __m128 y = _mm_loadu_ps(spheres.y + i);
+        __m128 z = _mm_loadu_ps(spheres.z + i);
+        __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(spheres.w + i));
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (const auto& plane : planes)
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(planeDistanceSse2(plane, x, y, z), negRadius));
+
+        unsigned mask = unsigned(_mm_movemask_ps(inside));
+        memcpy(visible + i, &kMaskBytes[mask], 4);
+        total += std::popcount(mask);
+    }
+
+    return total + cullSpheresScalar(frustum, advance(spheres, i), visible + i, count - i);
+}
+
+static size_t cullBoxesSse2(const Frustum& frustum, SoaVec3<const float> centers, SoaVec3<const float> extents, uint8_t *visible, size_t count) {
+    __m128 planes[Frustum::eCount][4];
+    __m128 absNormals[Frustum::eCount][3];
+    for (size_t p = 0; p < Frustum::eCount; p++) {
+        for (size_t c = 0; c < 4; c++)
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+
+        for (size_t c = 0; c < 3; c++)
+            absNormals[p][c] = _mm_set1_ps(std::abs(frustum.planes[p][c]));
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t total = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(centers.x + i);
+        __m128 y = _mm_loadu_ps(centers.y + i);
+        __m128 z = _mm_loadu_ps(centers.z + i);
+
+        __m128 ex = _mm_loadu_ps(extents.x + i);
+        __m128 ey = _mm_loadu_ps(extents.y + i);
+        __m128 ez = _mm_loadu_ps(extents.z + i);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (size_t p = 0; p < Frustum::eCount; p++) {
+            __m128 r = _mm_mul_ps(absNormals[p][0], ex);
+            r = _mm_add_ps(r, _mm_mul_ps(absNormals[p][1], ey));
+            r = _mm_add_ps(r, _mm_mul_ps(absNormals[p][2], ez));
+
+            __m128 d = planeDistanceSse2(planes[p], x, y, z);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_sub_ps(zero, r)));
+        }
+
+        unsigned mask = unsigned(_mm_movemask_ps(inside));
+        memcpy(visible + i, &kMaskBytes[mask], 4);
+        total += std::popcount(mask);
+    }
+
+    return total + cullBoxesScalar(frustum, advance(centers, i), advance(extents, i), visible + i, count - i);
+}
+
+static void normalizeQuatsSse2(SoaVec4<float> quats, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(quats.x + i);
+        __m128 y = _mm_loadu_ps(quats.y + i);
+        __m128 z = _mm_loadu_ps(quats.z + i);
+        __m128 w = _mm_loadu_ps(quats.w + i);
+
+        __m128 length = _mm_mul_ps(x, x);
+        length = _mm_add_ps(length, _mm_mul_ps(y, y));
+        length = _mm_add_ps(length, _mm_mul_ps(z, z));
+        length = _mm_add_ps(length, _mm_mul_ps(w, w));
+        length = _mm_sqrt_ps(length);
+
+        _mm_storeu_ps(quats.x + i, _mm_div_ps(x, length));
+        _mm_storeu_ps(quats.y + i, _mm_div_ps(y, length));
+        _mm_storeu_ps(quats.z + i, _mm_div_ps(z, length));
+        _mm_storeu_ps(quats.w + i, _mm_div_ps(w, length));
+    }
+
+    normalizeQuatsScalar(advance(quats, i), count - i);
+}
+
+static void scaleSse2(const float *src, float *dst, float scale, size_t count) {
+    const __m128 factor = _mm_set1_ps(scale);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), factor));
+
+    scaleScalar(src + i, dst + i, scale, count - i);
+}
+
+///
+/// avx2, eight lanes at a time with fused multiply add
+///
+
+static SM_TARGET_AVX2 __m256 transformRowAvx2(const __m256 *row, __m256 x, __m256 y, __m256 z) {
+    __m256 acc = _mm256_mul_ps(row[0], x);
+    acc = _mm256_fmadd_ps(row[1], y, acc);
+    acc = _mm256_fmadd_ps(row[2], z, acc);
+    return _mm256_add_ps(acc, row[3]);
+}
+
+static SM_TARGET_AVX2 void transformAvx2(const float4x4& matrix, float w, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) {
+    __m256 m[3][4];
+    for (size_t r = 0; r < 3; r++) {
+        const float4& row = matrix.rows[r];
+        m[r][0] = _mm256_set1_ps(row.x);
+        m[r][1] = _mm256_set1_ps(row.y);
+        m[r][2] = _mm256_set1_ps(row.z);
+        m[r][3] = _mm256_set1_ps(row.w * w);
+    }
+
+    size_t i = getAlignHead(dst.x, 32, count);
+    transformScalar(matrix, w, src, dst, i);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(src.x + i);
+        __m256 y = _mm256_loadu_ps(src.y + i);
+        __m256 z = _mm256_loadu_ps(src.z + i);
+
+        _mm256_storeu_ps(dst.x + i, transformRowAvx2(m[0], x, y, z));
+        _mm256_storeu_ps(dst.y + i, transformRowAvx2(m[1], x, y, z));
+        _mm256_storeu_ps(dst.z + i, transformRowAvx2(m[2], x, y, z));
+    }
+
+    transformScalar(matrix, w, advance(src, i), advance(dst, i), count - i);
+}
+
+static SM_TARGET_AVX2 __m256 planeDistanceAvx2(const __m256 *plane, __m256 x, __m256 y, __m256 z) {
+    __m256 d = _mm256_mul_ps(plane[0], x);
+    d = _mm256_fmadd_ps(plane[1], y, d);
+    d = _mm256_fmadd_ps(plane[2], z, d);
+    return _mm256_add_ps(d, plane[3]);
+}
+
+static SM_TARGET_AVX2 size_t cullSpheresAvx2(const Frustum& frustum, SoaVec4<const float> spheres, uint8_t *visible, size_t count) {
+    __m256 planes[Frustum::eCount][4];
+    for (size_t p = 0; p < Frustum::eCount; p++) {
+        for (size_t c = 0; c < 4; c++)
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = getAlignHead(spheres.x, 32, count);
+    size_t total = cullSpheresScalar(frustum, spheres, visible, i);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(spheres.x + i);
+        __m256 y = _mm256_loadu_ps(spheres.y + i);
+        __m256 z = _mm256_loadu_ps(spheres.z + i);
+        __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(spheres.w + i));
+
+        __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+        for (const auto& plane : planes)
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(planeDistanceAvx2(plane, x, y, z), negRadius, _CMP_GE_OQ));
+
+        unsigned mask = unsigned(_mm256_movemask_ps(inside));
+        memcpy(visible + i, &kMaskBytes[mask], 8);
+        total += std::popcount(mask);
+    }
+
+    return total + cullSpheresScalar(frustum, advance(spheres, i), visible + i, count - i);
+}
+
+static SM_TARGET_AVX2 size_t cullBoxesAvx2(const Frustum& frustum, SoaVec3<const float> centers, SoaVec3<const float> extents, uint8_t *visible, size_t count) {
+    __m256 planes[Frustum::eCount][4];
+    __m256 absNormals[Frustum::eCount][3];
+    for (size_t p = 0; p < Frustum::eCount; p++) {
+        for (size_t c = 0; c < 4; c++)
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+
+        for (size_t c = 0; c < 3; c++)
+            absNormals[p][c] = _mm256_set1_ps(std::abs(frustum.planes[p][c]));
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = getAlignHead(centers.x, 32, count);
+    size_t total = cullBoxesScalar(frustum, centers, extents, visible, i);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(centers.x + i);
+        __m256 y = _mm256_loadu_ps(centers.y + i);
+        __m256 z = _mm256_loadu_ps(centers.z + i);
+
+        __m256 ex = _mm256_loadu_ps(extents.x + i);
+        __m256 ey = _mm256_loadu_ps(extents.y + i);
+        __m256 ez = _mm256_loadu_ps(extents.z + i);
+
+        __m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+        for (size_t p = 0; p < Frustum::eCount; p++) {
+            __m256 r = _mm256_mul_ps(absNormals[p][0], ex);
+            r = _mm256_fmadd_ps(absNormals[p][1], ey, r);
+            r = _mm256_fmadd_ps(absNormals[p][2], ez, r);
+
+            __m256 d = planeDistanceAvx2(planes[p], x, y, z);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_sub_ps(zero, r), _CMP_GE_OQ));
+        }
+
+        unsigned mask = unsigned(_mm256_movemask_ps(inside));
+        memcpy(visible + i, &kMaskBytes[mask], 8);
+        total += std::popcount(mask);
+    }
+
+    return total + cullBoxesScalar(frustum, advance(centers, i), advance(extents, i), visible + i, count - i);
+}
+
+static SM_TARGET_AVX2 void normalizeQuatsAvx2(SoaVec4<float> quats, size_t count) {
+    size_t i = getAlignHead(quats.x, 32, count);
+    normalizeQuatsScalar(quats, i);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(quats.x + i);
+        __m256 y = _mm256_loadu_ps(quats.y + i);
+        __m256 z = _mm256_loadu_ps(quats.z + i);
+        __m256 w = _mm256_loadu_ps(quats.w + i);
+
+        __m256 length = _mm256_mul_ps(x, x);
+        length = _mm256_fmadd_ps(y, y, length);
+        length = _mm256_fmadd_ps(z, z, length);
+        length = _mm256_fmadd_ps(w, w, length);
+        length = _mm256_sqrt_ps(length);
+
+        _mm256_storeu_ps(quats.x + i, _mm256_div_ps(x, length));
+        _mm256_storeu_ps(quats.y + i, _mm256_div_ps(y, length));
+        _mm256_storeu_ps(quats.z + i, _mm256_div_ps(z, length));
+        _mm256_storeu_ps(quats.w + i, _mm256_div_ps(w, length));
+    }
+
+    normalizeQuatsScalar(advance(quats, i), count - i);
+}
+
+static SM_TARGET_AVX2 void scaleAvx2(const float *src, float *dst, float scale, size_t count) {
+    const __m256 factor = _mm256_set1_ps(scale);
+
+    size_t i = getAlignHead(dst, 32, count);
+    scaleScalar(src, dst, scale, i);
+
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), factor));
+
+    scaleScalar(src + i, dst + i, scale, count - i);
+}
+
+///
+/// avx512, sixteen lanes at a time. the last partial group uses masked loads and stores
+/// rather than falling back to the scalar code, masked off lanes never touch memory
+///
+
+static SM_TARGET_AVX512 __mmask16 laneMask(size_t remaining) {
+    return remaining >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << remaining) - 1);
+}
+
+static SM_TARGET_AVX512 __m512 transformRowAvx512(const __m512 *row, __m512 x, __m512 y, __m512 z) {
+    __m512 acc = _mm512_mul_ps(row[0], x);
+    acc = _mm512_fmadd_ps(row[1], y, acc);
+    acc = _mm512_fmadd_ps(row[2], z, acc);
+    return _mm512_add_ps(acc, row[3]);
+}
+
+static SM_TARGET_AVX512 void transformAvx512(const float4x4& matrix, float w, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) {
+    __m512 m[3][4];
+    for (size_t r = 0; r < 3; r++) {
+        const float4& row = matrix.rows[r];
+        m[r][0] = _mm512_set1_ps(row.x);
+        m[r][1] = _mm512_set1_ps(row.y);
+        m[r][2] = _mm512_set1_ps(row.z);
+        m[r][3] = _mm512_set1_ps(row.w * w);
+    }
+
+    size_t i = getAlignHead(dst.x, 64, count);
+    transformScalar(matrix, w, src, dst, i);
+
+    for (; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        __m512 x = _mm512_maskz_loadu_ps(lanes, src.x + i);
+        __m512 y = _mm512_maskz_loadu_ps(lanes, src.y + i);
+        __m512 z = _mm512_maskz_loadu_ps(lanes, src.z + i);
+
+        _mm512_mask_storeu_ps(dst.x + i, lanes, transformRowAvx512(m[0], x, y, z));
+        _mm512_mask_storeu_ps(dst.y + i, lanes, transformRowAvx512(m[1], x, y, z));
+        _mm512_mask_storeu_ps(dst.z + i, lanes, transformRowAvx512(m[2], x, y, z));
+    }
+}
+
+static SM_TARGET_AVX512 __m512 planeDistanceAvx512(const __m512 *plane, __m512 x, __m512 y, __m512 z) {
+    __m512 d = _mm512_mul_ps(plane[0], x);
+    d = _mm512_fmadd_ps(plane[1], y, d);
+    d = _mm512_fmadd_ps(plane[2], z, d);
+    return _mm512_add_ps(d, plane[3]);
+}
+
+static SM_TARGET_AVX512 size_t storeVisibleAvx512(uint8_t *visible, __mmask16 lanes, __mmask16 inside) {
+    _mm512_mask_cvtepi32_storeu_epi8(visible, lanes, _mm512_maskz_set1_epi32(inside, 1));
+    return std::popcount(unsigned(inside));
+}
+
+static SM_TARGET_AVX512 size_t cullSpheresAvx512(const Frustum& frustum, SoaVec4<const float> spheres, uint8_t *visible, size_t count) {
+    __m512 planes[Frustum::eCount][4];
+    for (size_t p = 0; p < Frustum::eCount; p++) {
+        for (size_t c = 0; c < 4; c++)
+            planes[p][c] = _mm512_set1_ps(frustum.planes[p][c]);
+    }
+
+    const __m512 zero = _mm512_setzero_ps();
+
+    size_t i = getAlignHead(spheres.x, 64, count);
+    size_t total = cullSpheresScalar(frustum, spheres, visible, i);
+
+    for (; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        __m512 x = _mm512_maskz_loadu_ps(lanes, spheres.x + i);
+        __m512 y = _mm512_maskz_loadu_ps(lanes, spheres.y + i);
+        __m512 z = _mm512_maskz_loadu_ps(lanes, spheres.z + i);
+        __m512 negRadius = _mm512_sub_ps(zero, _mm512_maskz_loadu_ps(lanes, spheres.w + i));
+
+        __mmask16 inside = lanes;
+        for (const auto& plane : planes)
+            inside = _mm512_mask_cmp_ps_mask(inside, planeDistanceAvx512(plane, x, y, z), negRadius, _CMP_GE_OQ);
+
+        total += storeVisibleAvx512(visible + i, lanes, inside);
+    }
+
+    return total;
+}
+
+static SM_TARGET_AVX512 size_t cullBoxesAvx512(const Frustum& frustum, SoaVec3<const float> centers, SoaVec3<const float> extents, uint8_t *visible, size_t count) {
+    __m512 planes[Frustum::eCount][4];
+    __m512 absNormals[Frustum::eCount][3];
+    for (size_t p = 0; p < Frustum::eCount; p++) {
+        for (size_t c = 0; c < 4; c++)
+            planes[p][c] = _mm512_set1_ps(frustum.planes[p][c]);
+
+        for (size_t c = 0; c < 3; c++)
+            absNormals[p][c] = _mm512_set1_ps(std::abs(frustum.planes[p][c]));
+    }
+
+    const __m512 zero = _mm512_setzero_ps();
+
+    size_t i = getAlignHead(centers.x, 64, count);
+    size_t total = cullBoxesScalar(frustum, centers, extents, visible, i);
+
+    for (; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        __m512 x = _mm512_maskz_loadu_ps(lanes, centers.x + i);
+        __m512 y = _mm512_maskz_loadu_ps(lanes, centers.y + i);
+        __m512 z = _mm512_maskz_loadu_ps(lanes, centers.z + i);
+
+        __m512 ex = _mm512_maskz_loadu_ps(lanes, extents.x + i);
+        __m512 ey = _mm512_maskz_loadu_ps(lanes, extents.y + i);
+        __m512 ez = _mm512_maskz_loadu_ps(lanes, extents.z + i);
+
+        __mmask16 inside = lanes;
+        for (size_t p = 0; p < Frustum::eCount; p++) {
+            __m512 r = _mm512_mul_ps(absNormals[p][0], ex);
+            r = _mm512_fmadd_ps(absNormals[p][1], ey, r);
+            r = _mm512_fmadd_ps(absNormals[p][2], ez, r);
+
+            __m512 d = planeDistanceAvx512(planes[p], x, y, z);
+            inside = _mm512_mask_cmp_ps_mask(inside, d, _mm512_sub_ps(zero, r), _CMP_GE_OQ);
+        }
+
+        total += storeVisibleAvx512(visible + i, lanes, inside);
+    }
+
+    return total;
+}
+
+static SM_TARGET_AVX512 void normalizeQuatsAvx512(SoaVec4<float> quats, size_t count) {
+    size_t i = getAlignHead(quats.x, 64, count);
+    normalizeQuatsScalar(quats, i);
+
+    for (; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        __m512 x = _mm512_maskz_loadu_ps(lanes, quats.x + i);
+        __m512 y = _mm512_maskz_loadu_ps(lanes, quats.y + i);
+        __m512 z = _mm512_maskz_loadu_ps(lanes, quats.z + i);
+        __m512 w = _mm512_maskz_loadu_ps(lanes, quats.w + i);
+
+        __m512 length = _mm512_mul_ps(x, x);
+        length = _mm512_fmadd_ps(y, y, length);
+        length = _mm512_fmadd_ps(z, z, length);
+        length = _mm512_fmadd_ps(w, w, length);
+        length = _mm512_sqrt_ps(length);
+
+        _mm512_mask_storeu_ps(quats.x + i, lanes, _mm512_div_ps(x, length));
+        _mm512_mask_storeu_ps(quats.y + i, lanes, _mm512_div_ps(y, length));
+        _mm512_mask_storeu_ps(quats.z + i, lanes, _mm512_div_ps(z, length));
+        _mm512_mask_storeu_ps(quats.w + i, lanes, _mm512_div_ps(w, length));
+    }
+}
+
+static SM_TARGET_AVX512 void scaleAvx512(const float *src, float *dst, float scale, size_t count) {
+    const __m512 factor = _mm512_set1_ps(scale);
+
+    size_t i = getAlignHead(dst, 64, count);
+    scaleScalar(src, dst, scale, i);
+
+    for (; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        _mm512_mask_storeu_ps(dst + i, lanes, _mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, src + i), factor));
+    }
+}
+
+#endif
+
+///
+/// dispatch
+///
+
+struct Kernels {
+    Isa isa;
+    void(*transform)(const float4x4& matrix, float w, SoaVec3<const float> src, SoaVec3<float> dst, size_t count);
+    size_t(*cullSpheres)(const Frustum& frustum, SoaVec4<const float> spheres, uint8_t *visible, size_t count);
+    size_t(*cullBoxes)(const Frustum& frustum, SoaVec3<const float> centers, SoaVec3<const float> extents, uint8_t *visible, size_t count);
+    void(*normalizeQuats)(SoaVec4<float> quats, size_t count);
+    void(*scale)(const float *src, float *dst, float scale, size_t count);
+};
+
+static constexpr Kernels kScalarKernels = {
+    Isa::eScalar, transformScalar, cullSpheresScalar, cullBoxesScalar, normalizeQuatsScalar, scaleScalar
+};
+
+#if SM_BATCH_X86
+static constexpr Kernels kSse2Kernels = {
+    Isa::eSse2, transformSse2, cullSpheresSse2, cullBoxesSse2, normalizeQuatsSse2, scaleSse2
+};
+
+static constexpr Kernels kAvx2Kernels = {
+    Isa::eAvx2, transformAvx2, cullSpheresAvx2, cullBoxesAvx2, normalizeQuatsAvx2, scaleAvx2
+};
+
+static constexpr Kernels kAvx512Kernels = {
+    Isa::eAvx512, transformAvx512, cullSpheresAvx512, cullBoxesAvx512, normalizeQuatsAvx512, scaleAvx512
+};
+#endif
+
+static const Kernels *getKernelsFor(Isa isa) {
+    switch (isa) {
+#if SM_BATCH_X86
+    case Isa::eSse2: return &kSse2Kernels;
+    case Isa::eAvx2: return &kAvx2Kernels;
+    case Isa::eAvx512: return &kAvx512Kernels;
+#endif
+    default: return &kScalarKernels;
+    }
+}
+
+// constant initialized and filled in on first use rather than a function local
+// static, those are not thread safe when built with -fno-threadsafe-statics.
+// null until the first batch call or setIsa, relaxed is enough as each table is immutable
+static constinit std::atomic<const Kernels*> gKernels = nullptr;
+
+static const Kernels& getKernels() {
+    const Kernels *kernels = gKernels.load(std::memory_order_relaxed);
+    if (kernels == nullptr) [[unlikely]] {
+        const Kernels *best = getKernelsFor(getSupportedIsa());
+
+        // a setIsa that got in first wins, on failure this loads its table
+        if (gKernels.compare_exchange_strong(kernels, best, std::memory_order_relaxed))
+            kernels = best;
+    }
+
+    return *kernels;
+}
+
+#if SM_BATCH_X86
+// cpuid always gives the same answer, so threads racing
+// to detect this all store the same value. -1 until detected
+static constinit std::atomic<int> gSupportedIsa = -1;
+
+static Isa detectSupportedIsa() noexcept {
+    if (CpuId::hasAvx512())
+        return Isa::eAvx512;
+
+    if (CpuId::hasAvx2() && CpuId::hasFma() && CpuId::hasF16c())
+        return Isa::eAvx2;
+
+    return Isa::eSse2;
+}
+#endif
+
+Isa batch::getSupportedIsa() noexcept {
+#if SM_BATCH_X86
+    int isa = gSupportedIsa.load(std::memory_order_relaxed);
+    if (isa == -1) [[unlikely]] {
+        isa = int(detectSupportedIsa());
+        gSupportedIsa.store(isa, std::memory_order_relaxed);
+    }
+
+    return Isa(isa);
+#else
+    return Isa::eScalar;
+#endif
+}
+
+Isa batch::getIsa() noexcept {
+    return getKernels().isa;
+}
+
+bool batch::setIsa(Isa isa) noexcept {
+    if (isa > getSupportedIsa())
+        return false;
+
+    gKernels.store(getKernelsFor(isa), std::memory_order_relaxed);
+    return true;
+}
+
+void batch::transformPoints(const float4x4& matrix, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) noexcept {
+    getKernels().transform(matrix, 1.f, src, dst, count);
+}
+
+void batch::transformVectors(const float4x4& matrix, SoaVec3<const float> src, SoaVec3<float> dst, size_t count) noexcept {
+    getKernels().transform(matrix, 0.f, src, dst, count);
+}
+
+size_t batch::cullSpheres(const Frustum& frustum, SoaVec4<const float> spheres, uint8_t *visible, size_t count) noexcept {
+    return getKernels().cullSpheres(frustum, spheres, visible, count);
+}
+
+size_t batch::cullBoxes(const Frustum& frustum, SoaVec3<const float> centers, SoaVec3<const float> extents, uint8_t *visible, size_t count) noexcept {
+    return getKernels().cullBoxes(frustum, centers, extents, visible, count);
+}
+
+void batch::normalizeQuats(SoaVec4<float> quats, size_t count) noexcept {
+    getKernels().normalizeQuats(quats, count);
+}
+
+// angle types are a single float, so arrays of them are arrays of floats
+static_assert(sizeof(degf) == sizeof(float) && sizeof(radf) == sizeof(float));
+
+void batch::toRadians(const degf *src, radf *dst, size_t count) noexcept {
+    getKernels().scale(reinterpret_cast<const float*>(src), reinterpret_cast<float*>(dst), kDegToRad<float>, count);
+}
+
+void batch::toDegrees(const radf *src, degf *dst, size_t count) noexcept {
+    getKernels().scale(reinterpret_cast<const float*>(src), reinterpret_cast<float*>(dst), kRadToDeg<float>, count);
+}
@@ -0,0 +1,404 @@
+#include "math/half.hpp"
+#include "math/batch.hpp"
+
+#include "base/panic.h"
+
+#include <simcoe_math_config.h>
+
+#include <stdint.h>
+
+#if SMC_MATH_SIMD && (defined(__x86_64__) || defined(_M_X64))
+#   define SM_HALF_X86 1
+#   include <immintrin.h>
+#else
+#   define SM_HALF_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define SM_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#   define SM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#   define SM_TARGET_AVX2
+#   define SM_TARGET_AVX512
+#endif
+
+using namespace sm;
+using namespace sm::math;
+
+using batch::Isa;
+
+template<typename T>
+static constexpr float kNormScale = float(std::numeric_limits<T>::max());
+
+///
+/// scalar, the reference for the wide kernels and what they use for leftover elements
+///
+
+static void toHalfScalar(const float *src, half *dst, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        dst[i] = toHalf(src[i]);
+}
+
+static void fromHalfScalar(const half *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        dst[i] = fromHalf(src[i]);
+}
+
+static void toBFloat16Scalar(const float *src, bfloat16 *dst, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        dst[i] = toBFloat16(src[i]);
+}
+
+static void fromBFloat16Scalar(const bfloat16 *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        dst[i] = fromBFloat16(src[i]);
+}
+
+template<typename T>
+static void quantizeScalar(const float *src, T *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if constexpr (std::is_signed_v<T>)
+            dst[i] = toSnorm<T>(src[i]);
+        else
+            dst[i] = toUnorm<T>(src[i]);
+    }
+}
+
+template<typename T>
+static void dequantizeScalar(const T *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if constexpr (std::is_signed_v<T>)
+            dst[i] = fromSnorm(src[i]);
+        else
+            dst[i] = fromUnorm(src[i]);
+    }
+}
+
+#if SM_HALF_X86
+
+///
+/// avx2 and f16c, 8 floats at a time
+///
+
+static SM_TARGET_AVX2 void toHalfAvx2(const float *src, half *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i result = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + i), result);
+    }
+
+    toHalfScalar(src + i, dst + i, count - i);
+}
+
+static SM_TARGET_AVX2 void fromHalfAvx2(const half *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 result = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i)));
+        _mm256_storeu_ps(dst + i, result);
+    }
+
+    fromHalfScalar(src + i, dst + i, count - i);
+}
+
+/// the same rounding as toBFloat16, the result is in the low 16 bits of each lane
+static SM_TARGET_AVX2 __m256i roundBFloat16Avx2(__m256i bits) {
+    __m256i abs = _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFF'FFFF));
+    __m256i nan = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x7F80'0000));
+
+    __m256i odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+    __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7FFF)));
+    __m256i quiet = _mm256_or_si256(bits, _mm256_set1_epi32(0x40'0000));
+
+    return _mm256_srli_epi32(_mm256_blendv_epi8(rounded, quiet, nan), 16);
+}
+
+static SM_TARGET_AVX2 void toBFloat16Avx2(const float *src, bfloat16 *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = roundBFloat16Avx2(_mm256_loadu_si256((const __m256i*)(src + i)));
+        __m256i hi = roundBFloat16Avx2(_mm256_loadu_si256((const __m256i*)(src + i + 8)));
+
+        // packing works within each 128 bit lane, put the quarters back in order afterwards
+        __m256i packed = _mm256_packus_epi32(lo, hi);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+    toBFloat16Scalar(src + i, dst + i, count - i);
+}
+
+static SM_TARGET_AVX2 void fromBFloat16Avx2(const bfloat16 *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i bits = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_slli_epi32(bits, 16));
+    }
+
+    fromBFloat16Scalar(src + i, dst + i, count - i);
+}
+
+/// clamp, scale, and round 8 floats the same way as toSnorm and toUnorm
+template<typename T>
+static SM_TARGET_AVX2 __m256i loadQuantizedAvx2(const float *src) {
+    __m256 x = _mm256_loadu_ps(src);
+
+    // test the bits rather than comparing x with itself, fast math may fold that away.
+    // masking nan out leaves 0
+    __m256i magnitude = _mm256_and_si256(_mm256_castps_si256(x), _mm256_set1_epi32(0x7FFF'FFFF));
+    __m256i nan = _mm256_cmpgt_epi32(magnitude, _mm256_set1_epi32(0x7F80'0000));
+    x = _mm256_andnot_ps(_mm256_castsi256_ps(nan), x);
+
+    const __m256 lower = _mm256_set1_ps(std::is_signed_v<T> ? -1.f : 0.f);
+    x = _mm256_min_ps(_mm256_max_ps(x, lower), _mm256_set1_ps(1.f));
+
+    return _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(kNormScale<T>)));
+}
+
+template<typename T>
+static SM_TARGET_AVX2 void quantizeAvx2(const float *src, T *dst, size_t count) {
+    size_t i = 0;
+    if constexpr (sizeof(T) == 2) {
+        for (; i + 16 <= count; i += 16) {
+            __m256i lo = loadQuantizedAvx2<T>(src + i);
+            __m256i hi = loadQuantizedAvx2<T>(src + i + 8);
+
+            __m256i packed = std::is_signed_v<T> ? _mm256_packs_epi32(lo, hi) : _mm256_packus_epi32(lo, hi);
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+    } else {
+        for (; i + 32 <= count; i += 32) {
+            __m256i a = loadQuantizedAvx2<T>(src + i);
+            __m256i b = loadQuantizedAvx2<T>(src + i + 8);
+            __m256i c = loadQuantizedAvx2<T>(src + i + 16);
+            __m256i d = loadQuantizedAvx2<T>(src + i + 24);
+
+            // every value fits in 16 bits already, so the signed pack is exact for both
+            __m256i ab = _mm256_packs_epi32(a, b);
+            __m256i cd = _mm256_packs_epi32(c, d);
+            __m256i packed = std::is_signed_v<T> ? _mm256_packs_epi16(ab, cd) : _mm256_packus_epi16(ab, cd);
+
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+        }
+    }
+
+    quantizeScalar(src + i, dst + i, count - i);
+}
+
+template<typename T>
+static SM_TARGET_AVX2 __m256i widenAvx2(const T *src) {
+    if constexpr (std::is_same_v<T, int8_t>)
+        return _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)src));
+    else if constexpr (std::is_same_v<T, uint8_t>)
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+    else if constexpr (std::is_same_v<T, int16_t>)
+        return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)src));
+    else
+        return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)src));
+}
+
+template<typename T>
+static SM_TARGET_AVX2 void dequantizeAvx2(const T *src, float *dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(kNormScale<T>);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // divide rather than multiply by the reciprocal, so the results match the scalar code exactly
+        __m256 x = _mm256_div_ps(_mm256_cvtepi32_ps(widenAvx2(src + i)), scale);
+        if constexpr (std::is_signed_v<T>)
+            x = _mm256_max_ps(x, _mm256_set1_ps(-1.f));
+
+        _mm256_storeu_ps(dst + i, x);
+    }
+
+    dequantizeScalar(src + i, dst + i, count - i);
+}
+
+///
+/// avx512f, 16 floats at a time. float sources use masked loads for the tail,
+/// 16 and 8 bit sources have no masked loads without avx512bw so they finish with scalar code
+///
+
+static SM_TARGET_AVX512 __mmask16 laneMask(size_t remaining) {
+    return remaining >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << remaining) - 1);
+}
+
+static SM_TARGET_AVX512 void toHalfAvx512(const float *src, half *dst, size_t count) {
+    for (size_t i = 0; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        __m256i result = _mm512_cvtps_ph(_mm512_maskz_loadu_ps(lanes, src + i), _MM_FROUND_TO_NEAREST_INT);
+
+        // widen back out so the narrowing store can take the mask
+        _mm512_mask_cvtepi32_storeu_epi16(dst + i, lanes, _mm512_cvtepu16_epi32(result));
+    }
+}
+
+static SM_TARGET_AVX512 void fromHalfAvx512(const half *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 result = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(src + i)));
+        _mm512_storeu_ps(dst + i, result);
+    }
+
+    fromHalfScalar(src + i, dst + i, count - i);
+}
+
+static SM_TARGET_AVX512 void toBFloat16Avx512(const float *src, bfloat16 *dst, size_t count) {
+    const __m512i absMask = _mm512_set1_epi32(0x7FFF'FFFF);
+    const __m512i infinity = _mm512_set1_epi32(0x7F80'0000);
+
+    for (size_t i = 0; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        __m512i bits = _mm512_maskz_loadu_epi32(lanes, src + i);
+
+        __mmask16 nan = _mm512_cmpgt_epi32_mask(_mm512_and_si512(bits, absMask), infinity);
+
+        __m512i odd = _mm512_and_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(1));
+        __m512i rounded = _mm512_add_epi32(bits, _mm512_add_epi32(odd, _mm512_set1_epi32(0x7FFF)));
+        rounded = _mm512_mask_or_epi32(rounded, nan, bits, _mm512_set1_epi32(0x40'0000));
+
+        _mm512_mask_cvtepi32_storeu_epi16(dst + i, lanes, _mm512_srli_epi32(rounded, 16));
+    }
+}
+
+static SM_TARGET_AVX512 void fromBFloat16Avx512(const bfloat16 *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i bits = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(src + i)));
+        _mm512_storeu_si512(dst + i, _mm512_slli_epi32(bits, 16));
+    }
+
+    fromBFloat16Scalar(src + i, dst + i, count - i);
+}
+
+template<typename T>
+static SM_TARGET_AVX512 void quantizeAvx512(const float *src, T *dst, size_t count) {
+    const __m512 lower = _mm512_set1_ps(std::is_signed_v<T> ? -1.f : 0.f);
+    const __m512 upper = _mm512_set1_ps(1.f);
+    const __m512 scale = _mm512_set1_ps(kNormScale<T>);
+
+    for (size_t i = 0; i < count; i += 16) {
+        __mmask16 lanes = laneMask(count - i);
+        __m512 x = _mm512_maskz_loadu_ps(lanes, src + i);
+
+        __m512i magnitude = _mm512_and_si512(_mm512_castps_si512(x), _mm512_set1_epi32(0x7FFF'FFFF));
+        x = _mm512_maskz_mov_ps(_mm512_cmple_epi32_mask(magnitude, _mm512_set1_epi32(0x7F80'0000)), x);
+        x = _mm512_min_ps(_mm512_max_ps(x, lower), upper);
+
+        // the clamp keeps every value in range of T, so truncating is exact
+        __m512i result = _mm512_cvtps_epi32(_mm512_mul_ps(x, scale));
+        if constexpr (sizeof(T) == 2)
+            _mm512_mask_cvtepi32_storeu_epi16(dst + i, lanes, result);
+        else
+            _mm512_mask_cvtepi32_storeu_epi8(dst + i, lanes, result);
+    }
+}
+
+template<typename T>
+static SM_TARGET_AVX512 __m512i widenAvx512(const T *src) {
+    if constexpr (std::is_same_v<T, int8_t>)
+        return _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i*)src));
+    else if constexpr (std::is_same_v<T, uint8_t>)
+        return _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)src));
+    else if constexpr (std::is_same_v<T, int16_t>)
+        return _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*)src));
+    else
+        return _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)src));
+}
+
+template<typename T>
+static SM_TARGET_AVX512 void dequantizeAvx512(const T *src, float *dst, size_t count) {
+    const __m512 scale = _mm512_set1_ps(kNormScale<T>);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 x = _mm512_div_ps(_mm512_cvtepi32_ps(widenAvx512(src + i)), scale);
+        if constexpr (std::is_signed_v<T>)
+            x = _mm512_max_ps(x, _mm512_set1_ps(-1.f));
+
+        _mm512_storeu_ps(dst + i, x);
+    }
+
+    dequantizeScalar(src + i, dst + i, count - i);
+}
+
+#endif
+
+///
+/// dispatch, sse2 has no half conversion instructions so it shares the scalar code
+///
+
+#if SM_HALF_X86
+#   define SM_DISPATCH(name, ...) \
+        switch (batch::getIsa()) { \
+        case Isa::eAvx512: return name##Avx512(__VA_ARGS__); \
+        case Isa::eAvx2: return name##Avx2(__VA_ARGS__); \
+        default: return name##Scalar(__VA_ARGS__); \
+        }
+#else
+#   define SM_DISPATCH(name, ...) return name##Scalar(__VA_ARGS__);
+#endif
+
+template<typename S, typename D>
+static void checkSize(std::span<S> src, std::span<D> dst) {
+    CTASSERTF(src.size() == dst.size(), "source has %zu elements, destination has %zu", src.size(), dst.size());
+}
+
+void math::toHalf(std::span<const float> src, std::span<half> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(toHalf, src.data(), dst.data(), src.size());
+}
+
+void math::fromHalf(std::span<const half> src, std::span<float> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(fromHalf, src.data(), dst.data(), src.size());
+}
+
+void math::toBFloat16(std::span<const float> src, std::span<bfloat16> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(toBFloat16, src.data(), dst.data(), src.size());
+}
+
+void math::fromBFloat16(std::span<const bfloat16> src, std::span<float> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(fromBFloat16, src.data(), dst.data(), src.size());
+}
+
+void math::toSnorm(std::span<const float> src, std::span<int8_t> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(quantize, src.data(), dst.data(), src.size());
+}
+
+void math::toSnorm(std::span<const float> src, std::span<int16_t> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(quantize, src.data(), dst.data(), src.size());
+}
+
+void math::toUnorm(std::span<const float> src, std::span<uint8_t> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(quantize, src.data(), dst.data(), src.size());
+}
+
+void math::toUnorm(std::span<const float> src, std::span<uint16_t> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(quantize, src.data(), dst.data(), src.size());
+}
+
+void math::fromSnorm(std::span<const int8_t> src, std::span<float> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(dequantize, src.data(), dst.data(), src.size());
+}
+
+void math::fromSnorm(std::span<const int16_t> src, std::span<float> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(dequantize, src.data(), dst.data(), src.size());
+}
+
+void math::fromUnorm(std::span<const uint8_t> src, std::span<float> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(dequantize, src.data(), dst.data(), src.size());
+}
+
+void math::fromUnorm(std::span<const uint16_t> src, std::span<float> dst) noexcept {
+    checkSize(src, dst);
+    SM_DISPATCH(dequantize, src.data(), dst.data(), src.size());
+}
@@ -0,0 +1,409 @@
+#include "test/gtest_common.hpp"
+
+#include "math/batch.hpp"
+
+#include <random>
+
+using namespace sm::math;
+
+using batch::Isa;
+
+// covers empty batches, partial vectors, and a few full ones with a remainder for every kernel width
+static constexpr size_t kCounts[] = { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1000, 1003 };
+
+// larger than any count so writes past the end can be caught
+static constexpr size_t kCapacity = 1024 + 16;
+
+static constexpr float kSentinel = -12345.f;
+
+static const char *getIsaName(Isa isa) {
+    switch (isa) {
+    case Isa::eScalar: return "scalar";
+    case Isa::eSse2: return "sse2";
+    case Isa::eAvx2: return "avx2";
+    case Isa::eAvx512: return "avx512";
+    default: return "unknown";
+    }
+}
+
+// only the scalar and sse2 kernels promise the same rounding as the per element code
+static bool isExact(Isa isa) {
+#if SM_MATH_FMA || defined(__FAST_MATH__)
+    return false;
+#else
+    return isa <= Isa::eSse2;
+#endif
+}
+
+/// run @a fn once for each instruction set this machine supports
+template<typename F>
+static void forEachIsa(F&& fn) {
+    Isa supported = batch::getSupportedIsa();
+    for (Isa isa : { Isa::eScalar, Isa::eSse2, Isa::eAvx2, Isa::eAvx512 }) {
+        if (!batch::setIsa(isa))
+            continue;
+
+        SCOPED_TRACE(getIsaName(isa));
+        fn(isa);
+    }
+
+    ASSERT_TRUE(batch::setIsa(supported));
+}
+
+/// structure of arrays storage for tests, every array is padded with sentinels
+struct Soa {
+    std::vector<float> x, y, z, w;
+
+    Soa() : x(kCapacity, kSentinel), y(kCapacity, kSentinel), z(kCapacity, kSentinel), w(kCapacity, kSentinel) { }
+
+    SoaVec3<float> vec3() { return { x.data(), y.data(), z.data() }; }
+    SoaVec4<float> vec4() { return { x.data(), y.data(), z.data(), w.data() }; }
+    SoaVec3<const float> cvec3() const { return { x.data(), y.data(), z.data() }; }
+    SoaVec4<const float> cvec4() const { return { x.data(), y.data(), z.data(), w.data() }; }
+
+    float4 at(size_t i) const { return { x[i], y[i], z[i], w[i] }; }
+};
+
+class BatchTest : public testing::Test {
+    std::mt19937 mRandom{1234};
+
+public:
+    float random(float low, float high) {
+        std::uniform_real_distribution<float> dist{low, high};
+        return dist(mRandom);
+    }
+
+    Soa soa(size_t count, float low, float high) {
+        Soa result;
+        for (size_t i = 0; i < count; i++) {
+            result.x[i] = random(low, high);
+            result.y[i] = random(low, high);
+            result.z[i] = random(low, high);
+            result.w[i] = random(low, high);
+        }
+        return result;
+    }
+
+    float4x4 matrix() {
+        float4x4 result;
+        for (float& field : result.fields)
+            field = random(-2.f, 2.f);
+
+        return result;
+    }
+
+    // a camera at (0, 0, 10) looking down -z, in the column vector convention the kernels use
+    static Frustum camera() {
+        float4x4 view = float4x4::lookToRH(float3(0.f, 0.f, 10.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f));
+        float4x4 projection = float4x4::perspectiveRH(radf(1.2f), 1.5f, 0.1f, 100.f);
+        return Frustum::fromViewProjection((view * projection).transpose());
+    }
+};
+
+TEST_F(BatchTest, SelectIsa) {
+    Isa supported = batch::getSupportedIsa();
+    ASSERT_EQ(batch::getIsa(), supported);
+
+    ASSERT_TRUE(batch::setIsa(Isa::eScalar));
+    ASSERT_EQ(batch::getIsa(), Isa::eScalar);
+
+    if (supported != Isa::eAvx512) {
+        ASSERT_FALSE(batch::setIsa(Isa::eAvx512));
+        ASSERT_EQ(batch::getIsa(), Isa::eScalar);
+    }
+
+    ASSERT_TRUE(batch::setIsa(supported));
+}
+
+TEST_F(BatchTest, TransformPoints) {
+    float4x4 m = matrix();
+    Soa src = soa(kCapacity, -10.f, 10.f);
+
+    forEachIsa([&](Isa isa) {
+        for (size_t count : kCounts) {
+            Soa dst;
+            batch::transformPoints(m, src.cvec3(), dst.vec3(), count);
+
+            for (size_t i = 0; i < count; i++) {
+                float4 expected = m.mul_scalar(float4(src.x[i], src.y[i], src.z[i], 1.f));
+                float4 actual = dst.at(i);
+                for (size_t c = 0; c < 3; c++) {
+                    if (isExact(isa))
+                        ASSERT_EQ(actual[c], expected[c]) << "count " << count << " element " << i;
+                    else
+                        ASSERT_NEAR(actual[c], expected[c], 1e-4f) << "count " << count << " element " << i;
+                }
+            }
+
+            ASSERT_EQ(dst.x[count], kSentinel);
+            ASSERT_EQ(dst.y[count], kSentinel);
+            ASSERT_EQ(dst.z[count], kSentinel);
+        }
+    });
+}
+
+TEST_F(BatchTest, TransformVectorsIgnoresTranslation) {
+    float4x4 m = float4x4::translation(5.f, 6.f, 7.f) * float4x4::scale(2.f, 3.f, 4.f);
+    Soa src = soa(kCapacity, -10.f, 10.f);
+
+    forEachIsa([&](Isa) {
+        Soa dst;
+        batch::transformVectors(m, src.cvec3(), dst.vec3(), 1003);
+
+        for (size_t i = 0; i < 1003; i++) {
+            ASSERT_EQ(dst.x[i], src.x[i] * 2.f);
+            ASSERT_EQ(dst.y[i], src.y[i] * 3.f);
+            ASSERT_EQ(dst.z[i], src.z[i] * 4.f);
+        }
+    });
+}
+
+TEST_F(BatchTest, TransformInPlace) {
+    float4x4 m = matrix();
+    Soa src = soa(kCapacity, -10.f, 10.f);
+
+    forEachIsa([&](Isa) {
+        Soa expected;
+        batch::transformPoints(m, src.cvec3(), expected.vec3(), 1003);
+
+        Soa inplace = src;
+        batch::transformPoints(m, inplace.cvec3(), inplace.vec3(), 1003);
+
+        ASSERT_TRUE(std::equal(expected.x.begin(), expected.x.begin() + 1003, inplace.x.begin()));
+        ASSERT_TRUE(std::equal(expected.y.begin(), expected.y.begin() + 1003, inplace.y.begin()));
+        ASSERT_TRUE(std::equal(expected.z.begin(), expected.z.begin() + 1003, inplace.z.begin()));
+    });
+}
+
+TEST_F(BatchTest, UnalignedArrays) {
+    float4x4 m = matrix();
+    Frustum frustum = camera();
+    Soa src = soa(kCapacity, -40.f, 40.f);
+
+    // every combination of input and output offsets within a cache line,
+    // so the kernels that align on one array see the others at every offset
+    forEachIsa([&](Isa isa) {
+        for (size_t in = 0; in < 16; in++) {
+            for (size_t out = 0; out < 16; out++) {
+                Soa dst;
+                size_t count = 1000;
+                SoaVec3<const float> points = { src.x.data() + in, src.y.data() + out, src.z.data() + in };
+                batch::transformPoints(m, points, { dst.x.data() + out, dst.y.data() + in, dst.z.data() + out }, count);
+
+                for (size_t i = 0; i < count; i++) {
+                    float4 expected = m.mul_scalar(float4(points.x[i], points.y[i], points.z[i], 1.f));
+                    float actual[] = { dst.x[out + i], dst.y[in + i], dst.z[out + i] };
+                    for (size_t c = 0; c < 3; c++) {
+                        if (isExact(isa))
+                            ASSERT_EQ(actual[c], expected[c]) << "in " << in << " out " << out << " element " << i;
+                        else
+                            ASSERT_NEAR(actual[c], expected[c], 1e-4f) << "in " << in << " out " << out << " element " << i;
+                    }
+                }
+
+                ASSERT_EQ(dst.x[out + count], kSentinel);
+                ASSERT_EQ(dst.y[in + count], kSentinel);
+                ASSERT_EQ(dst.z[out + count], kSentinel);
+
+                if (out > 0)
+                    ASSERT_EQ(dst.x[out - 1], kSentinel);
+            }
+
+            std::vector<uint8_t> visible(kCapacity, 0xFF);
+            SoaVec4<const float> spheres = { src.x.data() + in, src.y.data(), src.z.data() + in, src.w.data() };
+            size_t total = batch::cullSpheres(frustum, spheres, visible.data() + in, 1000);
+            ASSERT_EQ(total, size_t(std::count(visible.begin() + in, visible.begin() + in + 1000, 1)));
+            ASSERT_EQ(visible[in + 1000], 0xFF);
+            if (in > 0)
+                ASSERT_EQ(visible[in - 1], 0xFF);
+        }
+    });
+}
+
+TEST_F(BatchTest, FrustumPlanes) {
+    Frustum frustum = camera();
+
+    // every normal is unit length and the camera looks down -z
+    for (const float4& plane : frustum.planes)
+        ASSERT_NEAR(plane.xyz().length(), 1.f, 1e-5f);
+
+    ASSERT_NEAR(frustum.planes[Frustum::eNear].z, -1.f, 1e-5f);
+    ASSERT_NEAR(frustum.planes[Frustum::eFar].z, 1.f, 1e-5f);
+
+    // near is 0.1 in front of the camera, far is 100
+    ASSERT_NEAR(frustum.planes[Frustum::eNear].w, 9.9f, 1e-3f);
+    ASSERT_NEAR(frustum.planes[Frustum::eFar].w, 90.f, 1e-2f);
+}
+
+TEST_F(BatchTest, CullKnownSpheres) {
+    Frustum frustum = camera();
+
+    Soa spheres;
+    auto add = [&](size_t i, float x, float y, float z, float r) {
+        spheres.x[i] = x; spheres.y[i] = y; spheres.z[i] = z; spheres.w[i] = r;
+    };
+
+    add(0, 0.f, 0.f, 0.f, 1.f);       // straight ahead
+    add(1, 0.f, 0.f, 20.f, 1.f);      // behind the camera
+    add(2, 0.f, 0.f, -200.f, 1.f);    // past the far plane
+    add(3, 0.f, 0.f, -200.f, 150.f);  // past the far plane, but big enough to reach back
+    add(4, 100.f, 0.f, 0.f, 1.f);     // far off to the side
+    add(5, 0.f, 0.f, 10.f, 0.5f);     // around the camera, crosses the near plane
+    add(6, 0.f, 50.f, 0.f, 1.f);      // above
+    add(7, -3.f, 2.f, -20.f, 0.f);    // a point inside
+
+    const uint8_t expected[] = { 1, 0, 0, 1, 0, 1, 0, 1 };
+
+    forEachIsa([&](Isa) {
+        uint8_t visible[8];
+        ASSERT_EQ(batch::cullSpheres(frustum, spheres.cvec4(), visible, 8), 4);
+        for (size_t i = 0; i < 8; i++)
+            ASSERT_EQ(visible[i], expected[i]) << "sphere " << i;
+    });
+}
+
+TEST_F(BatchTest, CullPointsMatchesClipSpace) {
+    float4x4 view = float4x4::lookToRH(float3(0.f, 0.f, 10.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f));
+    float4x4 projection = float4x4::perspectiveRH(radf(1.2f), 1.5f, 0.1f, 100.f);
+    float4x4 viewProjection = (view * projection).transpose();
+    Frustum frustum = Frustum::fromViewProjection(viewProjection);
+
+    // spheres with no radius are points, which are inside if they land inside the clip volume
+    Soa points = soa(kCapacity, -60.f, 60.f);
+    std::vector<uint8_t> expected(kCapacity);
+    std::vector<bool> ambiguous(kCapacity);
+    for (size_t i = 0; i < kCapacity; i++) {
+        points.w[i] = 0.f;
+
+        float4 clip = viewProjection.mul(float4(points.x[i], points.y[i], points.z[i], 1.f));
+        float margin = std::min({ clip.w - std::abs(clip.x), clip.w - std::abs(clip.y), clip.z, clip.w - clip.z });
+        expected[i] = margin >= 0.f;
+        ambiguous[i] = std::abs(margin) < 1e-3f;
+    }
+
+    forEachIsa([&](Isa) {
+        for (size_t count : kCounts) {
+            std::vector<uint8_t> visible(kCapacity, 0xFF);
+            size_t total = batch::cullSpheres(frustum, points.cvec4(), visible.data(), count);
+
+            size_t seen = 0;
+            for (size_t i = 0; i < count; i++) {
+                seen += visible[i];
+                if (!ambiguous[i])
+                    ASSERT_EQ(visible[i], expected[i]) << "count " << count << " point " << i;
+            }
+
+            ASSERT_EQ(total, seen);
+            ASSERT_EQ(visible[count], 0xFF);
+        }
+    });
+}
+
+TEST_F(BatchTest, CullSpheresMatchesScalar) {
+    Frustum frustum = camera();
+    Soa spheres = soa(kCapacity, -60.f, 60.f);
+    for (size_t i = 0; i < kCapacity; i++)
+        spheres.w[i] = random(0.f, 5.f);
+
+    ASSERT_TRUE(batch::setIsa(Isa::eScalar));
+    std::vector<uint8_t> expected(kCapacity);
+    size_t expectedTotal = batch::cullSpheres(frustum, spheres.cvec4(), expected.data(), kCapacity);
+
+    // a fused multiply add could flip a sphere that exactly touches a plane,
+    // none of these are close enough for that to happen
+    forEachIsa([&](Isa) {
+        std::vector<uint8_t> visible(kCapacity);
+        ASSERT_EQ(batch::cullSpheres(frustum, spheres.cvec4(), visible.data(), kCapacity), expectedTotal);
+        ASSERT_EQ(visible, expected);
+    });
+}
+
+TEST_F(BatchTest, CullBoxes) {
+    Frustum frustum = camera();
+    Soa centers = soa(kCapacity, -60.f, 60.f);
+    Soa extents = soa(kCapacity, 0.f, 5.f);
+
+    ASSERT_TRUE(batch::setIsa(Isa::eScalar));
+    std::vector<uint8_t> expected(kCapacity);
+    size_t expectedTotal = batch::cullBoxes(frustum, centers.cvec3(), extents.cvec3(), expected.data(), kCapacity);
+
+    // boxes with no size are the same as points
+    Soa empty = soa(kCapacity, 0.f, 0.f);
+    Soa points = centers;
+    std::fill(points.w.begin(), points.w.end(), 0.f);
+
+    forEachIsa([&](Isa) {
+        for (size_t count : kCounts) {
+            std::vector<uint8_t> visible(kCapacity, 0xFF);
+            size_t total = batch::cullBoxes(frustum, centers.cvec3(), extents.cvec3(), visible.data(), count);
+            ASSERT_TRUE(std::equal(visible.begin(), visible.begin() + count, expected.begin())) << "count " << count;
+            ASSERT_EQ(total, size_t(std::count(expected.begin(), expected.begin() + count, 1)));
+            ASSERT_EQ(visible[count], 0xFF);
+        }
+
+        std::vector<uint8_t> all(kCapacity);
+        ASSERT_EQ(batch::cullBoxes(frustum, centers.cvec3(), extents.cvec3(), all.data(), kCapacity), expectedTotal);
+
+        std::vector<uint8_t> boxes(kCapacity);
+        std::vector<uint8_t> spheres(kCapacity);
+        batch::cullBoxes(frustum, centers.cvec3(), empty.cvec3(), boxes.data(), kCapacity);
+        batch::cullSpheres(frustum, points.cvec4(), spheres.data(), kCapacity);
+        ASSERT_EQ(boxes, spheres);
+    });
+
+    // a box that contains the whole frustum is visible even though its corners are all outside
+    float x = 0.f, y = 0.f, z = 0.f;
+    float e = 1000.f;
+    uint8_t visible = 0;
+    forEachIsa([&](Isa) {
+        ASSERT_EQ(batch::cullBoxes(frustum, { &x, &y, &z }, { &e, &e, &e }, &visible, 1), 1);
+    });
+}
+
+TEST_F(BatchTest, NormalizeQuats) {
+    Soa src = soa(kCapacity, -2.f, 2.f);
+
+    forEachIsa([&](Isa isa) {
+        for (size_t count : kCounts) {
+            Soa quats = src;
+            batch::normalizeQuats(quats.vec4(), count);
+
+            for (size_t i = 0; i < count; i++) {
+                float4 expected = src.at(i).normalized();
+                float4 actual = quats.at(i);
+                if (isExact(isa))
+                    ASSERT_EQ(actual, expected) << "count " << count << " element " << i;
+
+                for (size_t c = 0; c < 4; c++)
+                    ASSERT_NEAR(actual[c], expected[c], 1e-6f);
+            }
+
+            ASSERT_EQ(quats.x[count], src.x[count]);
+            ASSERT_EQ(quats.w[count], src.w[count]);
+        }
+    });
+}
+
+TEST_F(BatchTest, ConvertAngles) {
+    std::vector<degf> degrees(kCapacity, degf(kSentinel));
+    for (size_t i = 0; i < kCapacity; i++)
+        degrees[i] = degf(random(-720.f, 720.f));
+
+    forEachIsa([&](Isa) {
+        for (size_t count : kCounts) {
+            std::vector<radf> radians(kCapacity, radf(kSentinel));
+            batch::toRadians(degrees.data(), radians.data(), count);
+            for (size_t i = 0; i < count; i++)
+                ASSERT_EQ(radians[i].get_radians(), degrees[i].get_radians());
+
+            ASSERT_EQ(radians[count].get(), kSentinel);
+
+            std::vector<degf> back(kCapacity, degf(kSentinel));
+            batch::toDegrees(radians.data(), back.data(), count);
+            for (size_t i = 0; i < count; i++)
+                ASSERT_EQ(back[i].get_degrees(), radians[i].get_degrees());
+
+            ASSERT_EQ(back[count].get(), kSentinel);
+        }
+    });
+}
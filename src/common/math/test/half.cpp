@@ -0,0 +1,395 @@
+#include "test/gtest_common.hpp"
+
+#include "math/half.hpp"
+#include "math/batch.hpp"
+
+#include <random>
+
+using namespace sm::math;
+
+using batch::Isa;
+
+// covers empty spans, partial vectors, and full ones with a remainder for every kernel width
+static constexpr size_t kCounts[] = { 0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 1000, 1003 };
+
+static const char *getIsaName(Isa isa) {
+    switch (isa) {
+    case Isa::eScalar: return "scalar";
+    case Isa::eSse2: return "sse2";
+    case Isa::eAvx2: return "avx2";
+    case Isa::eAvx512: return "avx512";
+    default: return "unknown";
+    }
+}
+
+/// run @a fn once for each instruction set this machine supports
+template<typename F>
+static void forEachIsa(F&& fn) {
+    Isa supported = batch::getSupportedIsa();
+    for (Isa isa : { Isa::eScalar, Isa::eSse2, Isa::eAvx2, Isa::eAvx512 }) {
+        if (!batch::setIsa(isa))
+            continue;
+
+        SCOPED_TRACE(getIsaName(isa));
+        fn(isa);
+    }
+
+    ASSERT_TRUE(batch::setIsa(supported));
+}
+
+static uint32_t bitsOf(float value) {
+    return std::bit_cast<uint32_t>(value);
+}
+
+static float floatOf(uint32_t bits) {
+    return std::bit_cast<float>(bits);
+}
+
+static bool isHalfNan(uint16_t bits) {
+    return (bits & 0x7FFF) > 0x7C00;
+}
+
+// std::isnan may be folded to false under fast math, test the bits instead
+static bool isFloatNan(float value) {
+    return (bitsOf(value) & 0x7FFF'FFFF) > 0x7F80'0000;
+}
+
+/// random floats with every special case mixed in, spread over the range a half can represent
+static std::vector<float> getTestFloats(size_t count) {
+    std::mt19937 rng{1234};
+    std::uniform_int_distribution<int> exponent{-30, 20};
+    std::uniform_real_distribution<float> mantissa{-2.f, 2.f};
+
+    const float kSpecial[] = {
+        0.f, -0.f, 1.f, -1.f, 65504.f, 65519.f, 65520.f, -65520.f, 1e10f, 1e-10f,
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(), floatOf(0x7F80'0001), floatOf(0xFFC1'2345),
+        std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(),
+        floatOf(0x3300'0000), floatOf(0x3300'0001), floatOf(0x3380'0000),
+    };
+
+    std::vector<float> result;
+    for (size_t i = 0; i < count; i++) {
+        if (i % 7 == 0)
+            result.push_back(kSpecial[(i / 7) % std::size(kSpecial)]);
+        else
+            result.push_back(std::ldexp(mantissa(rng), exponent(rng)));
+    }
+
+    return result;
+}
+
+TEST(HalfTest, ExhaustiveRoundTrip) {
+    for (uint32_t i = 0; i <= 0xFFFF; i++) {
+        uint16_t bits = uint16_t(i);
+        float value = fromHalfBits(bits);
+        uint16_t result = toHalfBits(value);
+
+        if (isHalfNan(bits)) {
+            ASSERT_TRUE(isFloatNan(value)) << std::hex << i;
+            ASSERT_EQ(result, bits | 0x200) << std::hex << i;
+        } else {
+            ASSERT_EQ(result, bits) << std::hex << i;
+            ASSERT_EQ(bitsOf(value), bitsOf(float(std::bit_cast<half>(bits)))) << std::hex << i;
+        }
+    }
+}
+
+TEST(HalfTest, RoundsToNearestEven) {
+    // every pair of neighbouring finite positive halves, the midpoint is exact as a float
+    for (uint16_t bits = 0; bits < 0x7BFF; bits++) {
+        float lo = fromHalfBits(bits);
+        float hi = fromHalfBits(bits + 1);
+        float mid = (lo + hi) / 2.f;
+
+        uint16_t even = (bits & 1) ? bits + 1 : bits;
+        ASSERT_EQ(toHalfBits(mid), even) << std::hex << bits;
+        ASSERT_EQ(toHalfBits(std::nextafter(mid, 0.f)), bits) << std::hex << bits;
+        ASSERT_EQ(toHalfBits(std::nextafter(mid, INFINITY)), bits + 1) << std::hex << bits;
+        ASSERT_EQ(toHalfBits(-mid), even | 0x8000) << std::hex << bits;
+    }
+}
+
+TEST(HalfTest, MatchesCompilerConversion) {
+    for (float value : getTestFloats(100'000)) {
+        if (isFloatNan(value))
+            continue;
+
+        ASSERT_EQ(toHalfBits(value), std::bit_cast<uint16_t>(half(value))) << value;
+    }
+}
+
+TEST(HalfTest, SpecialValues) {
+    EXPECT_EQ(toHalfBits(0.f), 0x0000);
+    EXPECT_EQ(toHalfBits(-0.f), 0x8000);
+    EXPECT_EQ(toHalfBits(1.f), 0x3C00);
+    EXPECT_EQ(toHalfBits(65504.f), 0x7BFF);
+    EXPECT_EQ(toHalfBits(65519.f), 0x7BFF);
+    EXPECT_EQ(toHalfBits(65520.f), 0x7C00);
+    EXPECT_EQ(toHalfBits(-1e10f), 0xFC00);
+    EXPECT_EQ(toHalfBits(std::numeric_limits<float>::infinity()), 0x7C00);
+
+    // the smallest denormal is 2^-24, half of it is a tie that rounds to zero
+    EXPECT_EQ(toHalfBits(std::ldexp(1.f, -24)), 0x0001);
+    EXPECT_EQ(toHalfBits(std::ldexp(1.f, -25)), 0x0000);
+    EXPECT_EQ(toHalfBits(std::nextafter(std::ldexp(1.f, -25), 1.f)), 0x0001);
+    EXPECT_EQ(toHalfBits(std::numeric_limits<float>::denorm_min()), 0x0000);
+
+    // nans are quieted and keep the top of their payload
+    EXPECT_EQ(toHalfBits(floatOf(0x7F80'0001)), 0x7E00);
+    EXPECT_EQ(toHalfBits(floatOf(0xFFA0'2000)), 0xFF01);
+    EXPECT_EQ(bitsOf(fromHalfBits(0x7C01)), 0x7FC0'2000u);
+    EXPECT_EQ(bitsOf(fromHalfBits(0xFC00)), 0xFF80'0000u);
+
+    static_assert(toHalfBits(1.5f) == 0x3E00);
+    static_assert(fromHalfBits(0xC000) == -2.f);
+}
+
+TEST(HalfTest, BulkMatchesScalar) {
+    // every half, then the neighbours of every midpoint between them
+    std::vector<float> values;
+    for (uint32_t i = 0; i <= 0xFFFF; i++)
+        values.push_back(fromHalfBits(uint16_t(i)));
+
+    for (uint16_t bits = 0; bits < 0x7BFF; bits++) {
+        float mid = (fromHalfBits(bits) + fromHalfBits(bits + 1)) / 2.f;
+        values.push_back(std::nextafter(mid, 0.f));
+        values.push_back(mid);
+        values.push_back(-std::nextafter(mid, INFINITY));
+    }
+
+    std::vector<float> random = getTestFloats(10'000);
+    values.insert(values.end(), random.begin(), random.end());
+
+    std::vector<half> halves(values.size());
+    std::vector<float> floats(values.size());
+
+    forEachIsa([&](Isa) {
+        std::fill(halves.begin(), halves.end(), half(0));
+        toHalf(values, halves);
+
+        for (size_t i = 0; i < values.size(); i++)
+            ASSERT_EQ(std::bit_cast<uint16_t>(halves[i]), toHalfBits(values[i])) << i;
+
+        fromHalf(halves, floats);
+
+        for (size_t i = 0; i < values.size(); i++)
+            ASSERT_EQ(bitsOf(floats[i]), bitsOf(fromHalf(halves[i]))) << i;
+    });
+}
+
+TEST(HalfTest, BulkCounts) {
+    std::vector<float> values = getTestFloats(1024);
+
+    forEachIsa([&](Isa) {
+        for (size_t count : kCounts) {
+            SCOPED_TRACE(count);
+
+            // unaligned on purpose, and padded to catch writes past the end
+            std::vector<half> halves(count + 2, half(-3.f));
+            std::vector<float> floats(count + 2, -3.f);
+
+            std::span<const float> src{values.data() + 1, count};
+            toHalf(src, std::span{halves.data() + 1, count});
+            fromHalf(std::span<const half>{halves.data() + 1, count}, std::span{floats.data() + 1, count});
+
+            ASSERT_EQ(halves[0], half(-3.f));
+            ASSERT_EQ(halves[count + 1], half(-3.f));
+            ASSERT_EQ(floats[0], -3.f);
+            ASSERT_EQ(floats[count + 1], -3.f);
+
+            for (size_t i = 0; i < count; i++) {
+                ASSERT_EQ(std::bit_cast<uint16_t>(halves[i + 1]), toHalfBits(src[i])) << i;
+                ASSERT_EQ(bitsOf(floats[i + 1]), bitsOf(fromHalf(toHalf(src[i])))) << i;
+            }
+        }
+    });
+}
+
+TEST(BFloat16Test, ExhaustiveRoundTrip) {
+    for (uint32_t i = 0; i <= 0xFFFF; i++) {
+        bfloat16 value = { uint16_t(i) };
+        bfloat16 result = toBFloat16(fromBFloat16(value));
+
+        if ((i & 0x7FFF) > 0x7F80)
+            ASSERT_EQ(result.bits, i | 0x40) << std::hex << i;
+        else
+            ASSERT_EQ(result.bits, i) << std::hex << i;
+    }
+}
+
+TEST(BFloat16Test, Rounding) {
+    EXPECT_EQ(toBFloat16(1.f).bits, 0x3F80);
+
+    // ties go to the even neighbour, anything past the tie rounds up
+    EXPECT_EQ(toBFloat16(floatOf(0x3F80'8000)).bits, 0x3F80);
+    EXPECT_EQ(toBFloat16(floatOf(0x3F81'8000)).bits, 0x3F82);
+    EXPECT_EQ(toBFloat16(floatOf(0x3F80'8001)).bits, 0x3F81);
+    EXPECT_EQ(toBFloat16(floatOf(0x3F80'7FFF)).bits, 0x3F80);
+    EXPECT_EQ(toBFloat16(floatOf(0xBF81'8000)).bits, 0xBF82);
+
+    // denormals round rather than flush
+    EXPECT_EQ(toBFloat16(floatOf(0x0000'8000)).bits, 0x0000);
+    EXPECT_EQ(toBFloat16(floatOf(0x0001'8000)).bits, 0x0002);
+    EXPECT_EQ(toBFloat16(floatOf(0x0000'8001)).bits, 0x0001);
+
+    EXPECT_EQ(toBFloat16(std::numeric_limits<float>::max()).bits, 0x7F80);
+    EXPECT_EQ(toBFloat16(-std::numeric_limits<float>::infinity()).bits, 0xFF80);
+    EXPECT_EQ(toBFloat16(floatOf(0x7F80'0001)).bits, 0x7FC0);
+    EXPECT_EQ(toBFloat16(floatOf(0xFFA1'0000)).bits, 0xFFE1);
+}
+
+TEST(BFloat16Test, BulkMatchesScalar) {
+    std::vector<float> values = getTestFloats(10'000);
+    for (uint64_t i = 0; i < 0x1'0000'0000; i += 0x1'0001)
+        values.push_back(floatOf(uint32_t(i)));
+
+    forEachIsa([&](Isa) {
+        for (size_t count : kCounts) {
+            SCOPED_TRACE(count);
+
+            std::vector<bfloat16> packed(count + 2, bfloat16{ 0x1234 });
+            std::vector<float> floats(count + 2, -3.f);
+
+            std::span<const float> src{values.data() + 1, count};
+            toBFloat16(src, std::span{packed.data() + 1, count});
+            fromBFloat16(std::span<const bfloat16>{packed.data() + 1, count}, std::span{floats.data() + 1, count});
+
+            ASSERT_EQ(packed[0].bits, 0x1234);
+            ASSERT_EQ(packed[count + 1].bits, 0x1234);
+            ASSERT_EQ(floats[count + 1], -3.f);
+
+            for (size_t i = 0; i < count; i++) {
+                ASSERT_EQ(packed[i + 1].bits, toBFloat16(src[i]).bits) << i;
+                ASSERT_EQ(bitsOf(floats[i + 1]), uint32_t(packed[i + 1].bits) << 16) << i;
+            }
+        }
+
+        std::vector<bfloat16> packed(values.size());
+        toBFloat16(values, packed);
+
+        for (size_t i = 0; i < values.size(); i++)
+            ASSERT_EQ(packed[i].bits, toBFloat16(values[i]).bits) << std::hex << bitsOf(values[i]);
+    });
+}
+
+TEST(NormTest, Quantize) {
+    const float kNan = std::numeric_limits<float>::quiet_NaN();
+    const float kInf = std::numeric_limits<float>::infinity();
+
+    EXPECT_EQ(toSnorm<int8_t>(1.f), 127);
+    EXPECT_EQ(toSnorm<int8_t>(-1.f), -127);
+    EXPECT_EQ(toSnorm<int8_t>(5.f), 127);
+    EXPECT_EQ(toSnorm<int8_t>(-kInf), -127);
+    EXPECT_EQ(toSnorm<int8_t>(kNan), 0);
+    EXPECT_EQ(toSnorm<int8_t>(0.5f), 64); // 63.5 rounds to even
+    EXPECT_EQ(toSnorm<int16_t>(-1.f), -32767);
+    EXPECT_EQ(toSnorm<int16_t>(0.5f), 16384); // 16383.5
+
+    EXPECT_EQ(toUnorm<uint8_t>(1.f), 255);
+    EXPECT_EQ(toUnorm<uint8_t>(-1.f), 0);
+    EXPECT_EQ(toUnorm<uint8_t>(kInf), 255);
+    EXPECT_EQ(toUnorm<uint8_t>(kNan), 0);
+    EXPECT_EQ(toUnorm<uint8_t>(0.5f), 128); // 127.5
+    EXPECT_EQ(toUnorm<uint16_t>(1.f), 65535);
+    EXPECT_EQ(toUnorm<uint16_t>(0.5f), 32768); // 32767.5
+
+    EXPECT_EQ(fromSnorm(int8_t(-128)), -1.f);
+    EXPECT_EQ(fromSnorm(int8_t(-127)), -1.f);
+    EXPECT_EQ(fromSnorm(int8_t(127)), 1.f);
+    EXPECT_EQ(fromSnorm(int16_t(-32768)), -1.f);
+    EXPECT_EQ(fromUnorm(uint8_t(255)), 1.f);
+    EXPECT_EQ(fromUnorm(uint16_t(0)), 0.f);
+}
+
+template<typename T>
+static void checkNormRoundTrip() {
+    constexpr int kMin = std::is_signed_v<T> ? -int(std::numeric_limits<T>::max()) : 0;
+    for (int i = kMin; i <= int(std::numeric_limits<T>::max()); i++) {
+        T value = T(i);
+        if constexpr (std::is_signed_v<T>)
+            ASSERT_EQ(toSnorm<T>(fromSnorm(value)), value) << i;
+        else
+            ASSERT_EQ(toUnorm<T>(fromUnorm(value)), value) << i;
+    }
+}
+
+TEST(NormTest, RoundTrip) {
+    checkNormRoundTrip<int8_t>();
+    checkNormRoundTrip<uint8_t>();
+    checkNormRoundTrip<int16_t>();
+    checkNormRoundTrip<uint16_t>();
+}
+
+template<typename T>
+static void checkBulkNorm(std::span<const float> values) {
+    SCOPED_TRACE(sizeof(T));
+
+    std::vector<T> quantized(values.size());
+    std::vector<float> floats(values.size());
+
+    for (size_t count : kCounts) {
+        SCOPED_TRACE(count);
+
+        std::vector<T> result(count + 2, T(7));
+        std::span<const float> src = values.subspan(1, count);
+
+        if constexpr (std::is_signed_v<T>)
+            toSnorm(src, std::span{result.data() + 1, count});
+        else
+            toUnorm(src, std::span{result.data() + 1, count});
+
+        ASSERT_EQ(result[0], T(7));
+        ASSERT_EQ(result[count + 1], T(7));
+
+        for (size_t i = 0; i < count; i++) {
+            if constexpr (std::is_signed_v<T>)
+                ASSERT_EQ(result[i + 1], toSnorm<T>(src[i])) << src[i];
+            else
+                ASSERT_EQ(result[i + 1], toUnorm<T>(src[i])) << src[i];
+        }
+    }
+
+    // every integer value back to float
+    std::vector<T> every;
+    for (int i = std::numeric_limits<T>::min(); i <= int(std::numeric_limits<T>::max()); i++)
+        every.push_back(T(i));
+
+    std::vector<float> result(every.size());
+    if constexpr (std::is_signed_v<T>)
+        fromSnorm(std::span<const T>{every}, result);
+    else
+        fromUnorm(std::span<const T>{every}, result);
+
+    for (size_t i = 0; i < every.size(); i++) {
+        if constexpr (std::is_signed_v<T>)
+            ASSERT_EQ(bitsOf(result[i]), bitsOf(fromSnorm(every[i]))) << int(every[i]);
+        else
+            ASSERT_EQ(bitsOf(result[i]), bitsOf(fromUnorm(every[i]))) << int(every[i]);
+    }
+}
+
+TEST(NormTest, BulkMatchesScalar) {
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> dist{-1.5f, 1.5f};
+
+    std::vector<float> values;
+    for (size_t i = 0; i < 1024; i++)
+        values.push_back(dist(rng));
+
+    // specials, and the ties that need round to nearest even
+    const float kSpecial[] = {
+        std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(), -0.f, 0.5f, -0.5f, 1.5f / 255.f, 0.5f / 127.f,
+    };
+
+    for (size_t i = 0; i < std::size(kSpecial); i++)
+        values[i * 13 + 2] = kSpecial[i];
+
+    forEachIsa([&](Isa) {
+        checkBulkNorm<int8_t>(values);
+        checkBulkNorm<uint8_t>(values);
+        checkBulkNorm<int16_t>(values);
+        checkBulkNorm<uint16_t>(values);
+    });
+}
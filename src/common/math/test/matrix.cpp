@@ -0,0 +1,178 @@
+#include "test/gtest_common.hpp"
+
+#include "math/math.hpp"
+
+#include <random>
+
+using namespace sm::math;
+
+// reordered or fused arithmetic in either path means results can only be compared within a few ulps
+#if SM_MATH_FMA || defined(__FAST_MATH__)
+static constexpr bool kExact = false;
+#else
+static constexpr bool kExact = true;
+#endif
+
+static constexpr uint32_t kMaxUlps = kExact ? 0 : 4;
+static constexpr size_t kIterations = 10000;
+
+static uint32_t ulpDistance(float lhs, float rhs) {
+    // map the sign magnitude encoding onto a monotonic integer line
+    auto ordered = [](float value) {
+        int32_t bits = std::bit_cast<int32_t>(value);
+        return bits < 0 ? int64_t(INT32_MIN) - bits : int64_t(bits);
+    };
+
+    return uint32_t(std::abs(ordered(lhs) - ordered(rhs)));
+}
+
+static void expectUlps(const float4& actual, const float4& expected, uint32_t ulps) {
+    for (size_t i = 0; i < 4; i++)
+        EXPECT_LE(ulpDistance(actual[i], expected[i]), ulps) << "lane " << i << ": " << actual[i] << " != " << expected[i];
+}
+
+static void expectUlps(const float4x4& actual, const float4x4& expected, uint32_t ulps) {
+    for (size_t i = 0; i < 4; i++)
+        expectUlps(actual[i], expected[i], ulps);
+}
+
+static void expectNear(const float4x4& actual, const float4x4& expected, float epsilon) {
+    for (size_t i = 0; i < 16; i++)
+        EXPECT_NEAR(actual.fields[i], expected.fields[i], epsilon) << "element " << i;
+}
+
+class MatrixTest : public testing::Test {
+    std::mt19937 mRandom{1234};
+
+public:
+    float4 vec(float low, float high) {
+        std::uniform_real_distribution<float> dist{low, high};
+        return float4(dist(mRandom), dist(mRandom), dist(mRandom), dist(mRandom));
+    }
+
+    float4x4 mat(float low, float high) {
+        return float4x4(vec(low, high), vec(low, high), vec(low, high), vec(low, high));
+    }
+
+    // diagonally dominant so the inverse is well conditioned
+    float4x4 invertible() {
+        float4x4 result = mat(-1.f, 1.f);
+        for (size_t i = 0; i < 4; i++)
+            result[i, i] += 4.f;
+
+        return result;
+    }
+};
+
+TEST_F(MatrixTest, ConstantEvaluation) {
+    constexpr float4x4 transform = float4x4::translation(1.f, 2.f, 3.f) * float4x4::scale(2.f, 2.f, 2.f);
+    static_assert(transform.rows[0] == float4(2.f, 0.f, 0.f, 1.f));
+    static_assert(transform.rows[2] == float4(0.f, 0.f, 2.f, 3.f));
+
+    constexpr float4x4 transposed = transform.transpose();
+    static_assert(transposed.rows[3] == float4(1.f, 2.f, 3.f, 1.f));
+
+    constexpr float4 point = transform.mul(float4(1.f, 1.f, 1.f, 1.f));
+    static_assert(point == float4(3.f, 4.f, 5.f, 1.f));
+
+    static_assert(float4::dot(float4(1.f, 2.f, 3.f, 4.f), float4(1.f)).x == 10.f);
+    static_assert(float4::cross(float4(1.f, 0.f, 0.f, 7.f), float4(0.f, 1.f, 0.f, 7.f)) == float4(0.f, 0.f, 1.f, 0.f));
+}
+
+TEST_F(MatrixTest, TransposeIsExact) {
+    for (size_t i = 0; i < kIterations; i++) {
+        float4x4 m = mat(-100.f, 100.f);
+        expectUlps(m.transpose(), m.transpose_scalar(), 0);
+        expectUlps(m.transpose().transpose(), m, 0);
+    }
+}
+
+TEST_F(MatrixTest, MultiplyMatchesScalar) {
+    // positive inputs avoid cancellation, so reordering can only move the result by a few ulps
+    for (size_t i = 0; i < kIterations; i++) {
+        float4x4 lhs = mat(0.5f, 2.f);
+        float4x4 rhs = mat(0.5f, 2.f);
+        float4 v = vec(0.5f, 2.f);
+
+        expectUlps(lhs.mul(rhs), lhs.mul_scalar(rhs), kMaxUlps);
+        expectUlps(lhs.mul(v), lhs.mul_scalar(v), kMaxUlps);
+    }
+}
+
+TEST_F(MatrixTest, MultiplyAliasing) {
+    float4x4 lhs = mat(-1.f, 1.f);
+    float4x4 rhs = mat(-1.f, 1.f);
+    float4x4 expected = lhs * rhs;
+
+    float4x4 a = lhs;
+    a *= rhs;
+    expectUlps(a, expected, 0);
+
+    float4x4 b = rhs;
+    b = lhs * b;
+    expectUlps(b, expected, 0);
+}
+
+TEST_F(MatrixTest, DotMatchesScalar) {
+    for (size_t i = 0; i < kIterations; i++) {
+        float4 lhs = vec(0.5f, 2.f);
+        float4 rhs = vec(0.5f, 2.f);
+
+        // the vector path sums pairwise, so this is never required to be exact
+        float4 dot = float4::dot(lhs, rhs);
+        float4 expected = float4::dot_scalar(lhs, rhs);
+        expectUlps(dot, expected, 4);
+        ASSERT_TRUE(dot.is_uniform());
+    }
+}
+
+TEST_F(MatrixTest, CrossMatchesScalar) {
+    for (size_t i = 0; i < kIterations; i++) {
+        float4 lhs = vec(-2.f, 2.f);
+        float4 rhs = vec(-2.f, 2.f);
+
+        float4 cross = float4::cross(lhs, rhs);
+        float4 expected = float4::cross_scalar(lhs, rhs);
+        ASSERT_EQ(cross.w, 0.f);
+
+        if constexpr (kExact) {
+            expectUlps(cross, expected, 0);
+        } else {
+            // a fused multiply subtract can differ from two roundings by more than a few ulps near zero
+            for (size_t j = 0; j < 3; j++)
+                EXPECT_NEAR(cross[j], expected[j], 1e-6f);
+        }
+
+        EXPECT_NEAR(float4::dot_scalar(cross, lhs).x, 0.f, 1e-5f);
+        EXPECT_NEAR(float4::dot_scalar(cross, rhs).x, 0.f, 1e-5f);
+    }
+}
+
+TEST_F(MatrixTest, InverseMatchesScalar) {
+    for (size_t i = 0; i < kIterations; i++) {
+        float4x4 m = invertible();
+
+        float4x4 inverse = m.inverse();
+        float4x4 scalar = m.inverse_scalar();
+
+        if constexpr (kExact) {
+            expectUlps(inverse, scalar, 0);
+        } else {
+            expectNear(inverse, scalar, 1e-6f);
+        }
+
+        expectNear(m * inverse, float4x4::identity(), 1e-5f);
+        expectNear(m.mul_scalar(scalar), float4x4::identity(), 1e-5f);
+    }
+}
+
+TEST_F(MatrixTest, InverseOfTransform) {
+    float4x4 m = float4x4::transform(
+        float3(1.f, -2.f, 3.f),
+        quatf::fromAxisAngle(float3(0.f, 1.f, 0.f), radf(0.7f)),
+        float3(2.f, 3.f, 4.f)
+    );
+
+    expectNear(m * m.inverse(), float4x4::identity(), 1e-5f);
+    expectNear(m.inverse_scalar() * m, float4x4::identity(), 1e-5f);
+}
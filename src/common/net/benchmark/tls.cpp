@@ -0,0 +1,112 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/net_test_common.hpp"
+#include "test/tls_test_common.hpp"
+
+#include <thread>
+
+using namespace sm;
+using namespace sm::net;
+
+using namespace std::chrono_literals;
+
+static constexpr const char *kHost = "localhost";
+
+// large enough that per call overhead disappears next to the record work
+static constexpr size_t kTransferSize = 0x400000;
+static constexpr size_t kChunkSize = 0x10000;
+
+static std::pair<Socket, Socket> connectPair(Network& network) {
+    ListenSocket server = network.bind(Address::loopback(), 0);
+    server.listen(1).throwIfFailed();
+
+    Socket client = network.connect(Address::loopback(), server.getBoundPort());
+    Socket accepted = server.accept();
+
+    return { std::move(accepted), std::move(client) };
+}
+
+// the receiver reads a whole transfer then acknowledges it, so each
+// benchmark run covers the data actually arriving rather than just being queued
+template<typename S>
+static void receiveTransfers(S& socket, const std::stop_token& stop) {
+    std::vector<char> buffer(kChunkSize);
+
+    while (!stop.stop_requested()) {
+        size_t received = 0;
+        while (received < kTransferSize) {
+            NetResult<size_t> result = socket.recvBytes(buffer.data(), std::min(buffer.size(), kTransferSize - received));
+            if (!result.has_value())
+                return;
+
+            received += result.value();
+        }
+
+        if (!socket.send(uint8_t(1)).isSuccess())
+            return;
+    }
+}
+
+template<typename S>
+static size_t sendTransfer(S& socket, const std::vector<char>& data) {
+    for (size_t sent = 0; sent < kTransferSize; sent += kChunkSize) {
+        (void)socket.sendBytes(data.data(), kChunkSize).value();
+    }
+
+    return socket.template recv<uint8_t>().value();
+}
+
+TEST_CASE("Loopback throughput") {
+    net::create();
+
+    Network network = Network::create();
+    TlsTestIdentity identity = createTlsTestIdentity(kHost);
+
+    std::vector<char> data(kChunkSize);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = char(i * 31);
+
+    SECTION("plain socket") {
+        auto [accepted, client] = connectPair(network);
+
+        std::jthread receiver = std::jthread([&](const std::stop_token& stop) {
+            receiveTransfers(accepted, stop);
+        });
+
+        BENCHMARK("Plain socket 4MiB") {
+            return sendTransfer(client, data);
+        };
+
+        receiver.request_stop();
+        (void)sendTransfer(client, data);
+    }
+
+    for (bool kernelTls : { false, true }) {
+        TlsConfig config { .kernelTls = kernelTls };
+        TlsContext serverContext = identity.server(config);
+        TlsContext clientContext = identity.client(config);
+
+        auto [accepted, connected] = connectPair(network);
+
+        TlsSocket client = TlsSocket::client(clientContext, std::move(connected), kHost);
+
+        std::jthread receiver = std::jthread([&, socket = std::move(accepted)](const std::stop_token& stop) mutable {
+            TlsSocket server = TlsSocket::server(serverContext, std::move(socket));
+            if (server.handshake(5s).isSuccess())
+                receiveTransfers(server, stop);
+        });
+
+        REQUIRE(client.handshake(5s).isSuccess());
+
+        const char *name = kernelTls ? "TLS socket with kernel tls 4MiB" : "TLS socket 4MiB";
+        if (kernelTls && !client.isKernelSend())
+            WARN("kernel tls was requested but is not available, results match userspace tls");
+
+        BENCHMARK(name) {
+            return sendTransfer(client, data);
+        };
+
+        receiver.request_stop();
+        (void)sendTransfer(client, data);
+    }
+}
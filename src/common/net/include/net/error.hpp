@@ -9,6 +9,7 @@
 #define SNET_END_OF_PACKET 12001
 #define SNET_CONNECTION_CLOSED 12003
 #define SNET_CONNECTION_FAILED 12004
+#define SNET_TLS_FAILURE 12005
 
 #define SNET_LAST_STATUS 12999
 
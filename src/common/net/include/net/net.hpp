@@ -11,6 +11,7 @@
 #include <atomic>
 #include <expected>
 #include <chrono>
+#include <vector>
 
 #include <fmtlib/format.h>
 
@@ -36,14 +37,19 @@ namespace sm::net {
 
         ~Socket() noexcept;
 
+        // the moved from socket gives up its handle, otherwise both would close it
         Socket(Socket&& other) noexcept
-            : mSocket(other.mSocket.load(std::memory_order_seq_cst))
+            : mSocket(other.mSocket.exchange(system::os::kInvalidSocket, std::memory_order_seq_cst))
             , mFlags(other.mFlags.load(std::memory_order_seq_cst))
         { }
 
         Socket& operator=(Socket&& other) noexcept {
             if (this != &other) {
-                mSocket.store(other.mSocket.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                system::os::SocketHandle handle = other.mSocket.exchange(system::os::kInvalidSocket, std::memory_order_seq_cst);
+                system::os::SocketHandle old = mSocket.exchange(handle, std::memory_order_seq_cst);
+                if (old != system::os::kInvalidSocket)
+                    destroyHandle(old);
+
                 mFlags.store(other.mFlags.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
             }
 
@@ -102,14 +108,28 @@ namespace sm::net {
     };
 
     class ListenSocket : public Socket {
+        static constexpr int kDrainFlag = (1 << 1);
+
     public:
         using Socket::Socket;
 
         static constexpr int kMaxBacklog = SOMAXCONN;
+        static constexpr size_t kMaxAcceptBatch = 64;
 
         NetResult<Socket> tryAccept() noexcept;
         Socket accept() throws(NetException);
 
+        /// @brief wait for pending connections then accept as many as are queued.
+        /// the listener is switched to non-blocking mode on first use, so should
+        /// not be mixed with @a tryAccept. accepted sockets are non-blocking.
+        ///
+        /// @param clients accepted sockets are appended, these are kept even if an error is returned
+        /// @param timeout how long to wait for the first connection
+        /// @param limit maximum number of connections to accept
+        ///
+        /// @return ok if the wait timed out, interrupted if the listener was cancelled
+        NetError acceptBatch(std::vector<Socket>& clients, std::chrono::milliseconds timeout, size_t limit = kMaxAcceptBatch) noexcept;
+
         void cancel() noexcept;
 
         NetError listen(int backlog) noexcept;
@@ -127,6 +147,11 @@ namespace sm::net {
         Socket connectWithTimeout(const Address& address, uint16_t port, std::chrono::milliseconds timeout) throws(NetException);
 
         ListenSocket bind(const Address& address, uint16_t port) throws(NetException);
+
+        /// @brief bind a listener with SO_REUSEPORT set.
+        /// every listener bound to the same port this way is handed a share
+        /// of incoming connections by the kernel. not supported on windows.
+        ListenSocket bindReusePort(const Address& address, uint16_t port) throws(NetException);
     };
 
     void create(void);
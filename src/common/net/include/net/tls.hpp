@@ -0,0 +1,168 @@
+#pragma once
+
+#include "net/net.hpp"
+
+#include <openssl/ssl.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sm::net {
+    /// poll treats a negative timeout as waiting forever
+    static constexpr std::chrono::milliseconds kWaitForever{-1};
+
+    struct TlsConfig {
+        /// @brief hand record encryption to the kernel once the handshake completes.
+        /// kernel tls needs the socket as the transport, so sessions created with this
+        /// set read and write the socket directly rather than going through memory bios.
+        /// only takes effect on linux with the tls module loaded and a cipher the kernel
+        /// supports, @see TlsSocket::isKernelSend
+        bool kernelTls = false;
+
+        /// @brief clients verify the server certificate and host name,
+        /// servers verify a client certificate if one is sent
+        bool verifyPeer = true;
+    };
+
+    class TlsContext {
+        using ContextHandle = std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)>;
+
+        ContextHandle mContext;
+        TlsConfig mConfig;
+
+        TlsContext(ContextHandle context, const TlsConfig& config) noexcept;
+
+    public:
+        /// @brief create a context for accepting connections
+        /// @param key private key for @p cert
+        /// @param cert certificate sent to clients
+        static TlsContext server(EVP_PKEY *key, X509 *cert, const TlsConfig& config = {}) throws(NetException);
+
+        /// @brief create a context for connecting to servers, trusts the system certificate store
+        static TlsContext client(const TlsConfig& config = {}) throws(NetException);
+
+        /// @brief trust a certificate in addition to the system store
+        void addTrustedCertificate(X509 *cert) throws(NetException);
+
+        const TlsConfig& getConfig() const noexcept { return mConfig; }
+        SSL_CTX *get() noexcept { return mContext.get(); }
+    };
+
+    /// @brief a tls stream over a socket with the same send and receive interface as @a Socket.
+    ///
+    /// by default the session is driven through a pair of memory bios, openssl never
+    /// touches the socket so records can be pumped by whatever owns the socket. the
+    /// blocking functions wait on the socket themselves, the try functions return
+    /// a would block error instead and @a wantsWrite says which way to wait.
+    /// the socket is switched to non-blocking mode, waiting is always done by
+    /// polling so timeouts are honoured even if the peer stops sending.
+    class TlsSocket {
+        using SessionHandle = std::unique_ptr<SSL, decltype(&SSL_free)>;
+
+        enum class Interest { eRead, eWrite };
+
+        Socket mSocket;
+        SessionHandle mSession;
+
+        /// ciphertext waiting for the socket to accept it, only used with memory bios
+        std::vector<char> mPending;
+        size_t mPendingOffset = 0;
+
+        bool mMemoryBio;
+        Interest mInterest = Interest::eRead;
+
+        TlsSocket(Socket socket, SessionHandle session, bool memoryBio) noexcept;
+
+        static TlsSocket create(TlsContext& context, Socket socket) throws(NetException);
+
+        NetError flushPending() noexcept;
+        NetError fillInput() noexcept;
+        NetError waitReady(std::chrono::milliseconds timeout) noexcept;
+
+        template<typename F>
+        NetResult<size_t> tryCall(F&& fn) noexcept;
+
+        template<typename F>
+        NetResult<size_t> blockingCall(F&& fn, std::chrono::milliseconds timeout) noexcept;
+
+    public:
+        ~TlsSocket() noexcept;
+
+        TlsSocket(TlsSocket&&) noexcept = default;
+        TlsSocket& operator=(TlsSocket&&) noexcept = default;
+
+        SM_NOCOPY(TlsSocket);
+
+        /// @brief wrap an accepted socket, the handshake is not started
+        static TlsSocket server(TlsContext& context, Socket socket) throws(NetException);
+
+        /// @brief wrap a connected socket, the handshake is not started
+        /// @param host name sent for sni and checked against the server certificate
+        static TlsSocket client(TlsContext& context, Socket socket, const std::string& host) throws(NetException);
+
+        /// @brief complete the handshake, waiting on the socket as needed
+        NetError handshake(std::chrono::milliseconds timeout = kWaitForever) noexcept;
+
+        /// @brief advance the handshake without waiting
+        /// @return ok once complete, a would block error when the socket has to become ready first
+        NetError tryHandshake() noexcept;
+
+        NetResult<size_t> sendBytes(const void *data, size_t size) noexcept;
+        NetResult<size_t> recvBytes(void *data, size_t size) noexcept;
+
+        ReadResult recvBytesTimeout(void *data, size_t size, std::chrono::milliseconds timeout) noexcept;
+
+        /// @brief encrypt without waiting, with memory bios this always accepts the whole buffer
+        NetResult<size_t> trySendBytes(const void *data, size_t size) noexcept;
+
+        /// @brief decrypt whatever is available without waiting
+        NetResult<size_t> tryRecvBytes(void *data, size_t size) noexcept;
+
+        /// @brief push queued ciphertext to the socket without waiting
+        NetError flush() noexcept;
+
+        /// @brief check if the last would block error was waiting for the socket to become writable
+        bool wantsWrite() const noexcept;
+
+        template<typename T> requires (std::is_standard_layout_v<T>)
+        NetResult<T> recv() noexcept {
+            T value;
+            ReadResult result = recvBytesTimeout(&value, sizeof(T), kWaitForever);
+            if (!result.error.isSuccess())
+                return std::unexpected{result.error};
+
+            return value;
+        }
+
+        template<typename T> requires (std::is_standard_layout_v<T>)
+        NetResult<T> recvTimed(std::chrono::milliseconds timeout) noexcept {
+            T value;
+            ReadResult result = recvBytesTimeout(&value, sizeof(T), timeout);
+
+            if (result.size != sizeof(T))
+                return std::unexpected{NetError(SNET_END_OF_PACKET, "expected {} bytes, received {}", sizeof(T), result.size)};
+
+            return value;
+        }
+
+        template<typename T> requires (std::is_standard_layout_v<T>)
+        NetError send(const T& value) noexcept {
+            size_t result = TRY_UNWRAP(sendBytes(&value, sizeof(T)));
+
+            if (result != sizeof(T))
+                return NetError(SNET_END_OF_PACKET, "expected {} bytes, sent {}", sizeof(T), result);
+
+            return NetError::ok();
+        }
+
+        /// @brief check if the kernel encrypts outgoing records
+        bool isKernelSend() const noexcept;
+
+        /// @brief check if the kernel decrypts incoming records
+        bool isKernelRecv() const noexcept;
+
+        Socket& getSocket() noexcept { return mSocket; }
+        SSL *get() noexcept { return mSession.get(); }
+    };
+}
@@ -14,6 +14,8 @@ static std::string fmtOsError(int code) {
         return "Connection closed (" CT_STR(SNET_CONNECTION_CLOSED) ")";
     case SNET_CONNECTION_FAILED:
         return "Connection failed (" CT_STR(SNET_CONNECTION_FAILED) ")";
+    case SNET_TLS_FAILURE:
+        return "TLS failure (" CT_STR(SNET_TLS_FAILURE) ")";
     default:
         return fmt::to_string(OsError(code));
     }
@@ -137,7 +137,7 @@ Socket Network::connectWithTimeout(const Address& address, uint16_t port, std::c
     return Socket{findOpenSocketWithTimeout(result, timeout)};
 }
 
-ListenSocket Network::bind(const Address& address, uint16_t port) noexcept(false) {
+static ListenSocket bindListener(const Address& address, uint16_t port, bool reusePort) noexcept(false) {
     addrinfo hints = {
         .ai_flags = AI_PASSIVE,
         .ai_family = AF_INET,
@@ -161,6 +161,13 @@ ListenSocket Network::bind(const Address& address, uint16_t port) noexcept(false
         throw NetException{lastNetError()};
     }
 
+    // must be set before bind, the kernel only groups sockets that all opted in
+    if (reusePort && !system::os::enableReusePort(socket)) {
+        NetError error = lastNetError();
+        system::os::destroySocket(socket);
+        throw NetException{error};
+    }
+
     if (::bind(socket, result->ai_addr, result->ai_addrlen)) {
         NetError error = lastNetError();
         system::os::destroySocket(socket);
@@ -169,3 +176,11 @@ ListenSocket Network::bind(const Address& address, uint16_t port) noexcept(false
 
     return ListenSocket{socket};
 }
+
+ListenSocket Network::bind(const Address& address, uint16_t port) noexcept(false) {
+    return bindListener(address, port, false);
+}
+
+ListenSocket Network::bindReusePort(const Address& address, uint16_t port) noexcept(false) {
+    return bindListener(address, port, true);
+}
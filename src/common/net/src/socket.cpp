@@ -101,7 +101,7 @@ NetError Socket::setRecvTimeout(std::chrono::milliseconds timeout) noexcept {
     auto count = timeout.count();
     struct timeval tv = {
         .tv_sec = static_cast<long>(count / 1000),
-        .tv_usec = static_cast<long>(count % 1000)
+        .tv_usec = static_cast<long>((count % 1000) * 1000)
     };
 
     if (::setsockopt(get(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv)))
@@ -114,7 +114,7 @@ NetError Socket::setSendTimeout(std::chrono::milliseconds timeout) noexcept {
     auto count = timeout.count();
     struct timeval tv = {
         .tv_sec = static_cast<long>(count / 1000),
-        .tv_usec = static_cast<long>(count % 1000)
+        .tv_usec = static_cast<long>((count % 1000) * 1000)
     };
 
     if (::setsockopt(get(), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv)))
@@ -147,6 +147,49 @@ Socket ListenSocket::accept() noexcept(false) {
     return throwIfFailed(tryAccept());
 }
 
+NetError ListenSocket::acceptBatch(std::vector<Socket>& clients, std::chrono::milliseconds timeout, size_t limit) noexcept {
+    if (!isActive())
+        return NetError{system::os::kErrorInterrupted};
+
+    // accept has to return instead of blocking once the queue is drained
+    if (!(mFlags.load() & kDrainFlag)) {
+        if (!system::os::setNonBlocking(get()))
+            return lastNetError();
+
+        mFlags.fetch_or(kDrainFlag);
+    }
+
+    int ready = system::os::pollReadable(get(), timeout);
+    if (ready == -1)
+        return isActive() ? lastNetError() : NetError{system::os::kErrorInterrupted};
+
+    if (ready == 0)
+        return NetError::ok();
+
+    for (size_t i = 0; i < limit; i++) {
+        system::os::SocketHandle client = system::os::acceptSocket(get());
+        if (client != system::os::kInvalidSocket) {
+            clients.emplace_back(client);
+            continue;
+        }
+
+        int error = system::os::lastNetError();
+        if (error == system::os::kWouldBlock)
+            break;
+
+        // the client gave up before we got to it, theres no reason to stop draining
+        if (error == system::os::kConnectionAborted || error == system::os::kErrorInterrupted)
+            continue;
+
+        if (!isActive())
+            return NetError{system::os::kErrorInterrupted};
+
+        return NetError{error};
+    }
+
+    return NetError::ok();
+}
+
 void ListenSocket::cancel() noexcept {
     closeSocket(mSocket);
 }
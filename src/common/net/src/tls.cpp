@@ -0,0 +1,426 @@
+#include "stdafx.hpp"
+
+#include "net/tls.hpp"
+
+#include <openssl/err.h>
+
+#include <climits>
+
+using namespace sm;
+using namespace sm::net;
+
+namespace chrono = std::chrono;
+
+// kernel tls is only wired up for linux sockets
+#if CT_OS_LINUX && defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+static constexpr bool kKernelTlsSupported = true;
+#else
+static constexpr bool kKernelTlsSupported = false;
+#endif
+
+// writing to a connection the peer has closed should be an error rather than a signal
+#ifdef MSG_NOSIGNAL
+static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+static constexpr int kSendFlags = 0;
+#endif
+
+// largest tls record plus room for the header and tag
+static constexpr size_t kRecordSize = 16384 + 512;
+
+static NetError tlsError(std::string_view call) {
+    char buffer[256];
+    ERR_error_string_n(ERR_get_error(), buffer, sizeof(buffer));
+    ERR_clear_error();
+
+    return NetError(SNET_TLS_FAILURE, "{}: {}", call, buffer);
+}
+
+///
+/// context
+///
+
+TlsContext::TlsContext(ContextHandle context, const TlsConfig& config) noexcept
+    : mContext(std::move(context))
+    , mConfig(config)
+{ }
+
+using ContextHandle = std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)>;
+
+static ContextHandle newContext(const SSL_METHOD *method, const TlsConfig& config) {
+    ContextHandle context{SSL_CTX_new(method), &SSL_CTX_free};
+    if (context == nullptr)
+        throw NetException{tlsError("SSL_CTX_new")};
+
+    SSL_CTX *ctx = context.get();
+
+    if (SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION) != 1)
+        throw NetException{tlsError("SSL_CTX_set_min_proto_version")};
+
+    // partial writes let non-blocking sends make progress a record at a time,
+    // a retried send may come from a different buffer as long as the contents match
+    SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+    if (kKernelTlsSupported && config.kernelTls)
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+
+    return context;
+}
+
+TlsContext TlsContext::server(EVP_PKEY *key, X509 *cert, const TlsConfig& config) noexcept(false) {
+    ContextHandle context = newContext(TLS_server_method(), config);
+
+    if (SSL_CTX_use_certificate(context.get(), cert) != 1)
+        throw NetException{tlsError("SSL_CTX_use_certificate")};
+
+    if (SSL_CTX_use_PrivateKey(context.get(), key) != 1)
+        throw NetException{tlsError("SSL_CTX_use_PrivateKey")};
+
+    if (SSL_CTX_check_private_key(context.get()) != 1)
+        throw NetException{tlsError("SSL_CTX_check_private_key")};
+
+    // clients without a certificate are still accepted
+    SSL_CTX_set_verify(context.get(), config.verifyPeer ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+
+    return TlsContext{std::move(context), config};
+}
+
+TlsContext TlsContext::client(const TlsConfig& config) noexcept(false) {
+    ContextHandle context = newContext(TLS_client_method(), config);
+
+    if (SSL_CTX_set_default_verify_paths(context.get()) != 1)
+        throw NetException{tlsError("SSL_CTX_set_default_verify_paths")};
+
+    SSL_CTX_set_verify(context.get(), config.verifyPeer ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+
+    return TlsContext{std::move(context), config};
+}
+
+void TlsContext::addTrustedCertificate(X509 *cert) noexcept(false) {
+    X509_STORE *store = SSL_CTX_get_cert_store(mContext.get());
+    if (X509_STORE_add_cert(store, cert) != 1)
+        throw NetException{tlsError("X509_STORE_add_cert")};
+}
+
+///
+/// socket
+///
+
+TlsSocket::TlsSocket(Socket socket, SessionHandle session, bool memoryBio) noexcept
+    : mSocket(std::move(socket))
+    , mSession(std::move(session))
+    , mMemoryBio(memoryBio)
+{ }
+
+TlsSocket::~TlsSocket() noexcept {
+    // moved from
+    if (mSession == nullptr)
+        return;
+
+    // best effort close notify, the peer may already be gone
+    if (SSL_is_init_finished(mSession.get())) {
+        ERR_clear_error();
+        SSL_shutdown(mSession.get());
+        (void)flushPending();
+    }
+}
+
+TlsSocket TlsSocket::create(TlsContext& context, Socket socket) noexcept(false) {
+    SessionHandle session{SSL_new(context.get()), &SSL_free};
+    if (session == nullptr)
+        throw NetException{tlsError("SSL_new")};
+
+    // every wait polls the socket with the remaining timeout first, a blocking
+    // recv would hang on a peer that stops sending
+    if (NetError error = socket.setBlocking(false); !error.isSuccess())
+        throw NetException{error};
+
+    if (kKernelTlsSupported && context.getConfig().kernelTls) {
+        if (SSL_set_fd(session.get(), int(socket.get())) != 1)
+            throw NetException{tlsError("SSL_set_fd")};
+
+        return TlsSocket{std::move(socket), std::move(session), false};
+    }
+
+    BIO *input = BIO_new(BIO_s_mem());
+    BIO *output = BIO_new(BIO_s_mem());
+    if (input == nullptr || output == nullptr) {
+        BIO_free(input);
+        BIO_free(output);
+        throw NetException{tlsError("BIO_new")};
+    }
+
+    // an empty bio means wait for more data rather than end of stream
+    BIO_set_mem_eof_return(input, -1);
+    BIO_set_mem_eof_return(output, -1);
+
+    // the session takes ownership of both bios
+    SSL_set_bio(session.get(), input, output);
+
+    return TlsSocket{std::move(socket), std::move(session), true};
+}
+
+TlsSocket TlsSocket::server(TlsContext& context, Socket socket) noexcept(false) {
+    TlsSocket result = create(context, std::move(socket));
+    SSL_set_accept_state(result.get());
+    return result;
+}
+
+TlsSocket TlsSocket::client(TlsContext& context, Socket socket, const std::string& host) noexcept(false) {
+    TlsSocket result = create(context, std::move(socket));
+    SSL *ssl = result.get();
+
+    if (SSL_set_tlsext_host_name(ssl, host.c_str()) != 1)
+        throw NetException{tlsError("SSL_set_tlsext_host_name")};
+
+    if (context.getConfig().verifyPeer && SSL_set1_host(ssl, host.c_str()) != 1)
+        throw NetException{tlsError("SSL_set1_host")};
+
+    SSL_set_connect_state(ssl);
+    return result;
+}
+
+NetError TlsSocket::flushPending() noexcept {
+    if (!mMemoryBio)
+        return NetError::ok();
+
+    // queue new records behind anything the socket has not taken yet
+    BIO *output = SSL_get_wbio(mSession.get());
+    if (size_t size = BIO_ctrl_pending(output)) {
+        size_t offset = mPending.size();
+        mPending.resize(offset + size);
+        BIO_read(output, mPending.data() + offset, int(size));
+    }
+
+    while (mPendingOffset < mPending.size()) {
+        const char *data = mPending.data() + mPendingOffset;
+        int size = int(std::min<size_t>(mPending.size() - mPendingOffset, INT_MAX));
+
+        int sent = ::send(mSocket.get(), data, size, kSendFlags);
+        if (sent == -1) {
+            int error = system::os::lastNetError();
+            if (error == system::os::kErrorInterrupted)
+                continue;
+
+            mInterest = Interest::eWrite;
+            return NetError{error};
+        }
+
+        mPendingOffset += sent;
+    }
+
+    mPending.clear();
+    mPendingOffset = 0;
+
+    return NetError::ok();
+}
+
+NetError TlsSocket::fillInput() noexcept {
+    char buffer[kRecordSize];
+
+    mInterest = Interest::eRead;
+    size_t size = TRY_UNWRAP(mSocket.recvBytes(buffer, sizeof(buffer)));
+
+    BIO_write(SSL_get_rbio(mSession.get()), buffer, int(size));
+
+    return NetError::ok();
+}
+
+NetError TlsSocket::waitReady(chrono::milliseconds timeout) noexcept {
+    int ready = (mInterest == Interest::eWrite)
+        ? system::os::pollWritable(mSocket.get(), timeout)
+        : system::os::pollReadable(mSocket.get(), timeout);
+
+    if (ready == -1)
+        return NetError{system::os::lastNetError()};
+
+    if (ready == 0)
+        return NetError{system::os::kErrorTimeout};
+
+    return NetError::ok();
+}
+
+template<typename F>
+NetResult<size_t> TlsSocket::tryCall(F&& fn) noexcept {
+    SSL *ssl = mSession.get();
+
+    while (true) {
+        ERR_clear_error();
+
+        size_t length = 0;
+        int rc = fn(ssl, length);
+        int error = SSL_get_error(ssl, rc);
+        int osError = system::os::lastNetError();
+
+        // records are queued even if the call did not finish, a blocked
+        // socket only matters when the call cannot continue without it
+        NetError flushed = flushPending();
+        bool blocked = !flushed.isSuccess();
+        if (blocked && flushed.code() != system::os::kWouldBlock)
+            return std::unexpected{flushed};
+
+        switch (error) {
+        case SSL_ERROR_NONE:
+            return length;
+
+        case SSL_ERROR_WANT_READ:
+            // the peer is unlikely to answer before it has what we sent
+            if (!mMemoryBio || blocked) {
+                mInterest = blocked ? Interest::eWrite : Interest::eRead;
+                return std::unexpected{NetError{system::os::kWouldBlock}};
+            }
+
+            if (NetError filled = fillInput(); !filled.isSuccess())
+                return std::unexpected{filled};
+
+            continue;
+
+        case SSL_ERROR_WANT_WRITE:
+            mInterest = Interest::eWrite;
+            return std::unexpected{NetError{system::os::kWouldBlock}};
+
+        case SSL_ERROR_ZERO_RETURN:
+            return std::unexpected{NetError{SNET_CONNECTION_CLOSED}};
+
+        case SSL_ERROR_SYSCALL:
+            // no error code means the peer closed without a close notify
+            if (ERR_peek_error() == 0)
+                return std::unexpected{(osError != 0) ? NetError{osError} : NetError{SNET_CONNECTION_CLOSED}};
+
+            return std::unexpected{tlsError("SSL_ERROR_SYSCALL")};
+
+        default:
+            return std::unexpected{tlsError("SSL_get_error")};
+        }
+    }
+}
+
+template<typename F>
+NetResult<size_t> TlsSocket::blockingCall(F&& fn, chrono::milliseconds timeout) noexcept {
+    const chrono::time_point deadline = chrono::steady_clock::now() + timeout;
+
+    auto remaining = [&] {
+        if (timeout < chrono::milliseconds::zero())
+            return kWaitForever;
+
+        auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+        return std::max(left, chrono::milliseconds::zero());
+    };
+
+    while (true) {
+        NetResult<size_t> result = tryCall(fn);
+        if (!result.has_value()) {
+            if (result.error().code() != system::os::kWouldBlock)
+                return result;
+
+            if (NetError ready = waitReady(remaining()); !ready.isSuccess())
+                return std::unexpected{ready};
+
+            continue;
+        }
+
+        // nothing should be left queued once a blocking call returns
+        while (true) {
+            NetError flushed = flushPending();
+            if (flushed.isSuccess())
+                return result;
+
+            if (flushed.code() != system::os::kWouldBlock)
+                return std::unexpected{flushed};
+
+            if (NetError ready = waitReady(remaining()); !ready.isSuccess())
+                return std::unexpected{ready};
+        }
+    }
+}
+
+static auto doHandshake() {
+    return [](SSL *ssl, size_t&) { return SSL_do_handshake(ssl); };
+}
+
+static auto doWrite(const void *data, size_t size) {
+    return [=](SSL *ssl, size_t& length) { return SSL_write_ex(ssl, data, size, &length); };
+}
+
+static auto doRead(void *data, size_t size) {
+    return [=](SSL *ssl, size_t& length) { return SSL_read_ex(ssl, data, size, &length); };
+}
+
+NetError TlsSocket::handshake(chrono::milliseconds timeout) noexcept {
+    NetResult<size_t> result = blockingCall(doHandshake(), timeout);
+    return result.has_value() ? NetError::ok() : result.error();
+}
+
+NetError TlsSocket::tryHandshake() noexcept {
+    NetResult<size_t> result = tryCall(doHandshake());
+    return result.has_value() ? NetError::ok() : result.error();
+}
+
+NetResult<size_t> TlsSocket::sendBytes(const void *data, size_t size) noexcept {
+    const char *src = static_cast<const char *>(data);
+
+    // partial writes are enabled, keep going until everything is encrypted
+    size_t sent = 0;
+    while (sent < size) {
+        sent += TRY_RESULT(blockingCall(doWrite(src + sent, size - sent), kWaitForever));
+    }
+
+    return sent;
+}
+
+NetResult<size_t> TlsSocket::recvBytes(void *data, size_t size) noexcept {
+    if (size == 0)
+        return 0;
+
+    return blockingCall(doRead(data, size), kWaitForever);
+}
+
+ReadResult TlsSocket::recvBytesTimeout(void *data, size_t size, chrono::milliseconds timeout) noexcept {
+    const chrono::time_point deadline = chrono::steady_clock::now() + timeout;
+    char *dst = static_cast<char *>(data);
+    size_t consumed = 0;
+
+    while (consumed < size) {
+        auto left = kWaitForever;
+        if (timeout >= chrono::milliseconds::zero())
+            left = std::max(chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()), chrono::milliseconds::zero());
+
+        NetResult<size_t> result = blockingCall(doRead(dst + consumed, size - consumed), left);
+        if (!result.has_value())
+            return { consumed, result.error() };
+
+        consumed += result.value();
+    }
+
+    return { consumed, NetError::ok() };
+}
+
+NetResult<size_t> TlsSocket::trySendBytes(const void *data, size_t size) noexcept {
+    if (size == 0)
+        return 0;
+
+    return tryCall(doWrite(data, size));
+}
+
+NetResult<size_t> TlsSocket::tryRecvBytes(void *data, size_t size) noexcept {
+    if (size == 0)
+        return 0;
+
+    return tryCall(doRead(data, size));
+}
+
+NetError TlsSocket::flush() noexcept {
+    return flushPending();
+}
+
+bool TlsSocket::wantsWrite() const noexcept {
+    return mInterest == Interest::eWrite || mPendingOffset < mPending.size();
+}
+
+bool TlsSocket::isKernelSend() const noexcept {
+    return !mMemoryBio && BIO_get_ktls_send(SSL_get_wbio(mSession.get())) > 0;
+}
+
+bool TlsSocket::isKernelRecv() const noexcept {
+    return !mMemoryBio && BIO_get_ktls_recv(SSL_get_rbio(mSession.get())) > 0;
+}
@@ -0,0 +1,106 @@
+#include "net_test_common.hpp"
+
+#include <thread>
+
+#include "net/net.hpp"
+
+using namespace sm;
+using namespace sm::net;
+
+using namespace std::chrono_literals;
+
+static constexpr int kClientCount = 32;
+
+static std::vector<Socket> connectClients(Network& network, uint16_t port) {
+    std::vector<Socket> clients;
+    for (int i = 0; i < kClientCount; ++i) {
+        clients.push_back(network.connect(Address::loopback(), port));
+    }
+
+    return clients;
+}
+
+static size_t drainListener(ListenSocket& server, std::vector<Socket>& accepted, size_t limit) {
+    size_t batches = 0;
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+
+    while (accepted.size() < limit && std::chrono::steady_clock::now() < deadline) {
+        size_t before = accepted.size();
+        server.acceptBatch(accepted, 100ms).throwIfFailed();
+
+        if (accepted.size() != before)
+            batches += 1;
+    }
+
+    return batches;
+}
+
+TEST_CASE("Batch accept") {
+    if (!net::isSetup()) net::create();
+
+    Network network = Network::create();
+    ListenSocket server = network.bind(Address::loopback(), 0);
+    server.listen(ListenSocket::kMaxBacklog).throwIfFailed();
+    uint16_t port = server.getBoundPort();
+
+    SECTION("Queued connections are drained together") {
+        std::vector<Socket> clients = connectClients(network, port);
+
+        std::vector<Socket> accepted;
+        size_t batches = drainListener(server, accepted, kClientCount);
+
+        CHECK(accepted.size() == kClientCount);
+        CHECK(batches < kClientCount);
+    }
+
+    SECTION("Batches respect the limit") {
+        std::vector<Socket> clients = connectClients(network, port);
+
+        std::vector<Socket> accepted;
+        server.acceptBatch(accepted, 1s, 4).throwIfFailed();
+
+        CHECK(accepted.size() <= 4);
+        CHECK(!accepted.empty());
+    }
+
+    SECTION("Timeout without connections") {
+        std::vector<Socket> accepted;
+        CHECK(server.acceptBatch(accepted, 10ms).isSuccess());
+        CHECK(accepted.empty());
+    }
+
+    SECTION("Cancelled listener") {
+        server.cancel();
+
+        std::vector<Socket> accepted;
+        CHECK(server.acceptBatch(accepted, 10ms).cancelled());
+    }
+}
+
+#if CT_OS_LINUX
+TEST_CASE("Reuse port listeners") {
+    if (!net::isSetup()) net::create();
+
+    Network network = Network::create();
+    ListenSocket first = network.bindReusePort(Address::loopback(), 0);
+    uint16_t port = first.getBoundPort();
+    ListenSocket second = network.bindReusePort(Address::loopback(), port);
+
+    first.listen(ListenSocket::kMaxBacklog).throwIfFailed();
+    second.listen(ListenSocket::kMaxBacklog).throwIfFailed();
+
+    CHECK(second.getBoundPort() == port);
+
+    std::vector<Socket> clients = connectClients(network, port);
+
+    // each connection is handed to exactly one of the listeners
+    std::vector<Socket> accepted;
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (accepted.size() < kClientCount && std::chrono::steady_clock::now() < deadline) {
+        first.acceptBatch(accepted, 10ms).throwIfFailed();
+        second.acceptBatch(accepted, 10ms).throwIfFailed();
+    }
+
+    CHECK(accepted.size() == kClientCount);
+}
+#endif
@@ -0,0 +1,230 @@
+#include "net_test_common.hpp"
+#include "tls_test_common.hpp"
+
+#include <thread>
+
+using namespace sm;
+using namespace sm::net;
+
+using namespace std::chrono_literals;
+
+static constexpr const char *kHost = "localhost";
+static constexpr size_t kBulkSize = 0x40000;
+
+struct Message {
+    uint32_t id;
+    char text[60];
+};
+
+static uint8_t getPattern(size_t i) {
+    return uint8_t((i * 31) ^ (i >> 8));
+}
+
+// both ends of a loopback connection
+static std::pair<Socket, Socket> connectPair(Network& network) {
+    ListenSocket server = network.bind(Address::loopback(), 0);
+    server.listen(1).throwIfFailed();
+
+    Socket client = network.connect(Address::loopback(), server.getBoundPort());
+    Socket accepted = server.accept();
+
+    return { std::move(accepted), std::move(client) };
+}
+
+TEST_CASE("TLS client server") {
+    net::create();
+
+    Network network = Network::create();
+    TlsTestIdentity identity = createTlsTestIdentity(kHost);
+
+    bool kernelTls = GENERATE(false, true);
+    TlsConfig config { .kernelTls = kernelTls };
+
+    TlsContext serverContext = identity.server(config);
+    TlsContext clientContext = identity.client(config);
+
+    auto [accepted, connected] = connectPair(network);
+
+    SECTION("blocking handshake and transfer") {
+        NetTestStream errors;
+
+        std::jthread serverThread = std::jthread([&, socket = std::move(accepted)] mutable {
+            TlsSocket server = TlsSocket::server(serverContext, std::move(socket));
+            if (!errors.expect(server.handshake(5s).isSuccess(), "Server handshake failed"))
+                return;
+
+            NetResult<Message> message = server.recvTimed<Message>(5s);
+            if (!errors.expect(message.has_value(), "Server failed to receive message"))
+                return;
+
+            message->id += 1;
+            errors.expect(server.send(*message).isSuccess(), "Server failed to send reply");
+
+            std::vector<uint8_t> bulk(kBulkSize);
+            auto [read, err] = server.recvBytesTimeout(bulk.data(), bulk.size(), 5s);
+            errors.expect(err.isSuccess() && read == kBulkSize, "Received {} bulk bytes: {}", read, err.message());
+
+            uint64_t mismatches = 0;
+            for (size_t i = 0; i < read; i++)
+                mismatches += (bulk[i] != getPattern(i));
+
+            errors.expect(server.send(mismatches).isSuccess(), "Server failed to send result");
+        });
+
+        TlsSocket client = TlsSocket::client(clientContext, std::move(connected), kHost);
+        REQUIRE(client.handshake(5s).isSuccess());
+
+        Message message { .id = 1, .text = "hello" };
+        REQUIRE(client.send(message).isSuccess());
+
+        NetResult<Message> reply = client.recvTimed<Message>(5s);
+        REQUIRE(reply.has_value());
+        CHECK(reply->id == 2);
+        CHECK(std::string_view{reply->text} == "hello");
+
+        std::vector<uint8_t> bulk(kBulkSize);
+        for (size_t i = 0; i < bulk.size(); i++)
+            bulk[i] = getPattern(i);
+
+        NetResult<size_t> sent = client.sendBytes(bulk.data(), bulk.size());
+        REQUIRE(sent.has_value());
+        CHECK(sent.value() == kBulkSize);
+
+        NetResult<uint64_t> mismatches = client.recvTimed<uint64_t>(5s);
+        REQUIRE(mismatches.has_value());
+        CHECK(mismatches.value() == 0);
+
+        // kernel offload depends on the host so can only be reported
+        if (kernelTls) {
+            INFO("kernel tls send: " << client.isKernelSend() << ", recv: " << client.isKernelRecv());
+            SUCCEED();
+        } else {
+            CHECK_FALSE(client.isKernelSend());
+        }
+    }
+
+    SECTION("non-blocking handshake and transfer") {
+        REQUIRE(system::os::setNonBlocking(accepted.get()));
+        REQUIRE(system::os::setNonBlocking(connected.get()));
+
+        TlsSocket server = TlsSocket::server(serverContext, std::move(accepted));
+        TlsSocket client = TlsSocket::client(clientContext, std::move(connected), kHost);
+
+        auto isWouldBlock = [](const NetError& error) {
+            return error.code() == system::os::kWouldBlock;
+        };
+
+        // drive both ends from one thread, as a reactor would
+        bool serverDone = false;
+        bool clientDone = false;
+        for (int i = 0; i < 1000 && !(serverDone && clientDone); i++) {
+            if (!clientDone) {
+                NetError error = client.tryHandshake();
+                REQUIRE((error.isSuccess() || isWouldBlock(error)));
+                clientDone = error.isSuccess();
+            }
+
+            if (!serverDone) {
+                NetError error = server.tryHandshake();
+                REQUIRE((error.isSuccess() || isWouldBlock(error)));
+                serverDone = error.isSuccess();
+            }
+
+            std::this_thread::sleep_for(1ms);
+        }
+
+        REQUIRE(clientDone);
+        REQUIRE(serverDone);
+
+        Message message { .id = 42, .text = "non-blocking" };
+        NetResult<size_t> sent = client.trySendBytes(&message, sizeof(message));
+        REQUIRE(sent.has_value());
+        CHECK(sent.value() == sizeof(message));
+        CHECK(client.flush().isSuccess());
+
+        Message received{};
+        size_t consumed = 0;
+        for (int i = 0; i < 1000 && consumed < sizeof(received); i++) {
+            NetResult<size_t> result = server.tryRecvBytes(reinterpret_cast<char*>(&received) + consumed, sizeof(received) - consumed);
+            if (result.has_value()) {
+                consumed += result.value();
+            } else {
+                REQUIRE(isWouldBlock(result.error()));
+                CHECK_FALSE(server.wantsWrite());
+                std::this_thread::sleep_for(1ms);
+            }
+        }
+
+        REQUIRE(consumed == sizeof(received));
+        CHECK(received.id == 42);
+        CHECK(std::string_view{received.text} == "non-blocking");
+    }
+
+    SECTION("untrusted certificate") {
+        TlsContext untrusted = TlsContext::client(config);
+
+        std::jthread serverThread = std::jthread([&, socket = std::move(accepted)] mutable {
+            TlsSocket server = TlsSocket::server(serverContext, std::move(socket));
+            (void)server.handshake(5s);
+        });
+
+        TlsSocket client = TlsSocket::client(untrusted, std::move(connected), kHost);
+        NetError error = client.handshake(5s);
+        CHECK(error.code() == SNET_TLS_FAILURE);
+    }
+}
+
+TEST_CASE("TLS peer that never sends") {
+    net::create();
+
+    Network network = Network::create();
+    TlsTestIdentity identity = createTlsTestIdentity(kHost);
+
+    bool kernelTls = GENERATE(false, true);
+    TlsConfig config { .kernelTls = kernelTls };
+
+    TlsContext serverContext = identity.server(config);
+    TlsContext clientContext = identity.client(config);
+
+    auto [accepted, connected] = connectPair(network);
+
+    SECTION("handshake times out") {
+        // the peer accepts the connection but never starts its side of the handshake
+        TlsSocket client = TlsSocket::client(clientContext, std::move(connected), kHost);
+
+        auto start = std::chrono::steady_clock::now();
+        NetError error = client.handshake(200ms);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        CHECK(error.code() == system::os::kErrorTimeout);
+        CHECK(elapsed < 5s);
+    }
+
+    SECTION("receive times out") {
+        NetTestStream errors;
+
+        std::jthread serverThread = std::jthread([&, socket = std::move(accepted)] mutable {
+            TlsSocket server = TlsSocket::server(serverContext, std::move(socket));
+            if (!errors.expect(server.handshake(5s).isSuccess(), "Server handshake failed"))
+                return;
+
+            // hold the connection open without sending anything until the client closes it
+            (void)server.recvTimed<Message>(5s);
+        });
+
+        TlsSocket client = TlsSocket::client(clientContext, std::move(connected), kHost);
+        REQUIRE(client.handshake(5s).isSuccess());
+
+        auto start = std::chrono::steady_clock::now();
+        NetResult<Message> message = client.recvTimed<Message>(200ms);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        CHECK(!message.has_value());
+        CHECK(elapsed < 5s);
+
+        Message buffer;
+        ReadResult result = client.recvBytesTimeout(&buffer, sizeof(buffer), 100ms);
+        CHECK(result.size == 0);
+        CHECK(result.error.code() == system::os::kErrorTimeout);
+    }
+}
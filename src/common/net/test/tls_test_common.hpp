@@ -0,0 +1,51 @@
+#pragma once
+
+#include "net/tls.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <memory>
+#include <stdexcept>
+
+/// @brief a throwaway self signed key and certificate
+struct TlsTestIdentity {
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key{nullptr, &EVP_PKEY_free};
+    std::unique_ptr<X509, decltype(&X509_free)> cert{nullptr, &X509_free};
+
+    sm::net::TlsContext server(const sm::net::TlsConfig& config = {}) {
+        return sm::net::TlsContext::server(key.get(), cert.get(), config);
+    }
+
+    sm::net::TlsContext client(const sm::net::TlsConfig& config = {}) {
+        sm::net::TlsContext context = sm::net::TlsContext::client(config);
+        context.addTrustedCertificate(cert.get());
+        return context;
+    }
+};
+
+inline TlsTestIdentity createTlsTestIdentity(const char *host) {
+    TlsTestIdentity identity;
+
+    // ec keys are much faster to generate than rsa
+    identity.key.reset(EVP_EC_gen("P-256"));
+    if (identity.key == nullptr)
+        throw std::runtime_error("EVP_EC_gen");
+
+    identity.cert.reset(X509_new());
+    X509 *cert = identity.cert.get();
+
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 60L * 60L * 24L);
+    X509_set_pubkey(cert, identity.key.get());
+
+    X509_NAME *name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>(host), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+
+    if (X509_sign(cert, identity.key.get(), EVP_sha256()) == 0)
+        throw std::runtime_error("X509_sign");
+
+    return identity;
+}
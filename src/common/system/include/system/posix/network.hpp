@@ -18,6 +18,8 @@ namespace sm::system::os {
     static constexpr NetErrorCode kErrorInterrupted = EINTR;
     static constexpr NetErrorCode kNotInitialized = ENOTCONN;
     static constexpr NetErrorCode kWouldBlock = EWOULDBLOCK;
+    static constexpr NetErrorCode kNotSupported = EOPNOTSUPP;
+    static constexpr NetErrorCode kConnectionAborted = ECONNABORTED;
 
     inline NetErrorCode lastNetError() {
         return errno;
@@ -59,9 +61,33 @@ namespace sm::system::os {
         return ::fcntl(socket, F_SETFL, mode) != -1;
     }
 
+    inline bool setNonBlocking(SocketHandle socket) {
+        int flags = ::fcntl(socket, F_GETFL, 0);
+        if (flags == -1)
+            return false;
+
+        return ::fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1;
+    }
+
+    /// accepted sockets are non-blocking and not inherited by child processes
+    inline SocketHandle acceptSocket(SocketHandle socket) {
+        return ::accept4(socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    }
+
+    inline bool enableReusePort(SocketHandle socket) {
+        int enable = 1;
+        return ::setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == 0;
+    }
+
     inline bool cancelSocket(SocketHandle socket) {
         return ::shutdown(socket, SHUT_RDWR) == 0;
     }
 
+    /// @return 1 if the socket is readable, 0 on timeout, -1 on error
+    int pollReadable(SocketHandle socket, std::chrono::milliseconds timeout);
+
+    /// @return 1 if the socket is writable, 0 on timeout, -1 on error
+    int pollWritable(SocketHandle socket, std::chrono::milliseconds timeout);
+
     bool connectWithTimeout(SocketHandle socket, const sockaddr *addr, socklen_t len, std::chrono::milliseconds timeout);
 }
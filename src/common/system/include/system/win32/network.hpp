@@ -15,6 +15,8 @@ namespace sm::system::os {
     static constexpr NetErrorCode kErrorInterrupted = WSAEINTR;
     static constexpr NetErrorCode kNotInitialized = WSANOTINITIALISED;
     static constexpr NetErrorCode kWouldBlock = WSAEWOULDBLOCK;
+    static constexpr NetErrorCode kNotSupported = WSAEOPNOTSUPP;
+    static constexpr NetErrorCode kConnectionAborted = WSAECONNRESET;
 
     inline NetErrorCode lastNetError() {
         return ::WSAGetLastError();
@@ -52,9 +54,39 @@ namespace sm::system::os {
         return ::ioctlsocket(socket, FIONBIO, &mode) != SOCKET_ERROR;
     }
 
+    inline bool setNonBlocking(SocketHandle socket) {
+        u_long mode = 1;
+        return ::ioctlsocket(socket, FIONBIO, &mode) != SOCKET_ERROR;
+    }
+
+    /// accepted sockets are non-blocking, winsock handles are not inherited by default
+    inline SocketHandle acceptSocket(SocketHandle socket) {
+        SocketHandle client = ::accept(socket, nullptr, nullptr);
+        if (client != INVALID_SOCKET && !setNonBlocking(client)) {
+            int error = ::WSAGetLastError();
+            ::closesocket(client);
+            ::WSASetLastError(error);
+            return INVALID_SOCKET;
+        }
+
+        return client;
+    }
+
+    /// winsock has no equivalent that balances connections between listeners
+    inline bool enableReusePort(SocketHandle socket) {
+        ::WSASetLastError(WSAEOPNOTSUPP);
+        return false;
+    }
+
     inline bool cancelSocket(SocketHandle socket) {
         return ::shutdown(socket, SD_BOTH) == 0;
     }
 
+    /// @return 1 if the socket is readable, 0 on timeout, -1 on error
+    int pollReadable(SocketHandle socket, std::chrono::milliseconds timeout);
+
+    /// @return 1 if the socket is writable, 0 on timeout, -1 on error
+    int pollWritable(SocketHandle socket, std::chrono::milliseconds timeout);
+
     bool connectWithTimeout(SocketHandle socket, const sockaddr *addr, socklen_t len, std::chrono::milliseconds timeout);
 }
@@ -43,6 +43,28 @@ os::NetErrorCode os::destroySocket(SocketHandle socket) {
     return kSuccess;
 }
 
+int os::pollReadable(os::SocketHandle socket, std::chrono::milliseconds timeout) {
+    struct pollfd pfd = { .fd = socket, .events = POLLIN };
+
+    int rc;
+    do {
+        rc = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    } while (rc == -1 && errno == EINTR);
+
+    return rc;
+}
+
+int os::pollWritable(os::SocketHandle socket, std::chrono::milliseconds timeout) {
+    struct pollfd pfd = { .fd = socket, .events = POLLOUT };
+
+    int rc;
+    do {
+        rc = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    } while (rc == -1 && errno == EINTR);
+
+    return rc;
+}
+
 // mostly pulled from https://stackoverflow.com/a/61960339
 // with timespec usage replaced with chrono
 bool os::connectWithTimeout(os::SocketHandle socket, const sockaddr *addr, socklen_t len, std::chrono::milliseconds timeout) {
@@ -8,6 +8,20 @@ os::NetErrorCode os::destroySocket(os::SocketHandle socket) {
     return ::closesocket(socket);
 }
 
+int os::pollReadable(os::SocketHandle socket, std::chrono::milliseconds timeout) {
+    WSAPOLLFD pfd = { .fd = socket, .events = POLLRDNORM };
+
+    int rc = ::WSAPoll(&pfd, 1, static_cast<INT>(timeout.count()));
+    return (rc == SOCKET_ERROR) ? -1 : rc;
+}
+
+int os::pollWritable(os::SocketHandle socket, std::chrono::milliseconds timeout) {
+    WSAPOLLFD pfd = { .fd = socket, .events = POLLWRNORM };
+
+    int rc = ::WSAPoll(&pfd, 1, static_cast<INT>(timeout.count()));
+    return (rc == SOCKET_ERROR) ? -1 : rc;
+}
+
 static bool isSocketReady(os::SocketHandle socket) {
     fd_set writefds;
     FD_ZERO(&writefds);
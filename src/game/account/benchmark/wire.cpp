@@ -0,0 +1,91 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "test/common.hpp"
+
+#include "account/account.hpp"
+#include "account/wire.hpp"
+
+using namespace game;
+
+template<WirePacket T>
+static size_t encodedSize(const T& packet) {
+    std::vector<std::byte> buffer;
+    WireWriter writer{buffer};
+    encodeFrame(writer, packet);
+    return buffer.size();
+}
+
+template<WirePacket T>
+static void benchmarkPacket(std::string_view name, const T& packet) {
+    std::vector<std::byte> buffer;
+    buffer.reserve(kMaxFrameSize);
+
+    WireWriter writer{buffer};
+    encodeFrame(writer, packet);
+
+    WireReader reader{std::span(buffer).subspan(kFrameLengthSize)};
+    FrameHeader header;
+    REQUIRE(decodeFrameHeader(reader, header));
+    std::span<const std::byte> body = reader.remaining();
+
+    WARN(fmt::format("{}: fixed {} bytes, compact {} bytes", name, sizeof(T), encodedSize(packet)));
+
+    BENCHMARK(fmt::format("Encode {}", name)) {
+        buffer.clear();
+        WireWriter writer{buffer};
+        encodeFrame(writer, packet);
+        return buffer.size();
+    };
+
+    BENCHMARK(fmt::format("Decode {}", name)) {
+        return decodeFrameBody(header, body);
+    };
+}
+
+TEST_CASE("Compact encoding of requests") {
+    benchmarkPacket("CreateAccount", CreateAccount { 1, kClientStream, "username", "hunter2" });
+    benchmarkPacket("Login", Login { 1, kClientStream, "username", "hunter2" });
+    benchmarkPacket("CreateLobby", CreateLobby { 1, kClientStream, 1234, "my lobby" });
+    benchmarkPacket("JoinLobby", JoinLobby { 1, kClientStream, 1234, 5678 });
+    benchmarkPacket("GetSessionList", GetSessionList { 1, kClientStream, 1234 });
+    benchmarkPacket("SendMessage", SendMessage { 1, kMessageStream, 1234, 1700000000, "hello everyone, how is it going" });
+}
+
+TEST_CASE("Compact encoding of responses") {
+    PacketHeader instigator { PacketType::eLogin, sizeof(Login), 1, kClientStream };
+
+    benchmarkPacket("Response", Response { instigator, Status::eSuccess });
+    benchmarkPacket("NewSession", NewSession { instigator, 1234 });
+    benchmarkPacket("NewLobby", NewLobby { instigator, 5678 });
+}
+
+TEST_CASE("Compact encoding of lists") {
+    static constexpr size_t kCounts[] = { 16, 256, 4096 };
+
+    PacketHeader instigator { PacketType::eGetLobbyList, sizeof(GetLobbyList), 1, kClientStream };
+
+    for (size_t count : kCounts) {
+        std::vector<LobbyInfo> lobbies(count);
+        for (size_t i = 0; i < count; i++) {
+            lobbies[i] = LobbyInfo {
+                .id = i,
+                .players = { i, UINT64_MAX, UINT64_MAX, UINT64_MAX },
+                .name = std::string_view{fmt::format("lobby{}", i)},
+                .state = LobbyState::eWaiting
+            };
+        }
+
+        std::vector<std::byte> buffer;
+        WireWriter writer{buffer};
+        encodeListFrames<LobbyList, LobbyInfo>(writer, instigator, Status::eSuccess, lobbies);
+
+        WARN(fmt::format("LobbyList[{}]: fixed {} bytes, compact {} bytes", count, sizeof(LobbyList) + sizeof(LobbyInfo) * count, buffer.size()));
+
+        BENCHMARK(fmt::format("Encode LobbyList[{}]", count)) {
+            buffer.clear();
+            WireWriter writer{buffer};
+            encodeListFrames<LobbyList, LobbyInfo>(writer, instigator, Status::eSuccess, lobbies);
+            return buffer.size();
+        };
+    }
+}
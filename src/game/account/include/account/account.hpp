@@ -4,12 +4,16 @@
 
 #include "net/net.hpp"
 
+#include "account/feed.hpp"
 #include "account/packets.hpp"
 #include "account/router.hpp"
 #include "account/salt.hpp"
 
+#include <future>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <thread>
 
 namespace game {
     static constexpr uint8_t kClientStream = 0;
@@ -31,10 +35,28 @@ namespace game {
         sm::net::Network& mNetwork;
         sm::net::ListenSocket mSocket;
 
+        /// extra listeners sharing the port of @a mSocket with SO_REUSEPORT,
+        /// each is drained by its own accept thread
+        std::vector<sm::net::ListenSocket> mShards;
+
         std::mutex mSaltMutex;
         Salt mSalt;
 
-        std::unordered_map<SessionId, std::vector<SendMessage>> mOpenClients;
+        /// chat messages fanned out to every logged in session.
+        /// each client thread holds its own cursor into the feed
+        MessageFeed mMessageFeed;
+
+        /// state owned by a single client connection
+        struct ClientContext {
+            AccountServer& server;
+            SessionId session = UINT64_MAX;
+            std::optional<FeedCursor> feed;
+        };
+
+        /// shared by every client thread, built once when the server is created
+        MessageRouter<ClientContext> mRouter;
+
+        void buildRouter();
 
         bool authSession(SessionId id);
 
@@ -47,6 +69,7 @@ namespace game {
         uint64_t getLobbyList(std::span<LobbyInfo> lobbies);
 
         void handleClient(const std::stop_token& stop, sm::net::Socket socket) noexcept;
+        void acceptClients(sm::net::ListenSocket& listener);
 
         void dropSession(SessionId session);
 
@@ -54,18 +77,33 @@ namespace game {
 
     public:
         AccountServer(sm::db::Connection db, sm::net::Network& net, const sm::net::Address& address, uint16_t port) throws(sm::db::DbException);
-        AccountServer(sm::db::Connection db, sm::net::Network& net, const sm::net::Address& address, uint16_t port, unsigned seed) throws(sm::db::DbException);
+
+        /// @param seed makes salts reproducible for tests, nullopt takes them from the secure generator
+        AccountServer(sm::db::Connection db, sm::net::Network& net, const sm::net::Address& address, uint16_t port, std::optional<unsigned> seed) throws(sm::db::DbException);
+
+        /// @param seed makes salts reproducible for tests, nullopt takes them from the secure generator
+        /// @param listeners number of SO_REUSEPORT listeners to accept connections on, 1 disables sharding
+        AccountServer(sm::db::Connection db, sm::net::Network& net, const sm::net::Address& address, uint16_t port, std::optional<unsigned> seed, unsigned listeners) throws(sm::db::DbException, sm::net::NetException);
 
         SM_NOCOPY(AccountServer);
         SM_NOMOVE(AccountServer);
 
-        void begin(uint16_t connections);
+        /// @param backlog pending connection queue size of each listener
+        void begin(int backlog = sm::net::ListenSocket::kMaxBacklog);
         void work();
         void stop();
 
         bool isRunning() const;
 
+        size_t getListenerCount() const { return mShards.size() + 1; }
+
         uint16_t getPort() { return mSocket.getBoundPort(); }
+
+        /// @brief per packet type call counts, bytes received and handler latency
+        std::vector<RouteSnapshot> getRouteStats() const { return mRouter.scrape(); }
+
+        /// @brief number of packets that had no route and caused their client to be dropped
+        uint64_t getUnroutedCount() const { return mRouter.getUnroutedCount(); }
     };
 
     struct Message {
@@ -74,24 +112,68 @@ namespace game {
     };
 
     class AccountClient {
+    public:
+        /// @brief invoked with the response to a request.
+        /// if the request is cancelled or the connection is lost
+        /// before a response arrives the packet will be empty.
+        using RequestCallback = std::function<void(AnyPacket& response)>;
+
+        static constexpr std::chrono::milliseconds kDefaultTimeout{250};
+
+    private:
         sm::net::Socket mSocket;
+        PacketChannel mChannel{mSocket};
+
+        /// serializes writes to the socket, requests may be sent from any thread
+        std::mutex mSendMutex;
+
+        /// serializes reads from the socket and guards @a mSocketMux
+        std::mutex mRecvMutex;
         SocketMux mSocketMux;
+
+        /// guards id allocation and the in flight request table
+        std::mutex mRequestMutex;
         uint16_t mNextId = 0;
+        std::map<uint16_t, RequestCallback> mRequestSlots;
 
         SessionId mCurrentSession = UINT64_MAX;
         LobbyId mCurrentLobby = UINT64_MAX;
 
-        using RequestCallback = std::function<void(std::span<const std::byte>)>;
-
-        std::map<uint16_t, RequestCallback> mRequestSlots;
-
         std::vector<SessionInfo> mSessions;
         std::vector<LobbyInfo> mLobbies;
 
         std::vector<Message> mMessages;
 
+        /// background io loop, must be declared last so it is stopped
+        /// before any of the state it touches is destroyed
+        std::jthread mWorker;
+
+        uint16_t addRequestSlot(RequestCallback callback);
+        RequestCallback takeRequestSlot(uint16_t id);
+        void abortRequest(uint16_t id, sm::net::NetError error) throws(sm::net::NetException);
+        bool negotiate(WireVersion version);
+
+        void dispatchPacket(AnyPacket packet);
+        void cancelPendingRequests();
+
+        AnyPacket waitForResponse(uint16_t id, std::future<AnyPacket> future, std::chrono::milliseconds timeout);
+
+        template<typename T>
+        AnyPacket roundTrip(T packet, std::chrono::milliseconds timeout = kDefaultTimeout) {
+            auto promise = std::make_shared<std::promise<AnyPacket>>();
+            std::future<AnyPacket> future = promise->get_future();
+
+            uint16_t id = sendRequest(packet, [promise](AnyPacket& response) {
+                promise->set_value(std::move(response));
+            });
+
+            return waitForResponse(id, std::move(future), timeout);
+        }
+
     public:
-        AccountClient(sm::net::Network& net, const sm::net::Address& address, uint16_t port) throws(sm::net::NetException);
+        /// @param version the wire encoding to request, the server may pick an older one
+        AccountClient(sm::net::Network& net, const sm::net::Address& address, uint16_t port, WireVersion version = WireVersion::eFixed) throws(sm::net::NetException);
+        ~AccountClient() noexcept;
 
         SM_NOCOPY(AccountClient);
         SM_NOMOVE(AccountClient);
@@ -112,9 +194,61 @@ namespace game {
         bool refreshLobbyList();
         bool refreshMessageList();
 
+        /// @brief send a request without waiting for the response.
+        /// the header id is assigned by the client, @p callback is invoked on whichever
+        /// thread reads the response. any number of requests may be in flight at once.
+        template<WirePacket T>
+        uint16_t sendRequest(T packet, RequestCallback callback) throws(sm::net::NetException) {
+            uint16_t id = addRequestSlot(std::move(callback));
+            packet.header.id = id;
+            packet.header.stream = kClientStream;
+
+            sm::net::NetError error = [&] {
+                std::lock_guard guard(mSendMutex);
+                return mChannel.send(packet);
+            }();
+
+            if (!error.isSuccess())
+                abortRequest(id, std::move(error));
+
+            return id;
+        }
+
+        /// @brief send a request and receive its response through a future.
+        /// the future is only fulfilled while something is driving the socket,
+        /// either the background worker or calls to @a work.
+        template<WirePacket T>
+        std::future<AnyPacket> sendRequest(T packet) throws(sm::net::NetException) {
+            auto promise = std::make_shared<std::promise<AnyPacket>>();
+            std::future<AnyPacket> future = promise->get_future();
+
+            sendRequest(packet, [promise](AnyPacket& response) {
+                promise->set_value(std::move(response));
+            });
+
+            return future;
+        }
+
+        /// @brief cancel an in flight request, its callback is invoked with an empty packet.
+        /// @return true if the request was still in flight
+        bool cancelRequest(uint16_t id);
+
+        size_t getPendingRequestCount();
+
         AnyPacket getNextMessage(uint8_t stream);
 
-        void work();
+        /// @brief read and dispatch at most one packet from the server
+        void work(std::chrono::milliseconds timeout = kDefaultTimeout);
+
+        /// @brief start a background thread that drives the socket.
+        /// once started responses are dispatched as soon as they arrive
+        /// and callers no longer need to call @a work.
+        void begin();
+        void stop();
+
+        bool isWorkerRunning() const noexcept { return mWorker.joinable(); }
+
+        WireVersion getWireVersion() const noexcept { return mChannel.getVersion(); }
 
         std::vector<SessionInfo> getSessionInfo() { return mSessions; }
         std::vector<LobbyInfo> getLobbyInfo() { return mLobbies; }
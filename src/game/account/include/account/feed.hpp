@@ -0,0 +1,77 @@
+#pragma once
+
+#include "account/packets.hpp"
+
+#include <atomic>
+#include <memory>
+#include <span>
+
+namespace game {
+    struct FeedEntry {
+        uint64_t sequence;
+        SendMessage message;
+    };
+
+    using FeedEntryPtr = std::shared_ptr<const FeedEntry>;
+
+    class MessageFeed;
+
+    /// @brief a single subscribers position in a @a MessageFeed.
+    /// each cursor must only be polled from one thread at a time.
+    class FeedCursor {
+        const MessageFeed *mFeed;
+        SessionId mSession;
+        uint64_t mNext;
+        uint64_t mDropped = 0;
+
+    public:
+        FeedCursor(const MessageFeed& feed, SessionId session, uint64_t next) noexcept
+            : mFeed(&feed)
+            , mSession(session)
+            , mNext(next)
+        { }
+
+        /// @brief collect the next batch of messages not authored by this session.
+        /// @return the number of entries written to @p batch
+        size_t poll(std::span<FeedEntryPtr> batch) noexcept;
+
+        /// @brief number of messages overwritten before this cursor could read them
+        uint64_t getDroppedCount() const noexcept { return mDropped; }
+
+        SessionId getSession() const noexcept { return mSession; }
+    };
+
+    /// @brief multi producer, multi consumer broadcast log.
+    /// publishing is a single atomic increment and a compare exchange into a
+    /// fixed ring of reference counted entries, a slot only ever moves forward
+    /// to a newer sequence. every subscriber reads the same entry
+    /// through its own cursor. subscribers that fall more than a ring behind
+    /// skip ahead to the oldest message still available.
+    class MessageFeed {
+        friend FeedCursor;
+
+        using Slot = std::atomic<FeedEntryPtr>;
+
+        std::unique_ptr<Slot[]> mSlots;
+        uint64_t mMask;
+
+        /// sequence number of the next message to be published
+        std::atomic<uint64_t> mHead{0};
+
+        FeedEntryPtr load(uint64_t sequence) const noexcept {
+            return mSlots[sequence & mMask].load(std::memory_order_acquire);
+        }
+
+    public:
+        static constexpr size_t kDefaultCapacity = 1024;
+
+        MessageFeed(size_t capacity = kDefaultCapacity);
+
+        void publish(const SendMessage& message);
+
+        FeedCursor subscribe(SessionId session) const noexcept;
+
+        uint64_t getHead() const noexcept { return mHead.load(std::memory_order_acquire); }
+        size_t getCapacity() const noexcept { return mMask + 1; }
+    };
+}
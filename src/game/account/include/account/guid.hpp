@@ -1,5 +1,7 @@
 #pragma once
 
+#include "core/hash.hpp"
+
 #include <stdint.h>
 #include <cstring>
 
@@ -23,11 +25,8 @@ namespace game {
 template<>
 struct std::hash<game::Guid> {
     size_t operator()(const game::Guid& guid) const noexcept {
-        size_t hash = 0;
-        for (uint8_t byte : guid.data) {
-            hash = hash * 31 + byte;
-        }
-
-        return hash;
+        uint64_t words[2];
+        std::memcpy(words, guid.data, sizeof(words));
+        return size_t(sm::hashMix128(words[0], words[1]));
     }
 };
@@ -34,6 +34,8 @@ namespace game {
         eLeaveLobby,
         eStartGame,
 
+        eHello,
+
         eCount
     };
 
@@ -301,4 +303,30 @@ namespace game {
             , message(message)
         { }
     };
+
+    /// @brief sent by the client before any other request to pick a wire encoding.
+    /// always sent and answered with the fixed encoding.
+    struct Hello {
+        PacketHeader header;
+        uint8_t version;
+
+        Hello() = default;
+
+        Hello(uint16_t id, uint8_t stream, uint8_t version)
+            : header(PacketType::eHello, sizeof(Hello), id, stream)
+            , version(version)
+        { }
+    };
+
+    struct Welcome {
+        Response response;
+        uint8_t version;
+
+        Welcome() = default;
+
+        Welcome(PacketHeader instigator, uint8_t version)
+            : response(instigator, Status::eSuccess, sizeof(Welcome))
+            , version(version)
+        { }
+    };
 }
@@ -5,46 +5,162 @@
 #include "account/stream.hpp"
 #include "net/net.hpp"
 
-#include <unordered_map>
-#include <functional>
+#include "base/defer.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace game {
-    using RequestData = AnyPacket&;
-    using MessageHandler = std::function<void(RequestData request, sm::net::Socket& response)>;
+    /// @brief lock free histogram of handler latency.
+    /// bucket N counts samples in [2^(N-1), 2^N) nanoseconds.
+    class LatencyHistogram {
+    public:
+        static constexpr size_t kBucketCount = 40;
+
+        using Buckets = std::array<uint64_t, kBucketCount>;
+
+        void record(std::chrono::nanoseconds time) noexcept;
+
+        Buckets snapshot() const noexcept;
+
+        static std::chrono::nanoseconds getBucketUpperBound(size_t bucket) noexcept;
+
+    private:
+        std::array<std::atomic<uint64_t>, kBucketCount> mBuckets{};
+    };
 
+    struct RouteStats {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> bytes{0};
+        LatencyHistogram latency;
+
+        void record(size_t size, std::chrono::nanoseconds time) noexcept {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(size, std::memory_order_relaxed);
+            latency.record(time);
+        }
+    };
+
+    /// @brief point in time copy of a routes counters
+    struct RouteSnapshot {
+        PacketType type;
+        uint64_t calls;
+        uint64_t bytes;
+        LatencyHistogram::Buckets latency;
+
+        /// @brief upper bound of the bucket containing the given percentile
+        /// @param percentile in the range [0, 1]
+        std::chrono::nanoseconds getPercentile(double percentile) const noexcept;
+    };
+
+    /// @brief dispatches packets to handlers by their packet type.
+    /// built once and shared by every connection, per connection state is
+    /// passed through @p Context. handlers must be stateless callables, they
+    /// are instantiated into a function pointer table so dispatch is an index
+    /// and an indirect call.
+    template<typename Context>
     class MessageRouter {
-        std::unordered_map<PacketType, MessageHandler> mRoutes;
+        using Handler = void(*)(Context& context, AnyPacket& request, PacketChannel& response);
+
+        struct Route {
+            Handler handler = nullptr;
+            size_t minSize = 0;
+            RouteStats stats;
+        };
 
-        void addGenericRoute(PacketType type, MessageHandler handler);
+        static constexpr size_t kRouteCount = std::to_underlying(PacketType::eCount);
+
+        std::array<Route, kRouteCount> mRoutes;
+        std::atomic<uint64_t> mUnrouted{0};
+
+        void addGenericRoute(PacketType type, Handler handler, size_t minSize) noexcept {
+            Route& route = mRoutes[std::to_underlying(type)];
+            route.handler = handler;
+            route.minSize = minSize;
+        }
 
     public:
-        template<typename T, typename F>
-        void addRoute(PacketType type, F&& handler) {
-            using ResponseType = decltype(handler(std::declval<const T&>()));
+        template<typename F>
+        static constexpr bool kIsStateless = std::is_empty_v<F> && std::default_initializable<F>;
+
+        /// @brief route a packet to a handler that returns its response
+        template<typename T, typename F> requires (kIsStateless<F>)
+        void addRoute(PacketType type, F) noexcept {
+            Handler handler = [](Context& context, AnyPacket& request, PacketChannel& response) {
+                using ResponseType = std::invoke_result_t<F, Context&, const T&>;
 
-            auto messageHandler = [handler](RequestData request, sm::net::Socket& response) {
-                const T *requestPacket = std::bit_cast<const T*>(request.data());
+                const T& requestPacket = *std::bit_cast<const T*>(request.data());
                 if constexpr (std::is_void_v<ResponseType>) {
-                    handler(*requestPacket);
+                    F{}(context, requestPacket);
                 } else {
-                    ResponseType responsePacket = handler(*requestPacket);
-                    response.send(responsePacket).throwIfFailed();
+                    response.send(F{}(context, requestPacket)).throwIfFailed();
                 }
             };
 
-            addGenericRoute(type, messageHandler);
+            addGenericRoute(type, handler, sizeof(T));
         }
 
-        template<typename T, typename F>
-        void addFlexibleDataRoute(PacketType type, F&& handler) {
-            auto messageHandler = [handler](RequestData request, sm::net::Socket& response) {
-                const T *requestPacket = std::bit_cast<const T*>(request.data());
-                handler(*requestPacket, response);
+        /// @brief route a packet to a handler that writes its own response
+        template<typename T, typename F> requires (kIsStateless<F>)
+        void addFlexibleDataRoute(PacketType type, F) noexcept {
+            Handler handler = [](Context& context, AnyPacket& request, PacketChannel& response) {
+                const T& requestPacket = *std::bit_cast<const T*>(request.data());
+                F{}(context, requestPacket, response);
             };
 
-            addGenericRoute(type, messageHandler);
+            addGenericRoute(type, handler, sizeof(T));
+        }
+
+        /// @return false if there is no route for the packet or it is too small for its type
+        bool handleMessage(Context& context, AnyPacket& packet, PacketChannel& channel) {
+            size_t index = std::to_underlying(packet.header().type);
+            if (index >= kRouteCount) {
+                mUnrouted.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            Route& route = mRoutes[index];
+            if (route.handler == nullptr || packet.size < route.minSize) {
+                mUnrouted.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            defer { route.stats.record(packet.size, std::chrono::steady_clock::now() - start); };
+
+            route.handler(context, packet, channel);
+
+            return true;
+        }
+
+        /// @brief copy the counters of every registered route
+        std::vector<RouteSnapshot> scrape() const {
+            std::vector<RouteSnapshot> result;
+
+            for (size_t i = 0; i < kRouteCount; i++) {
+                const Route& route = mRoutes[i];
+                if (route.handler == nullptr)
+                    continue;
+
+                result.push_back(RouteSnapshot {
+                    .type = PacketType(i),
+                    .calls = route.stats.calls.load(std::memory_order_relaxed),
+                    .bytes = route.stats.bytes.load(std::memory_order_relaxed),
+                    .latency = route.stats.latency.snapshot(),
+                });
+            }
+
+            return result;
         }
 
-        bool handleMessage(AnyPacket& packet, sm::net::Socket& socket);
+        /// @brief number of packets dropped because they had no valid route
+        uint64_t getUnroutedCount() const noexcept {
+            return mUnrouted.load(std::memory_order_relaxed);
+        }
     };
 }
@@ -2,17 +2,26 @@
 
 #include "account/guid.hpp"
 
-#include <random>
+#include "core/random.hpp"
+
+#include <optional>
 #include <span>
+#include <string>
 
 namespace game {
     class Salt {
-        std::mt19937 mSource;
+        /// only set when seeded, otherwise everything comes from the secure generator
+        std::optional<sm::Random> mSource;
 
+        void fillBytes(std::span<uint8_t> buffer) noexcept;
         void newSalt(std::span<char> buffer) noexcept;
 
     public:
+        /// @brief salts and guids come from the operating system secure generator
         Salt();
+
+        /// @brief salts and guids are reproducible from @a seed
+        /// @warning predictable, only for tests
         Salt(unsigned seed);
 
         std::string getSaltString(size_t length);
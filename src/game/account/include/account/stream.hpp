@@ -1,8 +1,11 @@
 #pragma once
 
+#include "core/map.hpp"
+
 #include "net/net.hpp"
 
 #include "account/packets.hpp"
+#include "account/wire.hpp"
 
 #include <queue>
 
@@ -10,6 +13,10 @@ namespace game {
     struct AnyPacket {
         std::unique_ptr<std::byte[]> bytes;
 
+        /// size of the whole packet, this may be larger than
+        /// the header size for lists received with the compact encoding
+        size_t size = 0;
+
         void *data() const { return bytes.get(); }
 
         PacketHeader& header() const {
@@ -17,7 +24,7 @@ namespace game {
         }
 
         size_t bodySize() const noexcept {
-            return header().size - sizeof(PacketHeader);
+            return size - sizeof(PacketHeader);
         }
 
         uint8_t stream() const { return header().stream; }
@@ -27,6 +34,113 @@ namespace game {
     AnyPacket readSinglePacket(sm::net::Socket& socket);
     AnyPacket readSinglePacket(sm::net::Socket& socket, std::chrono::milliseconds timeout);
 
+    /// @brief decode a frame body into the fixed packet layout.
+    /// @return the packet, or an empty packet if the body is malformed
+    AnyPacket decodeFrameBody(const FrameHeader& header, std::span<const std::byte> body);
+
+    /// @brief a socket that sends and receives packets with a negotiated encoding.
+    /// packets are always exposed in their fixed layout, the encoding only
+    /// affects what is put on the wire. sending and reading use separate state
+    /// so may happen on different threads, but each must be serialized.
+    class PacketChannel {
+        sm::net::Socket& mSocket;
+        WireVersion mVersion = WireVersion::eFixed;
+
+        std::vector<std::byte> mSendBuffer;
+
+        /// bodies of multi part frames that are still being received, keyed by request id
+        sm::HashMap<uint16_t, std::vector<std::byte>> mPartialFrames;
+
+        /// total size of every body in @a mPartialFrames
+        size_t mPartialSize = 0;
+
+        sm::net::NetError sendBuffer(const void *data, size_t size) noexcept;
+
+        AnyPacket readFrame(std::chrono::milliseconds timeout);
+
+        template<typename L, typename E>
+        sm::net::NetError sendFixedList(const PacketHeader& instigator, Status status, std::span<const E> entries) {
+            size_t count = std::min(entries.size(), getMaxFixedListSize<L, E>());
+            size_t size = sizeof(L) + (sizeof(E) * count);
+
+            mSendBuffer.resize(size);
+            L *list = reinterpret_cast<L*>(mSendBuffer.data());
+            list->response = Response { instigator, status, uint16_t(size) };
+            std::memcpy(mSendBuffer.data() + sizeof(L), entries.data(), sizeof(E) * count);
+
+            return sendBuffer(mSendBuffer.data(), size);
+        }
+
+    public:
+        /// lists sent with the fixed encoding are truncated to fit in a single packet
+        template<typename L, typename E>
+        static constexpr size_t getMaxFixedListSize() noexcept {
+            return (UINT16_MAX - sizeof(L)) / sizeof(E);
+        }
+
+        /// reassembled lists larger than this are rejected
+        static constexpr size_t kMaxReassembledSize = 16 * 1024 * 1024;
+
+        /// the peer is dropped if it leaves more multi part frames than this open at once
+        static constexpr size_t kMaxPartialFrames = 16;
+
+        /// the peer is dropped if its open multi part frames buffer more than this in total
+        static constexpr size_t kMaxPartialSize = 2 * kMaxReassembledSize;
+
+        PacketChannel(sm::net::Socket& socket) noexcept
+            : mSocket(socket)
+        { }
+
+        WireVersion getVersion() const noexcept { return mVersion; }
+        void setVersion(WireVersion version) noexcept { mVersion = version; }
+
+        sm::net::Socket& getSocket() noexcept { return mSocket; }
+
+        template<WirePacket T>
+        sm::net::NetError send(const T& packet) {
+            if (mVersion == WireVersion::eFixed)
+                return sendBuffer(&packet, sizeof(T));
+
+            mSendBuffer.clear();
+            WireWriter writer{mSendBuffer};
+            encodeFrame(writer, packet);
+
+            return sendBuffer(mSendBuffer.data(), mSendBuffer.size());
+        }
+
+        /// @brief send many packets with a single write
+        template<WirePacket T>
+        sm::net::NetError sendAll(std::span<const T> packets) {
+            if (mVersion == WireVersion::eFixed)
+                return sendBuffer(packets.data(), packets.size_bytes());
+
+            mSendBuffer.clear();
+            WireWriter writer{mSendBuffer};
+            for (const T& packet : packets) {
+                encodeFrame(writer, packet);
+            }
+
+            return sendBuffer(mSendBuffer.data(), mSendBuffer.size());
+        }
+
+        /// @brief send a variable length list response
+        template<WirePacket L, WireStruct E>
+        sm::net::NetError sendList(const PacketHeader& instigator, Status status, std::span<const E> entries) {
+            if (mVersion == WireVersion::eFixed)
+                return sendFixedList<L, E>(instigator, status, entries);
+
+            mSendBuffer.clear();
+            WireWriter writer{mSendBuffer};
+            encodeListFrames<L, E>(writer, instigator, status, entries);
+
+            return sendBuffer(mSendBuffer.data(), mSendBuffer.size());
+        }
+
+        /// @brief read the next complete packet.
+        /// returns an empty packet on timeout or while a multi part list is still arriving
+        AnyPacket read(std::chrono::milliseconds timeout);
+    };
+
     struct SocketPartition {
         std::queue<AnyPacket> input;
     };
@@ -41,7 +155,9 @@ namespace game {
 
     public:
         AnyPacket pop(uint8_t stream);
+        void push(AnyPacket packet);
 
         void work(sm::net::Socket& socket, std::chrono::milliseconds timeout);
+        void work(PacketChannel& channel, std::chrono::milliseconds timeout);
     };
 }
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "account/packets.hpp"
+
+#include <limits>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * Compact wire encoding for account packets.
+ *
+ * Every frame is laid out as
+ *   u16le length of the rest of the frame
+ *   u8    stream in the low 4 bits, flags in the high 4 bits
+ *   var   wire type
+ *   var   request id
+ *   ...   fields in declaration order, integers as varints and strings length prefixed
+ *
+ * Lists that do not fit in a single frame are split into parts, every part but the
+ * last has @a kFrameMoreParts set. Only the first part carries the response status,
+ * the rest only carry entries so the bodies can be concatenated and decoded as one.
+ */
+namespace game {
+    enum class WireVersion : uint8_t {
+        /// packets are sent as their in memory structs
+        eFixed = 1,
+
+        /// packets are sent with the compact frame encoding
+        eCompact = 2,
+
+        eLatest = eCompact
+    };
+
+    enum class WireType : uint16_t {
+        eInvalid = 0,
+
+        // requests
+        eAck,
+        eCreateAccount,
+        eLogin,
+        ePostMessage,
+        eGetSessionList,
+        eGetLobbyList,
+        eCreateLobby,
+        eJoinLobby,
+        eLeaveLobby,
+        eStartGame,
+        eHello,
+
+        // responses, these all share PacketType::eResponse
+        // so need their own wire type to be decoded
+        eResponse,
+        eNewSession,
+        eNewLobby,
+        eSessionList,
+        eLobbyList,
+        eWelcome,
+
+        eCount
+    };
+
+    static constexpr size_t kMaxFrameSize = std::numeric_limits<uint16_t>::max();
+    static constexpr size_t kFrameLengthSize = sizeof(uint16_t);
+
+    static constexpr uint8_t kFrameStreamMask = 0b0000'1111;
+    static constexpr uint8_t kFrameMoreParts = 0b0001'0000;
+
+    class WireWriter {
+        std::vector<std::byte>& mBuffer;
+
+    public:
+        WireWriter(std::vector<std::byte>& buffer) noexcept
+            : mBuffer(buffer)
+        { }
+
+        void writeByte(uint8_t value);
+        void writeVarint(uint64_t value);
+        void writeString(std::string_view value);
+
+        size_t size() const noexcept { return mBuffer.size(); }
+        void truncate(size_t size) noexcept { mBuffer.resize(size); }
+
+        std::vector<std::byte>& buffer() noexcept { return mBuffer; }
+    };
+
+    class WireReader {
+        std::span<const std::byte> mData;
+        size_t mOffset = 0;
+        bool mValid = true;
+
+    public:
+        WireReader(std::span<const std::byte> data) noexcept
+            : mData(data)
+        { }
+
+        uint8_t readByte() noexcept;
+        uint64_t readVarint() noexcept;
+        std::string_view readString() noexcept;
+
+        void fail() noexcept { mValid = false; }
+
+        bool isValid() const noexcept { return mValid; }
+        bool isEmpty() const noexcept { return mOffset >= mData.size(); }
+
+        std::span<const std::byte> remaining() const noexcept { return mData.subspan(std::min(mOffset, mData.size())); }
+    };
+
+    struct FrameHeader {
+        uint8_t flags;
+        WireType type;
+        uint16_t id;
+
+        uint8_t stream() const noexcept { return flags & kFrameStreamMask; }
+        bool hasMoreParts() const noexcept { return flags & kFrameMoreParts; }
+    };
+
+    /// @brief field layout and wire type of a packet, see the table at the bottom of this file
+    template<typename T>
+    struct WireTraits;
+
+    template<typename T>
+    concept WireStruct = requires { WireTraits<T>::kFields; };
+
+    template<typename T>
+    concept WirePacket = WireStruct<T> && requires { WireTraits<T>::kWireType; };
+
+    namespace detail {
+        template<typename T> requires (std::is_unsigned_v<T>)
+        void encodeValue(WireWriter& writer, T value) {
+            writer.writeVarint(value);
+        }
+
+        template<typename T> requires (std::is_enum_v<T>)
+        void encodeValue(WireWriter& writer, T value) {
+            writer.writeVarint(std::to_underlying(value));
+        }
+
+        template<size_t N>
+        void encodeValue(WireWriter& writer, const Text<N>& text) {
+            writer.writeString(text.text());
+        }
+
+        template<typename T, size_t N>
+        void encodeValue(WireWriter& writer, const T (&values)[N]) {
+            for (const T& value : values) {
+                encodeValue(writer, value);
+            }
+        }
+
+        template<WireStruct T>
+        void encodeValue(WireWriter& writer, const T& value) {
+            std::apply([&](auto... fields) { (encodeValue(writer, value.*fields), ...); }, WireTraits<T>::kFields);
+        }
+
+        template<typename T> requires (std::is_unsigned_v<T>)
+        void decodeValue(WireReader& reader, T& value) {
+            uint64_t result = reader.readVarint();
+            if (result > std::numeric_limits<T>::max())
+                reader.fail();
+
+            value = static_cast<T>(result);
+        }
+
+        template<typename T> requires (std::is_enum_v<T>)
+        void decodeValue(WireReader& reader, T& value) {
+            std::underlying_type_t<T> result{};
+            decodeValue(reader, result);
+            value = static_cast<T>(result);
+        }
+
+        template<size_t N>
+        void decodeValue(WireReader& reader, Text<N>& text) {
+            std::string_view result = reader.readString();
+            if (result.size() > N)
+                reader.fail();
+
+            text = Text<N>(result);
+        }
+
+        template<typename T, size_t N>
+        void decodeValue(WireReader& reader, T (&values)[N]) {
+            for (T& value : values) {
+                decodeValue(reader, value);
+            }
+        }
+
+        template<WireStruct T>
+        void decodeValue(WireReader& reader, T& value) {
+            std::apply([&](auto... fields) { (decodeValue(reader, value.*fields), ...); }, WireTraits<T>::kFields);
+        }
+
+        template<typename T>
+        constexpr PacketHeader& headerOf(T& packet) noexcept {
+            if constexpr (requires { packet.header; }) {
+                return packet.header;
+            } else {
+                return packet.response.header;
+            }
+        }
+
+        template<typename T>
+        constexpr const PacketHeader& headerOf(const T& packet) noexcept {
+            return headerOf(const_cast<T&>(packet));
+        }
+    }
+
+    /// @brief begin a new frame, the frame must be closed with @a endFrame
+    /// @return the offset of the frame in the writers buffer
+    size_t beginFrame(WireWriter& writer, uint8_t flags, WireType type, uint16_t id);
+
+    /// @brief patch the length of a frame
+    void endFrame(WireWriter& writer, size_t frame);
+
+    bool decodeFrameHeader(WireReader& reader, FrameHeader& header) noexcept;
+
+    template<WirePacket T>
+    void encodeFrame(WireWriter& writer, const T& packet) {
+        const PacketHeader& header = detail::headerOf(packet);
+        size_t frame = beginFrame(writer, header.stream & kFrameStreamMask, WireTraits<T>::kWireType, header.id);
+        detail::encodeValue(writer, packet);
+        endFrame(writer, frame);
+    }
+
+    /// @brief encode a list response, splitting it into as many parts as needed
+    template<WirePacket L, WireStruct E>
+    void encodeListFrames(WireWriter& writer, const PacketHeader& instigator, Status status, std::span<const E> entries) {
+        uint8_t flags = instigator.stream & kFrameStreamMask;
+        size_t frame = beginFrame(writer, flags, WireTraits<L>::kWireType, instigator.id);
+        detail::encodeValue(writer, status);
+
+        for (const E& entry : entries) {
+            size_t mark = writer.size();
+            detail::encodeValue(writer, entry);
+
+            if (writer.size() - frame - kFrameLengthSize <= kMaxFrameSize)
+                continue;
+
+            // this entry doesnt fit, close the current part and start another
+            writer.truncate(mark);
+            writer.buffer()[frame + kFrameLengthSize] |= std::byte{kFrameMoreParts};
+            endFrame(writer, frame);
+
+            frame = beginFrame(writer, flags, WireTraits<L>::kWireType, instigator.id);
+            detail::encodeValue(writer, entry);
+        }
+
+        endFrame(writer, frame);
+    }
+
+#define WIRE_PACKET(T, TYPE, ...) \
+    template<> struct WireTraits<T> { \
+        static constexpr WireType kWireType = WireType::TYPE; \
+        static constexpr auto kFields = std::make_tuple(__VA_ARGS__); \
+    };
+
+#define WIRE_STRUCT(T, ...) \
+    template<> struct WireTraits<T> { \
+        static constexpr auto kFields = std::make_tuple(__VA_ARGS__); \
+    };
+
+    WIRE_STRUCT(SessionInfo, &SessionInfo::id, &SessionInfo::name)
+    WIRE_STRUCT(LobbyInfo, &LobbyInfo::id, &LobbyInfo::players, &LobbyInfo::name, &LobbyInfo::state)
+
+    WIRE_PACKET(Ack, eAck)
+    WIRE_PACKET(CreateAccount, eCreateAccount, &CreateAccount::username, &CreateAccount::password)
+    WIRE_PACKET(Login, eLogin, &Login::username, &Login::password)
+    WIRE_PACKET(SendMessage, ePostMessage, &SendMessage::author, &SendMessage::timestamp, &SendMessage::message)
+    WIRE_PACKET(GetSessionList, eGetSessionList, &GetSessionList::session)
+    WIRE_PACKET(GetLobbyList, eGetLobbyList, &GetLobbyList::session)
+    WIRE_PACKET(CreateLobby, eCreateLobby, &CreateLobby::session, &CreateLobby::name)
+    WIRE_PACKET(JoinLobby, eJoinLobby, &JoinLobby::session, &JoinLobby::lobby)
+    WIRE_PACKET(LeaveLobby, eLeaveLobby, &LeaveLobby::session, &LeaveLobby::lobby)
+    WIRE_PACKET(StartGame, eStartGame, &StartGame::session, &StartGame::lobby)
+    WIRE_PACKET(Hello, eHello, &Hello::version)
+
+    WIRE_PACKET(Response, eResponse, &Response::status)
+    WIRE_PACKET(NewSession, eNewSession, &NewSession::response, &NewSession::session)
+    WIRE_PACKET(NewLobby, eNewLobby, &NewLobby::response, &NewLobby::lobby)
+    WIRE_PACKET(Welcome, eWelcome, &Welcome::response, &Welcome::version)
+
+    // list entries are not fields, they are encoded by encodeListFrames
+    WIRE_PACKET(SessionList, eSessionList, &SessionList::response)
+    WIRE_PACKET(LobbyList, eLobbyList, &LobbyList::response)
+
+#undef WIRE_PACKET
+#undef WIRE_STRUCT
+}
@@ -7,17 +7,29 @@ using namespace game;
 
 using namespace std::chrono_literals;
 
-AccountClient::AccountClient(sm::net::Network& net, const sm::net::Address& address, uint16_t port) noexcept(false)
+namespace chrono = std::chrono;
+
+AccountClient::AccountClient(sm::net::Network& net, const sm::net::Address& address, uint16_t port, WireVersion version) noexcept(false)
     : mSocket{net.connect(address, port)}
-{ }
+{
+    // bound blocking reads so the io loop can observe stop requests
+    mSocket.setRecvTimeout(kDefaultTimeout).throwIfFailed();
+
+    if (version != WireVersion::eFixed && !negotiate(version)) {
+        LOG_WARN(GlobalLog, "Server did not accept wire version {}, using fixed encoding", std::to_underlying(version));
+    }
+}
+
+AccountClient::~AccountClient() noexcept {
+    stop();
+    cancelPendingRequests();
+}
 
 bool AccountClient::createAccount(std::string_view name, std::string_view password) {
     if (name.size() > sizeof(CreateAccount::username) || password.size() > sizeof(CreateAccount::password))
         return false;
 
-    mSocket.send(CreateAccount { mNextId++, kClientStream, name, password }).throwIfFailed();
-
-    if (AnyPacket packet = getNextMessage(kClientStream)) {
+    if (AnyPacket packet = roundTrip(CreateAccount { 0, kClientStream, name, password })) {
         Response& response = *std::bit_cast<Response*>(packet.data());
         return response.status == Status::eSuccess;
     }
@@ -29,9 +41,7 @@ bool AccountClient::login(std::string_view name, std::string_view password) {
     if (name.size() > sizeof(Login::username) || password.size() > sizeof(Login::password))
         return false;
 
-    mSocket.send(Login { mNextId++, kClientStream, name, password }).throwIfFailed();
-
-    if (AnyPacket packet = getNextMessage(kClientStream)) {
+    if (AnyPacket packet = roundTrip(Login { 0, kClientStream, name, password })) {
         NewSession& session = *std::bit_cast<NewSession*>(packet.data());
         LOG_INFO(GlobalLog, "New session established with server. Assigned id {}", session.session);
 
@@ -53,9 +63,7 @@ bool AccountClient::createLobby(std::string_view name) {
     if (!isAuthed())
         return false;
 
-    mSocket.send(CreateLobby { mNextId++, kClientStream, mCurrentSession, name }).throwIfFailed();
-
-    if (AnyPacket packet = getNextMessage(kClientStream)) {
+    if (AnyPacket packet = roundTrip(CreateLobby { 0, kClientStream, mCurrentSession, name })) {
         NewLobby& lobby = *std::bit_cast<NewLobby*>(packet.data());
 
         bool success = lobby.response.status == Status::eSuccess;
@@ -73,9 +81,7 @@ bool AccountClient::joinLobby(LobbyId id) {
     if (!isAuthed())
         return false;
 
-    mSocket.send(JoinLobby { mNextId++, kClientStream, mCurrentSession, id }).throwIfFailed();
-
-    if (AnyPacket packet = getNextMessage(kClientStream)) {
+    if (AnyPacket packet = roundTrip(JoinLobby { 0, kClientStream, mCurrentSession, id })) {
         Response& response = *std::bit_cast<Response*>(packet.data());
         bool success = response.status == Status::eSuccess;
         if (!success)
@@ -95,9 +101,7 @@ bool AccountClient::startGame() {
     if (mCurrentLobby == UINT64_MAX)
         return false;
 
-    mSocket.send(StartGame { mNextId++, kClientStream, mCurrentSession, mCurrentLobby }).throwIfFailed();
-
-    if (AnyPacket packet = getNextMessage(kClientStream)) {
+    if (AnyPacket packet = roundTrip(StartGame { 0, kClientStream, mCurrentSession, mCurrentLobby })) {
         Response& response = *std::bit_cast<Response*>(packet.data());
         return response.status == Status::eSuccess;
     }
@@ -112,7 +116,11 @@ void AccountClient::leaveLobby() {
     if (mCurrentLobby == UINT64_MAX)
         return;
 
-    mSocket.send(LeaveLobby { mNextId++, kClientStream, mCurrentSession, mCurrentLobby }).throwIfFailed();
+    // the server doesnt respond to this, so it doesnt need a request slot
+    {
+        std::lock_guard guard(mSendMutex);
+        mChannel.send(LeaveLobby { 0, kClientStream, mCurrentSession, mCurrentLobby }).throwIfFailed();
+    }
 
     mCurrentLobby = UINT64_MAX;
 }
@@ -125,19 +133,21 @@ bool AccountClient::sendMessage(std::string_view message) {
         return false;
     }
 
-    mSocket.send(SendMessage { mNextId++, kClientStream, mCurrentSession, 0, message }).throwIfFailed();
+    // the server acknowledges every message, nothing needs to wait on it
+    sendRequest(SendMessage { 0, kClientStream, mCurrentSession, 0, message }, [](AnyPacket&) { });
 
     mMessages.push_back(Message { .author = "You", .message = std::string{message} });
 
     return true;
 }
 
-static size_t getSessionListSize(const SessionList *list) {
-    size_t size = std::max<size_t>(list->response.header.size, sizeof(SessionList)) - sizeof(SessionList);
-    if (size % sizeof(SessionInfo) != 0)
+template<typename L, typename E>
+static size_t getListSize(const AnyPacket& packet) {
+    size_t size = std::max<size_t>(packet.size, sizeof(L)) - sizeof(L);
+    if (size % sizeof(E) != 0)
         return 0;
 
-    return size / sizeof(SessionInfo);
+    return size / sizeof(E);
 }
 
 bool AccountClient::refreshSessionList() {
@@ -146,11 +156,9 @@ bool AccountClient::refreshSessionList() {
 
     std::vector<SessionInfo> sessions;
 
-    mSocket.send(GetSessionList { mNextId++, kClientStream, mCurrentSession }).throwIfFailed();
-
-    if (AnyPacket data = getNextMessage(kClientStream)) {
+    if (AnyPacket data = roundTrip(GetSessionList { 0, kClientStream, mCurrentSession })) {
         SessionList *list = reinterpret_cast<SessionList*>(data.data());
-        size_t count = getSessionListSize(list);
+        size_t count = getListSize<SessionList, SessionInfo>(data);
 
         sessions.reserve(count);
 
@@ -165,25 +173,15 @@ bool AccountClient::refreshSessionList() {
     return false;
 }
 
-static size_t getLobbyListSize(const LobbyList *list) {
-    size_t size = std::max<size_t>(list->response.header.size, sizeof(LobbyList)) - sizeof(LobbyList);
-    if (size % sizeof(LobbyInfo) != 0)
-        return 0;
-
-    return size / sizeof(LobbyInfo);
-}
-
 bool AccountClient::refreshLobbyList() {
     if (!isAuthed())
         throw std::runtime_error("Not authenticated");
 
     std::vector<LobbyInfo> lobbies;
 
-    mSocket.send(GetLobbyList { mNextId++, kClientStream, mCurrentSession }).throwIfFailed();
-
-    if (AnyPacket data = getNextMessage(kClientStream)) {
+    if (AnyPacket data = roundTrip(GetLobbyList { 0, kClientStream, mCurrentSession })) {
         LobbyList *list = reinterpret_cast<LobbyList*>(data.data());
-        size_t count = getLobbyListSize(list);
+        size_t count = getListSize<LobbyList, LobbyInfo>(data);
 
         lobbies.reserve(count);
 
@@ -201,6 +199,7 @@ bool AccountClient::refreshLobbyList() {
 bool AccountClient::refreshMessageList() {
     work();
 
+    std::lock_guard guard(mRecvMutex);
     while (AnyPacket packet = mSocketMux.pop(kMessageStream)) {
         SendMessage& message = *std::bit_cast<SendMessage*>(packet.data());
         mMessages.push_back(Message { .author = "TODO", .message = std::string{message.message.text()} });
@@ -209,11 +208,170 @@ bool AccountClient::refreshMessageList() {
     return true;
 }
 
+uint16_t AccountClient::addRequestSlot(RequestCallback callback) {
+    std::lock_guard guard(mRequestMutex);
+
+    if (mRequestSlots.size() > UINT16_MAX)
+        throw std::runtime_error("Too many requests in flight");
+
+    // skip over ids that are still waiting on a response
+    while (mRequestSlots.contains(mNextId))
+        mNextId++;
+
+    uint16_t id = mNextId++;
+    mRequestSlots.emplace(id, std::move(callback));
+    return id;
+}
+
+AccountClient::RequestCallback AccountClient::takeRequestSlot(uint16_t id) {
+    std::lock_guard guard(mRequestMutex);
+
+    auto it = mRequestSlots.find(id);
+    if (it == mRequestSlots.end())
+        return nullptr;
+
+    RequestCallback callback = std::move(it->second);
+    mRequestSlots.erase(it);
+    return callback;
+}
+
+void AccountClient::abortRequest(uint16_t id, net::NetError error) noexcept(false) {
+    // the request never made it to the server, dont leave the slot dangling
+    takeRequestSlot(id);
+
+    throw net::NetException{std::move(error)};
+}
+
+bool AccountClient::negotiate(WireVersion version) {
+    // the handshake is always in the fixed encoding, nothing else may
+    // be in flight while the encoding changes.
+    if (AnyPacket packet = roundTrip(Hello { 0, kClientStream, std::to_underlying(version) })) {
+        if (packet.size < sizeof(Welcome))
+            return false;
+
+        Welcome& welcome = *std::bit_cast<Welcome*>(packet.data());
+        if (welcome.response.status != Status::eSuccess)
+            return false;
+
+        if (welcome.version < std::to_underlying(WireVersion::eFixed) || welcome.version > std::to_underlying(WireVersion::eLatest))
+            return false;
+
+        mChannel.setVersion(WireVersion{welcome.version});
+        return welcome.version == std::to_underlying(version);
+    }
+
+    return false;
+}
+
+void AccountClient::dispatchPacket(AnyPacket packet) {
+    if (packet.stream() != kClientStream) {
+        std::lock_guard guard(mRecvMutex);
+        mSocketMux.push(std::move(packet));
+        return;
+    }
+
+    uint16_t id = packet.header().id;
+    if (RequestCallback callback = takeRequestSlot(id)) {
+        callback(packet);
+    } else {
+        LOG_WARN(GlobalLog, "Dropping response to unknown request {}", id);
+    }
+}
+
+void AccountClient::cancelPendingRequests() {
+    std::map<uint16_t, RequestCallback> slots = [&] {
+        std::lock_guard guard(mRequestMutex);
+        return std::exchange(mRequestSlots, {});
+    }();
+
+    for (auto& [id, callback] : slots) {
+        AnyPacket empty;
+        callback(empty);
+    }
+}
+
+bool AccountClient::cancelRequest(uint16_t id) {
+    if (RequestCallback callback = takeRequestSlot(id)) {
+        AnyPacket empty;
+        callback(empty);
+        return true;
+    }
+
+    return false;
+}
+
+size_t AccountClient::getPendingRequestCount() {
+    std::lock_guard guard(mRequestMutex);
+    return mRequestSlots.size();
+}
+
+AnyPacket AccountClient::waitForResponse(uint16_t id, std::future<AnyPacket> future, std::chrono::milliseconds timeout) {
+    const auto deadline = chrono::steady_clock::now() + timeout;
+
+    while (future.wait_for(0ms) != std::future_status::ready) {
+        auto now = chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+
+        auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - now);
+
+        // if nothing else is driving the socket then do it ourselves
+        if (isWorkerRunning()) {
+            future.wait_for(remaining);
+        } else {
+            work(remaining);
+        }
+    }
+
+    // if the response raced the timeout then the callback has already
+    // been taken and the future will be fulfilled with the real response
+    cancelRequest(id);
+
+    return future.get();
+}
+
 AnyPacket AccountClient::getNextMessage(uint8_t stream) {
     work();
+
+    std::lock_guard guard(mRecvMutex);
     return mSocketMux.pop(stream);
 }
 
-void AccountClient::work() {
-    mSocketMux.work(mSocket, 250ms);
+void AccountClient::work(std::chrono::milliseconds timeout) {
+    AnyPacket packet = [&] {
+        std::lock_guard guard(mRecvMutex);
+        return mChannel.read(timeout);
+    }();
+
+    if (packet) {
+        dispatchPacket(std::move(packet));
+    }
+}
+
+void AccountClient::begin() {
+    if (isWorkerRunning())
+        return;
+
+    mWorker = std::jthread([this](const std::stop_token& stop) {
+        try {
+            while (!stop.stop_requested()) {
+                work();
+            }
+        } catch (const net::NetException& e) {
+            LOG_WARN(GlobalLog, "Account client io loop stopped: {}", e);
+        } catch (const std::exception& e) {
+            LOG_ERROR(GlobalLog, "Unhandled exception in account client io loop: {}", e.what());
+        }
+
+        // nothing will ever answer these now
+        cancelPendingRequests();
+    });
+}
+
+void AccountClient::stop() {
+    if (!isWorkerRunning())
+        return;
+
+    mWorker.request_stop();
+    mWorker.join();
 }
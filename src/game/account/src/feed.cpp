@@ -0,0 +1,68 @@
+#include "stdafx.hpp"
+
+#include "account/feed.hpp"
+
+#include <bit>
+
+using namespace game;
+
+MessageFeed::MessageFeed(size_t capacity)
+    : mSlots(std::make_unique<Slot[]>(std::bit_ceil(std::max<size_t>(capacity, 1))))
+    , mMask(std::bit_ceil(std::max<size_t>(capacity, 1)) - 1)
+{ }
+
+void MessageFeed::publish(const SendMessage& message) {
+    uint64_t sequence = mHead.fetch_add(1, std::memory_order_acq_rel);
+
+    // allocate outside of the slot so readers are never blocked on us
+    auto entry = std::make_shared<const FeedEntry>(FeedEntry { sequence, message });
+
+    // a publisher that stalled between claiming its sequence and storing it
+    // may find a newer message from a later pass around the ring already in
+    // the slot, that message must win or readers would see the ring go back.
+    Slot& slot = mSlots[sequence & mMask];
+    FeedEntryPtr current = slot.load(std::memory_order_acquire);
+    while (!current || current->sequence < sequence) {
+        if (slot.compare_exchange_weak(current, entry, std::memory_order_acq_rel, std::memory_order_acquire))
+            break;
+    }
+}
+
+FeedCursor MessageFeed::subscribe(SessionId session) const noexcept {
+    return FeedCursor { *this, session, getHead() };
+}
+
+size_t FeedCursor::poll(std::span<FeedEntryPtr> batch) noexcept {
+    size_t count = 0;
+    uint64_t capacity = mFeed->getCapacity();
+
+    while (count < batch.size()) {
+        FeedEntryPtr entry = mFeed->load(mNext);
+
+        // either nothing has been written here yet, or the publisher
+        // has claimed this sequence but not stored it yet.
+        if (!entry || entry->sequence < mNext)
+            break;
+
+        // we fell behind and the ring wrapped around us, skip
+        // to the oldest message that is still available.
+        if (entry->sequence > mNext) {
+            uint64_t head = mFeed->getHead();
+            uint64_t oldest = head > capacity ? head - capacity : 0;
+            uint64_t next = std::max(oldest, mNext + 1);
+
+            mDropped += next - mNext;
+            mNext = next;
+            continue;
+        }
+
+        mNext += 1;
+
+        if (entry->message.author == mSession)
+            continue;
+
+        batch[count++] = std::move(entry);
+    }
+
+    return count;
+}
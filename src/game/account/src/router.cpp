@@ -1,25 +1,57 @@
 #include "stdafx.hpp"
 
-#include "account/stream.hpp"
-
 #include "account/router.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
 using namespace game;
 
-namespace net = sm::net;
+///
+/// histogram
+///
+
+static size_t getBucketIndex(std::chrono::nanoseconds time) noexcept {
+    uint64_t count = static_cast<uint64_t>(std::max<int64_t>(time.count(), 0));
+    return std::min<size_t>(std::bit_width(count), LatencyHistogram::kBucketCount - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds time) noexcept {
+    mBuckets[getBucketIndex(time)].fetch_add(1, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Buckets LatencyHistogram::snapshot() const noexcept {
+    Buckets result;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        result[i] = mBuckets[i].load(std::memory_order_relaxed);
+    }
 
-void MessageRouter::addGenericRoute(PacketType type, MessageHandler handler) {
-    mRoutes[type] = std::move(handler);
+    return result;
 }
 
-bool MessageRouter::handleMessage(AnyPacket& packet, sm::net::Socket& socket) {
-    PacketHeader& header = packet.header();
+std::chrono::nanoseconds LatencyHistogram::getBucketUpperBound(size_t bucket) noexcept {
+    return std::chrono::nanoseconds{uint64_t(1) << std::min(bucket, kBucketCount - 1)};
+}
+
+///
+/// snapshot
+///
+
+std::chrono::nanoseconds RouteSnapshot::getPercentile(double percentile) const noexcept {
+    // the buckets are read one at a time so may not add up to calls exactly
+    uint64_t total = std::accumulate(latency.begin(), latency.end(), uint64_t(0));
+    if (total == 0)
+        return std::chrono::nanoseconds::zero();
 
-    auto it = mRoutes.find(header.type);
-    if (it == mRoutes.end())
-        return false;
+    uint64_t target = static_cast<uint64_t>(std::clamp(percentile, 0.0, 1.0) * double(total - 1));
 
-    it->second(packet, socket);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < latency.size(); i++) {
+        seen += latency[i];
+        if (seen > target)
+            return LatencyHistogram::getBucketUpperBound(i);
+    }
 
-    return true;
+    return LatencyHistogram::getBucketUpperBound(latency.size() - 1);
 }
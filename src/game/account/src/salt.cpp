@@ -8,19 +8,38 @@ using namespace game;
 
 static constexpr std::string_view kChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
 
-Salt::Salt()
-    : mSource{std::random_device{}()}
-{ }
+Salt::Salt() = default;
 
 Salt::Salt(unsigned seed)
     : mSource{seed}
 { }
 
-void Salt::newSalt(std::span<char> buffer) noexcept {
-    std::uniform_int_distribution<int> anySaltChar(0, kChars.size() - 1);
+void Salt::fillBytes(std::span<uint8_t> buffer) noexcept {
+    if (mSource) {
+        mSource->nextBytes(buffer);
+    } else {
+        sm::getSecureRandomBytes(buffer);
+    }
+}
 
-    for (char& c : buffer) {
-        c = kChars[anySaltChar(mSource)];
+void Salt::newSalt(std::span<char> buffer) noexcept {
+    // bytes past the last whole multiple of the alphabet are thrown away,
+    // otherwise the first few characters would turn up more often than the rest
+    constexpr size_t kLimit = 256 - (256 % kChars.size());
+
+    uint8_t bytes[64];
+    size_t used = 0;
+    while (used < buffer.size()) {
+        fillBytes(bytes);
+
+        for (uint8_t byte : bytes) {
+            if (byte >= kLimit)
+                continue;
+
+            buffer[used++] = kChars[byte % kChars.size()];
+            if (used == buffer.size())
+                break;
+        }
     }
 }
 
@@ -31,12 +50,8 @@ std::string Salt::getSaltString(size_t length) {
 }
 
 Guid Salt::newGuid() noexcept {
-    std::uniform_int_distribution<> anyByte(0, 255);
     Guid guid{};
-    for (uint8_t& byte : guid.data) {
-        byte = anyByte(mSource);
-    }
-
+    fillBytes(guid.data);
     return guid;
 }
 
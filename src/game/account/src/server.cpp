@@ -190,8 +190,6 @@ void AccountServer::dropSession(SessionId session) try {
     if (db::DbError error = stmt.execute()) {
         LOG_WARN(GlobalLog, "Failed to remove data associated with session {}. {}", session, error);
     }
-
-    mOpenClients.erase(session);
 } catch (const std::exception& e) {
     LOG_WARN(GlobalLog, "Failed to drop session: {}", e.what());
 } catch (...) {
@@ -199,58 +197,66 @@ void AccountServer::dropSession(SessionId session) try {
 }
 
 void AccountServer::broadcastMessage(SendMessage message) {
-    std::lock_guard guard(mDbMutex);
+    message.header.stream = kMessageStream;
+    mMessageFeed.publish(message);
+}
 
-    for (auto& [id, clients] : mOpenClients) {
-        if (id == message.author)
-            continue;
+static constexpr size_t kMessageBatchSize = 32;
 
-        clients.push_back(message);
+// lists larger than a single packet are only delivered in full to compact clients
+static constexpr size_t kMaxListEntries = 4096;
+
+static net::NetError sendMessageBatch(PacketChannel& channel, std::span<const FeedEntryPtr> batch) {
+    SendMessage messages[kMessageBatchSize];
+
+    for (size_t i = 0; i < batch.size(); i++) {
+        messages[i] = batch[i]->message;
     }
-}
 
-void AccountServer::handleClient(const std::stop_token& stop, net::Socket socket) noexcept try {
-    MessageRouter router;
-    SessionId session = UINT64_MAX;
+    return channel.sendAll(std::span<const SendMessage>(messages, batch.size()));
+}
 
-    defer { dropSession(session); };
+void AccountServer::buildRouter() {
+    // the reply is sent with the encoding the client connected with,
+    // only packets after it use the negotiated encoding
+    mRouter.addFlexibleDataRoute<Hello>(PacketType::eHello, [](ClientContext&, const Hello& req, PacketChannel& channel) {
+        uint8_t version = std::clamp<uint8_t>(req.version, std::to_underlying(WireVersion::eFixed), std::to_underlying(WireVersion::eLatest));
 
-    socket.setBlocking(false);
-    socket.setRecvTimeout(250ms);
-    socket.setSendTimeout(250ms);
+        channel.send(Welcome { req.header, version }).throwIfFailed();
+        channel.setVersion(WireVersion{version});
+    });
 
-    router.addRoute<Ack>(PacketType::eAck, [](const Ack& req) {
+    mRouter.addRoute<Ack>(PacketType::eAck, [](ClientContext&, const Ack& req) {
         LOG_INFO(GlobalLog, "received ack: {}/{}", req.header.id, req.header.stream);
 
         return Ack { req.header };
     });
 
-    router.addRoute<CreateAccount>(PacketType::eCreateAccount, [this](const CreateAccount& req) {
-        if (createAccount(req)) {
+    mRouter.addRoute<CreateAccount>(PacketType::eCreateAccount, [](ClientContext& ctx, const CreateAccount& req) {
+        if (ctx.server.createAccount(req)) {
             return Response { req.header, Status::eSuccess };
         } else {
             return Response { req.header, Status::eFailure };
         }
     });
 
-    router.addRoute<Login>(PacketType::eLogin, [this, &session](const Login& req) {
-        if (session != UINT64_MAX) {
-            return NewSession { req.header, session };
+    mRouter.addRoute<Login>(PacketType::eLogin, [](ClientContext& ctx, const Login& req) {
+        if (ctx.session != UINT64_MAX) {
+            return NewSession { req.header, ctx.session };
         }
 
-        SessionId auth = login(req);
+        SessionId auth = ctx.server.login(req);
         if (auth == UINT64_MAX) {
             return NewSession { req.header };
         } else {
-            session = auth;
-            std::lock_guard guard(mDbMutex);
-            mOpenClients[session] = {};
+            ctx.session = auth;
+            ctx.feed.emplace(ctx.server.mMessageFeed.subscribe(auth));
             return NewSession { req.header, auth };
         }
     });
 
-    router.addRoute<CreateLobby>(PacketType::eCreateLobby, [this](const CreateLobby& req) {
-        LobbyId id = createLobby(req);
+    mRouter.addRoute<CreateLobby>(PacketType::eCreateLobby, [](ClientContext& ctx, const CreateLobby& req) {
+        LobbyId id = ctx.server.createLobby(req);
         if (id == UINT64_MAX) {
             return NewLobby { req.header };
         } else {
@@ -258,84 +264,90 @@ void AccountServer::handleClient(const std::stop_token& stop, net::Socket socket
         }
     });
 
-    router.addRoute<JoinLobby>(PacketType::eJoinLobby, [this](const JoinLobby& req) {
-        if (joinLobby(req)) {
+    mRouter.addRoute<JoinLobby>(PacketType::eJoinLobby, [](ClientContext& ctx, const JoinLobby& req) {
+        if (ctx.server.joinLobby(req)) {
             return Response { req.header, Status::eSuccess };
         } else {
             return Response { req.header, Status::eFailure };
         }
     });
 
-    router.addFlexibleDataRoute<GetSessionList>(PacketType::eGetSessionList, [this](const GetSessionList& req, net::Socket& socket) {
-        if (!authSession(req.session)) {
-            socket.send(Response { req.header, Status::eFailure }).throwIfFailed();
+    mRouter.addFlexibleDataRoute<GetSessionList>(PacketType::eGetSessionList, [](ClientContext& ctx, const GetSessionList& req, PacketChannel& channel) {
+        if (!ctx.server.authSession(req.session)) {
+            channel.send(Response { req.header, Status::eFailure }).throwIfFailed();
             return;
         }
 
-        static constexpr size_t kMaxSessions = 256;
-        std::unique_ptr<std::byte[]> data = std::make_unique<std::byte[]>(sizeof(SessionList) + (sizeof(SessionInfo) * kMaxSessions));
-        SessionList *list = reinterpret_cast<SessionList*>(data.get());
-        auto count = getSessionList(std::span<SessionInfo>(list->sessions, kMaxSessions));
-        uint16_t size = sizeof(SessionList) + (sizeof(SessionInfo) * count);
+        std::vector<SessionInfo> sessions(kMaxListEntries);
+        sessions.resize(ctx.server.getSessionList(sessions));
 
-        list->response = Response { req.header, Status::eSuccess, size };
-
-        net::throwIfFailed(socket.sendBytes(data.get(), size));
+        channel.sendList<SessionList, SessionInfo>(req.header, Status::eSuccess, sessions).throwIfFailed();
     });
 
-    router.addFlexibleDataRoute<GetLobbyList>(PacketType::eGetLobbyList, [this](const GetLobbyList& req, net::Socket& socket) {
-        if (!authSession(req.session)) {
-            socket.send(Response { req.header, Status::eFailure }).throwIfFailed();
+    mRouter.addFlexibleDataRoute<GetLobbyList>(PacketType::eGetLobbyList, [](ClientContext& ctx, const GetLobbyList& req, PacketChannel& channel) {
+        if (!ctx.server.authSession(req.session)) {
+            channel.send(Response { req.header, Status::eFailure }).throwIfFailed();
             return;
         }
 
-        static constexpr size_t kMaxLobbies = 256;
-        std::unique_ptr<std::byte[]> data = std::make_unique<std::byte[]>(sizeof(LobbyList) + (sizeof(LobbyInfo) * kMaxLobbies));
-        LobbyList *list = reinterpret_cast<LobbyList*>(data.get());
-        auto count = getLobbyList(std::span<LobbyInfo>(list->lobbies, kMaxLobbies));
-        uint16_t size = sizeof(LobbyList) + (sizeof(LobbyInfo) * count);
-
-        list->response = Response { req.header, Status::eSuccess, size };
+        std::vector<LobbyInfo> lobbies(kMaxListEntries);
+        lobbies.resize(ctx.server.getLobbyList(lobbies));
 
-        net::throwIfFailed(socket.sendBytes(data.get(), size));
+        channel.sendList<LobbyList, LobbyInfo>(req.header, Status::eSuccess, lobbies).throwIfFailed();
     });
 
-    router.addRoute<SendMessage>(PacketType::ePostMessage, [&](const SendMessage& req) {
-        if (!authSession(req.author)) {
+    mRouter.addRoute<SendMessage>(PacketType::ePostMessage, [](ClientContext& ctx, const SendMessage& req) {
+        if (!ctx.server.authSession(req.author)) {
             return Response { req.header, Status::eFailure };
         }
 
         LOG_INFO(GlobalLog, "received message: {}", req.message.text());
 
-        broadcastMessage(req);
+        ctx.server.broadcastMessage(req);
 
         return Response { req.header, Status::eSuccess };
     });
+}
+
+void AccountServer::handleClient(const std::stop_token& stop, net::Socket socket) noexcept try {
+    ClientContext ctx { *this };
+
+    defer { dropSession(ctx.session); };
+
+    socket.setBlocking(false);
+    socket.setRecvTimeout(250ms);
+    socket.setSendTimeout(250ms);
+
+    PacketChannel channel{socket};
 
     SocketMux mux;
 
     while (!stop.stop_requested()) {
-        mux.work(socket, 100ms);
+        mux.work(channel, 100ms);
 
         if (AnyPacket packet = mux.pop(kClientStream)) {
-            if (!router.handleMessage(packet, socket)) {
+            if (!mRouter.handleMessage(ctx, packet, channel)) {
                 LOG_INFO(GlobalLog, "dropping client connection");
                 return;
             }
         }
 
-        if (session != UINT64_MAX) {
-            std::lock_guard guard(mDbMutex);
-            auto& messages = mOpenClients[session];
-            for (auto& message : messages) {
-                message.header.stream = kMessageStream;
-                if (net::NetError error = socket.send(message); error) {
+        if (ctx.feed.has_value()) {
+            FeedEntryPtr batch[kMessageBatchSize];
+            uint64_t dropped = ctx.feed->getDroppedCount();
+
+            // drain everything published since the last pass, otherwise
+            // delivery is capped at one batch per mux wait
+            while (size_t count = ctx.feed->poll(batch)) {
+                if (net::NetError error = sendMessageBatch(channel, std::span(batch, count)); error) {
                     LOG_WARN(GlobalLog, "failed to send message: {}", error);
                     return;
                 }
             }
 
-            messages.clear();
+            if (ctx.feed->getDroppedCount() != dropped) {
+                LOG_WARN(GlobalLog, "session {} fell behind, dropped {} messages", ctx.session, ctx.feed->getDroppedCount() - dropped);
+            }
         }
 
         mux.pop(kEventStream); // server doesnt handle events, just keep the queue empty
@@ -361,41 +373,93 @@ static void createSchema(db::Connection& db) {
 }
 
 AccountServer::AccountServer(db::Connection db, net::Network& net, const net::Address& address, uint16_t port) noexcept(false)
-    : AccountServer(std::move(db), net, address, port, std::random_device{}())
+    : AccountServer(std::move(db), net, address, port, std::nullopt)
+{ }
+
+AccountServer::AccountServer(db::Connection db, net::Network& net, const net::Address& address, uint16_t port, std::optional<unsigned> seed) noexcept(false)
+    : AccountServer(std::move(db), net, address, port, seed, 1)
 { }
 
-AccountServer::AccountServer(db::Connection db, net::Network& net, const net::Address& address, uint16_t port, unsigned seed) noexcept(false)
+static net::ListenSocket bindListener(net::Network& net, const net::Address& address, uint16_t port, unsigned listeners) noexcept(false) {
+    return (listeners > 1) ? net.bindReusePort(address, port) : net.bind(address, port);
+}
+
+AccountServer::AccountServer(db::Connection db, net::Network& net, const net::Address& address, uint16_t port, std::optional<unsigned> seed, unsigned listeners) noexcept(false)
     : mAccountDb(std::move(db))
     , mNetwork(net)
-    , mSocket(mNetwork.bind(address, port))
-    , mSalt(seed)
+    , mSocket(bindListener(mNetwork, address, port, listeners))
+    , mSalt(seed ? Salt(*seed) : Salt())
 {
+    // the shards have to bind to the port the first listener was given
+    // in case we were asked for any free port
+    uint16_t boundPort = mSocket.getBoundPort();
+    for (unsigned i = 1; i < listeners; i++) {
+        mShards.emplace_back(mNetwork.bindReusePort(address, boundPort));
+    }
+
     createSchema(mAccountDb);
+    buildRouter();
 }
 
-void AccountServer::begin(uint16_t connections) {
-    mSocket.listen(connections).throwIfFailed();
+void AccountServer::begin(int backlog) {
+    mSocket.listen(backlog).throwIfFailed();
+
+    for (net::ListenSocket& shard : mShards) {
+        shard.listen(backlog).throwIfFailed();
+    }
 }
 
-void AccountServer::work() {
+void AccountServer::acceptClients(net::ListenSocket& listener) {
     std::unordered_set<std::unique_ptr<std::jthread>> threads;
-    while (mSocket.isActive()) {
-        net::NetResult<net::Socket> client = mSocket.tryAccept();
-        if (isCancelled(client))
-            break;
+    std::vector<net::Socket> clients;
 
-        net::Socket socket = net::throwIfFailed(std::move(client));
+    while (listener.isActive()) {
+        if (net::NetError error = listener.acceptBatch(clients, 100ms)) {
+            if (error.cancelled())
+                break;
 
-        threads.emplace(
-            std::make_unique<std::jthread>([&, socket = std::move(socket)](const std::stop_token& stop) mutable {
-                handleClient(stop, std::move(socket));
-            })
-        );
+            throw net::NetException{error};
+        }
+
+        for (net::Socket& socket : clients) {
+            threads.emplace(
+                std::make_unique<std::jthread>([&, socket = std::move(socket)](const std::stop_token& stop) mutable {
+                    handleClient(stop, std::move(socket));
+                })
+            );
+        }
+
+        clients.clear();
     }
 }
 
+void AccountServer::work() {
+    // if the main listener fails the shards have to be stopped
+    // otherwise joining their threads would never finish
+    defer { stop(); };
+
+    std::vector<std::jthread> shards;
+    shards.reserve(mShards.size());
+
+    for (net::ListenSocket& shard : mShards) {
+        shards.emplace_back([this, &shard] {
+            try {
+                acceptClients(shard);
+            } catch (const net::NetException& e) {
+                LOG_ERROR(GlobalLog, "listener shard failed: {}", e);
+            }
+        });
+    }
+
+    acceptClients(mSocket);
+}
+
 void AccountServer::stop() {
     mSocket.cancel();
+
+    for (net::ListenSocket& shard : mShards) {
+        shard.cancel();
+    }
 }
 
 bool AccountServer::isRunning() const {
@@ -7,5 +7,6 @@
 #include <mutex>
 #include <span>
 #include <unordered_set>
+#include <optional>
 
 // IWYU pragma: end_exports
@@ -2,6 +2,8 @@
 
 #include "logger/logging.hpp"
 
+#include "core/endian.hpp"
+
 using namespace game;
 using namespace sm;
 
@@ -22,7 +24,7 @@ AnyPacket game::readSinglePacket(sm::net::Socket& socket) {
 
     memcpy(data.get(), &header, sizeof(PacketHeader));
 
-    return AnyPacket { std::move(data) };
+    return AnyPacket { std::move(data), header.size };
 }
 
 AnyPacket game::readSinglePacket(sm::net::Socket& socket, std::chrono::milliseconds timeout) {
@@ -42,9 +44,96 @@ AnyPacket game::readSinglePacket(sm::net::Socket& socket, std::chrono::milliseco
 
     memcpy(data.get(), &header, sizeof(PacketHeader));
 
-    return AnyPacket { std::move(data) };
+    return AnyPacket { std::move(data), header.size };
+}
+
+///
+/// packet channel
+///
+
+net::NetError PacketChannel::sendBuffer(const void *data, size_t size) noexcept {
+    size_t sent = TRY_UNWRAP(mSocket.sendBytes(data, size));
+    if (sent != size)
+        return net::NetError(SNET_END_OF_PACKET, "expected {} bytes, sent {}", size, sent);
+
+    return net::NetError::ok();
 }
 
+AnyPacket PacketChannel::readFrame(std::chrono::milliseconds timeout) {
+    net::NetResult<sm::le<uint16_t>> maybeLength = mSocket.recvTimed<sm::le<uint16_t>>(timeout);
+    if (!maybeLength.has_value()) {
+        return AnyPacket { };
+    }
+
+    uint16_t length = maybeLength.value();
+
+    std::vector<std::byte> frame(length);
+    auto [size, err] = mSocket.recvBytesTimeout(frame.data(), length, timeout);
+    if (size != length) {
+        throw net::NetException{err, "Torn read recovery unimplemented, discard the connection. {} of {} bytes read.", size, length};
+    }
+
+    WireReader reader{frame};
+    FrameHeader header;
+    if (!decodeFrameHeader(reader, header)) {
+        throw net::NetException{SNET_END_OF_PACKET, "Malformed frame header"};
+    }
+
+    std::span<const std::byte> body = reader.remaining();
+
+    // early parts of a list are only buffered, the last part completes it
+    // both sides read through here, so the limits stop a peer from making
+    // the other buffer without bound by never finishing its lists
+    auto it = mPartialFrames.find(header.id);
+    if (header.hasMoreParts() || it != mPartialFrames.end()) {
+        if (it == mPartialFrames.end() && mPartialFrames.size() >= kMaxPartialFrames) {
+            throw net::NetException{SNET_END_OF_PACKET, "More than {} multi part frames open at once", kMaxPartialFrames};
+        }
+
+        if (mPartialSize + body.size() > kMaxPartialSize) {
+            throw net::NetException{SNET_END_OF_PACKET, "Multi part frames exceed {} bytes in total", kMaxPartialSize};
+        }
+
+        std::vector<std::byte>& parts = mPartialFrames[header.id];
+        if (parts.size() + body.size() > kMaxReassembledSize) {
+            throw net::NetException{SNET_END_OF_PACKET, "Multi part response {} exceeds {} bytes", header.id, kMaxReassembledSize};
+        }
+
+        parts.insert(parts.end(), body.begin(), body.end());
+        mPartialSize += body.size();
+
+        if (header.hasMoreParts())
+            return AnyPacket { };
+
+        std::vector<std::byte> whole = std::move(parts);
+        mPartialFrames.erase(header.id);
+        mPartialSize -= whole.size();
+
+        AnyPacket packet = decodeFrameBody(header, whole);
+        if (!packet)
+            throw net::NetException{SNET_END_OF_PACKET, "Malformed multi part frame {}", header.id};
+
+        return packet;
+    }
+
+    AnyPacket packet = decodeFrameBody(header, body);
+    if (!packet)
+        throw net::NetException{SNET_END_OF_PACKET, "Malformed frame {}", header.id};
+
+    return packet;
+}
+
+AnyPacket PacketChannel::read(std::chrono::milliseconds timeout) {
+    if (mVersion == WireVersion::eFixed)
+        return readSinglePacket(mSocket, timeout);
+
+    return readFrame(timeout);
+}
+
+///
+/// socket mux
+///
+
 SocketPartition& SocketMux::getPartition(uint8_t id) {
     return mStreams[id & kMaxStreams];
 }
@@ -60,8 +149,18 @@ AnyPacket SocketMux::pop(uint8_t stream) {
     return buffer;
 }
 
+void SocketMux::push(AnyPacket packet) {
+    getPartition(packet.stream()).input.push(std::move(packet));
+}
+
 void SocketMux::work(sm::net::Socket& socket, std::chrono::milliseconds timeout) {
     if (AnyPacket packet = readSinglePacket(socket, timeout)) {
-        getPartition(packet.stream()).input.push(std::move(packet));
+        push(std::move(packet));
+    }
+}
+
+void SocketMux::work(PacketChannel& channel, std::chrono::milliseconds timeout) {
+    if (AnyPacket packet = channel.read(timeout)) {
+        push(std::move(packet));
     }
 }
@@ -0,0 +1,191 @@
+#include "stdafx.hpp"
+
+#include "account/wire.hpp"
+#include "account/stream.hpp"
+
+#include "core/endian.hpp"
+#include "core/error.hpp"
+
+using namespace game;
+
+///
+/// writer
+///
+
+void WireWriter::writeByte(uint8_t value) {
+    mBuffer.push_back(std::byte{value});
+}
+
+void WireWriter::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        writeByte(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+
+    writeByte(static_cast<uint8_t>(value));
+}
+
+void WireWriter::writeString(std::string_view value) {
+    writeVarint(value.size());
+
+    const std::byte *data = reinterpret_cast<const std::byte*>(value.data());
+    mBuffer.insert(mBuffer.end(), data, data + value.size());
+}
+
+///
+/// reader
+///
+
+uint8_t WireReader::readByte() noexcept {
+    if (mOffset >= mData.size()) {
+        fail();
+        return 0;
+    }
+
+    return std::to_integer<uint8_t>(mData[mOffset++]);
+}
+
+uint64_t WireReader::readVarint() noexcept {
+    uint64_t result = 0;
+
+    // a uint64_t fits in at most 10 groups of 7 bits
+    for (int shift = 0; shift < 70; shift += 7) {
+        uint8_t byte = readByte();
+        result |= uint64_t(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80))
+            return result;
+    }
+
+    fail();
+    return 0;
+}
+
+std::string_view WireReader::readString() noexcept {
+    uint64_t length = readVarint();
+    if (length > mData.size() - std::min(mOffset, mData.size())) {
+        fail();
+        return "";
+    }
+
+    const char *data = reinterpret_cast<const char*>(mData.data() + mOffset);
+    mOffset += length;
+    return { data, length };
+}
+
+///
+/// frames
+///
+
+size_t game::beginFrame(WireWriter& writer, uint8_t flags, WireType type, uint16_t id) {
+    size_t frame = writer.size();
+
+    // length is patched in by endFrame
+    writer.writeByte(0);
+    writer.writeByte(0);
+
+    writer.writeByte(flags);
+    writer.writeVarint(std::to_underlying(type));
+    writer.writeVarint(id);
+
+    return frame;
+}
+
+void game::endFrame(WireWriter& writer, size_t frame) {
+    size_t length = writer.size() - frame - kFrameLengthSize;
+    CTASSERTF(length <= kMaxFrameSize, "frame too large: %zu > %zu", length, kMaxFrameSize);
+
+    sm::le<uint16_t> size = static_cast<uint16_t>(length);
+    std::memcpy(writer.buffer().data() + frame, &size, sizeof(size));
+}
+
+bool game::decodeFrameHeader(WireReader& reader, FrameHeader& header) noexcept {
+    header.flags = reader.readByte();
+
+    uint64_t type = reader.readVarint();
+    if (type == 0 || type >= std::to_underlying(WireType::eCount))
+        reader.fail();
+
+    header.type = static_cast<WireType>(type);
+
+    uint64_t id = reader.readVarint();
+    if (id > UINT16_MAX)
+        reader.fail();
+
+    header.id = static_cast<uint16_t>(id);
+
+    return reader.isValid();
+}
+
+template<WirePacket T>
+static AnyPacket decodeFixed(WireReader& reader, const FrameHeader& header, PacketType type) {
+    T packet{};
+    detail::decodeValue(reader, packet);
+
+    // trailing bytes mean the peer disagrees with us about the layout
+    if (!reader.isValid() || !reader.isEmpty())
+        return AnyPacket { };
+
+    detail::headerOf(packet) = PacketHeader { type, sizeof(T), header.id, header.stream() };
+
+    auto data = std::make_unique<std::byte[]>(sizeof(T));
+    std::memcpy(data.get(), &packet, sizeof(T));
+
+    return AnyPacket { std::move(data), sizeof(T) };
+}
+
+template<WirePacket L, WireStruct E>
+static AnyPacket decodeList(WireReader& reader, const FrameHeader& header) {
+    Response response{};
+    detail::decodeValue(reader, response);
+
+    std::vector<E> entries;
+    while (reader.isValid() && !reader.isEmpty()) {
+        E entry{};
+        detail::decodeValue(reader, entry);
+        entries.push_back(entry);
+    }
+
+    if (!reader.isValid())
+        return AnyPacket { };
+
+    size_t size = sizeof(L) + (sizeof(E) * entries.size());
+
+    // the fixed header cant describe lists this large, AnyPacket::size is authoritative
+    uint16_t headerSize = static_cast<uint16_t>(std::min<size_t>(size, UINT16_MAX));
+    response.header = PacketHeader { PacketType::eResponse, headerSize, header.id, header.stream() };
+
+    auto data = std::make_unique<std::byte[]>(size);
+    std::memcpy(data.get(), &response, sizeof(Response));
+    std::memcpy(data.get() + sizeof(L), entries.data(), sizeof(E) * entries.size());
+
+    return AnyPacket { std::move(data), size };
+}
+
+AnyPacket game::decodeFrameBody(const FrameHeader& header, std::span<const std::byte> body) {
+    WireReader reader{body};
+
+    switch (header.type) {
+    case WireType::eAck: return decodeFixed<Ack>(reader, header, PacketType::eAck);
+    case WireType::eCreateAccount: return decodeFixed<CreateAccount>(reader, header, PacketType::eCreateAccount);
+    case WireType::eLogin: return decodeFixed<Login>(reader, header, PacketType::eLogin);
+    case WireType::ePostMessage: return decodeFixed<SendMessage>(reader, header, PacketType::ePostMessage);
+    case WireType::eGetSessionList: return decodeFixed<GetSessionList>(reader, header, PacketType::eGetSessionList);
+    case WireType::eGetLobbyList: return decodeFixed<GetLobbyList>(reader, header, PacketType::eGetLobbyList);
+    case WireType::eCreateLobby: return decodeFixed<CreateLobby>(reader, header, PacketType::eCreateLobby);
+    case WireType::eJoinLobby: return decodeFixed<JoinLobby>(reader, header, PacketType::eJoinLobby);
+    case WireType::eLeaveLobby: return decodeFixed<LeaveLobby>(reader, header, PacketType::eLeaveLobby);
+    case WireType::eStartGame: return decodeFixed<StartGame>(reader, header, PacketType::eStartGame);
+    case WireType::eHello: return decodeFixed<Hello>(reader, header, PacketType::eHello);
+
+    case WireType::eResponse: return decodeFixed<Response>(reader, header, PacketType::eResponse);
+    case WireType::eNewSession: return decodeFixed<NewSession>(reader, header, PacketType::eResponse);
+    case WireType::eNewLobby: return decodeFixed<NewLobby>(reader, header, PacketType::eResponse);
+    case WireType::eWelcome: return decodeFixed<Welcome>(reader, header, PacketType::eResponse);
+
+    case WireType::eSessionList: return decodeList<SessionList, SessionInfo>(reader, header);
+    case WireType::eLobbyList: return decodeList<LobbyList, LobbyInfo>(reader, header);
+
+    default: return AnyPacket { };
+    }
+}
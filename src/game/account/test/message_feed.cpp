@@ -0,0 +1,122 @@
+#include "account_test_common.hpp"
+
+#include "account/feed.hpp"
+
+using namespace game;
+
+static SendMessage newMessage(SessionId author, uint64_t timestamp) {
+    return SendMessage { 0, kMessageStream, author, timestamp, "hello" };
+}
+
+TEST_CASE("Message feed delivery") {
+    MessageFeed feed{16};
+
+    FeedCursor first = feed.subscribe(1);
+    FeedCursor second = feed.subscribe(2);
+
+    feed.publish(newMessage(1, 0));
+    feed.publish(newMessage(2, 1));
+    feed.publish(newMessage(3, 2));
+
+    FeedEntryPtr batch[8];
+
+    SECTION("Own messages are skipped") {
+        size_t count = first.poll(batch);
+        REQUIRE(count == 2);
+        CHECK(batch[0]->message.timestamp == 1);
+        CHECK(batch[1]->message.timestamp == 2);
+
+        CHECK(first.poll(batch) == 0);
+    }
+
+    SECTION("Subscribers share entries") {
+        FeedEntryPtr other[8];
+        REQUIRE(first.poll(batch) == 2);
+        REQUIRE(second.poll(other) == 2);
+
+        CHECK(batch[1].get() == other[1].get());
+    }
+
+    SECTION("Late subscribers only see new messages") {
+        FeedCursor late = feed.subscribe(4);
+        CHECK(late.poll(batch) == 0);
+
+        feed.publish(newMessage(1, 3));
+        REQUIRE(late.poll(batch) == 1);
+        CHECK(batch[0]->message.timestamp == 3);
+    }
+}
+
+TEST_CASE("Message feed overrun") {
+    MessageFeed feed{8};
+    FeedCursor cursor = feed.subscribe(0);
+
+    for (uint64_t i = 0; i < 20; i++) {
+        feed.publish(newMessage(1, i));
+    }
+
+    FeedEntryPtr batch[32];
+    size_t count = cursor.poll(batch);
+
+    CHECK(count == feed.getCapacity());
+    CHECK(cursor.getDroppedCount() == 20 - feed.getCapacity());
+    CHECK(batch[0]->message.timestamp == 20 - feed.getCapacity());
+}
+
+TEST_CASE("Message feed concurrent publishers") {
+    static constexpr size_t kPublishers = 4;
+    static constexpr size_t kMessages = 256;
+
+    MessageFeed feed{kPublishers * kMessages};
+    FeedCursor cursor = feed.subscribe(0);
+
+    doParallel(kPublishers, [&](int i, auto stop) {
+        for (size_t j = 0; j < kMessages; j++) {
+            feed.publish(newMessage(i + 1, j));
+        }
+    });
+
+    std::vector<size_t> counts(kPublishers);
+    FeedEntryPtr batch[64];
+    while (size_t count = cursor.poll(batch)) {
+        for (size_t i = 0; i < count; i++) {
+            counts[batch[i]->message.author - 1] += 1;
+        }
+    }
+
+    CHECK(cursor.getDroppedCount() == 0);
+    for (size_t count : counts) {
+        CHECK(count == kMessages);
+    }
+}
+
+TEST_CASE("Message feed concurrent publishers wrapping the ring") {
+    static constexpr size_t kPublishers = 8;
+    static constexpr size_t kMessages = 4096;
+
+    // far more messages than slots, so publishers constantly race for each slot
+    MessageFeed feed{8};
+    FeedCursor cursor = feed.subscribe(0);
+
+    doParallel(kPublishers, [&](int i, auto stop) {
+        for (size_t j = 0; j < kMessages; j++) {
+            feed.publish(newMessage(i + 1, j));
+        }
+    });
+
+    uint64_t head = feed.getHead();
+    REQUIRE(head == kPublishers * kMessages);
+
+    // every slot holds the newest sequence that maps to it, a stalled
+    // publisher storing an older one would cut the read short
+    FeedEntryPtr batch[32];
+    size_t count = cursor.poll(batch);
+
+    REQUIRE(count == feed.getCapacity());
+    for (size_t i = 0; i < count; i++) {
+        CHECK(batch[i]->sequence == head - feed.getCapacity() + i);
+    }
+
+    CHECK(cursor.getDroppedCount() == head - feed.getCapacity());
+    CHECK(cursor.poll(batch) == 0);
+}
@@ -0,0 +1,100 @@
+#include "account_test_common.hpp"
+
+#include "account/account.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+using namespace sm;
+
+using namespace std::chrono_literals;
+
+static constexpr net::Address kAddress = net::Address::loopback();
+
+static constexpr size_t kRequestCount = 64;
+
+/// shared with the callbacks so a timed out wait never leaves them writing to a dead stack frame
+struct CallbackProgress {
+    std::mutex mutex;
+    std::condition_variable ready;
+    size_t completed = 0;
+    size_t responses = 0;
+};
+
+TEST_CASE("Pipelined requests") {
+    if (!net::isSetup())
+        net::create();
+
+    TestServerConfig test{"account/pipelined_requests"};
+
+    {
+        NetTestStream errors;
+
+        // setup account server
+        game::AccountServer server = test.server(kAddress, 0, 1234);
+        uint16_t port = server.getPort();
+
+        auto serverThread = test.run(server, errors, kClientCount);
+
+        game::AccountClient client { test.network, kAddress, port };
+
+        errors.expect(client.createAccount("pipeline", "password"), "failed to create pipeline");
+        errors.expect(client.login("pipeline", "password"), "failed to login to pipeline");
+        errors.expect(client.createLobby("lobby0"), "failed to create lobby0");
+
+        client.begin();
+
+        SECTION("Futures") {
+            std::vector<std::future<game::AnyPacket>> futures;
+
+            // put all requests on the wire before waiting on any of them
+            for (size_t i = 0; i < kRequestCount; i++) {
+                futures.push_back(client.sendRequest(game::GetLobbyList { 0, game::kClientStream, UINT64_MAX }));
+            }
+
+            for (auto& future : futures) {
+                errors.expect(future.wait_for(5s) == std::future_status::ready, "request timed out");
+            }
+        }
+
+        SECTION("Callbacks") {
+            auto progress = std::make_shared<CallbackProgress>();
+            std::set<uint16_t> ids;
+
+            for (size_t i = 0; i < kRequestCount; i++) {
+                uint16_t id = client.sendRequest(game::GetLobbyList { 0, game::kClientStream, UINT64_MAX }, [progress](game::AnyPacket& response) {
+                    std::lock_guard guard(progress->mutex);
+                    if (response) {
+                        progress->responses += 1;
+                    }
+
+                    progress->completed += 1;
+                    progress->ready.notify_one();
+                });
+
+                errors.expect(ids.insert(id).second, "request {} reused in flight id {}", i, id);
+            }
+
+            std::unique_lock lock(progress->mutex);
+            bool finished = progress->ready.wait_for(lock, 5s, [&] { return progress->completed == kRequestCount; });
+
+            errors.expect(finished, "only {} of {} requests completed in time", progress->completed, kRequestCount);
+            errors.expect(progress->responses == kRequestCount, "expected {} responses, got {}", kRequestCount, progress->responses);
+            lock.unlock();
+
+            errors.expect(client.getPendingRequestCount() == 0, "{} requests still pending", client.getPendingRequestCount());
+        }
+
+        SECTION("Mixed with blocking calls") {
+            std::future<game::AnyPacket> pending = client.sendRequest(game::GetSessionList { 0, game::kClientStream, UINT64_MAX });
+
+            errors.expect(client.refreshLobbyList(), "failed to refresh lobby list");
+            errors.expect(client.getLobbyInfo().size() == 1, "Expected 1 lobby, got {}", client.getLobbyInfo().size());
+
+            errors.expect(pending.wait_for(5s) == std::future_status::ready, "request timed out");
+        }
+
+        client.stop();
+    }
+}
@@ -0,0 +1,68 @@
+#include "account_test_common.hpp"
+
+#include "account/account.hpp"
+
+#include <numeric>
+
+using namespace sm;
+
+static constexpr net::Address kAddress = net::Address::loopback();
+
+static const game::RouteSnapshot *findRoute(std::span<const game::RouteSnapshot> routes, game::PacketType type) {
+    for (const game::RouteSnapshot& route : routes) {
+        if (route.type == type)
+            return &route;
+    }
+
+    return nullptr;
+}
+
+TEST_CASE("Account server route stats") {
+    net::create();
+
+    TestServerConfig test{"account/route_stats"};
+
+    NetTestStream errors;
+
+    game::AccountServer server = test.server(kAddress, 0, 1234);
+    uint16_t port = server.getPort();
+
+    {
+        auto serverThread = test.run(server, errors, kClientCount);
+
+        createTestAccounts(test.network, kAddress, port, errors, kClientCount);
+
+        doParallel(kClientCount, [&](int i, auto stop) {
+            game::AccountClient client { test.network, kAddress, port };
+            std::string name = newClientName(i);
+
+            errors.expect(client.login(name, "password"), "Failed to login {}", name);
+        });
+
+        // stopping the server joins every client thread, so all handlers have been timed
+        serverThread.request_stop();
+    }
+
+    std::vector<game::RouteSnapshot> routes = server.getRouteStats();
+
+    const game::RouteSnapshot *login = findRoute(routes, game::PacketType::eLogin);
+    REQUIRE(login != nullptr);
+    CHECK(login->calls == kClientCount);
+    CHECK(login->bytes == kClientCount * sizeof(game::Login));
+
+    uint64_t samples = std::accumulate(login->latency.begin(), login->latency.end(), uint64_t(0));
+    CHECK(samples == login->calls);
+    CHECK(login->getPercentile(0.5) <= login->getPercentile(0.99));
+    CHECK(login->getPercentile(0.99) > std::chrono::nanoseconds::zero());
+
+    const game::RouteSnapshot *create = findRoute(routes, game::PacketType::eCreateAccount);
+    REQUIRE(create != nullptr);
+    CHECK(create->calls == kClientCount);
+
+    // registered but never called routes are still reported
+    const game::RouteSnapshot *lobby = findRoute(routes, game::PacketType::eCreateLobby);
+    REQUIRE(lobby != nullptr);
+    CHECK(lobby->calls == 0);
+
+    CHECK(server.getUnroutedCount() == 0);
+}
@@ -3,6 +3,7 @@
 #include "account/salt.hpp"
 
 #include <fstream>
+#include <random>
 
 TEST_CASE("Password salting") {
     std::mt19937 rng{9999};
@@ -0,0 +1,229 @@
+#include "account_test_common.hpp"
+
+#include "account/stream.hpp"
+#include "account/wire.hpp"
+
+using namespace game;
+
+using namespace std::chrono_literals;
+
+template<WirePacket T>
+static AnyPacket roundTrip(const T& packet) {
+    std::vector<std::byte> buffer;
+    WireWriter writer{buffer};
+    encodeFrame(writer, packet);
+
+    REQUIRE(buffer.size() > kFrameLengthSize);
+
+    WireReader reader{std::span(buffer).subspan(kFrameLengthSize)};
+    FrameHeader header;
+    REQUIRE(decodeFrameHeader(reader, header));
+    CHECK_FALSE(header.hasMoreParts());
+
+    return decodeFrameBody(header, reader.remaining());
+}
+
+TEST_CASE("Varint encoding") {
+    std::vector<std::byte> buffer;
+    WireWriter writer{buffer};
+
+    const uint64_t values[] = { 0, 1, 127, 128, 300, UINT16_MAX, UINT32_MAX, UINT64_MAX };
+    for (uint64_t value : values) {
+        writer.writeVarint(value);
+    }
+
+    CHECK(buffer.size() == 1 + 1 + 1 + 2 + 2 + 3 + 5 + 10);
+
+    WireReader reader{buffer};
+    for (uint64_t value : values) {
+        CHECK(reader.readVarint() == value);
+    }
+
+    CHECK(reader.isValid());
+    CHECK(reader.isEmpty());
+
+    reader.readVarint();
+    CHECK_FALSE(reader.isValid());
+}
+
+TEST_CASE("Compact packet round trip") {
+    SECTION("Requests") {
+        AnyPacket packet = roundTrip(CreateAccount { 42, kClientStream, "name", "password" });
+        REQUIRE(packet);
+
+        const CreateAccount& result = *std::bit_cast<CreateAccount*>(packet.data());
+        CHECK(result.header.type == PacketType::eCreateAccount);
+        CHECK(result.header.id == 42);
+        CHECK(result.header.size == sizeof(CreateAccount));
+        CHECK(result.getUsername() == "name");
+        CHECK(result.getPassword() == "password");
+    }
+
+    SECTION("Messages") {
+        SendMessage message { 7, kMessageStream, 1234, 5678, "hello world" };
+        AnyPacket packet = roundTrip(message);
+        REQUIRE(packet);
+
+        const SendMessage& result = *std::bit_cast<SendMessage*>(packet.data());
+        CHECK(result.header.stream == kMessageStream);
+        CHECK(result.author == 1234);
+        CHECK(result.timestamp == 5678);
+        CHECK(result.message.text() == "hello world");
+    }
+
+    SECTION("Responses") {
+        PacketHeader instigator { PacketType::eLogin, sizeof(Login), 9, kClientStream };
+        AnyPacket packet = roundTrip(NewSession { instigator, 99 });
+        REQUIRE(packet);
+
+        const NewSession& result = *std::bit_cast<NewSession*>(packet.data());
+        CHECK(result.response.header.type == PacketType::eResponse);
+        CHECK(result.response.header.id == 9);
+        CHECK(result.response.status == Status::eSuccess);
+        CHECK(result.session == 99);
+    }
+}
+
+TEST_CASE("Malformed frames are rejected") {
+    std::vector<std::byte> buffer;
+    WireWriter writer{buffer};
+    encodeFrame(writer, Login { 1, kClientStream, "name", "password" });
+
+    WireReader reader{std::span(buffer).subspan(kFrameLengthSize)};
+    FrameHeader header;
+    REQUIRE(decodeFrameHeader(reader, header));
+
+    std::span<const std::byte> body = reader.remaining();
+
+    CHECK_FALSE(decodeFrameBody(header, body.first(body.size() - 1)));
+
+    // a string longer than the field it decodes into
+    std::vector<std::byte> oversized;
+    WireWriter bad{oversized};
+    bad.writeString(std::string(64, 'a'));
+    bad.writeString("password");
+    CHECK_FALSE(decodeFrameBody(header, oversized));
+}
+
+TEST_CASE("Large lists are split into parts") {
+    static constexpr size_t kSessionCount = 8192;
+
+    std::vector<SessionInfo> sessions(kSessionCount);
+    for (size_t i = 0; i < kSessionCount; i++) {
+        sessions[i] = SessionInfo { .id = i, .name = std::string_view{fmt::format("session{:05}", i)} };
+    }
+
+    PacketHeader instigator { PacketType::eGetSessionList, sizeof(GetSessionList), 3, kClientStream };
+
+    std::vector<std::byte> buffer;
+    WireWriter writer{buffer};
+    encodeListFrames<SessionList, SessionInfo>(writer, instigator, Status::eSuccess, sessions);
+
+    // reassemble the same way PacketChannel does
+    std::vector<std::byte> whole;
+    FrameHeader last;
+    size_t parts = 0;
+    std::span<const std::byte> data = buffer;
+    while (!data.empty()) {
+        uint16_t length = uint16_t(std::to_integer<uint16_t>(data[0]) | (std::to_integer<uint16_t>(data[1]) << 8));
+        REQUIRE(data.size() >= kFrameLengthSize + length);
+
+        WireReader reader{data.subspan(kFrameLengthSize, length)};
+        REQUIRE(decodeFrameHeader(reader, last));
+
+        std::span<const std::byte> body = reader.remaining();
+        whole.insert(whole.end(), body.begin(), body.end());
+
+        data = data.subspan(kFrameLengthSize + length);
+        parts += 1;
+
+        CHECK(last.hasMoreParts() == !data.empty());
+    }
+
+    CHECK(parts > 1);
+
+    AnyPacket packet = decodeFrameBody(last, whole);
+    REQUIRE(packet);
+    REQUIRE(packet.size == sizeof(SessionList) + sizeof(SessionInfo) * kSessionCount);
+
+    const SessionList& list = *std::bit_cast<SessionList*>(packet.data());
+    CHECK(list.response.status == Status::eSuccess);
+    CHECK(list.response.header.id == 3);
+    for (size_t i = 0; i < kSessionCount; i++) {
+        CHECK(list.sessions[i].id == i);
+    }
+}
+
+/// encode @p partsPerId frames for each of @p ids lists starting at @p firstId, none of them finished
+static std::vector<std::byte> encodeOpenFrames(uint16_t firstId, size_t ids, size_t partsPerId, size_t bodySize) {
+    std::vector<std::byte> buffer;
+    WireWriter writer{buffer};
+
+    for (size_t id = 0; id < ids; id++) {
+        for (size_t part = 0; part < partsPerId; part++) {
+            size_t frame = beginFrame(writer, kFrameMoreParts | kClientStream, WireType::eSessionList, uint16_t(firstId + id));
+            for (size_t i = 0; i < bodySize; i++)
+                writer.writeByte(uint8_t(i));
+
+            endFrame(writer, frame);
+        }
+    }
+
+    return buffer;
+}
+
+/// read until the channel gives up on the peer, or @p limit reads pass without it doing so
+static bool readUntilDropped(PacketChannel& channel, size_t limit) {
+    try {
+        for (size_t i = 0; i < limit; i++) {
+            if (channel.read(1s))
+                return false;
+        }
+    } catch (const net::NetException&) {
+        return true;
+    }
+
+    return false;
+}
+
+TEST_CASE("Open multi part frames are bounded") {
+    net::create();
+
+    net::Network network = net::Network::create();
+    net::ListenSocket listener = network.bind(net::Address::loopback(), 0);
+    REQUIRE(listener.listen(1).isSuccess());
+
+    net::Socket client = network.connect(net::Address::loopback(), listener.getBoundPort());
+    net::Socket server = listener.accept();
+
+    // a stalled reader should not hold up the sender forever
+    client.setSendTimeout(1s).throwIfFailed();
+
+    PacketChannel channel{server};
+    channel.setVersion(WireVersion::eCompact);
+
+    SECTION("too many open lists") {
+        std::vector<std::byte> frames = encodeOpenFrames(1, PacketChannel::kMaxPartialFrames + 1, 1, 16);
+        REQUIRE(client.sendBytes(frames.data(), frames.size()).value() == frames.size());
+
+        // every open list is buffered until one too many arrives
+        CHECK(readUntilDropped(channel, PacketChannel::kMaxPartialFrames + 1));
+    }
+
+    SECTION("too much buffered across lists") {
+        // each list stays under the per list limit, together they go over the total
+        static constexpr size_t kBodySize = 60'000;
+        static constexpr size_t kPartsPerId = PacketChannel::kMaxReassembledSize / kBodySize - 1;
+        static constexpr size_t kIds = PacketChannel::kMaxPartialSize / (kPartsPerId * kBodySize) + 1;
+        static_assert(kIds <= PacketChannel::kMaxPartialFrames);
+
+        std::vector<std::byte> frames = encodeOpenFrames(1, kIds, kPartsPerId, kBodySize);
+
+        std::jthread sender([&] {
+            // fails once the reader drops the connection
+            (void)client.sendBytes(frames.data(), frames.size());
+        });
+
+        CHECK(readUntilDropped(channel, kIds * kPartsPerId));
+    }
+}
@@ -0,0 +1,212 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "orarpc/orarpc.hpp"
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+
+using namespace sm::rpc;
+
+namespace fs = std::filesystem;
+
+// run from the source root, see the benchmark workdir in meson.build
+static const fs::path kCaptureRoot = "src/server/docs/packets";
+
+// common fragment sizes for udp and tcp transports
+static constexpr size_t kClFragmentSize = 1464;
+static constexpr size_t kCbFragmentSize = 4280 - sizeof(CbPacketHeader) - sizeof(CbRequestHeader);
+
+using Buffer = std::vector<uint8_t>;
+
+// captures are hex dumps, `offset  xx xx xx ...  ascii`
+static Buffer loadCapture(const fs::path& path) {
+    Buffer result;
+    std::ifstream file(path);
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string_view text = line;
+        size_t start = text.find_first_of(' ');
+        if (start == std::string_view::npos)
+            continue;
+
+        text.remove_prefix(start);
+        for (int i = 0; i < 16; i++) {
+            text.remove_prefix(std::min(text.find_first_not_of(' '), text.size()));
+
+            uint8_t byte = 0;
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + std::min<size_t>(text.size(), 2), byte, 16);
+            if (ec != std::errc() || ptr != text.data() + 2)
+                break;
+
+            result.push_back(byte);
+            text.remove_prefix(2);
+        }
+    }
+
+    return result;
+}
+
+static std::vector<Buffer> loadCaptures() {
+    std::vector<Buffer> result;
+    for (const auto& entry : fs::directory_iterator(kCaptureRoot)) {
+        if (entry.path().extension() == ".txt")
+            result.push_back(loadCapture(entry.path()));
+    }
+
+    return result;
+}
+
+template<typename T>
+static void store(uint8_t *dst, T value, std::endian order) {
+    if (order != std::endian::native)
+        value = std::byteswap(value);
+
+    std::memcpy(dst, &value, sizeof(T));
+}
+
+static uint8_t getDrep(std::endian order) {
+    return (order == std::endian::little) ? 0x10 : 0x00;
+}
+
+/// @brief split each capture into connectionless fragments, one datagram per fragment
+static std::vector<Buffer> buildClDatagrams(const std::vector<Buffer>& captures, std::endian order) {
+    std::vector<Buffer> result;
+
+    uint32_t sequence = 0;
+    for (const Buffer& capture : captures) {
+        size_t count = std::max<size_t>((capture.size() + kClFragmentSize - 1) / kClFragmentSize, 1);
+        for (size_t i = 0; i < count; i++) {
+            size_t offset = i * kClFragmentSize;
+            size_t size = std::min(kClFragmentSize, capture.size() - offset);
+
+            Buffer& datagram = result.emplace_back(sizeof(ClPacketHeader) + size);
+            uint8_t *data = datagram.data();
+
+            uint8_t flags = (count > 1) ? uint8_t(PacketFlags0::eMultiFragment) : 0;
+            if (count > 1 && i == count - 1)
+                flags |= uint8_t(PacketFlags0::eLastFragment);
+
+            data[offsetof(ClPacketHeader, version)] = kClVersion;
+            data[offsetof(ClPacketHeader, flags0)] = flags;
+            data[offsetof(ClPacketHeader, drep)] = getDrep(order);
+            store<uint32_t>(data + offsetof(ClPacketHeader, sequence), sequence, order);
+            store<uint16_t>(data + offsetof(ClPacketHeader, length), uint16_t(size), order);
+            store<uint16_t>(data + offsetof(ClPacketHeader, fragment), uint16_t(i), order);
+
+            std::memcpy(data + sizeof(ClPacketHeader), capture.data() + offset, size);
+        }
+
+        sequence += 1;
+    }
+
+    return result;
+}
+
+/// @brief split each capture into connection based fragments, back to back in one receive buffer
+static Buffer buildCbStream(const std::vector<Buffer>& captures, std::endian order) {
+    Buffer result;
+
+    uint32_t call = 0;
+    for (const Buffer& capture : captures) {
+        size_t count = std::max<size_t>((capture.size() + kCbFragmentSize - 1) / kCbFragmentSize, 1);
+        for (size_t i = 0; i < count; i++) {
+            size_t offset = i * kCbFragmentSize;
+            size_t size = std::min(kCbFragmentSize, capture.size() - offset);
+            size_t length = sizeof(CbPacketHeader) + sizeof(CbRequestHeader) + size;
+
+            size_t start = result.size();
+            result.resize(start + length);
+            uint8_t *data = result.data() + start;
+
+            uint8_t flags = 0;
+            if (i == 0) flags |= uint8_t(CbPacketFlags::eFirstFragment);
+            if (i == count - 1) flags |= uint8_t(CbPacketFlags::eLastFragment);
+
+            data[offsetof(CbPacketHeader, version)] = kCbVersion;
+            data[offsetof(CbPacketHeader, ptype)] = uint8_t(PacketType::eRequest);
+            data[offsetof(CbPacketHeader, flags)] = flags;
+            data[offsetof(CbPacketHeader, drep)] = getDrep(order);
+            store<uint16_t>(data + offsetof(CbPacketHeader, fragLength), uint16_t(length), order);
+            store<uint32_t>(data + offsetof(CbPacketHeader, callId), call, order);
+
+            std::memcpy(data + sizeof(CbPacketHeader) + sizeof(CbRequestHeader), capture.data() + offset, size);
+        }
+
+        call += 1;
+    }
+
+    return result;
+}
+
+static size_t parseClDatagrams(const std::vector<Buffer>& datagrams) {
+    Reassembler reassembler;
+
+    size_t total = 0;
+    for (const Buffer& datagram : datagrams) {
+        ClPacketView packet = parseClPacket(datagram).value();
+        if (auto message = reassembler.add(packet).value())
+            total += message->size();
+    }
+
+    return total;
+}
+
+static size_t parseCbStream(const Buffer& stream) {
+    Reassembler reassembler;
+
+    size_t total = 0;
+    ByteView remaining = stream;
+    while (!remaining.empty()) {
+        CbPacketView packet = parseCbPacket(remaining).value();
+        remaining = remaining.subspan(packet.data().size());
+
+        if (auto message = reassembler.add(packet).value())
+            total += message->size();
+    }
+
+    return total;
+}
+
+TEST_CASE("Parse captured packets") {
+    std::vector<Buffer> captures = loadCaptures();
+    REQUIRE(!captures.empty());
+
+    size_t captureSize = 0;
+    for (const Buffer& capture : captures)
+        captureSize += capture.size();
+
+    REQUIRE(captureSize > 0);
+
+    // the captures are a vendor extension that rarely passes validation,
+    // this measures how quickly they are rejected
+    BENCHMARK("Reject raw captures") {
+        size_t accepted = 0;
+        for (const Buffer& capture : captures) {
+            accepted += parseClPacket(capture).has_value();
+            accepted += parseCbPacket(capture).has_value();
+        }
+
+        return accepted;
+    };
+
+    for (std::endian order : { std::endian::little, std::endian::big }) {
+        const char *name = (order == std::endian::little) ? "little endian" : "big endian";
+
+        std::vector<Buffer> datagrams = buildClDatagrams(captures, order);
+        Buffer stream = buildCbStream(captures, order);
+
+        REQUIRE(parseClDatagrams(datagrams) == captureSize);
+        REQUIRE(parseCbStream(stream) == captureSize);
+
+        BENCHMARK(std::string("Connectionless reassembly ") + name) {
+            return parseClDatagrams(datagrams);
+        };
+
+        BENCHMARK(std::string("Connection based reassembly ") + name) {
+            return parseCbStream(stream);
+        };
+    }
+}
@@ -0,0 +1,110 @@
+#include "orarpc/orarpc.hpp"
+
+#include <fuzztest/fuzztest.h>
+#include <fuzztest/init_fuzztest.h>
+#include <gtest/gtest.h>
+
+using namespace sm::rpc;
+
+static bool isWithin(ByteView inner, ByteView outer) {
+    return inner.empty() || (inner.data() >= outer.data() && inner.data() + inner.size() <= outer.data() + outer.size());
+}
+
+static void clPacketsStayInBounds(const std::vector<uint8_t>& data) {
+    auto packet = parseClPacket(data);
+    if (!packet.has_value())
+        return;
+
+    EXPECT_TRUE(isWithin(packet->body(), data));
+    EXPECT_EQ(packet->body().size(), packet->length());
+}
+
+static void cbPacketsStayInBounds(const std::vector<uint8_t>& data) {
+    auto packet = parseCbPacket(data);
+    if (!packet.has_value())
+        return;
+
+    EXPECT_TRUE(isWithin(packet->data(), data));
+    EXPECT_TRUE(isWithin(packet->body(), packet->data()));
+    EXPECT_EQ(packet->data().size(), getCbPacketSize(data));
+}
+
+// a receive buffer of back to back packets, as read from a connection
+static void cbStreamIsConsumed(const std::vector<uint8_t>& stream) {
+    Reassembler reassembler;
+
+    ByteView remaining = stream;
+    while (!remaining.empty()) {
+        auto packet = parseCbPacket(remaining);
+        if (!packet.has_value())
+            break;
+
+        // every parsed packet consumes at least its header so this terminates
+        ASSERT_GE(packet->data().size(), sizeof(CbPacketHeader));
+        remaining = remaining.subspan(packet->data().size());
+
+        (void)reassembler.add(*packet);
+    }
+}
+
+static constexpr ReassemblyLimits kFuzzLimits = {
+    .maxMessageSize = 4096,
+    .maxPendingSize = 8192,
+    .maxPendingCount = 8,
+};
+
+static void reassemblyIsBounded(const std::vector<std::vector<uint8_t>>& datagrams) {
+    Reassembler reassembler{kFuzzLimits};
+
+    for (const auto& datagram : datagrams) {
+        auto packet = parseClPacket(datagram);
+        if (!packet.has_value())
+            continue;
+
+        auto message = reassembler.add(*packet);
+        if (message.has_value() && message->has_value()) {
+            EXPECT_LE(message->value().size(), std::max<size_t>(kFuzzLimits.maxMessageSize, packet->length()));
+        }
+
+        EXPECT_LE(reassembler.getPendingSize(), kFuzzLimits.maxPendingSize);
+        EXPECT_LE(reassembler.getPendingCount(), kFuzzLimits.maxPendingCount);
+    }
+}
+
+// random bytes rarely get past the version check, start from valid headers
+static std::vector<uint8_t> clSeed() {
+    std::vector<uint8_t> data(sizeof(ClPacketHeader) + 16);
+    data[offsetof(ClPacketHeader, version)] = kClVersion;
+    data[offsetof(ClPacketHeader, flags0)] = uint8_t(PacketFlags0::eMultiFragment);
+    data[offsetof(ClPacketHeader, drep)] = 0x10;
+    data[offsetof(ClPacketHeader, length)] = 16;
+    return data;
+}
+
+static std::vector<uint8_t> cbSeed() {
+    std::vector<uint8_t> data(sizeof(CbPacketHeader) + sizeof(CbRequestHeader) + 16);
+    data[offsetof(CbPacketHeader, version)] = kCbVersion;
+    data[offsetof(CbPacketHeader, flags)] = uint8_t(CbPacketFlags::eFirstFragment);
+    data[offsetof(CbPacketHeader, drep)] = 0x10;
+    data[offsetof(CbPacketHeader, fragLength)] = uint8_t(data.size());
+    return data;
+}
+
+FUZZ_TEST(OraRpcFuzz, clPacketsStayInBounds)
+    .WithSeeds({ clSeed() });
+
+FUZZ_TEST(OraRpcFuzz, cbPacketsStayInBounds)
+    .WithSeeds({ cbSeed() });
+
+FUZZ_TEST(OraRpcFuzz, cbStreamIsConsumed)
+    .WithSeeds({ cbSeed() });
+
+FUZZ_TEST(OraRpcFuzz, reassemblyIsBounded)
+    .WithSeeds({ std::vector { clSeed(), clSeed() } });
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    fuzztest::ParseAbslFlags(argc, argv);
+    fuzztest::InitFuzzTest(&argc, &argv);
+    return RUN_ALL_TESTS();
+}
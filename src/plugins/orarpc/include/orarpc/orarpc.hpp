@@ -2,10 +2,43 @@
 
 #include <stdint.h>
 
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <expected>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
 namespace sm::rpc {
     struct Uuid {
         uint64_t low;
         uint64_t high;
+
+        constexpr auto operator<=>(const Uuid&) const noexcept = default;
+    };
+
+    enum class PacketType : uint8_t {
+        eRequest = 0,
+        ePing = 1,
+        eResponse = 2,
+        eFault = 3,
+        eWorking = 4,
+        eNoCall = 5,
+        eReject = 6,
+        eAck = 7,
+        eClCancel = 8,
+        eFack = 9,
+        eCancelAck = 10,
+        eBind = 11,
+        eBindAck = 12,
+        eBindNak = 13,
+        eAlterContext = 14,
+        eAlterContextResponse = 15,
+        eShutdown = 17,
+        eCoCancel = 18,
+        eOrphaned = 19,
     };
 
     enum class PacketFlags0 : uint8_t {
@@ -30,6 +63,25 @@ namespace sm::rpc {
         eReserved6 = (1 << 7),
     };
 
+    enum class CbPacketFlags : uint8_t {
+        eFirstFragment = (1 << 0),
+        eLastFragment = (1 << 1),
+        eCancelPending = (1 << 2),
+        eReserved0 = (1 << 3),
+        eMultiplex = (1 << 4),
+        eDidNotExecute = (1 << 5),
+        eMaybe = (1 << 6),
+        eObjectUuid = (1 << 7),
+    };
+
+    constexpr bool operator&(PacketFlags0 lhs, PacketFlags0 rhs) noexcept {
+        return (uint8_t(lhs) & uint8_t(rhs)) != 0;
+    }
+
+    constexpr bool operator&(CbPacketFlags lhs, CbPacketFlags rhs) noexcept {
+        return (uint8_t(lhs) & uint8_t(rhs)) != 0;
+    }
+
     // cl prefixed types are for connectionless packets
     struct [[gnu::packed]] ClPacketHeader {
         uint8_t version;
@@ -41,6 +93,7 @@ namespace sm::rpc {
         Uuid object;
         Uuid interfaceId;
         Uuid activityId;
+        uint32_t serverBoot;
         uint32_t interfaceVersion;
         uint32_t sequence;
         uint16_t operation;
@@ -54,6 +107,273 @@ namespace sm::rpc {
 
     // cb prefixed types are for connection based packets
     struct [[gnu::packed]] CbPacketHeader {
+        uint8_t version;
+        uint8_t versionMinor;
+        uint8_t ptype;
+        CbPacketFlags flags;
+        uint8_t drep[4];
+        uint16_t fragLength;
+        uint16_t authLength;
+        uint32_t callId;
+    };
+
+    /// the body of request and response packets starts with these fields
+    struct [[gnu::packed]] CbRequestHeader {
+        uint32_t allocHint;
+        uint16_t contextId;
+        uint16_t operation;
+    };
+
+    /// trails the stub data of a packet with an auth verifier
+    struct [[gnu::packed]] CbSecurityTrailer {
+        uint8_t authType;
+        uint8_t authLevel;
+        uint8_t authPadLength;
+        uint8_t reserved;
+        uint32_t authContextId;
+    };
+
+    static_assert(sizeof(ClPacketHeader) == 80);
+    static_assert(sizeof(CbPacketHeader) == 16);
+    static_assert(sizeof(CbRequestHeader) == 8);
+    static_assert(sizeof(CbSecurityTrailer) == 8);
+
+    static constexpr uint8_t kClVersion = 4;
+    static constexpr uint8_t kCbVersion = 5;
+
+    enum class ParseError {
+        /// more data is needed before the packet can be parsed
+        eIncomplete,
+
+        /// the packet is not a version this parser understands
+        eUnsupportedVersion,
+
+        /// a length field disagrees with the size of the packet
+        eBadLength,
+
+        /// a fragment does not fit with the rest of its message
+        eBadFragment,
+
+        /// reassembling the message would exceed the configured limits
+        eTooLarge,
+    };
+
+    template<typename T>
+    using ParseResult = std::expected<T, ParseError>;
+
+    using ByteView = std::span<const uint8_t>;
+
+    namespace detail {
+        /// @brief read a field that was written in the senders byte order
+        template<typename T>
+        T loadField(const uint8_t *data, std::endian order) noexcept {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return (order == std::endian::native) ? value : std::byteswap(value);
+        }
+
+        /// @brief integer byte order from the first drep byte
+        constexpr std::endian getByteOrder(uint8_t drep) noexcept {
+            return (drep & 0xF0) ? std::endian::little : std::endian::big;
+        }
+    }
+
+#define SM_RPC_FIELD(TYPE, HEADER, NAME) \
+    TYPE NAME() const noexcept { return detail::loadField<TYPE>(mData.data() + offsetof(HEADER, NAME), mOrder); }
+
+    /// @brief a validated connectionless packet.
+    /// points into the buffer it was parsed from, fields are
+    /// converted from the senders byte order when they are read
+    class ClPacketView {
+        ByteView mData;
+        std::endian mOrder;
+
+    public:
+        ClPacketView(ByteView data) noexcept
+            : mData(data)
+            , mOrder(detail::getByteOrder(data[offsetof(ClPacketHeader, drep)]))
+        { }
+
+        const ClPacketHeader& header() const noexcept { return *reinterpret_cast<const ClPacketHeader*>(mData.data()); }
+
+        PacketType type() const noexcept { return PacketType(header().ptype & 0x1F); }
+        PacketFlags0 flags0() const noexcept { return header().flags0; }
+        PacketFlags1 flags1() const noexcept { return header().flags1; }
+        std::endian byteOrder() const noexcept { return mOrder; }
+
+        // uuids are used as opaque keys so are not byte swapped
+        Uuid object() const noexcept { return header().object; }
+        Uuid interfaceId() const noexcept { return header().interfaceId; }
+        Uuid activityId() const noexcept { return header().activityId; }
+
+        SM_RPC_FIELD(uint32_t, ClPacketHeader, serverBoot)
+        SM_RPC_FIELD(uint32_t, ClPacketHeader, interfaceVersion)
+        SM_RPC_FIELD(uint32_t, ClPacketHeader, sequence)
+        SM_RPC_FIELD(uint16_t, ClPacketHeader, operation)
+        SM_RPC_FIELD(uint16_t, ClPacketHeader, length)
+        SM_RPC_FIELD(uint16_t, ClPacketHeader, fragment)
+
+        bool isFragmented() const noexcept { return flags0() & PacketFlags0::eMultiFragment; }
+        bool isLastFragment() const noexcept { return flags0() & PacketFlags0::eLastFragment; }
+
+        /// @brief the stub data carried by this packet
+        ByteView body() const noexcept { return mData.subspan(sizeof(ClPacketHeader), length()); }
+
+        /// @brief the whole packet, including any auth verifier
+        ByteView data() const noexcept { return mData; }
+    };
+
+    /// @brief a validated connection based packet.
+    /// points into the buffer it was parsed from, fields are
+    /// converted from the senders byte order when they are read
+    class CbPacketView {
+        ByteView mData;
+        std::endian mOrder;
+
+    public:
+        CbPacketView(ByteView data) noexcept
+            : mData(data)
+            , mOrder(detail::getByteOrder(data[offsetof(CbPacketHeader, drep)]))
+        { }
+
+        const CbPacketHeader& header() const noexcept { return *reinterpret_cast<const CbPacketHeader*>(mData.data()); }
+
+        PacketType type() const noexcept { return PacketType(header().ptype); }
+        CbPacketFlags flags() const noexcept { return header().flags; }
+        std::endian byteOrder() const noexcept { return mOrder; }
+
+        SM_RPC_FIELD(uint16_t, CbPacketHeader, fragLength)
+        SM_RPC_FIELD(uint16_t, CbPacketHeader, authLength)
+        SM_RPC_FIELD(uint32_t, CbPacketHeader, callId)
+
+        bool isFirstFragment() const noexcept { return flags() & CbPacketFlags::eFirstFragment; }
+        bool isLastFragment() const noexcept { return flags() & CbPacketFlags::eLastFragment; }
+
+        /// @brief request and response packets carry stub data
+        bool hasBody() const noexcept { return type() == PacketType::eRequest || type() == PacketType::eResponse; }
+
+        /// @brief operation number of a request packet
+        uint16_t operation() const noexcept {
+            return detail::loadField<uint16_t>(mData.data() + sizeof(CbPacketHeader) + offsetof(CbRequestHeader, operation), mOrder);
+        }
+
+        /// @brief the stub data of a request or response, empty for other packet types
+        ByteView body() const noexcept;
+
+        /// @brief the whole packet
+        ByteView data() const noexcept { return mData; }
+    };
+
+#undef SM_RPC_FIELD
+
+    /// @brief validate a connectionless packet in place
+    /// @param data a single datagram
+    ParseResult<ClPacketView> parseClPacket(ByteView data) noexcept;
+
+    /// @brief validate the first connection based packet in a receive buffer.
+    /// the packet is @a CbPacketView::data().size() bytes long, the caller
+    /// consumes that much of the buffer before parsing the next one.
+    /// @return @a ParseError::eIncomplete until the whole packet has been received
+    ParseResult<CbPacketView> parseCbPacket(ByteView data) noexcept;
+
+    /// @brief total size of the connection based packet at the start of @p data
+    /// @return 0 if not enough of the header has arrived to tell
+    size_t getCbPacketSize(ByteView data) noexcept;
+
+    /// sizes are charged per fragment as its stub data plus a fixed overhead,
+    /// so a flood of empty fragments still counts against the limits
+    struct ReassemblyLimits {
+        /// @brief largest message that will be reassembled
+        size_t maxMessageSize = 1024 * 1024;
+
+        /// @brief limit on the total size of messages waiting for more fragments
+        size_t maxPendingSize = 4 * 1024 * 1024;
+
+        /// @brief limit on the number of messages waiting for more fragments
+        size_t maxPendingCount = 64;
+    };
+
+    /// @brief joins fragmented messages back together.
+    /// unfragmented packets are returned without copying, fragments are
+    /// held until their message completes. when the limits are reached
+    /// the oldest incomplete message is dropped to make room.
+    class Reassembler {
+        struct Fragment {
+            uint16_t number;
+            std::vector<uint8_t> data;
+        };
+
+        struct Message {
+            uint64_t age;
+
+            /// stub data received so far
+            size_t size = 0;
+
+            /// size charged against the limits, the stub data plus bookkeeping
+            size_t charged = 0;
+
+            int lastFragment = -1;
+            int highestFragment = -1;
+
+            /// one bit per fragment number that has arrived
+            std::vector<uint64_t> received;
+            std::vector<Fragment> fragments;
+
+            bool hasFragment(uint16_t number) const noexcept {
+                size_t word = number / 64;
+                return word < received.size() && (received[word] & (1ull << (number % 64)));
+            }
+        };
+
+        /// charged for each fragment on top of its stub data
+        static constexpr size_t kFragmentOverhead = sizeof(Fragment);
+
+        struct ClKey {
+            Uuid activity;
+            uint32_t sequence;
+
+            constexpr auto operator<=>(const ClKey&) const noexcept = default;
+        };
+
+        ReassemblyLimits mLimits;
+
+        std::map<ClKey, Message> mClMessages;
+        std::map<uint32_t, Message> mCbMessages;
+
+        size_t mPendingSize = 0;
+        uint64_t mAge = 0;
+
+        /// the most recently completed message
+        std::vector<uint8_t> mOutput;
+
+        template<typename K>
+        ParseResult<std::optional<ByteView>> addFragment(std::map<K, Message>& messages, const K& key, uint16_t number, bool last, ByteView data);
+
+        template<typename K>
+        void release(std::map<K, Message>& messages, typename std::map<K, Message>::iterator it) noexcept;
+
+        /// @return false if there was nothing other than @p keep to evict
+        bool evictOldest(const Message *keep) noexcept;
+        bool reserve(const Message *keep, size_t size) noexcept;
+
+    public:
+        Reassembler(const ReassemblyLimits& limits = {}) noexcept
+            : mLimits(limits)
+        { }
+
+        /// @brief add a connectionless packet, fragments may arrive in any order.
+        /// @return the stub data of the message once it is complete, nullopt
+        /// while more fragments are needed. the data is valid until the
+        /// next call to @a add or until the packet buffer is reused.
+        ParseResult<std::optional<ByteView>> add(const ClPacketView& packet);
+
+        /// @brief add a connection based packet, fragments of a call must arrive in order.
+        /// @return the stub data of the message once it is complete, nullopt
+        /// while more fragments are needed. the data is valid until the
+        /// next call to @a add or until the packet buffer is reused.
+        ParseResult<std::optional<ByteView>> add(const CbPacketView& packet);
 
+        size_t getPendingCount() const noexcept { return mClMessages.size() + mCbMessages.size(); }
+        size_t getPendingSize() const noexcept { return mPendingSize; }
     };
 }
@@ -8,6 +8,8 @@
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 
+#include <chrono>
+
 namespace sm::ssl {
     class SslError : public errors::Error<SslError> {
         using Super = errors::Error<SslError>;
@@ -76,6 +78,17 @@ namespace sm::ssl {
         X509 *get() { return mCert.get(); }
     };
 
+    struct SessionCacheConfig {
+        /// @brief how long a client can resume a session for
+        std::chrono::seconds timeout = std::chrono::minutes(5);
+
+        /// @brief number of sessions kept in the server side cache for tls 1.2 clients
+        long cacheSize = 1024 * 8;
+
+        /// @brief tls 1.3 tickets sent after each full handshake, 0 to disable tickets
+        size_t ticketCount = 2;
+    };
+
     class SslContext {
         using ContextHandle = std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)>;
         static ContextHandle create();
@@ -83,11 +96,30 @@ namespace sm::ssl {
         ContextHandle mContext;
 
     public:
-        SslContext(ssl::PrivateKey key, ssl::X509Certificate cert);
+        SslContext(ssl::PrivateKey key, ssl::X509Certificate cert, const SessionCacheConfig& config = {});
+
+        /// @brief number of handshakes that resumed a previous session
+        long getResumedCount();
 
         SSL_CTX *get() { return mContext.get(); }
     };
 
+    enum class SslStatus {
+        /// the operation completed
+        eDone,
+
+        /// retry once the socket is readable
+        eWantRead,
+
+        /// retry once the socket is writable
+        eWantWrite,
+
+        /// the peer closed the connection
+        eClosed,
+
+        eError,
+    };
+
     class SslSession {
         using SessionHandle = std::unique_ptr<SSL, decltype(&SSL_free)>;
         static SessionHandle createSession(SSL_CTX *context);
@@ -105,12 +137,25 @@ namespace sm::ssl {
 
         SslError accept();
 
+        /// @brief advance the handshake without blocking.
+        /// the socket must be non-blocking, call again when the socket
+        /// is ready for whatever the returned status asks for
+        SslStatus tryAccept();
+
+        /// @brief read without blocking
+        /// @param length set to the number of bytes read when the read completes
+        SslStatus tryRead(void *dst, int size, int& length);
+
+        /// @brief check if the handshake resumed a previous session
+        bool isResumed();
+
         int writeBytes(const void *src, int size);
 
         int readBytes(void *dst, int size);
 
         X509 *getPeerCertificate();
 
+        net::Socket& getSocket() { return mSocket; }
         SSL *get() { return mSession.get(); }
     };
 }
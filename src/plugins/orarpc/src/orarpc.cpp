@@ -0,0 +1,246 @@
+#include "orarpc/orarpc.hpp"
+
+#include <algorithm>
+
+using namespace sm;
+using namespace sm::rpc;
+
+///
+/// connectionless packets
+///
+
+ParseResult<ClPacketView> rpc::parseClPacket(ByteView data) noexcept {
+    if (data.size() < sizeof(ClPacketHeader))
+        return std::unexpected{ParseError::eBadLength};
+
+    if (data[offsetof(ClPacketHeader, version)] != kClVersion)
+        return std::unexpected{ParseError::eUnsupportedVersion};
+
+    ClPacketView packet{data};
+
+    // anything after the body is the auth verifier
+    if (sizeof(ClPacketHeader) + packet.length() > data.size())
+        return std::unexpected{ParseError::eBadLength};
+
+    return packet;
+}
+
+///
+/// connection based packets
+///
+
+// the object uuid is only present on requests
+static size_t getBodyOffset(const CbPacketView& packet) noexcept {
+    size_t offset = sizeof(CbPacketHeader) + sizeof(CbRequestHeader);
+    if (packet.type() == PacketType::eRequest && (packet.flags() & CbPacketFlags::eObjectUuid))
+        offset += sizeof(Uuid);
+
+    return offset;
+}
+
+// stub data is padded to align the security trailer, the padding is not part of the stub
+static size_t getTrailerSize(const CbPacketView& packet) noexcept {
+    size_t authLength = packet.authLength();
+    if (authLength == 0)
+        return 0;
+
+    ByteView data = packet.data();
+    size_t trailer = data.size() - authLength - sizeof(CbSecurityTrailer);
+    return authLength + sizeof(CbSecurityTrailer) + data[trailer + offsetof(CbSecurityTrailer, authPadLength)];
+}
+
+ByteView CbPacketView::body() const noexcept {
+    if (!hasBody())
+        return {};
+
+    size_t begin = getBodyOffset(*this);
+    size_t end = mData.size() - getTrailerSize(*this);
+    return mData.subspan(begin, end - begin);
+}
+
+size_t rpc::getCbPacketSize(ByteView data) noexcept {
+    if (data.size() < sizeof(CbPacketHeader))
+        return 0;
+
+    std::endian order = detail::getByteOrder(data[offsetof(CbPacketHeader, drep)]);
+    return detail::loadField<uint16_t>(data.data() + offsetof(CbPacketHeader, fragLength), order);
+}
+
+ParseResult<CbPacketView> rpc::parseCbPacket(ByteView data) noexcept {
+    if (data.size() < sizeof(CbPacketHeader))
+        return std::unexpected{ParseError::eIncomplete};
+
+    if (data[offsetof(CbPacketHeader, version)] != kCbVersion || data[offsetof(CbPacketHeader, versionMinor)] > 1)
+        return std::unexpected{ParseError::eUnsupportedVersion};
+
+    size_t size = getCbPacketSize(data);
+    if (size < sizeof(CbPacketHeader))
+        return std::unexpected{ParseError::eBadLength};
+
+    if (size > data.size())
+        return std::unexpected{ParseError::eIncomplete};
+
+    CbPacketView packet{data.first(size)};
+
+    // the auth verifier is at the very end of the packet
+    size_t authLength = packet.authLength();
+    size_t header = packet.hasBody() ? getBodyOffset(packet) : sizeof(CbPacketHeader);
+    size_t trailer = (authLength != 0) ? authLength + sizeof(CbSecurityTrailer) : 0;
+
+    if (header + trailer > size)
+        return std::unexpected{ParseError::eBadLength};
+
+    // padding comes out of the stub data
+    if (packet.hasBody() && getTrailerSize(packet) > size - header)
+        return std::unexpected{ParseError::eBadLength};
+
+    return packet;
+}
+
+///
+/// reassembly
+///
+
+template<typename K>
+void Reassembler::release(std::map<K, Message>& messages, typename std::map<K, Message>::iterator it) noexcept {
+    mPendingSize -= it->second.charged;
+    messages.erase(it);
+}
+
+bool Reassembler::evictOldest(const Message *keep) noexcept {
+    auto oldest = [&](auto& messages) {
+        return std::ranges::min_element(messages, {}, [&](const auto& entry) {
+            return (&entry.second == keep) ? UINT64_MAX : entry.second.age;
+        });
+    };
+
+    auto cl = oldest(mClMessages);
+    auto cb = oldest(mCbMessages);
+
+    bool hasCl = cl != mClMessages.end() && &cl->second != keep;
+    bool hasCb = cb != mCbMessages.end() && &cb->second != keep;
+
+    if (hasCl && (!hasCb || cl->second.age < cb->second.age)) {
+        release(mClMessages, cl);
+    } else if (hasCb) {
+        release(mCbMessages, cb);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+bool Reassembler::reserve(const Message *keep, size_t size) noexcept {
+    if (size > mLimits.maxPendingSize)
+        return false;
+
+    while (mPendingSize + size > mLimits.maxPendingSize) {
+        // only the message being added is left
+        if (!evictOldest(keep))
+            return false;
+    }
+
+    return true;
+}
+
+template<typename K>
+ParseResult<std::optional<ByteView>> Reassembler::addFragment(std::map<K, Message>& messages, const K& key, uint16_t number, bool last, ByteView data) {
+    auto it = messages.find(key);
+    if (it == messages.end()) {
+        if (getPendingCount() >= mLimits.maxPendingCount)
+            evictOldest(nullptr);
+
+        it = messages.emplace(key, Message { .age = mAge++ }).first;
+    }
+
+    Message& message = it->second;
+
+    auto reject = [&](ParseError error) -> ParseResult<std::optional<ByteView>> {
+        release(messages, it);
+        return std::unexpected{error};
+    };
+
+    // datagrams can be duplicated in flight
+    if (message.hasFragment(number))
+        return std::nullopt;
+
+    if (last) {
+        if (message.lastFragment != -1)
+            return reject(ParseError::eBadFragment);
+
+        message.lastFragment = number;
+    }
+
+    // no fragment can come after the last one
+    if (message.lastFragment != -1 && std::max<int>(message.highestFragment, number) > message.lastFragment)
+        return reject(ParseError::eBadFragment);
+
+    // the bitmap only grows to the highest fragment number seen, its growth is charged too
+    size_t words = size_t(number) / 64 + 1;
+    size_t growth = (words > message.received.size()) ? (words - message.received.size()) * sizeof(uint64_t) : 0;
+    size_t cost = data.size() + kFragmentOverhead + growth;
+
+    if (message.charged + cost > mLimits.maxMessageSize || !reserve(&message, cost))
+        return reject(ParseError::eTooLarge);
+
+    if (growth != 0)
+        message.received.resize(words);
+
+    message.received[number / 64] |= (1ull << (number % 64));
+    message.highestFragment = std::max<int>(message.highestFragment, number);
+
+    message.fragments.push_back(Fragment { number, { data.begin(), data.end() } });
+    message.size += data.size();
+    message.charged += cost;
+    mPendingSize += cost;
+
+    if (message.lastFragment == -1 || message.fragments.size() != size_t(message.lastFragment) + 1)
+        return std::nullopt;
+
+    // every fragment number up to the last is present once, so this is a complete sequence
+    std::ranges::sort(message.fragments, {}, &Fragment::number);
+
+    mOutput.clear();
+    mOutput.reserve(message.size);
+    for (const Fragment& fragment : message.fragments)
+        mOutput.insert(mOutput.end(), fragment.data.begin(), fragment.data.end());
+
+    release(messages, it);
+
+    return ByteView{mOutput};
+}
+
+ParseResult<std::optional<ByteView>> Reassembler::add(const ClPacketView& packet) {
+    if (!packet.isFragmented())
+        return packet.body();
+
+    ClKey key { packet.activityId(), packet.sequence() };
+    return addFragment(mClMessages, key, packet.fragment(), packet.isLastFragment(), packet.body());
+}
+
+ParseResult<std::optional<ByteView>> Reassembler::add(const CbPacketView& packet) {
+    if (packet.isFirstFragment() && packet.isLastFragment())
+        return packet.body();
+
+    uint32_t call = packet.callId();
+    auto it = mCbMessages.find(call);
+
+    // a new first fragment abandons whatever was left of the previous call
+    if (packet.isFirstFragment() && it != mCbMessages.end()) {
+        release(mCbMessages, it);
+        it = mCbMessages.end();
+    }
+
+    if (!packet.isFirstFragment() && it == mCbMessages.end())
+        return std::unexpected{ParseError::eBadFragment};
+
+    // fragments on a connection arrive in order, so they are numbered as they arrive
+    size_t number = (it != mCbMessages.end()) ? it->second.fragments.size() : 0;
+    if (number > UINT16_MAX) {
+        release(mCbMessages, it);
+        return std::unexpected{ParseError::eTooLarge};
+    }
+
+    return addFragment(mCbMessages, call, uint16_t(number), packet.isLastFragment(), packet.body());
+}
@@ -198,13 +198,41 @@ static void setupEncryptionConfig(SSL_CTX *context, ssl::PrivateKey key, ssl::X5
     }
 }
 
-SslContext::SslContext(ssl::PrivateKey key, ssl::X509Certificate cert)
+// resumed sessions must come from a context with the same id when peers are verified
+static constexpr unsigned char kSessionIdContext[] = "orarpc";
+
+static void setupSessionCache(SSL_CTX *context, const SessionCacheConfig& config) {
+    if (SSL_CTX_set_session_id_context(context, kSessionIdContext, sizeof(kSessionIdContext) - 1) != 1) {
+        throw SslException{SslError::errorOf("SSL_CTX_set_session_id_context")};
+    }
+
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(context, config.cacheSize);
+    SSL_CTX_set_timeout(context, long(config.timeout.count()));
+
+    if (config.ticketCount == 0) {
+        SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+    } else {
+        SSL_CTX_clear_options(context, SSL_OP_NO_TICKET);
+    }
+
+    if (SSL_CTX_set_num_tickets(context, config.ticketCount) != 1) {
+        throw SslException{SslError::errorOf("SSL_CTX_set_num_tickets")};
+    }
+}
+
+SslContext::SslContext(ssl::PrivateKey key, ssl::X509Certificate cert, const SessionCacheConfig& config)
     : mContext(create())
 {
     setupEncryptionConfig(mContext.get(), std::move(key), std::move(cert));
+    setupSessionCache(mContext.get(), config);
     SSL_CTX_set_verify(mContext.get(), SSL_VERIFY_PEER, nullptr);
 }
 
+long SslContext::getResumedCount() {
+    return SSL_CTX_sess_hits(mContext.get());
+}
+
 ///
 /// ssl session
 ///
@@ -238,6 +266,34 @@ SslError SslSession::accept() {
     }
 }
 
+// the error queue is per thread and only describes the last call
+// if it was cleared before the call was made
+static SslStatus getStatus(SSL *ssl, int rc) {
+    switch (SSL_get_error(ssl, rc)) {
+    case SSL_ERROR_NONE: return SslStatus::eDone;
+    case SSL_ERROR_WANT_READ: return SslStatus::eWantRead;
+    case SSL_ERROR_WANT_WRITE: return SslStatus::eWantWrite;
+    case SSL_ERROR_ZERO_RETURN: return SslStatus::eClosed;
+    default: return SslStatus::eError;
+    }
+}
+
+SslStatus SslSession::tryAccept() {
+    ERR_clear_error();
+    return getStatus(mSession.get(), SSL_accept(mSession.get()));
+}
+
+SslStatus SslSession::tryRead(void *dst, int size, int& length) {
+    ERR_clear_error();
+    int rc = SSL_read(mSession.get(), dst, size);
+    length = std::max(rc, 0);
+    return getStatus(mSession.get(), rc);
+}
+
+bool SslSession::isResumed() {
+    return SSL_session_reused(mSession.get()) == 1;
+}
+
 int SslSession::writeBytes(const void *src, int size) {
     return SSL_write(mSession.get(), src, size);
 }
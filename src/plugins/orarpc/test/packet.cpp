@@ -0,0 +1,302 @@
+#include "test/common.hpp"
+
+#include "orarpc/orarpc.hpp"
+
+#include <chrono>
+
+using namespace sm::rpc;
+
+using Buffer = std::vector<uint8_t>;
+
+template<typename T>
+static void store(uint8_t *dst, T value, std::endian order) {
+    if (order != std::endian::native)
+        value = std::byteswap(value);
+
+    std::memcpy(dst, &value, sizeof(T));
+}
+
+static uint8_t getDrep(std::endian order) {
+    return (order == std::endian::little) ? 0x10 : 0x00;
+}
+
+struct ClFragment {
+    uint32_t sequence = 0;
+    uint16_t number = 0;
+    bool last = false;
+    Buffer body;
+};
+
+static Buffer buildClPacket(const ClFragment& fragment, std::endian order = std::endian::little) {
+    Buffer datagram(sizeof(ClPacketHeader) + fragment.body.size());
+    uint8_t *data = datagram.data();
+
+    uint8_t flags = uint8_t(PacketFlags0::eMultiFragment);
+    if (fragment.last)
+        flags |= uint8_t(PacketFlags0::eLastFragment);
+
+    data[offsetof(ClPacketHeader, version)] = kClVersion;
+    data[offsetof(ClPacketHeader, flags0)] = flags;
+    data[offsetof(ClPacketHeader, drep)] = getDrep(order);
+    store<uint32_t>(data + offsetof(ClPacketHeader, sequence), fragment.sequence, order);
+    store<uint16_t>(data + offsetof(ClPacketHeader, length), uint16_t(fragment.body.size()), order);
+    store<uint16_t>(data + offsetof(ClPacketHeader, fragment), fragment.number, order);
+
+    std::memcpy(data + sizeof(ClPacketHeader), fragment.body.data(), fragment.body.size());
+    return datagram;
+}
+
+static Buffer buildCbPacket(uint32_t call, bool first, bool last, const Buffer& body, std::endian order = std::endian::little) {
+    size_t length = sizeof(CbPacketHeader) + sizeof(CbRequestHeader) + body.size();
+    Buffer packet(length);
+    uint8_t *data = packet.data();
+
+    uint8_t flags = 0;
+    if (first) flags |= uint8_t(CbPacketFlags::eFirstFragment);
+    if (last) flags |= uint8_t(CbPacketFlags::eLastFragment);
+
+    data[offsetof(CbPacketHeader, version)] = kCbVersion;
+    data[offsetof(CbPacketHeader, ptype)] = uint8_t(PacketType::eRequest);
+    data[offsetof(CbPacketHeader, flags)] = flags;
+    data[offsetof(CbPacketHeader, drep)] = getDrep(order);
+    store<uint16_t>(data + offsetof(CbPacketHeader, fragLength), uint16_t(length), order);
+    store<uint32_t>(data + offsetof(CbPacketHeader, callId), call, order);
+    store<uint16_t>(data + sizeof(CbPacketHeader) + offsetof(CbRequestHeader, operation), 7, order);
+
+    std::memcpy(data + sizeof(CbPacketHeader) + sizeof(CbRequestHeader), body.data(), body.size());
+    return packet;
+}
+
+static ParseResult<std::optional<ByteView>> addCl(Reassembler& reassembler, const ClFragment& fragment) {
+    Buffer datagram = buildClPacket(fragment);
+    return reassembler.add(parseClPacket(datagram).value());
+}
+
+static Buffer getBytes(std::optional<ByteView> view) {
+    REQUIRE(view.has_value());
+    return { view->begin(), view->end() };
+}
+
+TEST_CASE("Connectionless header parsing") {
+    for (std::endian order : { std::endian::little, std::endian::big }) {
+        Buffer datagram = buildClPacket({ .sequence = 0x01020304, .number = 0x0506, .last = true, .body = { 1, 2, 3 } }, order);
+
+        auto packet = parseClPacket(datagram);
+        REQUIRE(packet.has_value());
+
+        // fields are read back the same whichever order they were written in
+        CHECK(packet->byteOrder() == order);
+        CHECK(packet->sequence() == 0x01020304);
+        CHECK(packet->fragment() == 0x0506);
+        CHECK(packet->length() == 3);
+        CHECK(packet->isFragmented());
+        CHECK(packet->isLastFragment());
+        CHECK(packet->body().size() == 3);
+        CHECK(packet->body()[2] == 3);
+    }
+
+    SECTION("truncated packets are rejected") {
+        Buffer datagram = buildClPacket({ .body = { 1, 2, 3 } });
+
+        CHECK(parseClPacket(ByteView{datagram}.first(sizeof(ClPacketHeader) - 1)).error() == ParseError::eBadLength);
+        CHECK(parseClPacket(ByteView{datagram}.first(sizeof(ClPacketHeader) + 2)).error() == ParseError::eBadLength);
+    }
+
+    SECTION("other versions are rejected") {
+        Buffer datagram = buildClPacket({});
+        datagram[offsetof(ClPacketHeader, version)] = kCbVersion;
+
+        CHECK(parseClPacket(datagram).error() == ParseError::eUnsupportedVersion);
+    }
+}
+
+TEST_CASE("Connection based header parsing") {
+    for (std::endian order : { std::endian::little, std::endian::big }) {
+        Buffer packet = buildCbPacket(0xA0B0C0D0, true, true, { 9, 8, 7, 6 }, order);
+
+        CHECK(getCbPacketSize(packet) == packet.size());
+
+        auto view = parseCbPacket(packet);
+        REQUIRE(view.has_value());
+
+        CHECK(view->byteOrder() == order);
+        CHECK(view->callId() == 0xA0B0C0D0);
+        CHECK(view->fragLength() == packet.size());
+        CHECK(view->operation() == 7);
+        CHECK(view->isFirstFragment());
+        CHECK(view->isLastFragment());
+        CHECK(view->body().size() == 4);
+        CHECK(view->body()[0] == 9);
+    }
+
+    SECTION("a partial packet needs more data") {
+        Buffer packet = buildCbPacket(1, true, true, { 1, 2, 3, 4 });
+
+        CHECK(getCbPacketSize(ByteView{packet}.first(sizeof(CbPacketHeader) - 1)) == 0);
+        CHECK(parseCbPacket(ByteView{packet}.first(4)).error() == ParseError::eIncomplete);
+        CHECK(parseCbPacket(ByteView{packet}.first(packet.size() - 1)).error() == ParseError::eIncomplete);
+    }
+
+    SECTION("back to back packets are parsed one at a time") {
+        Buffer stream = buildCbPacket(1, true, true, { 1 });
+        Buffer second = buildCbPacket(2, true, true, { 2, 2 });
+        stream.insert(stream.end(), second.begin(), second.end());
+
+        auto first = parseCbPacket(stream);
+        REQUIRE(first.has_value());
+        CHECK(first->callId() == 1);
+
+        auto next = parseCbPacket(ByteView{stream}.subspan(first->data().size()));
+        REQUIRE(next.has_value());
+        CHECK(next->callId() == 2);
+        CHECK(next->body().size() == 2);
+    }
+
+    SECTION("a length shorter than the header is rejected") {
+        Buffer packet = buildCbPacket(1, true, true, {});
+        store<uint16_t>(packet.data() + offsetof(CbPacketHeader, fragLength), 4, std::endian::little);
+
+        CHECK(parseCbPacket(packet).error() == ParseError::eBadLength);
+    }
+}
+
+TEST_CASE("Connectionless reassembly") {
+    Reassembler reassembler;
+
+    SECTION("fragments may arrive out of order") {
+        CHECK(addCl(reassembler, { .number = 2, .last = true, .body = { 5, 6 } }).value() == std::nullopt);
+        CHECK(addCl(reassembler, { .number = 0, .body = { 1, 2 } }).value() == std::nullopt);
+        CHECK(reassembler.getPendingCount() == 1);
+
+        auto message = addCl(reassembler, { .number = 1, .body = { 3, 4 } });
+        REQUIRE(message.has_value());
+        CHECK(getBytes(*message) == Buffer { 1, 2, 3, 4, 5, 6 });
+
+        CHECK(reassembler.getPendingCount() == 0);
+        CHECK(reassembler.getPendingSize() == 0);
+    }
+
+    SECTION("duplicates are ignored") {
+        CHECK(addCl(reassembler, { .number = 0, .body = { 1 } }).value() == std::nullopt);
+        size_t pending = reassembler.getPendingSize();
+
+        CHECK(addCl(reassembler, { .number = 0, .body = { 9 } }).value() == std::nullopt);
+        CHECK(reassembler.getPendingSize() == pending);
+
+        auto message = addCl(reassembler, { .number = 1, .last = true, .body = { 2 } });
+        CHECK(getBytes(*message) == Buffer { 1, 2 });
+    }
+
+    SECTION("a second last fragment is rejected") {
+        CHECK(addCl(reassembler, { .number = 3, .last = true }).value() == std::nullopt);
+        CHECK(addCl(reassembler, { .number = 4, .last = true }).error() == ParseError::eBadFragment);
+        CHECK(reassembler.getPendingCount() == 0);
+    }
+
+    SECTION("fragments after the last are rejected") {
+        CHECK(addCl(reassembler, { .number = 5 }).value() == std::nullopt);
+        CHECK(addCl(reassembler, { .number = 2, .last = true }).error() == ParseError::eBadFragment);
+
+        CHECK(addCl(reassembler, { .number = 1, .last = true }).value() == std::nullopt);
+        CHECK(addCl(reassembler, { .number = 3 }).error() == ParseError::eBadFragment);
+        CHECK(reassembler.getPendingCount() == 0);
+    }
+
+    SECTION("messages are keyed by sequence") {
+        CHECK(addCl(reassembler, { .sequence = 1, .number = 0, .body = { 1 } }).value() == std::nullopt);
+        CHECK(addCl(reassembler, { .sequence = 2, .number = 0, .body = { 2 } }).value() == std::nullopt);
+
+        auto message = addCl(reassembler, { .sequence = 2, .number = 1, .last = true, .body = { 3 } });
+        CHECK(getBytes(*message) == Buffer { 2, 3 });
+        CHECK(reassembler.getPendingCount() == 1);
+    }
+}
+
+TEST_CASE("Connection based reassembly") {
+    Reassembler reassembler;
+
+    auto add = [&](uint32_t call, bool first, bool last, const Buffer& body) {
+        Buffer packet = buildCbPacket(call, first, last, body);
+        return reassembler.add(parseCbPacket(packet).value());
+    };
+
+    SECTION("fragments are joined in arrival order") {
+        CHECK(add(1, true, false, { 1, 2 }).value() == std::nullopt);
+        CHECK(add(1, false, false, { 3 }).value() == std::nullopt);
+
+        auto message = add(1, false, true, { 4 });
+        CHECK(getBytes(*message) == Buffer { 1, 2, 3, 4 });
+        CHECK(reassembler.getPendingCount() == 0);
+    }
+
+    SECTION("a fragment without a first fragment is rejected") {
+        CHECK(add(1, false, true, { 1 }).error() == ParseError::eBadFragment);
+    }
+
+    SECTION("a new first fragment restarts the call") {
+        CHECK(add(1, true, false, { 1 }).value() == std::nullopt);
+        CHECK(add(1, true, false, { 2 }).value() == std::nullopt);
+
+        auto message = add(1, false, true, { 3 });
+        CHECK(getBytes(*message) == Buffer { 2, 3 });
+    }
+}
+
+TEST_CASE("Reassembly limits") {
+    SECTION("messages over the size limit are dropped") {
+        Reassembler reassembler{{ .maxMessageSize = 160 }};
+
+        CHECK(addCl(reassembler, { .number = 0, .body = Buffer(100) }).value() == std::nullopt);
+        CHECK(addCl(reassembler, { .number = 1, .body = Buffer(100) }).error() == ParseError::eTooLarge);
+        CHECK(reassembler.getPendingCount() == 0);
+        CHECK(reassembler.getPendingSize() == 0);
+    }
+
+    SECTION("the oldest message is evicted when pending data is full") {
+        Reassembler reassembler{{ .maxMessageSize = 256, .maxPendingSize = 256 }};
+
+        CHECK(addCl(reassembler, { .sequence = 1, .body = Buffer(80) }).value() == std::nullopt);
+        CHECK(addCl(reassembler, { .sequence = 2, .body = Buffer(80) }).value() == std::nullopt);
+        CHECK(reassembler.getPendingCount() == 2);
+
+        CHECK(addCl(reassembler, { .sequence = 3, .body = Buffer(80) }).value() == std::nullopt);
+        CHECK(reassembler.getPendingCount() == 2);
+        CHECK(reassembler.getPendingSize() <= 256);
+
+        // sequence 1 was evicted, so its last fragment starts a new incomplete message
+        CHECK(addCl(reassembler, { .sequence = 1, .number = 1, .last = true }).value() == std::nullopt);
+
+        auto message = addCl(reassembler, { .sequence = 3, .number = 1, .last = true, .body = { 1 } });
+        CHECK(getBytes(*message).size() == 81);
+    }
+
+    SECTION("the oldest message is evicted when there are too many") {
+        Reassembler reassembler{{ .maxPendingCount = 2 }};
+
+        for (uint32_t i = 0; i < 10; i++)
+            CHECK(addCl(reassembler, { .sequence = i }).value() == std::nullopt);
+
+        CHECK(reassembler.getPendingCount() == 2);
+    }
+
+    SECTION("empty fragments count against the limits") {
+        Reassembler reassembler{{ .maxMessageSize = 64 * 1024, .maxPendingSize = 64 * 1024 }};
+
+        auto start = std::chrono::steady_clock::now();
+
+        bool limited = false;
+        for (uint16_t i = 0; i < 30'000 && !limited; i++) {
+            auto result = addCl(reassembler, { .number = i });
+            limited = !result.has_value();
+
+            CHECK(reassembler.getPendingSize() <= 64 * 1024);
+        }
+
+        // each fragment costs something, so the flood is cut off well before 30000
+        CHECK(limited);
+        CHECK(reassembler.getPendingCount() == 0);
+
+        // and duplicate checks do not scan every stored fragment
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+    }
+}
@@ -12,7 +12,15 @@
 
 #include "system/system.hpp"
 
+#include <blockingconcurrentqueue.h>
+
+#include <algorithm>
 #include <csignal>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <poll.h>
 #include <sys/stat.h>
 
 using namespace sm;
@@ -123,6 +131,276 @@ static ssl::X509Certificate loadCertificate(ssl::PrivateKey& key) {
     return cert;
 }
 
+/// writes captured client data on its own thread so
+/// the event loop never waits on the file system
+class CaptureWriter {
+    struct Write {
+        std::string path;
+        std::string data;
+
+        /// close the file once the data is written
+        bool close = false;
+    };
+
+    moodycamel::BlockingConcurrentQueue<Write> mQueue;
+
+    // only touched by the writer thread
+    std::unordered_map<std::string, std::ofstream> mFiles;
+
+    std::jthread mWorkerThread;
+
+    void writeFile(Write& write) {
+        auto [it, inserted] = mFiles.try_emplace(write.path);
+        if (inserted) {
+            it->second.open(write.path, std::ios::binary | std::ios::app);
+            if (!it->second.is_open()) {
+                LOG_ERROR(GlobalLog, "failed to open {}", write.path);
+            }
+        }
+
+        it->second.write(write.data.data(), write.data.size());
+
+        if (write.close) {
+            mFiles.erase(it);
+        }
+    }
+
+    void workerThread(const std::stop_token& stop) {
+        Write write;
+        while (!stop.stop_requested()) {
+            if (mQueue.wait_dequeue_timed(write, 100ms)) {
+                writeFile(write);
+            }
+        }
+
+        // write anything queued before shutdown
+        while (mQueue.try_dequeue(write)) {
+            writeFile(write);
+        }
+    }
+
+public:
+    CaptureWriter()
+        : mWorkerThread([this](const std::stop_token& stop) { workerThread(stop); })
+    { }
+
+    void write(std::string path, std::string data) {
+        mQueue.enqueue(Write { std::move(path), std::move(data) });
+    }
+
+    void close(std::string path, std::string data = "") {
+        mQueue.enqueue(Write { std::move(path), std::move(data), true });
+    }
+};
+
+static constexpr auto kHandshakeTimeout = 10s;
+
+// large enough to hold any tls record, so each read consumes a
+// whole record and nothing is left buffered inside the session
+static constexpr int kReadBufferSize = 16 * 1024;
+
+// stops a single client from starving the others
+static constexpr int kMaxReadsPerWake = 16;
+
+// connections past this wait in the listen backlog until a handshake
+// completes or times out, so stalled clients cannot pile up sessions
+static constexpr size_t kMaxPendingHandshakes = 256;
+
+struct OnsClient {
+    int id;
+    std::unique_ptr<ssl::SslSession> session;
+
+    /// the handshake must complete by this time
+    std::chrono::steady_clock::time_point deadline;
+
+    bool connected = false;
+    ssl::SslStatus want = ssl::SslStatus::eWantRead;
+
+    std::string logPath() const { return fmt::format("/opt/shared/logs/server_{:0>8}.log", id); }
+    std::string messagePath() const { return fmt::format("/opt/shared/messages/client_{:0>8}.bin", id); }
+    std::string certPath() const { return fmt::format("/opt/shared/certs/client_{:0>8}.pem", id); }
+};
+
+class OnsListener {
+    net::ListenSocket& mServer;
+    ssl::SslContext& mContext;
+    CaptureWriter& mWriter;
+
+    std::vector<std::unique_ptr<OnsClient>> mClients;
+    std::vector<pollfd> mPollFds;
+    std::vector<net::Socket> mAccepted;
+
+    int mNextId = 0;
+
+    size_t getPendingCount() const {
+        return std::ranges::count_if(mClients, [](const auto& client) { return !client->connected; });
+    }
+
+    void acceptClients(size_t limit) {
+        mAccepted.clear();
+        if (net::NetError error = mServer.acceptBatch(mAccepted, 0ms, limit)) {
+            LOG_ERROR(GlobalLog, "failed to accept clients: {}", error);
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + kHandshakeTimeout;
+
+        for (net::Socket& socket : mAccepted) {
+            auto client = std::make_unique<OnsClient>(OnsClient { .id = mNextId++, .deadline = deadline });
+
+            mWriter.write(client->logPath(), "Client connected\n");
+            LOG_INFO(GlobalLog, "Client {} connected", client->id);
+
+            client->session = std::make_unique<ssl::SslSession>(mContext, std::move(socket));
+            mClients.push_back(std::move(client));
+        }
+    }
+
+    void onHandshakeComplete(OnsClient& client) {
+        client.connected = true;
+
+        ssl::SslSession& session = *client.session;
+        std::string log = session.isResumed() ? "Client resumed session\n" : "";
+
+        if (X509 *cert = session.getPeerCertificate()) {
+            defer { X509_free(cert); };
+
+            std::ostringstream pem;
+            ssl::X509Certificate::save(pem, cert);
+            mWriter.close(client.certPath(), std::move(pem).str());
+
+            log += "Client presented certificate\n";
+        } else {
+            log += "Client presented no certificate\n";
+            LOG_WARN(GlobalLog, "Client {} presented no certificate", client.id);
+        }
+
+        mWriter.write(client.logPath(), std::move(log));
+    }
+
+    /// @return false once the client should be dropped
+    bool advance(OnsClient& client) {
+        ssl::SslSession& session = *client.session;
+
+        if (!client.connected) {
+            ssl::SslStatus status = session.tryAccept();
+            switch (status) {
+            case ssl::SslStatus::eDone:
+                onHandshakeComplete(client);
+                break;
+
+            case ssl::SslStatus::eWantRead:
+            case ssl::SslStatus::eWantWrite:
+                client.want = status;
+                return true;
+
+            default: {
+                ssl::SslError error = ssl::SslError::errorOf("SSL_accept");
+                mWriter.close(client.logPath(), fmt::format("Client failed to connect: {}\n", error));
+                LOG_INFO(GlobalLog, "Client {} failed to connect: {}", client.id, error);
+                return false;
+            }
+            }
+        }
+
+        char buffer[kReadBufferSize];
+        for (int i = 0; i < kMaxReadsPerWake; i++) {
+            int length = 0;
+            ssl::SslStatus status = session.tryRead(buffer, sizeof(buffer), length);
+            switch (status) {
+            case ssl::SslStatus::eDone:
+                mWriter.write(client.messagePath(), std::string(buffer, length));
+                break;
+
+            case ssl::SslStatus::eWantRead:
+            case ssl::SslStatus::eWantWrite:
+                client.want = status;
+                return true;
+
+            case ssl::SslStatus::eClosed:
+                disconnect(client);
+                return false;
+
+            default:
+                LOG_ERROR(GlobalLog, "Client {} read error: {}", client.id, ssl::SslError::errorOf("SSL_read"));
+                disconnect(client);
+                return false;
+            }
+        }
+
+        // the rest of the data is still queued on the socket, so poll wakes us again
+        client.want = ssl::SslStatus::eWantRead;
+        return true;
+    }
+
+    void disconnect(OnsClient& client) {
+        mWriter.close(client.messagePath());
+        mWriter.close(client.logPath(), "Client disconnected\n");
+        LOG_INFO(GlobalLog, "Client {} disconnected", client.id);
+    }
+
+    bool isExpired(const OnsClient& client, std::chrono::steady_clock::time_point now) {
+        if (client.connected || now < client.deadline)
+            return false;
+
+        mWriter.close(client.logPath(), "Client handshake timed out\n");
+        LOG_WARN(GlobalLog, "Client {} did not complete the handshake in time", client.id);
+        return true;
+    }
+
+public:
+    OnsListener(net::ListenSocket& server, ssl::SslContext& context, CaptureWriter& writer)
+        : mServer(server)
+        , mContext(context)
+        , mWriter(writer)
+    { }
+
+    void run() {
+        while (true) {
+            bool accepting = getPendingCount() < kMaxPendingHandshakes;
+
+            mPollFds.clear();
+            mPollFds.push_back(pollfd { .fd = mServer.get(), .events = short(accepting ? POLLIN : 0) });
+
+            for (const auto& client : mClients) {
+                short events = client->want == ssl::SslStatus::eWantWrite ? POLLOUT : POLLIN;
+                mPollFds.push_back(pollfd { .fd = client->session->getSocket().get(), .events = events });
+            }
+
+            // wake up periodically to expire stalled handshakes
+            int ready = ::poll(mPollFds.data(), mPollFds.size(), 1000);
+            if (ready == -1) {
+                if (errno == EINTR)
+                    continue;
+
+                throw OsException(OsError(errno), "poll");
+            }
+
+            auto now = std::chrono::steady_clock::now();
+
+            // clients are polled in the same order they are stored
+            for (size_t i = 0; i < mClients.size(); i++) {
+                OnsClient& client = *mClients[i];
+                short revents = mPollFds[i + 1].revents;
+
+                // a client that keeps sending but never finishes the handshake
+                // still has to be expired
+                bool keep = !isExpired(client, now) && (revents == 0 || advance(client));
+                if (!keep) {
+                    client.session.reset();
+                }
+            }
+
+            std::erase_if(mClients, [](const auto& client) { return client->session == nullptr; });
+
+            // accepted after servicing so the indices above still line up
+            size_t pending = getPendingCount();
+            if ((mPollFds[0].revents & POLLIN) && pending < kMaxPendingHandshakes) {
+                acceptClients(kMaxPendingHandshakes - pending);
+            }
+        }
+    }
+};
+
 int commonMain(launch::LaunchResult&) noexcept try {
     auto args = system::getCommandLine();
     if (args.size() < 2) {
@@ -175,50 +453,12 @@ int commonMain(launch::LaunchResult&) noexcept try {
 
     LOG_INFO(GlobalLog, "Successfully loaded ssl context");
 
-    int i = 0;
-    while (true) {
-        std::ofstream logFile(fmt::format("/opt/shared/logs/server_{:0>8}.log", i++));
-        ssl::SslSession session(sslContext, server.accept());
-        std::ofstream messageFile(fmt::format("/opt/shared/messages/client_{:0>8}.bin", i));
-
-        logFile << "Client connected\n";
-        LOG_INFO(GlobalLog, "Client {} connected", i);
+    // clients that disconnect mid write would otherwise kill the daemon
+    std::signal(SIGPIPE, SIG_IGN);
 
-        if (ssl::SslError error = session.accept()) {
-            logFile << "Client failed to connect: " << fmt::to_string(error) << '\n';
-            LOG_INFO(GlobalLog, "Client {} failed to connect: {}", i, error);
-            continue;
-        }
-
-        std::ofstream certFile(fmt::format("/opt/shared/certs/client_{:0>8}.pem", i));
-
-        if (X509 *cert = session.getPeerCertificate()) {
-            logFile << "Client presented certificate\n";
-            ssl::X509Certificate::save(certFile, cert);
-        } else {
-            logFile << "Client presented no certificate\n";
-            LOG_WARN(GlobalLog, "Client {} presented no certificate", i);
-        }
-
-        char buffer[1024];
-        while (true) {
-            int length = session.readBytes(buffer, sizeof(buffer));
-            if (length == -1) {
-                LOG_ERROR(GlobalLog, "Client {} read error: {}", i, ssl::SslError::errorOf("SSL_read"));
-                break;
-            }
-
-            if (length == 0) {
-                break;
-            }
-
-            messageFile.write(buffer, length);
-        }
-
-        logFile << "Client disconnected\n";
-
-        LOG_INFO(GlobalLog, "Client {} disconnected", i);
-    }
+    CaptureWriter writer;
+    OnsListener listener{ server, sslContext, writer };
+    listener.run();
 
 #if 0
     int i = 0;
@@ -34,6 +34,18 @@ static sm::opt<uint16_t> gServerPort {
     init = 9919
 };
 
+static sm::opt<int> gListenBacklog {
+    name = "backlog",
+    desc = "Pending connection queue size of each listener",
+    init = net::ListenSocket::kMaxBacklog
+};
+
+static sm::opt<unsigned> gListenThreads {
+    name = "listeners",
+    desc = "Number of SO_REUSEPORT listeners to accept connections on",
+    init = 1
+};
+
 static void serverGui(game::AccountServer &server) {
     launch::GuiWindow window{"Server"};
     while (!window.shouldClose()) {
@@ -51,11 +63,12 @@ static int serverMain() {
     game::AccountServer server {
         sqlite.connect({ .host = "server-users.db" }),
         network,
-        address, gServerPort.getValue()
+        address, gServerPort.getValue(),
+        std::nullopt, gListenThreads.getValue()
     };
 
     std::jthread serverThread = std::jthread([&](const std::stop_token& stop) {
-        server.begin(16);
+        server.begin(gListenBacklog.getValue());
 
         std::stop_callback cb(stop, [&] {
             LOG_INFO(ServerLog, "Stopping server");